@@ -0,0 +1,106 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the Arduino core: fixed-width types, the C
+ *        library, Print and Serial, timing and GPIO. Timing and pins are
+ *        backed by the simulated board in hostBoard.h; only what the
+ *        modules built by host/CMakeLists.txt use is here.
+ */
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+using std::max;
+using std::min;
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define OPEN_DRAIN 0x10
+#define OUTPUT_OPEN_DRAIN 0x13
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define IRAM_ATTR
+
+#define _BV(bit) (1UL << (bit))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Character sink; the host version only formats, subclasses decide where
+// the bytes go
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+
+    size_t write(const char *s)
+    {
+        size_t n = 0;
+        while (*s)
+            n += write((uint8_t)*s++);
+        return n;
+    }
+    size_t print(const char *s) { return write(s); }
+    size_t println(const char *s = "") { return write(s) + write("\r\n"); }
+    size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buf[256];
+        va_list ap;
+        va_start(ap, fmt);
+        vsnprintf(buf, sizeof(buf), fmt, ap);
+        va_end(ap);
+        return write(buf);
+    }
+};
+
+// UART0: stdout, unless hostSerialEcho(false)
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c) override;
+    using Print::write;
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() { fflush(stdout); }
+};
+
+extern HardwareSerial Serial;
+
+// Time on the simulated board's clock; the 32-bit values wrap as on the ESP32
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void detachInterrupt(uint8_t pin);
+#define digitalPinToInterrupt(p) (p)
+
+// ESP-IDF GPIO call the drivers use next to digitalWrite()
+typedef int gpio_num_t;
+int gpio_set_level(int pin, uint32_t level);
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,36 @@
+#include "EEPROM.h"
+#include "hostBoard.h"
+#include <algorithm>
+#include <vector>
+
+EEPROMClass EEPROM;
+
+// Outlives begin()/end() like the flash sector behind the real emulation
+static std::vector<uint8_t> &image()
+{
+    static std::vector<uint8_t> bytes(HOST_EEPROM_SIZE, 0xFF);
+    return bytes;
+}
+
+uint8_t *EEPROMClass::data() const
+{
+    return image().data();
+}
+
+bool EEPROMClass::begin(size_t size)
+{
+    if (size == 0 || size > HOST_EEPROM_SIZE)
+        return false;
+    this->size = size;
+    return true;
+}
+
+bool EEPROMClass::commit()
+{
+    return size != 0;
+}
+
+void hostEepromClear()
+{
+    std::fill(image().begin(), image().end(), 0xFF);
+}
@@ -0,0 +1,49 @@
+/**
+ * @file EEPROM.h
+ * @brief Host EEPROM emulation: a RAM image that survives begin() and
+ *        commit(), erased (0xFF) at start or by hostEepromClear().
+ */
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#define HOST_EEPROM_SIZE 4096
+
+class EEPROMClass
+{
+public:
+    bool begin(size_t size);
+    bool commit();
+    void end() {}
+    size_t length() const { return size; }
+    uint8_t read(int addr) const { return addr >= 0 && (size_t)addr < size ? data()[addr] : 0; }
+    void write(int addr, uint8_t val)
+    {
+        if (addr >= 0 && (size_t)addr < size)
+            data()[addr] = val;
+    }
+
+    template <typename T> T &get(int addr, T &t) const
+    {
+        if (addr >= 0 && addr + sizeof(T) <= size)
+            memcpy(&t, data() + addr, sizeof(T));
+        return t;
+    }
+    template <typename T> const T &put(int addr, const T &t)
+    {
+        if (addr >= 0 && addr + sizeof(T) <= size)
+            memcpy(data() + addr, &t, sizeof(T));
+        return t;
+    }
+
+private:
+    uint8_t *data() const;
+    size_t size = 0;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // HOST_EEPROM_H
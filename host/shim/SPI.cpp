@@ -0,0 +1,48 @@
+#include "SPI.h"
+#include "hostBoard.h"
+
+SPIClass SPI;
+static HostSpiDevice *device = nullptr;
+
+void hostSpiAttach(HostSpiDevice *dev)
+{
+    device = dev;
+}
+
+void SPIClass::beginTransaction(SPISettings settings)
+{
+    clockHz = settings.clock ? settings.clock : 1;
+}
+
+uint8_t SPIClass::transfer(uint8_t data)
+{
+    uint8_t in = device ? device->transfer(data) : 0xFF;
+    count++;
+    // 8 clocks per byte; whole microseconds go to the board clock
+    clockNs += 8000000000ull / clockHz;
+    if (clockNs >= 1000)
+    {
+        hostClockAdvance(clockNs / 1000);
+        clockNs %= 1000;
+    }
+    return in;
+}
+
+uint16_t SPIClass::transfer16(uint16_t data)
+{
+    uint16_t hi = transfer(data >> 8);
+    return (hi << 8) | transfer(data & 0xFF);
+}
+
+void SPIClass::transfer(void *data, uint32_t size)
+{
+    uint8_t *p = (uint8_t *)data;
+    for (uint32_t i = 0; i < size; i++)
+        p[i] = transfer(p[i]);
+}
+
+void SPIClass::writeBytes(const uint8_t *data, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++)
+        transfer(data[i]);
+}
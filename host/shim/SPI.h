@@ -0,0 +1,58 @@
+/**
+ * @file SPI.h
+ * @brief Host SPI master: every byte goes to the HostSpiDevice attached
+ *        with hostSpiAttach() and takes 8 clocks of the transaction's speed
+ *        on the simulated board's clock.
+ */
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define MSBFIRST 1
+#define LSBFIRST 0
+#define SPI_MODE0 0
+#define SPI_MODE1 1
+#define SPI_MODE2 2
+#define SPI_MODE3 3
+
+class SPISettings
+{
+public:
+    SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0)
+        : clock(clock), bitOrder(bitOrder), dataMode(dataMode)
+    {
+    }
+    uint32_t clock;
+    uint8_t bitOrder;
+    uint8_t dataMode;
+};
+
+class SPIClass
+{
+public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+    void end() {}
+    void beginTransaction(SPISettings settings);
+    void endTransaction() {}
+    void setHwCs(bool use) {}
+
+    uint8_t transfer(uint8_t data);
+    uint16_t transfer16(uint16_t data);
+    void transfer(void *data, uint32_t size);
+    void write(uint8_t data) { transfer(data); }
+    void write16(uint16_t data) { transfer16(data); }
+    void writeBytes(const uint8_t *data, uint32_t size);
+
+    uint32_t bytes() const { return count; } // transferred since start
+
+private:
+    uint32_t clockHz = 1000000;
+    uint32_t count = 0;
+    uint64_t clockNs = 0; // fraction of a microsecond carried between bytes
+};
+
+extern SPIClass SPI;
+
+#endif // HOST_SPI_H
@@ -0,0 +1,114 @@
+#include "esp_partition.h"
+#include "hostBoard.h"
+#include <cstring>
+#include <list>
+#include <vector>
+
+#define HOST_FLASH_SECTOR 4096
+
+struct HostPartition
+{
+    esp_partition_t info;
+    std::vector<uint8_t> bytes;
+};
+
+// A list so the esp_partition_t pointers handed out stay put
+static std::list<HostPartition> partitions;
+static uint32_t nextAddress = 0x9000;
+static bool failing = false;
+
+bool hostPartitionAdd(const char *label, uint32_t size)
+{
+    if (size == 0 || size % HOST_FLASH_SECTOR || strlen(label) >= sizeof(esp_partition_t::label))
+        return false;
+    HostPartition p;
+    p.info.type = ESP_PARTITION_TYPE_DATA;
+    p.info.subtype = ESP_PARTITION_SUBTYPE_DATA_NVS;
+    p.info.address = nextAddress;
+    p.info.size = size;
+    strcpy(p.info.label, label);
+    p.bytes.assign(size, 0xFF);
+    partitions.push_back(std::move(p));
+    nextAddress += size;
+    return true;
+}
+
+void hostPartitionsClear()
+{
+    partitions.clear();
+    nextAddress = 0x9000;
+    failing = false;
+}
+
+void hostPartitionFail(bool fail)
+{
+    failing = fail;
+}
+
+static HostPartition *lookup(const esp_partition_t *part)
+{
+    for (HostPartition &p : partitions)
+    {
+        if (&p.info == part)
+            return &p;
+    }
+    return nullptr;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    for (HostPartition &p : partitions)
+    {
+        if (p.info.type != type)
+            continue;
+        if (subtype != ESP_PARTITION_SUBTYPE_ANY && p.info.subtype != subtype)
+            continue;
+        if (label && strcmp(label, p.info.label) != 0)
+            continue;
+        return &p.info;
+    }
+    return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t size)
+{
+    HostPartition *p = lookup(part);
+    if (!p || !dst)
+        return ESP_ERR_INVALID_ARG;
+    if (offset > p->info.size || size > p->info.size - offset)
+        return ESP_ERR_INVALID_SIZE;
+    memcpy(dst, p->bytes.data() + offset, size);
+    return ESP_OK;
+}
+
+// NOR flash: a write can only clear bits
+esp_err_t esp_partition_write(const esp_partition_t *part, size_t offset, const void *src, size_t size)
+{
+    HostPartition *p = lookup(part);
+    if (!p || !src)
+        return ESP_ERR_INVALID_ARG;
+    if (offset > p->info.size || size > p->info.size - offset)
+        return ESP_ERR_INVALID_SIZE;
+    if (failing)
+        return ESP_FAIL;
+    const uint8_t *s = (const uint8_t *)src;
+    for (size_t i = 0; i < size; i++)
+        p->bytes[offset + i] &= s[i];
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *part, size_t offset, size_t size)
+{
+    HostPartition *p = lookup(part);
+    if (!p)
+        return ESP_ERR_INVALID_ARG;
+    if (offset % HOST_FLASH_SECTOR || size % HOST_FLASH_SECTOR)
+        return ESP_ERR_INVALID_SIZE;
+    if (offset > p->info.size || size > p->info.size - offset)
+        return ESP_ERR_INVALID_SIZE;
+    if (failing)
+        return ESP_FAIL;
+    memset(p->bytes.data() + offset, 0xFF, size);
+    return ESP_OK;
+}
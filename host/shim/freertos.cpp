@@ -0,0 +1,382 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "hostBoard.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Block on 'cv' until 'ready' holds. A finite timeout waits that many
+// milliseconds in real time for another thread, then moves the simulated
+// clock by the timeout as the blocked task would have seen it.
+template <typename Pred>
+static bool waitFor(std::unique_lock<std::mutex> &lock, std::condition_variable &cv, TickType_t timeout,
+                    Pred ready)
+{
+    if (ready())
+        return true;
+    if (timeout == 0)
+        return false;
+    if (timeout == portMAX_DELAY)
+    {
+        cv.wait(lock, ready);
+        return true;
+    }
+    if (cv.wait_for(lock, std::chrono::milliseconds(timeout), ready))
+        return true;
+    lock.unlock();
+    hostClockAdvance((uint64_t)timeout * 1000);
+    lock.lock();
+    return ready();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Tasks
+// ─────────────────────────────────────────────────────────────────────────────
+struct HostTask
+{
+    std::string name;
+    UBaseType_t priority;
+    BaseType_t core;
+    std::mutex m;
+    std::condition_variable cv;
+    uint32_t value = 0;   // notification value
+    bool pending = false; // notification state
+};
+
+struct TaskExit
+{
+};
+
+static thread_local HostTask *currentTask = nullptr;
+
+BaseType_t xPortGetCoreID()
+{
+    return xTaskGetCurrentTaskHandle()->core;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *created, BaseType_t core)
+{
+    HostTask *task = new HostTask;
+    task->name = name ? name : "";
+    task->priority = priority;
+    task->core = core;
+    if (created)
+        *created = task;
+    std::thread([fn, param, task]() {
+        currentTask = task;
+        try
+        {
+            fn(param);
+        }
+        catch (const TaskExit &)
+        {
+        }
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *param,
+                       UBaseType_t priority, TaskHandle_t *created)
+{
+    return xTaskCreatePinnedToCore(fn, name, stackDepth, param, priority, created, 0);
+}
+
+// Only a task deleting itself ends its thread; the handle stays valid so a
+// late notification to it is harmless
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == nullptr || task == currentTask)
+        throw TaskExit();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    if (!currentTask)
+    {
+        currentTask = new HostTask;
+        currentTask->name = "main";
+        currentTask->priority = 1;
+        currentTask->core = 1;
+    }
+    return currentTask;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+    return (task ? task : xTaskGetCurrentTaskHandle())->priority;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    return 4096;
+}
+
+const char *pcTaskGetName(TaskHandle_t task)
+{
+    return (task ? task : xTaskGetCurrentTaskHandle())->name.c_str();
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    hostClockAdvance(ticks ? (uint64_t)ticks * 1000 : HOST_YIELD_US);
+    std::this_thread::yield();
+}
+
+void vTaskDelayUntil(TickType_t *previousWake, TickType_t increment)
+{
+    *previousWake += increment;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previousWake - now) > 0)
+        vTaskDelay(*previousWake - now);
+    else
+        std::this_thread::yield();
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return (TickType_t)(hostClockUs() / 1000);
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    std::lock_guard<std::mutex> g(task->m);
+    switch (action)
+    {
+    case eNoAction:
+        break;
+    case eSetBits:
+        task->value |= value;
+        break;
+    case eIncrement:
+        task->value++;
+        break;
+    case eSetValueWithOverwrite:
+        task->value = value;
+        break;
+    case eSetValueWithoutOverwrite:
+        if (task->pending)
+            return pdFAIL;
+        task->value = value;
+        break;
+    }
+    task->pending = true;
+    task->cv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t *woken)
+{
+    if (woken)
+        *woken = pdFALSE;
+    return xTaskNotify(task, value, action);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken)
+{
+    xTaskNotifyFromISR(task, 0, eIncrement, woken);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t timeout)
+{
+    HostTask *self = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(self->m);
+    waitFor(lock, self->cv, timeout, [self] { return self->value != 0; });
+    uint32_t value = self->value;
+    if (value)
+        self->value = clearOnExit ? 0 : value - 1;
+    self->pending = false;
+    return value;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t *value, TickType_t timeout)
+{
+    HostTask *self = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(self->m);
+    if (!self->pending)
+        self->value &= ~clearOnEntry;
+    if (!waitFor(lock, self->cv, timeout, [self] { return self->pending; }))
+        return pdFALSE;
+    if (value)
+        *value = self->value;
+    self->value &= ~clearOnExit;
+    self->pending = false;
+    return pdTRUE;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Queues
+// ─────────────────────────────────────────────────────────────────────────────
+struct HostQueue
+{
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    std::mutex m;
+    std::condition_variable cv; // any change: items or space
+    std::deque<std::vector<uint8_t>> items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    if (length == 0)
+        return nullptr;
+    HostQueue *q = new HostQueue;
+    q->length = length;
+    q->itemSize = itemSize;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    delete queue;
+}
+
+static BaseType_t queueSend(QueueHandle_t q, const void *item, TickType_t timeout, bool front)
+{
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!waitFor(lock, q->cv, timeout, [q] { return q->items.size() < q->length; }))
+        return errQUEUE_FULL;
+    const uint8_t *p = (const uint8_t *)item;
+    std::vector<uint8_t> copy(p, p + q->itemSize);
+    if (front)
+        q->items.push_front(std::move(copy));
+    else
+        q->items.push_back(std::move(copy));
+    q->cv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t timeout)
+{
+    return queueSend(queue, item, timeout, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t timeout)
+{
+    return queueSend(queue, item, timeout, true);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken)
+{
+    if (woken)
+        *woken = pdFALSE;
+    return queueSend(queue, item, 0, false);
+}
+
+static BaseType_t queueReceive(QueueHandle_t q, void *item, TickType_t timeout, bool remove)
+{
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!waitFor(lock, q->cv, timeout, [q] { return !q->items.empty(); }))
+        return pdFALSE;
+    memcpy(item, q->items.front().data(), q->itemSize);
+    if (remove)
+    {
+        q->items.pop_front();
+        q->cv.notify_all();
+    }
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t timeout)
+{
+    return queueReceive(queue, item, timeout, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t timeout)
+{
+    return queueReceive(queue, item, timeout, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> g(queue->m);
+    return queue->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> g(queue->m);
+    return queue->length - queue->items.size();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Semaphores
+// ─────────────────────────────────────────────────────────────────────────────
+struct HostSemaphore
+{
+    UBaseType_t count;
+    UBaseType_t maxCount;
+    std::mutex m;
+    std::condition_variable cv;
+};
+
+static SemaphoreHandle_t semaphoreCreate(UBaseType_t maxCount, UBaseType_t initialCount)
+{
+    HostSemaphore *s = new HostSemaphore;
+    s->count = initialCount;
+    s->maxCount = maxCount;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return semaphoreCreate(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return semaphoreCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount)
+{
+    return semaphoreCreate(maxCount, initialCount);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    delete sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout)
+{
+    std::unique_lock<std::mutex> lock(sem->m);
+    if (!waitFor(lock, sem->cv, timeout, [sem] { return sem->count > 0; }))
+        return pdFALSE;
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    std::lock_guard<std::mutex> g(sem->m);
+    if (sem->count >= sem->maxCount)
+        return pdFALSE;
+    sem->count++;
+    sem->cv.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken)
+{
+    if (woken)
+        *woken = pdFALSE;
+    return xSemaphoreGive(sem);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem)
+{
+    std::lock_guard<std::mutex> g(sem->m);
+    return sem->count;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host stand-in for the ESP-IDF FreeRTOS port: types, ticks and
+ *        critical sections. Tasks, queues and semaphores are threads,
+ *        mutexes and condition variables (host/shim/freertos.cpp).
+ *
+ * A tick is 1 ms of the simulated board's clock (hostBoard.h). Blocking
+ * calls with a timeout wait up to that long in real time for another
+ * thread, then move the clock by the timeout as a delay would.
+ */
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <cstdint>
+#include <mutex>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define errQUEUE_FULL 0
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskIDLE_PRIORITY 0
+#define configMAX_PRIORITIES 25
+
+// Spinlock of the dual-core port; a plain mutex here. Not recursive, as on
+// the target, where nesting on the same lock aborts.
+struct portMUX_TYPE
+{
+    std::mutex m;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+
+#define portENTER_CRITICAL(mux) (mux)->m.lock()
+#define portEXIT_CRITICAL(mux) (mux)->m.unlock()
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+BaseType_t xPortGetCoreID();
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,30 @@
+/**
+ * @file gfxfont.h
+ * @brief Host stand-in for Adafruit GFX's font structures, same layout, so
+ *        code that reads GFX fonts (glyphAtlas) builds without the library.
+ */
+#ifndef HOST_GFXFONT_H
+#define HOST_GFXFONT_H
+
+#include <cstdint>
+
+typedef struct
+{
+    uint16_t bitmapOffset; // into GFXfont::bitmap
+    uint8_t width;         // bitmap size in pixels
+    uint8_t height;
+    uint8_t xAdvance;      // cursor advance
+    int8_t xOffset;        // from the cursor to the upper-left corner
+    int8_t yOffset;        // from the baseline, negative upwards
+} GFXglyph;
+
+typedef struct
+{
+    uint8_t *bitmap;       // glyph bitmaps, MSB first, rows not padded
+    GFXglyph *glyph;
+    uint16_t first;        // character range
+    uint16_t last;
+    uint8_t yAdvance;      // line height
+} GFXfont;
+
+#endif // HOST_GFXFONT_H
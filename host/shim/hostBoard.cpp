@@ -0,0 +1,385 @@
+#include "hostBoard.h"
+#include <Arduino.h>
+#include "esp_timer.h"
+#include "soc/gpio_struct.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Clock and esp_timer
+// ─────────────────────────────────────────────────────────────────────────────
+struct HostTimer
+{
+    esp_timer_cb_t callback;
+    void *arg;
+    const char *name;
+    uint64_t dueUs;
+    uint64_t periodUs; // 0 for one-shot
+    bool active;
+};
+
+struct ClockListener
+{
+    HostClockListener fn;
+    void *ctx;
+};
+
+static std::atomic<uint64_t> clockUs{0};
+static std::recursive_mutex advanceLock; // one thread moves the clock at a time
+static std::mutex timerLock;
+
+// Registries are built on first use, so chips and drivers constructed as
+// globals can register from their constructors
+static std::vector<HostTimer *> &timerList()
+{
+    static std::vector<HostTimer *> list; // creation order breaks ties
+    return list;
+}
+
+static std::vector<ClockListener> &clockListeners()
+{
+    static std::vector<ClockListener> list;
+    return list;
+}
+
+static void setClock(uint64_t t)
+{
+    clockUs.store(t);
+    std::vector<ClockListener> ls;
+    {
+        std::lock_guard<std::mutex> g(timerLock);
+        ls = clockListeners();
+    }
+    for (const ClockListener &l : ls)
+        l.fn(t, l.ctx);
+}
+
+uint64_t hostClockUs()
+{
+    return clockUs.load();
+}
+
+void hostClockAdvance(uint64_t us)
+{
+    std::lock_guard<std::recursive_mutex> g(advanceLock);
+    uint64_t end = clockUs.load() + us;
+    // A callback may wait itself and move the clock past 'end'
+    while (clockUs.load() < end || us == 0)
+    {
+        HostTimer *next = nullptr;
+        {
+            std::lock_guard<std::mutex> t(timerLock);
+            for (HostTimer *tm : timerList())
+            {
+                if (tm->active && tm->dueUs <= end && (!next || tm->dueUs < next->dueUs))
+                    next = tm;
+            }
+            if (next)
+            {
+                if (next->periodUs)
+                    next->dueUs += next->periodUs;
+                else
+                    next->active = false;
+            }
+        }
+        if (!next)
+            break;
+        uint64_t due = next->periodUs ? next->dueUs - next->periodUs : next->dueUs;
+        if (due > clockUs.load())
+            setClock(due);
+        next->callback(next->arg);
+    }
+    if (clockUs.load() < end)
+        setClock(end);
+}
+
+void hostClockListen(HostClockListener fn, void *ctx)
+{
+    std::lock_guard<std::mutex> g(timerLock);
+    clockListeners().push_back({fn, ctx});
+}
+
+void hostClockUnlisten(HostClockListener fn, void *ctx)
+{
+    std::lock_guard<std::mutex> g(timerLock);
+    std::vector<ClockListener> &ls = clockListeners();
+    for (size_t i = 0; i < ls.size(); i++)
+    {
+        if (ls[i].fn == fn && ls[i].ctx == ctx)
+        {
+            ls.erase(ls.begin() + i);
+            return;
+        }
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out)
+{
+    if (!args || !args->callback || !out)
+        return ESP_ERR_INVALID_ARG;
+    HostTimer *t = new HostTimer{args->callback, args->arg, args->name, 0, 0, false};
+    std::lock_guard<std::mutex> g(timerLock);
+    timerList().push_back(t);
+    *out = t;
+    return ESP_OK;
+}
+
+static esp_err_t startTimer(esp_timer_handle_t t, uint64_t us, bool periodic)
+{
+    if (!t)
+        return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> g(timerLock);
+    if (t->active)
+        return ESP_ERR_INVALID_STATE;
+    // A periodic timer of 0 would never let the clock move
+    t->periodUs = periodic ? (us ? us : 1) : 0;
+    t->dueUs = clockUs.load() + us;
+    t->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs)
+{
+    return startTimer(timer, timeoutUs, false);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs)
+{
+    return startTimer(timer, periodUs, true);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (!timer)
+        return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> g(timerLock);
+    if (!timer->active)
+        return ESP_ERR_INVALID_STATE;
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    if (!timer)
+        return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> g(timerLock);
+    if (timer->active)
+        return ESP_ERR_INVALID_STATE;
+    std::vector<HostTimer *> &ts = timerList();
+    for (size_t i = 0; i < ts.size(); i++)
+    {
+        if (ts[i] == timer)
+            ts.erase(ts.begin() + i);
+    }
+    delete timer;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer)
+{
+    std::lock_guard<std::mutex> g(timerLock);
+    return timer && timer->active;
+}
+
+int64_t esp_timer_get_time()
+{
+    return (int64_t)clockUs.load();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Arduino timing
+// ─────────────────────────────────────────────────────────────────────────────
+unsigned long millis()
+{
+    return (uint32_t)(clockUs.load() / 1000);
+}
+
+unsigned long micros()
+{
+    return (uint32_t)clockUs.load();
+}
+
+void delay(uint32_t ms)
+{
+    hostClockAdvance((uint64_t)ms * 1000);
+    std::this_thread::yield();
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    hostClockAdvance(us);
+}
+
+void yield()
+{
+    hostClockAdvance(HOST_YIELD_US);
+    std::this_thread::yield();
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    if (inMax == inMin)
+        return outMin;
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Pins
+// ─────────────────────────────────────────────────────────────────────────────
+struct PinListener
+{
+    HostPinListener fn;
+    void *ctx;
+};
+
+static std::mutex pinLock;
+static bool pinLevel[HOST_PINS];
+static bool pinDriven[HOST_PINS]; // an external signal sets the level
+static uint8_t pinModes[HOST_PINS];
+static void (*pinIsr[HOST_PINS])();
+static int pinIsrMode[HOST_PINS];
+
+static std::vector<PinListener> &pinListeners()
+{
+    static std::vector<PinListener> list;
+    return list;
+}
+
+HostGpioDev GPIO;
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin >= HOST_PINS)
+        return;
+    std::lock_guard<std::mutex> g(pinLock);
+    pinModes[pin] = mode;
+    if ((mode & PULLUP) && !pinDriven[pin])
+        pinLevel[pin] = true;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level)
+{
+    if (pin >= HOST_PINS)
+        return;
+    std::vector<PinListener> ls;
+    {
+        std::lock_guard<std::mutex> g(pinLock);
+        pinLevel[pin] = level != LOW;
+        ls = pinListeners();
+    }
+    for (const PinListener &l : ls)
+        l.fn(pin, level != LOW, l.ctx);
+}
+
+int gpio_set_level(int pin, uint32_t level)
+{
+    if (pin < 0 || pin >= HOST_PINS)
+        return ESP_ERR_INVALID_ARG;
+    digitalWrite(pin, level ? HIGH : LOW);
+    return ESP_OK;
+}
+
+int digitalRead(uint8_t pin)
+{
+    if (pin >= HOST_PINS)
+        return LOW;
+    std::lock_guard<std::mutex> g(pinLock);
+    return pinLevel[pin] ? HIGH : LOW;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode)
+{
+    if (pin >= HOST_PINS)
+        return;
+    std::lock_guard<std::mutex> g(pinLock);
+    pinIsr[pin] = isr;
+    pinIsrMode[pin] = mode;
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    attachInterrupt(pin, nullptr, 0);
+}
+
+void hostPinDrive(uint8_t pin, bool level)
+{
+    if (pin >= HOST_PINS)
+        return;
+    void (*isr)() = nullptr;
+    {
+        std::lock_guard<std::mutex> g(pinLock);
+        bool old = pinLevel[pin];
+        pinLevel[pin] = level;
+        pinDriven[pin] = true;
+        int mode = pinIsrMode[pin];
+        if (pinIsr[pin] && old != level &&
+            (mode == CHANGE || (mode == RISING && level) || (mode == FALLING && !level)))
+            isr = pinIsr[pin];
+    }
+    if (isr)
+        isr();
+}
+
+bool hostPinLevel(uint8_t pin)
+{
+    return digitalRead(pin) == HIGH;
+}
+
+uint8_t hostPinMode(uint8_t pin)
+{
+    std::lock_guard<std::mutex> g(pinLock);
+    return pin < HOST_PINS ? pinModes[pin] : 0;
+}
+
+void hostPinListen(HostPinListener fn, void *ctx)
+{
+    std::lock_guard<std::mutex> g(pinLock);
+    pinListeners().push_back({fn, ctx});
+}
+
+void hostPinUnlisten(HostPinListener fn, void *ctx)
+{
+    std::lock_guard<std::mutex> g(pinLock);
+    std::vector<PinListener> &ls = pinListeners();
+    for (size_t i = 0; i < ls.size(); i++)
+    {
+        if (ls[i].fn == fn && ls[i].ctx == ctx)
+        {
+            ls.erase(ls.begin() + i);
+            return;
+        }
+    }
+}
+
+uint32_t hostGpioInputs(int bank)
+{
+    std::lock_guard<std::mutex> g(pinLock);
+    uint32_t v = 0;
+    for (int i = 0; i < 32 && bank * 32 + i < HOST_PINS; i++)
+    {
+        if (pinLevel[bank * 32 + i])
+            v |= 1u << i;
+    }
+    return v;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Serial
+// ─────────────────────────────────────────────────────────────────────────────
+HardwareSerial Serial;
+static std::atomic<bool> serialEcho{true};
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if (serialEcho.load())
+        putchar(c);
+    return 1;
+}
+
+void hostSerialEcho(bool on)
+{
+    serialEcho.store(on);
+}
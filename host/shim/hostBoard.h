@@ -0,0 +1,71 @@
+/**
+ * @file hostBoard.h
+ * @brief The simulated board behind the host shims: clock, pins, SPI,
+ *        flash partitions and serial output.
+ *
+ * Firmware code only sees the Arduino, ESP-IDF and FreeRTOS calls; tests
+ * and benches play the hardware through these.
+ *
+ * Time is virtual and never sleeps. It moves when code waits (delay(),
+ * vTaskDelay(), yield(), SPI transfers, timed-out blocking calls) or when a
+ * test calls hostClockAdvance(). Due esp_timer callbacks and the clock
+ * listeners run on the thread that moves the clock, at their due time, so
+ * a single-threaded test replays the same way every run.
+ */
+#ifndef HOST_BOARD_H
+#define HOST_BOARD_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define HOST_PINS 64
+#define HOST_YIELD_US 10 // clock time a yield() or taskYIELD() takes
+
+// ── Clock ───────────────────────────────────────────────────────────────────
+uint64_t hostClockUs();
+
+// Move the clock forward, running timers and listeners at their due times
+void hostClockAdvance(uint64_t us);
+
+// Called with the new time whenever the clock moves (simulated chips)
+typedef void (*HostClockListener)(uint64_t nowUs, void *ctx);
+void hostClockListen(HostClockListener fn, void *ctx);
+void hostClockUnlisten(HostClockListener fn, void *ctx);
+
+// ── Pins ────────────────────────────────────────────────────────────────────
+// An external signal on 'pin' (a key, an opto, DREQ). Runs the pin's
+// interrupt handler on a matching edge.
+void hostPinDrive(uint8_t pin, bool level);
+bool hostPinLevel(uint8_t pin);
+uint8_t hostPinMode(uint8_t pin);
+
+// Called when the firmware writes an output pin (row selects, chip selects)
+typedef void (*HostPinListener)(uint8_t pin, bool level, void *ctx);
+void hostPinListen(HostPinListener fn, void *ctx);
+void hostPinUnlisten(HostPinListener fn, void *ctx);
+
+// ── SPI ─────────────────────────────────────────────────────────────────────
+// The device on the bus sees every byte; chip selects come as pin writes
+class HostSpiDevice
+{
+public:
+    virtual ~HostSpiDevice() {}
+    virtual uint8_t transfer(uint8_t out) = 0;
+};
+
+void hostSpiAttach(HostSpiDevice *dev);
+
+// ── Flash ───────────────────────────────────────────────────────────────────
+// Data partition in RAM with NOR semantics: erase sets 0xFF, writes clear bits
+bool hostPartitionAdd(const char *label, uint32_t size);
+void hostPartitionsClear();
+// Make partition writes and erases fail (ESP_FAIL) until switched off
+void hostPartitionFail(bool fail);
+// EEPROM emulation back to erased
+void hostEepromClear();
+
+// ── Serial ──────────────────────────────────────────────────────────────────
+// Serial output to stdout (default) or dropped
+void hostSerialEcho(bool on);
+
+#endif // HOST_BOARD_H
@@ -0,0 +1,28 @@
+/**
+ * @file pins.h
+ * @brief Pin map of the simulated board. The opto inputs must be GPIO
+ *        4-10 in order, as optoInDriver reads them as one field of GPIO.in;
+ *        the rest only need to be distinct.
+ */
+#ifndef HOST_PINS_H
+#define HOST_PINS_H
+
+#define optoIn1 4
+#define optoIn2 5
+#define optoIn3 6
+#define optoIn4 7
+#define optoIn5 8
+#define optoIn6 9
+#define optoIn7 10
+#define selOptoRow1 11 // low: inputs 0-6 on optoIn1-7
+#define selOptoRow2 12 // low: inputs 7-13
+
+#define VS1003B_CS_PIN 15
+#define VS1003B_DCS_PIN 16
+#define VS1003B_DREQ_PIN 17
+#define VS1003B_RST_PIN 18
+#define VS1003B_CLK_PIN 19
+#define VS1003B_MISO_PIN 20
+#define VS1003B_MOSI_PIN 21
+
+#endif // HOST_PINS_H
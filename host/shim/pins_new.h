@@ -0,0 +1,16 @@
+/**
+ * @file pins_new.h
+ * @brief Keypad pins of the simulated board, split over both GPIO input
+ *        banks so keypadDriver reads GPIO.in and GPIO.in1.
+ */
+#ifndef HOST_PINS_NEW_H
+#define HOST_PINS_NEW_H
+
+#include "pins.h"
+
+#define KEY_PREVIOUS_PIN 13
+#define KEY_NEXT_PIN 14
+#define KEY_DOWN_PIN 38
+#define KEY_UP_PIN 39
+
+#endif // HOST_PINS_NEW_H
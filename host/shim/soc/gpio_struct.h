@@ -0,0 +1,32 @@
+/**
+ * @file gpio_struct.h
+ * @brief Host GPIO register block: GPIO.in and GPIO.in1.val read the
+ *        simulated pin levels (pins 0-31 and 32-63) at the time of the read.
+ */
+#ifndef HOST_SOC_GPIO_STRUCT_H
+#define HOST_SOC_GPIO_STRUCT_H
+
+#include <cstdint>
+
+uint32_t hostGpioInputs(int bank);
+
+template <int Bank>
+struct HostGpioIn
+{
+    operator uint32_t() const { return hostGpioInputs(Bank); }
+};
+
+struct HostGpioIn1
+{
+    HostGpioIn<1> val;
+};
+
+struct HostGpioDev
+{
+    HostGpioIn<0> in;
+    HostGpioIn1 in1;
+};
+
+extern HostGpioDev GPIO;
+
+#endif // HOST_SOC_GPIO_STRUCT_H
@@ -0,0 +1,124 @@
+#include "OptoFilterBench.h"
+#include "optoInLogic.h"
+#include <chrono>
+#include <vector>
+
+// Inputs 0..6 are pressed and released, 7..13 only ever see noise
+static const uint16_t DRIVEN_MASK = 0x007F;
+
+static uint32_t nextRandom(uint32_t &s)
+{
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+// Raw samples for the whole run, identical for both filters
+static std::vector<uint16_t> makeWaveform(const OptoFilterBenchConfig &cfg, std::vector<uint32_t> &edges)
+{
+    std::vector<uint16_t> w;
+    uint32_t s = cfg.seed ? cfg.seed : 1;
+    uint32_t noise = (uint32_t)(cfg.noiseProb * 65536);
+    uint32_t period = cfg.holdScans + cfg.gapScans;
+
+    for (uint32_t t = 0; t < cfg.presses * period; t++)
+    {
+        uint32_t phase = t % period;
+        bool level = phase >= cfg.gapScans;
+        if (phase == cfg.gapScans || phase == 0)
+            edges.push_back(t);
+
+        // Chatter right after either edge
+        uint32_t sinceEdge = level ? phase - cfg.gapScans : phase;
+        if (t >= period && sinceEdge < cfg.bounceScans)
+            level = nextRandom(s) & 1;
+
+        uint16_t raw = level ? DRIVEN_MASK : 0;
+        for (int i = 0; i < NUM_INPUTS; i++)
+            if ((nextRandom(s) & 0xFFFF) < noise)
+                raw ^= 1 << i;
+        w.push_back(raw);
+    }
+    return w;
+}
+
+template <typename Filter>
+static void measure(const OptoFilterBenchConfig &cfg, const std::vector<uint16_t> &w,
+                    const std::vector<uint32_t> &edges, OptoFilterResult &r)
+{
+    Filter f;
+    f.init(cfg.threshold);
+    std::vector<uint16_t> out(w.size());
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < w.size(); t++)
+        out[t] = f.update(w[t]);
+    auto t1 = std::chrono::steady_clock::now();
+
+    r = OptoFilterResult();
+    r.nsPerScan = std::chrono::duration<double, std::nano>(t1 - t0).count() / w.size();
+
+    // Latency of input 0 after every edge, within the following half period
+    uint64_t pressSum = 0, releaseSum = 0;
+    uint32_t presses = 0, releases = 0;
+    for (size_t e = 0; e < edges.size(); e++)
+    {
+        bool rising = (e % 2) == 1; // edges alternate: gap start, press start
+        uint32_t end = e + 1 < edges.size() ? edges[e + 1] : w.size();
+        uint32_t t = edges[e];
+        while (t < end && ((out[t] & 1) != 0) != rising)
+            t++;
+        if (t == end)
+        {
+            if (rising)
+                r.missed++;
+            continue;
+        }
+        uint32_t lat = t - edges[e];
+        if (rising)
+        {
+            pressSum += lat;
+            presses++;
+            if (lat > r.maxPressScans)
+                r.maxPressScans = lat;
+        }
+        else if (e)
+        {
+            releaseSum += lat;
+            releases++;
+            if (lat > r.maxReleaseScans)
+                r.maxReleaseScans = lat;
+        }
+    }
+    r.meanPressScans = presses ? (double)pressSum / presses : 0;
+    r.meanReleaseScans = releases ? (double)releaseSum / releases : 0;
+
+    for (size_t t = 1; t < out.size(); t++)
+    {
+        uint16_t changed = (out[t] ^ out[t - 1]) & ~DRIVEN_MASK & ((1 << NUM_INPUTS) - 1);
+        r.falseToggles += __builtin_popcount(changed);
+    }
+}
+
+void runOptoFilterBench(const OptoFilterBenchConfig &cfg, OptoFilterResult &window, OptoFilterResult &vertical)
+{
+    std::vector<uint32_t> edges;
+    std::vector<uint16_t> w = makeWaveform(cfg, edges);
+    measure<OptoWindowFilter>(cfg, w, edges, window);
+    measure<OptoVerticalFilter>(cfg, w, edges, vertical);
+}
+
+static void printRow(const char *name, const OptoFilterResult &r, FILE *out)
+{
+    fprintf(out, "%-9s %8.1f ns/scan  press %5.1f/%3u  release %5.1f/%3u  missed %u  false %u\n", name,
+            r.nsPerScan, r.meanPressScans, r.maxPressScans, r.meanReleaseScans, r.maxReleaseScans, r.missed,
+            r.falseToggles);
+}
+
+void printOptoFilterBench(const OptoFilterResult &window, const OptoFilterResult &vertical, FILE *out)
+{
+    fprintf(out, "latency in scans (mean/max)\n");
+    printRow("window", window, out);
+    printRow("vertical", vertical, out);
+}
@@ -0,0 +1,41 @@
+#ifndef OPTOFILTERBENCH_H
+#define OPTOFILTERBENCH_H
+
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * @brief Side-by-side comparison of the opto filters
+ *
+ * Feeds OptoWindowFilter and OptoVerticalFilter the same 14-input
+ * waveforms (clean steps, bouncing edges, random noise) and reports
+ * time per scan, press/release detection latency in scans and the number
+ * of spurious output toggles on inputs that are only noise.
+ */
+
+struct OptoFilterResult
+{
+    double nsPerScan;
+    double meanPressScans;   // edge -> output ON
+    uint32_t maxPressScans;
+    double meanReleaseScans; // edge -> output OFF
+    uint32_t maxReleaseScans;
+    uint32_t missed;         // presses never detected
+    uint32_t falseToggles;   // output changes on noise-only inputs
+};
+
+struct OptoFilterBenchConfig
+{
+    uint32_t seed = 1;
+    uint32_t presses = 2000;
+    uint8_t threshold = 30;
+    uint32_t holdScans = 200;   // press length
+    uint32_t gapScans = 200;    // idle between presses
+    uint32_t bounceScans = 3;   // chatter after each edge
+    float noiseProb = 0.05f;    // per-sample bit flips on every input
+};
+
+void runOptoFilterBench(const OptoFilterBenchConfig &cfg, OptoFilterResult &window, OptoFilterResult &vertical);
+void printOptoFilterBench(const OptoFilterResult &window, const OptoFilterResult &vertical, FILE *out);
+
+#endif // OPTOFILTERBENCH_H
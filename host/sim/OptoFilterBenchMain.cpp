@@ -0,0 +1,17 @@
+#include "OptoFilterBench.h"
+#include <cstdlib>
+
+// opto_filter_bench [presses] [seed]
+int main(int argc, char **argv)
+{
+    OptoFilterBenchConfig cfg;
+    if (argc > 1)
+        cfg.presses = strtoul(argv[1], nullptr, 0);
+    if (argc > 2)
+        cfg.seed = strtoul(argv[2], nullptr, 0);
+
+    OptoFilterResult window, vertical;
+    runOptoFilterBench(cfg, window, vertical);
+    printOptoFilterBench(window, vertical, stdout);
+    return 0;
+}
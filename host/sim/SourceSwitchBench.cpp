@@ -0,0 +1,184 @@
+#include "SourceSwitchBench.h"
+#include "Vs1053Model.h"
+#include "sourceSwitch.h"
+#include <cmath>
+#include <cstring>
+
+#define SDINEW (1 << 11)
+#define RESET_US 2000 // soft reset until DREQ, patches not counted
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Vs1053Port on the model: every SCI access costs its SPI time
+// ─────────────────────────────────────────────────────────────────────────────
+class ModelPort : public Vs1053Port
+{
+public:
+    explicit ModelPort(Vs1053Model &vs) : vs(vs) {}
+
+    uint16_t sciRead(uint8_t reg) override
+    {
+        vs.advance(vs.sciTimeUs());
+        return vs.sciRead(reg);
+    }
+
+    void sciWrite(uint8_t reg, uint16_t value) override
+    {
+        vs.sciWrite(reg, value);
+        vs.advance(vs.sciTimeUs());
+    }
+
+    void sdiFill(uint8_t fill, size_t len) override
+    {
+        uint8_t chunk[Vs1053Model::CHUNK_SIZE];
+        memset(chunk, fill, sizeof(chunk));
+        while (len)
+        {
+            size_t n = len < sizeof(chunk) ? len : sizeof(chunk);
+            vs.playChunk(chunk, n);
+            len -= n;
+        }
+    }
+
+    void softReset() override
+    {
+        vs.sciWrite(Vs1053Model::SCI_MODE, SDINEW | 1 << Vs1053Model::SM_RESET);
+        vs.advance(RESET_US);
+    }
+
+    void waitUs(uint32_t us) override { vs.advance(us); }
+    uint32_t nowUs() override { return (uint32_t)vs.stats().elapsedUs; }
+
+private:
+    Vs1053Model &vs;
+};
+
+static bool fromDecoder(SwitchCase c)
+{
+    return c != SwitchCase::LineToDecoder;
+}
+
+static bool toLine(SwitchCase c)
+{
+    return c == SwitchCase::DecoderToLine;
+}
+
+static void setupModel(const SourceSwitchBenchConfig &cfg, Vs1053Model &vs)
+{
+    Vs1053Signal sig = {cfg.decoderAmp, cfg.decoderDc, cfg.lineAmp, cfg.lineDc};
+    vs.setSignal(sig);
+    // Decoder idle as after an earlier song: fill bytes are not played
+    vs.sciWrite(Vs1053Model::SCI_MODE, SDINEW | 1 << Vs1053Model::SM_CANCEL);
+    vs.setCancelUs(cfg.cancelUs);
+}
+
+// Fill the FIFO with a 128 kbps stream and let it play a while
+static void playStream(Vs1053Model &vs)
+{
+    uint8_t block[64] = {0xFF, 0xFB, 0x90, 0x64};
+    for (size_t i = 0; i < Vs1053Model::FIFO_SIZE * 2; i += sizeof(block))
+        vs.playChunk(block, sizeof(block));
+}
+
+static float toDb(float level)
+{
+    return 20.0f * log10f(level > 1e-7f ? level : 1e-7f);
+}
+
+static void result(Vs1053Model &vs, uint32_t silentUs, SourceSwitchResult &r)
+{
+    r.latencyUs = (uint32_t)vs.stats().elapsedUs;
+    r.silentUs = silentUs;
+    r.steps = vs.stats().outputSteps;
+    r.maxStepDb = toDb(vs.stats().maxStep);
+    r.dcStepDb = toDb(vs.stats().maxDcStep);
+}
+
+// VS1053::stopSong() on the port: end-of-song fill, then cancel polled every 10 ms
+static void stopSongDirect(ModelPort &port)
+{
+    port.sdiFill(0, 2052);
+    port.waitUs(10000);
+    port.sciWrite(Vs1053Model::SCI_MODE, SDINEW | 1 << Vs1053Model::SM_CANCEL);
+    for (int i = 0; i < 200; i++)
+    {
+        port.sdiFill(0, 32);
+        if (!(port.sciRead(Vs1053Model::SCI_MODE) & 1 << Vs1053Model::SM_CANCEL))
+        {
+            port.sdiFill(0, 2052);
+            return;
+        }
+        port.waitUs(10000);
+    }
+}
+
+static void runDirect(const SourceSwitchBenchConfig &cfg, SwitchCase c, SourceSwitchResult &r)
+{
+    Vs1053Model vs(cfg.spiHz, cfg.byteRate);
+    ModelPort port(vs);
+    setupModel(cfg, vs);
+    uint16_t vol = (uint16_t)cfg.volume << 8 | cfg.volume;
+    port.sciWrite(Vs1053Model::SCI_VOL, vol);
+    if (fromDecoder(c))
+    {
+        port.sciWrite(Vs1053Model::SCI_MODE, SDINEW);
+        playStream(vs);
+    }
+    else
+    {
+        port.sciWrite(Vs1053Model::SCI_MODE, SDINEW | 1 << Vs1053Model::SM_LINE1);
+    }
+    vs.resetStats();
+
+    // initPlayback(): stop, volume, then SCI_MODE for the radio
+    stopSongDirect(port);
+    port.sciWrite(Vs1053Model::SCI_VOL, vol);
+    if (toLine(c))
+        port.sciWrite(Vs1053Model::SCI_MODE, SDINEW | 1 << Vs1053Model::SM_LINE1);
+    result(vs, 0, r);
+}
+
+static void runSequenced(const SourceSwitchBenchConfig &cfg, SwitchCase c, SourceSwitchResult &r)
+{
+    Vs1053Model vs(cfg.spiHz, cfg.byteRate);
+    ModelPort port(vs);
+    SourceSwitch sw(port);
+    setupModel(cfg, vs);
+    sw.begin(AudioInput::Line1, cfg.volume);
+    if (fromDecoder(c))
+    {
+        sw.select(AudioInput::Decoder, cfg.volume);
+        playStream(vs);
+    }
+    vs.resetStats();
+
+    sw.select(toLine(c) ? AudioInput::Line1 : AudioInput::Decoder, cfg.volume);
+    result(vs, sw.stats().lastMuteUs, r);
+}
+
+void runSourceSwitchBench(const SourceSwitchBenchConfig &cfg, SourceSwitchResult direct[SWITCH_CASES],
+                          SourceSwitchResult sequenced[SWITCH_CASES])
+{
+    for (int i = 0; i < SWITCH_CASES; i++)
+    {
+        runDirect(cfg, (SwitchCase)i, direct[i]);
+        runSequenced(cfg, (SwitchCase)i, sequenced[i]);
+    }
+}
+
+static void printRow(const char *change, const char *path, const SourceSwitchResult &r, FILE *out)
+{
+    fprintf(out, "%-15s %-9s %7.2f ms  %5.2f ms  %4u  %6.1f dBFS  %6.1f dBFS\n", change, path, r.latencyUs / 1000.0,
+            r.silentUs / 1000.0, r.steps, r.maxStepDb, r.dcStepDb);
+}
+
+void printSourceSwitchBench(const SourceSwitchResult direct[SWITCH_CASES],
+                            const SourceSwitchResult sequenced[SWITCH_CASES], FILE *out)
+{
+    static const char *names[SWITCH_CASES] = {"decoder -> FM", "FM -> decoder", "next track"};
+    fprintf(out, "change          path       latency     silent  steps  max step     DC step\n");
+    for (int i = 0; i < SWITCH_CASES; i++)
+    {
+        printRow(names[i], "direct", direct[i], out);
+        printRow(names[i], "sequenced", sequenced[i], out);
+    }
+}
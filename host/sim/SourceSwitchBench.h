@@ -0,0 +1,58 @@
+#ifndef SOURCESWITCHBENCH_H
+#define SOURCESWITCHBENCH_H
+
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * @brief Source change latency and clicks, old path against SourceSwitch
+ *
+ * Runs each change between the FM line input and the decoder on the
+ * decoder model (Vs1053Model) twice:
+ *
+ *  - direct: what AudioTask did before, stopSong() (2052 endFill bytes,
+ *    SM_CANCEL polled every 10 ms), volume written at once, SCI_MODE with
+ *    SM_LINE1 written at full level
+ *  - sequenced: the real SourceSwitch logic (ramp, flush, SCI_MODE from the
+ *    shadow, ramp)
+ *
+ * Latency runs from the request to the new input at full level; the click
+ * is the largest output step (worst-case signal phase) and the largest
+ * change of the output DC level, in dB relative to full scale.
+ */
+
+enum class SwitchCase : uint8_t {
+    DecoderToLine,   // file or stream -> FM
+    LineToDecoder,   // FM -> file or stream
+    DecoderToDecoder // next track
+};
+
+static const int SWITCH_CASES = 3;
+
+struct SourceSwitchBenchConfig
+{
+    uint32_t spiHz = 4000000;
+    uint32_t byteRate = 16000;     // 128 kbps stream playing when the change comes
+    uint32_t cancelUs = 2000;      // decoder response to SM_CANCEL (model assumption)
+    uint8_t volume = 20;           // SCI_VOL attenuation, -10 dB
+    float decoderAmp = 0.7f;       // programme peak
+    float decoderDc = 0.0f;
+    float lineAmp = 0.5f;          // FM audio on the line input
+    float lineDc = 0.02f;          // ADC offset of the line input
+};
+
+struct SourceSwitchResult
+{
+    uint32_t latencyUs;  // request to the new input at full level
+    uint32_t silentUs;   // request to silence, 0 if never silent
+    uint32_t steps;      // output steps during the change
+    float maxStepDb;     // largest output step, dBFS
+    float dcStepDb;      // largest DC step, dBFS
+};
+
+void runSourceSwitchBench(const SourceSwitchBenchConfig &cfg, SourceSwitchResult direct[SWITCH_CASES],
+                          SourceSwitchResult sequenced[SWITCH_CASES]);
+void printSourceSwitchBench(const SourceSwitchResult direct[SWITCH_CASES],
+                            const SourceSwitchResult sequenced[SWITCH_CASES], FILE *out);
+
+#endif // SOURCESWITCHBENCH_H
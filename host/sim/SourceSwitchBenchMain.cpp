@@ -0,0 +1,16 @@
+#include "SourceSwitchBench.h"
+
+// source_switch_bench: default decoder, then one slow to cancel
+int main()
+{
+    SourceSwitchBenchConfig cfg;
+    SourceSwitchResult direct[SWITCH_CASES], sequenced[SWITCH_CASES];
+    runSourceSwitchBench(cfg, direct, sequenced);
+    printSourceSwitchBench(direct, sequenced, stdout);
+
+    cfg.cancelUs = 26000;
+    runSourceSwitchBench(cfg, direct, sequenced);
+    printf("\nSM_CANCEL after 26 ms\n");
+    printSourceSwitchBench(direct, sequenced, stdout);
+    return 0;
+}
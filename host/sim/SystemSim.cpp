@@ -0,0 +1,410 @@
+#include "SystemSim.h"
+#include "Vs1053Model.h"
+#include "optoInLogic.h"
+#include "gestureEngine.h"
+#include "displayFlush.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Deterministic random source (xorshift32)
+// ─────────────────────────────────────────────────────────────────────────────
+class SimRandom
+{
+public:
+    explicit SimRandom(uint32_t seed) : s(seed ? seed : 0x9E3779B9) {}
+    uint32_t next()
+    {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        return s;
+    }
+    uint32_t below(uint32_t n) { return n ? next() % n : 0; }
+    bool chance(float p) { return (next() >> 8) < (uint32_t)(p * (1 << 24)); }
+
+private:
+    uint32_t s;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Event queue
+// ─────────────────────────────────────────────────────────────────────────────
+struct SimEvent
+{
+    uint64_t timeUs;
+    uint32_t seq; // keeps same-time events in scheduling order
+    std::function<void()> run;
+    bool operator>(const SimEvent &o) const { return timeUs != o.timeUs ? timeUs > o.timeUs : seq > o.seq; }
+};
+
+class SimScheduler
+{
+public:
+    uint64_t now = 0;
+
+    void at(uint64_t timeUs, std::function<void()> fn) { events.push({timeUs, seq++, std::move(fn)}); }
+    void after(uint64_t delayUs, std::function<void()> fn) { at(now + delayUs, std::move(fn)); }
+    void runUntil(uint64_t endUs)
+    {
+        while (!events.empty() && events.top().timeUs <= endUs)
+        {
+            SimEvent e = events.top();
+            events.pop();
+            now = e.timeUs;
+            e.run();
+        }
+        now = endUs;
+    }
+
+private:
+    std::priority_queue<SimEvent, std::vector<SimEvent>, std::greater<SimEvent>> events;
+    uint32_t seq = 0;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Stimulus: one input asserted at t0 for holdUs, with bounce on both edges
+// ─────────────────────────────────────────────────────────────────────────────
+struct Contact
+{
+    uint64_t t0;
+    uint64_t t1;
+    uint32_t bounceUs;
+    uint32_t seed;
+
+    bool level(uint64_t t) const
+    {
+        if (t < t0)
+            return false;
+        if (t < t0 + bounceUs || (t >= t1 && t < t1 + bounceUs))
+        {
+            // Chatter: a fixed pseudo-random pattern in 250 us slots
+            uint32_t x = (uint32_t)(t / 250) * 2654435761u ^ seed;
+            return (x >> 13) & 1;
+        }
+        return t < t1;
+    }
+};
+
+static SimLatency summarize(std::vector<uint32_t> &v)
+{
+    SimLatency l = {};
+    if (v.empty())
+        return l;
+    std::sort(v.begin(), v.end());
+    l.count = v.size();
+    l.p50Us = v[v.size() / 2];
+    l.p99Us = v[std::min(v.size() - 1, (size_t)(v.size() * 0.99))];
+    l.maxUs = v.back();
+    return l;
+}
+
+// Collects events from the gesture engine for the current trial
+static std::vector<std::pair<uint8_t, KeyEventType>> pendingEvents;
+
+static void collectEvent(uint8_t input, KeyEventType type, uint32_t)
+{
+    pendingEvents.push_back({input, type});
+}
+
+// Opto timing of the default Setup (GESTURE_PROFILE_OPTO), for every input
+static const GestureProfile optoProfiles[GESTURE_PROFILES] = {{3000, 300, 0, 0, 0, 0, 0}};
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Trigger-to-audio trial
+// ─────────────────────────────────────────────────────────────────────────────
+static void runTriggerTrial(const SimConfig &cfg, SimRandom &rnd, SimReport &rep, std::vector<uint32_t> &lat)
+{
+    SimScheduler sched;
+    OptoWindowFilter filter;
+    GestureEngine gestures;
+    Vs1053Model vs(cfg.spiHz);
+    filter.init(cfg.optoThreshold);
+    gestures.init(optoProfiles);
+    uint16_t alarmMask = cfg.alarmInput ? 1 << cfg.triggerInput : 0;
+    uint16_t gestureState = 0;
+    uint8_t decimation = 0;
+    pendingEvents.clear();
+
+    // Random phase against the scan tick and against the event decimation
+    uint64_t warmup = (uint64_t)cfg.scanPeriodUs * (OPTO_EVENT_DECIMATION + 1);
+    Contact contact = {warmup + rnd.below(warmup), 0, cfg.bounceUs, rnd.next()};
+    contact.t1 = contact.t0 + cfg.holdUs;
+    bool triggered = false;
+    uint64_t audibleAt = 0;
+
+    // AudioTask: open the file, then read 64-byte blocks and playChunk() them
+    auto startAnnouncement = [&]() {
+        uint64_t t = sched.now + cfg.audioWakeUs + cfg.sdOpenUs;
+        vs.advance((uint32_t)(t - vs.stats().elapsedUs));
+        uint8_t block[64] = {0xFF, 0xFB, 0x90, 0x64}; // 128 kbps frame header
+        for (uint32_t off = 0; off < cfg.announceBytes; off += sizeof(block))
+        {
+            uint32_t readUs = cfg.sdCallUs;
+            if (off % 512 == 0)
+                readUs += rnd.chance(cfg.sdStallProb) ? cfg.sdStallUs : cfg.sdSectorUs;
+            vs.advance(readUs);
+            if (!audibleAt)
+                audibleAt = vs.stats().elapsedUs + vs.sdiTimeUs(Vs1053Model::CHUNK_SIZE) + cfg.decoderStartUs;
+            vs.playChunk(block, sizeof(block));
+        }
+    };
+
+    // OptoKeypadInTask: one matrix sample per tick, and the gesture engine
+    // fed the way updateOptoEvents() does: inputs below triggerInput never,
+    // the others every OPTO_EVENT_DECIMATION+1 ticks, alarms every tick
+    std::function<void()> scanTick = [&]() {
+        uint16_t raw = contact.level(sched.now) ? (1 << cfg.triggerInput) : 0;
+        for (int i = 0; i < NUM_INPUTS; i++)
+            if (rnd.chance(cfg.noiseProb))
+                raw ^= 1 << i;
+        uint16_t filtered = filter.update(raw);
+        bool full = decimation >= OPTO_EVENT_DECIMATION;
+        decimation = full ? 0 : decimation + 1;
+        uint16_t mask = (full ? 0xFFFF : alarmMask) & ~((1u << cfg.triggerInput) - 1);
+        gestureState = (gestureState & ~mask) | (filtered & mask);
+        gestures.update(gestureState, (uint32_t)sched.now, collectEvent);
+
+        for (auto &e : pendingEvents)
+        {
+            if (e.first != cfg.triggerInput)
+                rep.falseEvents++;
+            else if (e.second == KEY_EVENT_PRESS && !triggered)
+            {
+                triggered = true;
+                startAnnouncement();
+            }
+        }
+        pendingEvents.clear();
+        sched.after(cfg.scanPeriodUs, scanTick);
+    };
+
+    sched.at(rnd.below(cfg.scanPeriodUs), scanTick);
+    sched.runUntil(contact.t1);
+
+    if (!triggered)
+    {
+        rep.missedTriggers++;
+        return;
+    }
+    lat.push_back((uint32_t)(audibleAt - contact.t0));
+    rep.underruns += vs.stats().underruns;
+    rep.underrunUs += vs.stats().underrunUs;
+    rep.dreqBlockedUs += vs.stats().blockedUs;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  I2C bus: RDS polls at NORMAL priority every rdsPollUs, display slices at
+//  LOW. The bus task finishes the transaction on the bus, then runs the
+//  highest priority one queued, so a poll that comes due waits for at most
+//  one display slice.
+// ─────────────────────────────────────────────────────────────────────────────
+class SimRadioPolls
+{
+public:
+    SimRadioPolls(const SimConfig &cfg, uint32_t phaseUs)
+        : phase(phaseUs), period(cfg.rdsPollUs), busUs((uint32_t)(cfg.rdsPollBytes * 9ULL * 1000000 / cfg.i2cHz))
+    {
+    }
+
+    // i2cBusPending(I2C_DEV_RADIO) on an otherwise idle bus
+    bool pending(uint64_t t) const { return t >= phase && (t - phase) % period < busUs; }
+
+    // First use of the bus at 't': waits for a poll that is on the bus
+    uint64_t claim(uint64_t t)
+    {
+        next = t < phase ? phase : phase + (t - phase) / period * period;
+        if (next + busUs <= t)
+            next += period;
+        else if (next < t)
+        {
+            t = next + busUs;
+            next += period;
+        }
+        return t;
+    }
+
+    // Bus free again at 't': run the polls that came due meanwhile
+    uint64_t serve(uint64_t t)
+    {
+        while (next <= t)
+        {
+            t += busUs;
+            next += period;
+        }
+        return t;
+    }
+
+private:
+    uint64_t phase;
+    uint32_t period;
+    uint32_t busUs;
+    uint64_t next = 0;
+};
+
+// QueuedSsd1306Bus on the simulated bus: commands in one write, data in
+// slices of i2cBusSliceBytes(), each with its control and address bytes
+class SimSsd1306Bus : public Ssd1306Bus
+{
+public:
+    SimSsd1306Bus(const SimConfig &cfg, SimRadioPolls &polls, uint64_t t) : cfg(cfg), polls(polls)
+    {
+        freeAt = polls.claim(t);
+        size_t n = (uint64_t)cfg.i2cHz * cfg.i2cSliceUs / 9000000;
+        slice = std::min<size_t>(std::max<size_t>(n, 16), cfg.i2cXferMax) - 1;
+    }
+
+    void command(const uint8_t *, size_t len) override { write(len); }
+    void data(const uint8_t *, size_t len) override
+    {
+        for (; len > slice; len -= slice)
+            write(slice);
+        write(len);
+    }
+
+    uint64_t freeAt;
+
+private:
+    void write(size_t len)
+    {
+        freeAt = polls.serve(freeAt) + (len + 2) * 9ULL * 1000000 / cfg.i2cHz;
+    }
+
+    const SimConfig &cfg;
+    SimRadioPolls &polls;
+    size_t slice;
+};
+
+class NullSsd1306Bus : public Ssd1306Bus
+{
+public:
+    void command(const uint8_t *, size_t) override {}
+    void data(const uint8_t *, size_t) override {}
+};
+
+// Frames before and after the key: the changed region as a test pattern
+struct SimFrames
+{
+    uint8_t before[SSD1306_FLUSH_BYTES];
+    uint8_t after[SSD1306_FLUSH_BYTES];
+
+    explicit SimFrames(const SimConfig &cfg)
+    {
+        memset(before, 0, sizeof(before));
+        memcpy(after, before, sizeof(after));
+        for (int p = cfg.changedPage; p < cfg.changedPage + cfg.changedPages && p < SSD1306_FLUSH_PAGES; p++)
+            for (int c = cfg.changedCol; c < cfg.changedCol + cfg.changedCols && c < SSD1306_FLUSH_WIDTH; c++)
+                after[p * SSD1306_FLUSH_WIDTH + c] = 0x5A ^ c;
+    }
+};
+
+// RenderTask from the UI's submission to the last byte of the frame:
+// frame-rate cap, deferral while a radio poll is queued, draw, then the
+// partial flush through the bus task
+static uint64_t renderFrame(const SimConfig &cfg, SimRandom &rnd, const SimFrames &frames, uint64_t t)
+{
+    SimRadioPolls polls(cfg, rnd.below(cfg.rdsPollUs));
+    uint64_t lastFrame = t - std::min<uint64_t>(t, rnd.below(cfg.frameAgeMaxUs));
+    t = std::max(t, lastFrame + cfg.renderMinFrameUs);
+    for (uint8_t defers = 0; defers < cfg.renderMaxDefer && polls.pending(t); defers++)
+        t += cfg.renderDeferUs;
+    t += cfg.uiDrawUs;
+
+    DisplayFlush flusher;
+    NullSsd1306Bus idle;
+    flusher.flush(frames.before, idle);
+    SimSsd1306Bus bus(cfg, polls, t);
+    flusher.flush(frames.after, bus);
+    return bus.freeAt;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Key-to-screen trial: every edge restarts the debounce timer, the key is
+//  read once the contact has been quiet for keyDebounceUs
+// ─────────────────────────────────────────────────────────────────────────────
+static void runKeyTrial(const SimConfig &cfg, SimRandom &rnd, const SimFrames &frames, std::vector<uint32_t> &lat)
+{
+    SimScheduler sched;
+    Contact contact = {cfg.scanPeriodUs + rnd.below(cfg.scanPeriodUs), 0, cfg.bounceUs, rnd.next()};
+    contact.t1 = contact.t0 + cfg.holdUs;
+    uint64_t shownAt = 0;
+    uint64_t timerDue = 0;
+
+    // Edges of the bouncing contact, at its 250 us chatter resolution
+    bool level = false;
+    for (uint64_t t = contact.t0; t < contact.t0 + cfg.bounceUs + 250; t += 250)
+    {
+        if (contact.level(t) != level)
+        {
+            level = !level;
+            uint64_t due = t + cfg.keyDebounceUs;
+            timerDue = due;
+            sched.at(due, [&, due]() {
+                if (due == timerDue && !shownAt && contact.level(sched.now))
+                    shownAt = renderFrame(cfg, rnd, frames, sched.now + cfg.uiWakeUs);
+            });
+        }
+    }
+
+    sched.runUntil(contact.t1);
+    if (shownAt)
+        lat.push_back((uint32_t)(shownAt - contact.t0));
+}
+
+void runSystemSim(const SimConfig &cfg, SimReport &report)
+{
+    SimRandom rnd(cfg.seed);
+    std::vector<uint32_t> trigger, key;
+    SimFrames frames(cfg);
+    report = SimReport();
+
+    for (uint32_t i = 0; i < cfg.trials; i++)
+    {
+        runTriggerTrial(cfg, rnd, report, trigger);
+        runKeyTrial(cfg, rnd, frames, key);
+    }
+    report.triggerToAudio = summarize(trigger);
+    report.keyToScreen = summarize(key);
+}
+
+void printSimReport(const SimReport &r, FILE *out)
+{
+    fprintf(out, "trigger->audio: n=%u p50=%.1f ms p99=%.1f ms max=%.1f ms\n", r.triggerToAudio.count,
+            r.triggerToAudio.p50Us / 1000.0, r.triggerToAudio.p99Us / 1000.0, r.triggerToAudio.maxUs / 1000.0);
+    fprintf(out, "key->screen:    n=%u p50=%.1f ms p99=%.1f ms max=%.1f ms\n", r.keyToScreen.count,
+            r.keyToScreen.p50Us / 1000.0, r.keyToScreen.p99Us / 1000.0, r.keyToScreen.maxUs / 1000.0);
+    fprintf(out, "missed triggers %u, false events %u\n", r.missedTriggers, r.falseEvents);
+    fprintf(out, "decoder underruns %u (%.1f ms), blocked on DREQ %.1f ms\n", r.underruns, r.underrunUs / 1000.0,
+            r.dreqBlockedUs / 1000.0);
+}
+
+bool checkSimBudget(const SimReport &r, const SimBudget &b, FILE *out)
+{
+    bool ok = true;
+    if (r.triggerToAudio.p99Us > b.triggerP99Us)
+    {
+        fprintf(out, "FAIL trigger->audio p99 %.1f ms > %.1f ms\n", r.triggerToAudio.p99Us / 1000.0,
+                b.triggerP99Us / 1000.0);
+        ok = false;
+    }
+    if (r.keyToScreen.p99Us > b.keyP99Us)
+    {
+        fprintf(out, "FAIL key->screen p99 %.1f ms > %.1f ms\n", r.keyToScreen.p99Us / 1000.0, b.keyP99Us / 1000.0);
+        ok = false;
+    }
+    if ((uint64_t)r.underruns * 1000 > (uint64_t)b.underrunsPer1000 * r.triggerToAudio.count)
+    {
+        fprintf(out, "FAIL decoder underruns %u in %u announcements > %u per 1000\n", r.underruns,
+                r.triggerToAudio.count, b.underrunsPer1000);
+        ok = false;
+    }
+    if (!r.triggerToAudio.count || !r.keyToScreen.count)
+    {
+        fprintf(out, "FAIL no samples\n");
+        ok = false;
+    }
+    return ok;
+}
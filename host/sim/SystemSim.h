@@ -0,0 +1,109 @@
+#ifndef SYSTEMSIM_H
+#define SYSTEMSIM_H
+
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * @brief Virtual-time simulation of the input-to-output paths
+ *
+ * Replays the two latency budgets we care about on the host, with the real
+ * filter (optoInLogic), gesture engine and the decoder model (Vs1053Model):
+ *
+ *  - trigger-to-audio: opto input asserted (with contact bounce and sample
+ *    noise) -> 100 Hz scan -> window filter -> gesture engine -> AudioTask
+ *    command -> SD open/read -> playChunk -> decoder output
+ *  - key-to-screen: keypad contact -> edge interrupt + debounce timer ->
+ *    event bus -> UI wakeup -> RenderTask (frame-rate cap, deferral while
+ *    radio polls are queued) -> redraw -> partial flush (DisplayFlush) in
+ *    slices through the I2C bus task, where RDS polls cut in
+ *
+ * Every trial starts from reset state with the stimulus at a random phase
+ * against the scan tick; the seed makes runs repeatable.
+ */
+
+struct SimConfig
+{
+    uint32_t trials = 1000;
+    uint32_t seed = 1;
+
+    // Input scanning (OptoKeypadInTask)
+    uint32_t scanPeriodUs = 10000;
+    uint8_t optoThreshold = 30;
+    uint8_t triggerInput = 2;      // first input that raises events
+    uint32_t bounceUs = 5000;      // contact chatter after the edge
+    uint32_t holdUs = 1000000;     // how long the input stays asserted
+    float noiseProb = 0.01f;       // per-sample chance of a flipped bit
+    bool alarmInput = false;       // trigger input on the minimum-latency path
+
+    // AudioTask and SD card
+    uint32_t audioWakeUs = 50;     // command queue + task notification
+    uint32_t sdOpenUs = 8000;      // typical open() time
+    uint32_t sdSectorUs = 1500;    // typical 512-byte sector read
+    uint32_t sdCallUs = 15;        // read() served from the sector cache
+    float sdStallProb = 0.002f;    // chance a sector read stalls
+    uint32_t sdStallUs = 150000;   // length of such a stall
+    uint32_t decoderStartUs = 26000; // first frame decoded (~1 frame at 44.1 kHz)
+    uint32_t announceBytes = 32000;  // announcement length (~2 s at 128 kbps)
+    uint32_t spiHz = 4000000;
+
+    // Keypad
+    uint32_t keyDebounceUs = 5000; // KEY_DEBOUNCE_US: quiet time after the last edge
+
+    // UI and RenderTask
+    uint32_t uiWakeUs = 50;        // event bus notification + renderSubmit()
+    uint32_t uiDrawUs = 3000;      // screen render into the frame buffer
+    uint32_t renderMinFrameUs = 40000; // RENDER_MIN_FRAME_MS
+    uint32_t renderDeferUs = 5000;     // RENDER_DEFER_MS
+    uint8_t renderMaxDefer = 4;        // RENDER_MAX_DEFER
+    uint32_t frameAgeMaxUs = 80000;    // previous frame up to this long before the key
+    // Region the key changes, in SSD1306 pages/columns (radio frequency digits)
+    uint8_t changedPage = 2;
+    uint8_t changedPages = 3;
+    uint8_t changedCol = 12;
+    uint8_t changedCols = 104;
+
+    // I2C bus task
+    uint32_t i2cHz = 400000;       // SSD1306 and Si4703 clock
+    uint32_t i2cSliceUs = 2000;    // I2C_BUS_SLICE_US
+    uint32_t i2cXferMax = 128;     // I2C_BUS_XFER_MAX
+    uint32_t rdsPollUs = 40000;    // RDS_POLL_MS, NORMAL priority
+    uint32_t rdsPollBytes = 14;    // 6 registers + address byte and restart
+};
+
+/**
+ * @brief Limits the CI run checks the report against
+ */
+struct SimBudget
+{
+    uint32_t triggerP99Us = 650000;  // one SD stall on top of the normal path
+    uint32_t keyP99Us = 80000;       // two frame slots
+    uint32_t underrunsPer1000 = 300; // decoder underruns per 1000 announcements
+};
+
+struct SimLatency
+{
+    uint32_t count;
+    uint32_t p50Us;
+    uint32_t p99Us;
+    uint32_t maxUs;
+};
+
+struct SimReport
+{
+    SimLatency triggerToAudio;
+    SimLatency keyToScreen;
+    uint32_t missedTriggers;  // no press event within the hold time
+    uint32_t falseEvents;     // events on inputs that were never driven
+    uint32_t underruns;       // decoder starvation during announcements
+    uint64_t underrunUs;
+    uint64_t dreqBlockedUs;
+};
+
+void runSystemSim(const SimConfig &cfg, SimReport &report);
+void printSimReport(const SimReport &report, FILE *out);
+
+// Prints each limit the report exceeds; true if it is within all of them
+bool checkSimBudget(const SimReport &report, const SimBudget &budget, FILE *out);
+
+#endif // SYSTEMSIM_H
@@ -0,0 +1,26 @@
+#include "SystemSim.h"
+#include <cstdlib>
+
+// system_sim [trials] [seed]
+// Exits non-zero when a run is over its SimBudget
+int main(int argc, char **argv)
+{
+    SimConfig cfg;
+    if (argc > 1)
+        cfg.trials = strtoul(argv[1], nullptr, 0);
+    if (argc > 2)
+        cfg.seed = strtoul(argv[2], nullptr, 0);
+
+    SimBudget budget;
+    SimReport r;
+    runSystemSim(cfg, r);
+    printSimReport(r, stdout);
+    bool ok = checkSimBudget(r, budget, stdout);
+
+    cfg.alarmInput = true;
+    runSystemSim(cfg, r);
+    printf("\nalarm input\n");
+    printSimReport(r, stdout);
+    ok &= checkSimBudget(r, budget, stdout);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+#include "Vs1053Model.h"
+#include <cmath>
+#include <cstring>
+
+// MPEG audio layer III bitrates in kbps, by header bitrate index
+static const uint16_t bitrateMpeg1[16] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0};
+static const uint16_t bitrateMpeg2[16] = {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0};
+
+Vs1053Model::Vs1053Model(uint32_t spiHz, uint32_t defaultByteRate)
+    : spiHz(spiHz), defaultRate(defaultByteRate)
+{
+    resetStats();
+    reset();
+}
+
+void Vs1053Model::reset()
+{
+    memset(regs, 0, sizeof(regs));
+    regs[SCI_MODE] = 0x0800;   // SM_SDINEW
+    regs[SCI_STATUS] = 0x0040; // VS1053 version field
+    rate = defaultRate;
+    rateAccum = 0;
+    fill = 0;
+    streaming = false;
+    starved = false;
+    headerShift = 0;
+    decodeUs = 0;
+    cancelling = false;
+    flushing = false;
+    volGain = 1.0f; // SCI_VOL 0 after reset
+    updateOutput();
+}
+
+void Vs1053Model::resetStats()
+{
+    memset(&st, 0, sizeof(st));
+    st.minFill = FIFO_SIZE;
+}
+
+uint16_t Vs1053Model::sciRead(uint8_t reg)
+{
+    reg &= 0x0F;
+    switch (reg)
+    {
+    case SCI_DECODE_TIME:
+        return (uint16_t)(decodeUs / 1000000);
+    case SCI_WRAM:
+    {
+        // The parametric block entries the driver reads
+        uint16_t addr = regs[SCI_WRAMADDR]++;
+        if (addr == 0x1e05)
+            return (uint16_t)rate; // byteRate
+        return 0;                  // endFillByte (0x1e06) and the rest
+    }
+    default:
+        return regs[reg];
+    }
+}
+
+void Vs1053Model::sciWrite(uint8_t reg, uint16_t value)
+{
+    reg &= 0x0F;
+    switch (reg)
+    {
+    case SCI_MODE:
+        if (value & (1 << SM_RESET))
+        {
+            reset();
+            return;
+        }
+        regs[SCI_MODE] = value;
+        if (!(value & (1 << SM_CANCEL)))
+            cancelling = false;
+        else if (!cancelUs)
+            completeCancel();
+        else if (!cancelling)
+        {
+            cancelling = true;
+            cancelLeftUs = cancelUs;
+        }
+        break;
+    case SCI_VOL:
+        regs[SCI_VOL] = value;
+        volGain = (value >> 8) == 0xFF ? 0.0f : powf(10.0f, -(float)(value >> 8) / 40.0f);
+        break;
+    case SCI_DECODE_TIME:
+        decodeUs = (uint64_t)value * 1000000;
+        break;
+    default:
+        regs[reg] = value;
+        break;
+    }
+    updateOutput();
+}
+
+// Song cancelled: the decoder discards what is buffered and clears the bit
+void Vs1053Model::completeCancel()
+{
+    regs[SCI_MODE] &= ~(1 << SM_CANCEL);
+    regs[SCI_HDAT0] = 0;
+    regs[SCI_HDAT1] = 0;
+    cancelling = false;
+    flushing = true;
+    fill = 0;
+    streaming = false;
+    starved = false;
+    rate = defaultRate;
+    rateAccum = 0;
+    updateOutput();
+}
+
+// Record the output step when the gain or the selected input changes
+void Vs1053Model::updateOutput()
+{
+    OutputSource source = OUT_NONE;
+    float amp = 0, dc = 0;
+    if (regs[SCI_MODE] & (1 << SM_LINE1))
+    {
+        source = OUT_LINE;
+        amp = sig.lineAmp;
+        dc = sig.lineDc;
+    }
+    else if (streaming && !flushing && !starved)
+    {
+        source = OUT_DECODER;
+        amp = sig.decoderAmp;
+        dc = sig.decoderDc;
+    }
+    if (source == outSource && volGain == outGain && amp == outAmp && dc == outDc)
+        return;
+
+    // The same input keeps its phase across a gain change; a different one
+    // may be at the opposite peak
+    float dcStep = fabsf(volGain * dc - outGain * outDc);
+    float step = source == outSource ? fabsf(volGain - outGain) * (fabsf(dc) + amp)
+                                     : dcStep + volGain * amp + outGain * outAmp;
+    if (step > 0)
+        st.outputSteps++;
+    if (step > st.maxStep)
+        st.maxStep = step;
+    if (dcStep > st.maxDcStep)
+        st.maxDcStep = dcStep;
+    outSource = source;
+    outGain = volGain;
+    outAmp = amp;
+    outDc = dc;
+}
+
+// Track MP3 frame headers in the byte stream to follow the bitrate (CBR or VBR)
+void Vs1053Model::scanHeader(uint8_t b)
+{
+    headerShift = (headerShift << 8) | b;
+    uint32_t h = headerShift;
+
+    if ((h & 0xFFE00000) != 0xFFE00000)
+        return; // no frame sync
+    uint8_t version = (h >> 19) & 3; // 0 = 2.5, 2 = 2, 3 = 1
+    uint8_t layer = (h >> 17) & 3;   // 1 = layer III
+    uint8_t brIndex = (h >> 12) & 15;
+    uint8_t srIndex = (h >> 10) & 3;
+    if (version == 1 || layer != 1 || brIndex == 0 || brIndex == 15 || srIndex == 3)
+        return;
+
+    uint16_t kbps = version == 3 ? bitrateMpeg1[brIndex] : bitrateMpeg2[brIndex];
+    flushing = false;
+    rate = kbps * 1000 / 8;
+    regs[SCI_HDAT1] = h >> 16;
+    regs[SCI_HDAT0] = h & 0xFFFF;
+}
+
+size_t Vs1053Model::sdiWrite(const uint8_t *data, size_t len)
+{
+    size_t room = FIFO_SIZE - fill;
+    size_t n = len < room ? len : room;
+
+    for (size_t i = 0; i < n; i++)
+        scanHeader(data[i]);
+    fill += n;
+    st.bytesIn += n;
+    st.overflowBytes += len - n;
+    if (fill > st.maxFill)
+        st.maxFill = fill;
+    if (n)
+    {
+        streaming = true;
+        starved = false;
+        updateOutput();
+    }
+    return n;
+}
+
+void Vs1053Model::playChunk(const uint8_t *data, size_t len, uint32_t pollUs)
+{
+    while (len)
+    {
+        while (!dreq())
+        {
+            advance(pollUs);
+            st.blockedUs += pollUs;
+        }
+        size_t chunk = len < CHUNK_SIZE ? len : CHUNK_SIZE;
+        sdiWrite(data, chunk);
+        advance(sdiTimeUs(chunk));
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+void Vs1053Model::advance(uint32_t us)
+{
+    if (cancelling)
+    {
+        if (us < cancelLeftUs)
+        {
+            cancelLeftUs -= us;
+        }
+        else
+        {
+            // Plays up to the moment the cancel takes effect
+            uint32_t before = cancelLeftUs;
+            decode(before);
+            completeCancel();
+            us -= before;
+        }
+    }
+    decode(us);
+}
+
+void Vs1053Model::decode(uint32_t us)
+{
+    st.elapsedUs += us;
+    if (!streaming)
+        return;
+    if (flushing)
+    {
+        fill = 0; // no format: fill bytes go as fast as they arrive
+        return;
+    }
+
+    rateAccum += (uint64_t)rate * us;
+    size_t want = rateAccum / 1000000;
+    rateAccum -= (uint64_t)want * 1000000;
+
+    if (want <= fill)
+    {
+        fill -= want;
+        st.bytesDecoded += want;
+        decodeUs += us;
+    }
+    else
+    {
+        // Ran dry part way through the interval
+        uint32_t playedUs = rate ? (uint32_t)((uint64_t)fill * 1000000 / rate) : 0;
+        st.bytesDecoded += fill;
+        decodeUs += playedUs;
+        st.underrunUs += us - playedUs;
+        fill = 0;
+        rateAccum = 0;
+        if (!starved)
+        {
+            st.underruns++;
+            starved = true;
+            updateOutput();
+        }
+    }
+    if (fill < st.minFill)
+        st.minFill = fill;
+}
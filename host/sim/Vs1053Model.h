@@ -0,0 +1,147 @@
+#ifndef VS1053MODEL_H
+#define VS1053MODEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Software model of the VS1053 decoder for off-target throughput tests
+ *
+ * Models what the feeding side can observe: the SCI registers, a 2048-byte
+ * SDI FIFO and the DREQ line. The FIFO drains at the byte rate of the last
+ * MP3 frame header seen in the data (or defaultByteRate until one arrives),
+ * so buffering strategies can be compared for underruns and time blocked on
+ * DREQ. Time is virtual: nothing happens until advance() is called.
+ *
+ * For click measurements the output is modelled as well: SCI_VOL gain times
+ * the selected input (SM_LINE1, or the decoder while it plays), each input
+ * carrying what setSignal() says. Every instant change of gain or input is
+ * recorded as an output step. SM_CANCEL can take effect after a delay
+ * (setCancelUs()); the decoder plays on until then.
+ *
+ * Plain C++, no Arduino or FreeRTOS dependencies.
+ */
+
+struct Vs1053ModelStats
+{
+    uint64_t elapsedUs;     // virtual time advanced
+    uint64_t bytesIn;       // bytes accepted over SDI
+    uint64_t bytesDecoded;  // bytes drained by the decoder
+    uint32_t overflowBytes; // bytes written while the FIFO was full (lost)
+    uint32_t underruns;     // FIFO ran dry while a stream was playing
+    uint64_t underrunUs;    // time spent starved
+    uint64_t blockedUs;     // time playChunk() spent waiting for DREQ
+    uint16_t maxFill;       // FIFO high-water mark
+    uint16_t minFill;       // FIFO low-water mark once playing
+    uint32_t outputSteps;   // instant changes of output gain or input
+    float maxStep;          // largest of them, worst-case signal phase (full scale 1.0)
+    float maxDcStep;        // largest change of the output DC level
+};
+
+// What each input carries, full scale 1.0: a signal of peak 'amp' on 'dc'
+struct Vs1053Signal
+{
+    float decoderAmp;
+    float decoderDc;
+    float lineAmp;
+    float lineDc;
+};
+
+class Vs1053Model
+{
+public:
+    static const size_t FIFO_SIZE = 2048;
+    static const size_t CHUNK_SIZE = 32; // DREQ high means at least this much room
+
+    // SCI registers, same numbering as the chip
+    static const uint8_t SCI_MODE = 0x0;
+    static const uint8_t SCI_STATUS = 0x1;
+    static const uint8_t SCI_DECODE_TIME = 0x4;
+    static const uint8_t SCI_WRAM = 0x6;
+    static const uint8_t SCI_WRAMADDR = 0x7;
+    static const uint8_t SCI_HDAT0 = 0x8;
+    static const uint8_t SCI_HDAT1 = 0x9;
+    static const uint8_t SCI_VOL = 0xB;
+    static const uint8_t SM_RESET = 2;
+    static const uint8_t SM_CANCEL = 3;
+    static const uint8_t SM_LINE1 = 14;
+
+    explicit Vs1053Model(uint32_t spiHz = 4000000, uint32_t defaultByteRate = 16000);
+
+    // Hardware reset: registers to power-on values, FIFO empty, stats kept
+    void reset();
+
+    uint16_t sciRead(uint8_t reg);
+    void sciWrite(uint8_t reg, uint16_t value);
+
+    // Push bytes over SDI; returns how many fit. The rest count as overflow.
+    size_t sdiWrite(const uint8_t *data, size_t len);
+
+    // Same contract as VS1053::playChunk(): waits for DREQ before every
+    // 32-byte chunk, advancing virtual time by pollUs per check and by the
+    // SPI transfer time per chunk
+    void playChunk(const uint8_t *data, size_t len, uint32_t pollUs = 100);
+
+    // Let the decoder run for 'us' microseconds of virtual time
+    void advance(uint32_t us);
+
+    // Stop counting underruns until the next sdiWrite (song finished)
+    void endOfStream()
+    {
+        streaming = false;
+        updateOutput();
+    }
+
+    // Delay from setting SM_CANCEL to the decoder stopping and clearing it;
+    // 0 (default) cancels at once
+    void setCancelUs(uint32_t us) { cancelUs = us; }
+    void setSignal(const Vs1053Signal &s)
+    {
+        sig = s;
+        updateOutput();
+    }
+
+    bool dreq() const { return FIFO_SIZE - fill >= CHUNK_SIZE; }
+    size_t fifoFill() const { return fill; }
+    uint32_t byteRate() const { return rate; }
+    uint32_t sdiTimeUs(size_t len) const { return (uint32_t)(len * 8ULL * 1000000ULL / spiHz); }
+    uint32_t sciTimeUs() const { return sdiTimeUs(4); } // command, address, 16-bit value
+
+    const Vs1053ModelStats &stats() const { return st; }
+    void resetStats();
+
+private:
+    enum OutputSource : uint8_t
+    {
+        OUT_NONE,
+        OUT_DECODER,
+        OUT_LINE
+    };
+
+    void scanHeader(uint8_t b);
+    void decode(uint32_t us);
+    void completeCancel();
+    void updateOutput();
+
+    uint32_t spiHz;
+    uint32_t defaultRate;
+    uint32_t rate;          // current decode rate, bytes/s
+    uint64_t rateAccum;     // fractional bytes, in byte*us units
+    size_t fill;
+    bool streaming;         // data received and not yet ended
+    bool starved;
+    uint32_t headerShift;   // last four SDI bytes, for frame sync
+    uint64_t decodeUs;
+    uint32_t cancelUs = 0;
+    uint32_t cancelLeftUs;
+    bool cancelling;        // SM_CANCEL set, decoder still playing
+    bool flushing;          // cancelled: bytes are dropped until the next frame header
+    uint16_t regs[16];
+    float volGain;          // from SCI_VOL
+    Vs1053Signal sig = {};
+    OutputSource outSource = OUT_NONE;
+    float outGain = 0, outAmp = 0, outDc = 0;
+    Vs1053ModelStats st;
+};
+
+#endif // VS1053MODEL_H
@@ -0,0 +1,127 @@
+#include "Vs1053SpiChip.h"
+
+#define SCI_OP_WRITE 2
+#define SCI_OP_READ 3
+
+Vs1053SpiChip::Vs1053SpiChip(uint8_t csPin, uint8_t dcsPin, uint8_t dreqPin, uint32_t defaultByteRate)
+    : cs(csPin), dcs(dcsPin), dreq(dreqPin), chip(4000000, defaultByteRate), lastUs(hostClockUs())
+{
+    hostSpiAttach(this);
+    hostPinListen(onPin, this);
+    hostClockListen(onClock, this);
+    updateDreq();
+}
+
+Vs1053SpiChip::~Vs1053SpiChip()
+{
+    hostClockUnlisten(onClock, this);
+    hostPinUnlisten(onPin, this);
+    hostSpiAttach(nullptr);
+}
+
+void Vs1053SpiChip::onPin(uint8_t pin, bool level, void *ctx)
+{
+    Vs1053SpiChip *self = (Vs1053SpiChip *)ctx;
+    if (pin != self->cs && pin != self->dcs)
+        return;
+    {
+        std::lock_guard<std::mutex> g(self->m);
+        bool wasReset = self->csLow && self->dcsLow;
+        if (pin == self->cs)
+        {
+            self->csLow = !level;
+            self->sciPos = 0; // any xCS edge ends or starts a frame
+        }
+        else
+        {
+            self->dcsLow = !level;
+        }
+        if (self->csLow && self->dcsLow && !wasReset)
+        {
+            self->chip.reset();
+            self->resetCount++;
+        }
+    }
+    self->updateDreq();
+}
+
+void Vs1053SpiChip::onClock(uint64_t nowUs, void *ctx)
+{
+    Vs1053SpiChip *self = (Vs1053SpiChip *)ctx;
+    {
+        std::lock_guard<std::mutex> g(self->m);
+        while (nowUs > self->lastUs)
+        {
+            uint64_t step = nowUs - self->lastUs;
+            if (step > 1000000)
+                step = 1000000;
+            self->chip.advance((uint32_t)step);
+            self->lastUs += step;
+        }
+    }
+    self->updateDreq();
+}
+
+uint8_t Vs1053SpiChip::transfer(uint8_t out)
+{
+    uint8_t in = 0xFF;
+    {
+        std::lock_guard<std::mutex> g(m);
+        if (csLow && dcsLow)
+            return in; // held in reset
+        if (dcsLow)
+        {
+            chip.sdiWrite(&out, 1);
+        }
+        else if (csLow)
+        {
+            switch (sciPos)
+            {
+            case 0:
+                sciOp = out;
+                break;
+            case 1:
+                sciReg = out;
+                if (sciOp == SCI_OP_READ)
+                    sciValue = chip.sciRead(sciReg);
+                break;
+            case 2:
+                if (sciOp == SCI_OP_READ)
+                    in = sciValue >> 8;
+                else
+                    sciValue = out << 8;
+                break;
+            case 3:
+                if (sciOp == SCI_OP_READ)
+                {
+                    in = sciValue & 0xFF;
+                }
+                else if (sciOp == SCI_OP_WRITE)
+                {
+                    sciValue |= out;
+                    chip.sciWrite(sciReg, sciValue);
+                }
+                sciCount++;
+                break;
+            default:
+                badSci++;
+                break;
+            }
+            sciPos++;
+        }
+    }
+    updateDreq();
+    return in;
+}
+
+void Vs1053SpiChip::updateDreq()
+{
+    bool level;
+    {
+        std::lock_guard<std::mutex> g(m);
+        // DREQ stays low while the chip is held in reset
+        level = !(csLow && dcsLow) && chip.dreq();
+    }
+    if (hostPinLevel(dreq) != level)
+        hostPinDrive(dreq, level);
+}
@@ -0,0 +1,52 @@
+#ifndef VS1053SPICHIP_H
+#define VS1053SPICHIP_H
+
+#include "Vs1053Model.h"
+#include "hostBoard.h"
+#include <mutex>
+
+/**
+ * @brief Puts a Vs1053Model on the simulated board's SPI bus and pins
+ *
+ * The firmware's VS1053 driver then runs unchanged against the model: xCS
+ * low frames a 4-byte SCI command (opcode, register, 16-bit value), xDCS
+ * low sends SDI bytes to the FIFO, both low is the driver's hardware reset.
+ * The decoder runs as the board clock moves and the model's DREQ is driven
+ * on the DREQ pin.
+ *
+ * One chip per process: it owns the SPI device slot (hostSpiAttach).
+ */
+class Vs1053SpiChip : public HostSpiDevice
+{
+public:
+    Vs1053SpiChip(uint8_t csPin, uint8_t dcsPin, uint8_t dreqPin, uint32_t defaultByteRate = 16000);
+    ~Vs1053SpiChip() override;
+
+    uint8_t transfer(uint8_t out) override;
+
+    // The model, for stats and settings; lock() around use from a test
+    // while other threads may feed the chip
+    Vs1053Model &model() { return chip; }
+    std::mutex &lock() { return m; }
+
+    uint32_t resets() const { return resetCount; }
+    uint32_t sciCommands() const { return sciCount; }
+    uint32_t badSciBytes() const { return badSci; } // bytes past a 4-byte command
+
+private:
+    static void onPin(uint8_t pin, bool level, void *ctx);
+    static void onClock(uint64_t nowUs, void *ctx);
+    void updateDreq();
+
+    uint8_t cs, dcs, dreq;
+    Vs1053Model chip;
+    std::mutex m;
+    bool csLow = false, dcsLow = false;
+    uint8_t sciPos = 0;      // byte index in the current SCI frame
+    uint8_t sciOp = 0, sciReg = 0;
+    uint16_t sciValue = 0;   // read result or write value being assembled
+    uint64_t lastUs;
+    uint32_t resetCount = 0, sciCount = 0, badSci = 0;
+};
+
+#endif // VS1053SPICHIP_H
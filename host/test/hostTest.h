@@ -0,0 +1,44 @@
+/**
+ * @file hostTest.h
+ * @brief Minimal checks for the host unit tests: each failed CHECK prints
+ *        its location and expression, main() returns hostTestResult().
+ */
+#ifndef HOSTTEST_H
+#define HOSTTEST_H
+
+#include <cstdio>
+
+static int hostTestFailures = 0;
+
+#define CHECK(cond)                                                            \
+    do                                                                         \
+    {                                                                          \
+        if (!(cond))                                                           \
+        {                                                                      \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            hostTestFailures++;                                                \
+        }                                                                      \
+    } while (0)
+
+// Integer comparison that also prints both values
+#define CHECK_EQ(a, b)                                                         \
+    do                                                                         \
+    {                                                                          \
+        long long va_ = (long long)(a), vb_ = (long long)(b);                  \
+        if (va_ != vb_)                                                        \
+        {                                                                      \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, va_, vb_); \
+            hostTestFailures++;                                                \
+        }                                                                      \
+    } while (0)
+
+static inline int hostTestResult(const char *name)
+{
+    if (hostTestFailures)
+        fprintf(stderr, "%s: %d check(s) failed\n", name, hostTestFailures);
+    else
+        printf("%s: ok\n", name);
+    return hostTestFailures ? 1 : 0;
+}
+
+#endif // HOSTTEST_H
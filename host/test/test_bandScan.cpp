@@ -0,0 +1,130 @@
+// Band scan station selection on a synthetic 87.5-108 MHz band (206
+// channels at 100 kHz): eight stations with shoulders on the neighbouring
+// channels, a noise floor below the threshold, one programme on two
+// channels and one station without RDS
+#include "bandScanLogic.h"
+#include "hostTest.h"
+#include <cstring>
+
+#define CHANNELS 206
+
+struct Transmitter
+{
+    uint16_t channel;
+    uint8_t rssi;
+    uint16_t pi;
+};
+
+static const Transmitter band[] = {
+    {12, 48, 0xD3C2},
+    {31, 35, 0xD312},
+    {60, 56, 0xD3A1},
+    {61, 56, 0xD3A1}, // flat top over two channels: one peak
+    {95, 41, 0xD3C2}, // same programme as channel 12, weaker
+    {130, 28, 0},     // no RDS
+    {150, 52, 0xD8F5},
+    {177, 24, 0xD544},
+    {205, 39, 0xD611}, // last channel
+};
+
+static void buildBand(uint8_t *rssi)
+{
+    for (int ch = 0; ch < CHANNELS; ch++)
+        rssi[ch] = 8 + ch % 5; // noise floor
+    for (const Transmitter &t : band)
+    {
+        rssi[t.channel] = t.rssi;
+        // Shoulders: weaker, and still above the threshold for strong ones
+        if (t.channel > 0 && rssi[t.channel - 1] < t.rssi - 12)
+            rssi[t.channel - 1] = t.rssi - 12;
+        if (t.channel + 1 < CHANNELS && rssi[t.channel + 1] < t.rssi - 12)
+            rssi[t.channel + 1] = t.rssi - 12;
+    }
+}
+
+static uint16_t piOf(uint16_t ch)
+{
+    for (const Transmitter &t : band)
+        if (t.channel == ch)
+            return t.pi;
+    return 0;
+}
+
+static void scanBand()
+{
+    uint8_t rssi[CHANNELS];
+    buildBand(rssi);
+
+    uint16_t peaks[SCAN_MAX_STATIONS];
+    uint8_t n = scanFindPeaks(rssi, CHANNELS, peaks);
+    static const uint16_t strongestFirst[] = {60, 150, 12, 95, 205, 31, 130, 177};
+    CHECK_EQ(n, 8);
+    for (int i = 0; i < n && i < 8; i++)
+        CHECK_EQ(peaks[i], strongestFirst[i]);
+
+    // Identify in peak order, as the scan task does
+    ScanStation stations[SCAN_MAX_STATIONS];
+    uint8_t count = 0;
+    int dropped = 0;
+    for (int i = 0; i < n; i++)
+    {
+        ScanStation s = {(uint16_t)(8750 + peaks[i] * 10), piOf(peaks[i]), rssi[peaks[i]], true};
+        if (!scanAddStation(stations, count, s))
+            dropped++;
+    }
+    CHECK_EQ(dropped, 1);
+    CHECK_EQ(count, 7);
+
+    // The duplicate PI kept its stronger channel
+    for (int i = 0; i < count; i++)
+        CHECK(stations[i].freq != 8750 + 95 * 10);
+
+    scanRankStations(stations, count);
+    static const uint16_t ranked[] = {9350, 10250, 8870, 10800, 9060, 10520, 10050};
+    for (int i = 0; i < count; i++)
+        CHECK_EQ(stations[i].freq, ranked[i]);
+    CHECK_EQ(stations[count - 1].pi, 0);
+}
+
+static void edges()
+{
+    uint8_t rssi[CHANNELS];
+    uint16_t peaks[SCAN_MAX_STATIONS];
+
+    // Nothing above the threshold; a peak exactly at it counts
+    memset(rssi, SCAN_MIN_RSSI - 1, sizeof(rssi));
+    CHECK_EQ(scanFindPeaks(rssi, CHANNELS, peaks), 0);
+    rssi[100] = SCAN_MIN_RSSI;
+    CHECK_EQ(scanFindPeaks(rssi, CHANNELS, peaks), 1);
+
+    // More peaks than the list holds: the strongest stay, strongest first
+    for (int ch = 0; ch < CHANNELS; ch++)
+        rssi[ch] = ch % 2 ? 20 + ch / 4 : 0;
+    CHECK_EQ(scanFindPeaks(rssi, CHANNELS, peaks), SCAN_MAX_STATIONS);
+    CHECK_EQ(peaks[0], 205);
+    for (int i = 1; i < SCAN_MAX_STATIONS; i++)
+        CHECK(rssi[peaks[i]] <= rssi[peaks[i - 1]]);
+    CHECK(rssi[peaks[SCAN_MAX_STATIONS - 1]] >= 20 + 125 / 4);
+
+    // Stations without RDS are never merged; a full list takes no more
+    ScanStation stations[SCAN_MAX_STATIONS];
+    uint8_t count = 0;
+    for (int i = 0; i < SCAN_MAX_STATIONS; i++)
+        CHECK(scanAddStation(stations, count, {(uint16_t)(8750 + i * 10), 0, 30, false}));
+    CHECK(!scanAddStation(stations, count, {10000, 0x1234, 60, true}));
+    CHECK_EQ(count, SCAN_MAX_STATIONS);
+
+    // Ranking is stable for equal RSSI
+    ScanStation tie[3] = {{9000, 0, 30, false}, {9100, 0x1111, 30, false}, {9200, 0x2222, 30, false}};
+    scanRankStations(tie, 3);
+    CHECK_EQ(tie[0].freq, 9100);
+    CHECK_EQ(tie[1].freq, 9200);
+    CHECK_EQ(tie[2].freq, 9000);
+}
+
+int main()
+{
+    scanBand();
+    edges();
+    return hostTestResult("bandScan");
+}
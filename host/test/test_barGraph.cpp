@@ -0,0 +1,98 @@
+// Bar graph against a per-pixel reference: for random regions, bar counts
+// and levels, every pixel of the region must be lit exactly when it lies in
+// a bar column at or below the bar's height, and nothing outside the region
+// may change
+#include "barGraph.h"
+#include "displayFlush.h"
+#include "hostTest.h"
+#include <cstdlib>
+#include <cstring>
+
+static bool getPixel(const uint8_t *frame, int x, int y)
+{
+    return frame[(y >> 3) * SSD1306_FLUSH_WIDTH + x] & (1 << (y & 7));
+}
+
+// Pixel (x, y) of the graph, region already clamped to the panel
+static bool barPixel(const uint8_t *levels, int count, int page0, int page1, int col0, int col1, int x, int y)
+{
+    int width = col1 - col0 + 1;
+    int rows = (page1 - page0 + 1) * 8;
+    if (!count)
+        return false;
+    int pitch = width + 1 >= count ? (width + 1) / count : 1;
+    int bar = (x - col0) / pitch;
+    if (bar >= count)
+        return false;
+    if (pitch > 1 && (x - col0) % pitch == pitch - 1)
+        return false; // gap column
+    int lit = (2 * levels[bar] * rows + 255) / 510; // level * rows / 255, nearest
+    return y >= page0 * 8 + rows - lit;
+}
+
+static void randomRegions()
+{
+    long mismatches = 0, outside = 0;
+
+    srand(11);
+    for (int it = 0; it < 5000; it++)
+    {
+        uint8_t page0 = rand() % 9, page1 = rand() % 10;
+        uint8_t col0 = rand() % 140, col1 = rand() % 150;
+        uint8_t count = rand() % 8 == 0 ? rand() % 256 : rand() % 33;
+        uint8_t levels[256];
+        for (int i = 0; i < count; i++)
+            levels[i] = rand() % 4 == 0 ? (rand() & 1) * 255 : rand();
+
+        uint8_t frame[SSD1306_FLUSH_BYTES], before[SSD1306_FLUSH_BYTES];
+        for (int i = 0; i < SSD1306_FLUSH_BYTES; i++)
+            before[i] = rand();
+        memcpy(frame, before, sizeof(frame));
+        drawBarGraph(frame, levels, count, page0, page1, col0, col1);
+
+        int p1 = page1 < SSD1306_FLUSH_PAGES ? page1 : SSD1306_FLUSH_PAGES - 1;
+        int c1 = col1 < SSD1306_FLUSH_WIDTH ? col1 : SSD1306_FLUSH_WIDTH - 1;
+        bool drawn = page0 <= p1 && col0 <= c1;
+        bool bad = false, changed = false;
+        for (int y = 0; y < SSD1306_FLUSH_PAGES * 8; y++)
+            for (int x = 0; x < SSD1306_FLUSH_WIDTH; x++)
+            {
+                bool inside = drawn && y >= page0 * 8 && y < (p1 + 1) * 8 && x >= col0 && x <= c1;
+                if (inside)
+                    bad |= getPixel(frame, x, y) != barPixel(levels, count, page0, p1, col0, c1, x, y);
+                else
+                    changed |= getPixel(frame, x, y) != getPixel(before, x, y);
+            }
+        mismatches += bad;
+        outside += changed;
+    }
+    CHECK_EQ(mismatches, 0);
+    CHECK_EQ(outside, 0);
+}
+
+// The operation screen's VU meter: two bars on pages 4-5, columns 72-127
+static void vuMeter()
+{
+    uint8_t frame[SSD1306_FLUSH_BYTES] = {};
+    uint8_t levels[2] = {255, 128};
+    drawBarGraph(frame, levels, 2, 4, 5, 72, 127);
+    // 28 columns per bar: 27 lit, one gap
+    for (int x = 72; x < 72 + 27; x++)
+    {
+        CHECK_EQ(frame[4 * SSD1306_FLUSH_WIDTH + x], 0xFF);
+        CHECK_EQ(frame[5 * SSD1306_FLUSH_WIDTH + x], 0xFF);
+    }
+    CHECK_EQ(frame[5 * SSD1306_FLUSH_WIDTH + 72 + 27], 0);
+    // Half height: the lower page only
+    CHECK_EQ(frame[4 * SSD1306_FLUSH_WIDTH + 100], 0);
+    CHECK_EQ(frame[5 * SSD1306_FLUSH_WIDTH + 100], 0xFF);
+    CHECK_EQ(frame[5 * SSD1306_FLUSH_WIDTH + 126], 0xFF);
+    CHECK_EQ(frame[5 * SSD1306_FLUSH_WIDTH + 127], 0);
+}
+
+int main()
+{
+    randomRegions();
+    vuMeter();
+    return hostTestResult("barGraph");
+}
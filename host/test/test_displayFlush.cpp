@@ -0,0 +1,129 @@
+// Partial flush windows: after every flush the modelled panel RAM must equal
+// the frame, and typical UI changes must go out as small windows
+#include "displayFlush.h"
+#include "hostTest.h"
+#include <cstdlib>
+#include <cstring>
+
+// SSD1306 GDDRAM in horizontal addressing mode
+struct Panel : Ssd1306Bus
+{
+    uint8_t ram[SSD1306_FLUSH_BYTES];
+    int col0 = 0, col1 = SSD1306_FLUSH_WIDTH - 1, page0 = 0, page1 = SSD1306_FLUSH_PAGES - 1;
+    int col = 0, page = 0;
+
+    void command(const uint8_t *c, size_t n) override
+    {
+        for (size_t i = 0; i < n;)
+        {
+            if (c[i] == 0x21 && i + 2 < n) // COLUMNADDR
+            {
+                col0 = col = c[i + 1];
+                col1 = c[i + 2];
+                i += 3;
+            }
+            else if (c[i] == 0x22 && i + 2 < n) // PAGEADDR
+            {
+                page0 = page = c[i + 1];
+                page1 = c[i + 2] & 7;
+                i += 3;
+            }
+            else
+                i++;
+        }
+    }
+    void data(const uint8_t *b, size_t n) override
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            ram[page * SSD1306_FLUSH_WIDTH + col] = b[i];
+            if (col == col1)
+            {
+                col = col0;
+                page = page == page1 ? page0 : page + 1;
+            }
+            else
+                col++;
+        }
+    }
+};
+
+static void fillRect(uint8_t *frame, int x, int y, int w, int h, bool on)
+{
+    for (int j = y; j < y + h && j < 64; j++)
+        for (int i = x; i < x + w && i < SSD1306_FLUSH_WIDTH; i++)
+        {
+            uint8_t bit = 1 << (j & 7);
+            uint8_t &b = frame[(j >> 3) * SSD1306_FLUSH_WIDTH + i];
+            b = on ? b | bit : b & ~bit;
+        }
+}
+
+static void randomFrames()
+{
+    Panel panel;
+    memset(panel.ram, 0x55, sizeof(panel.ram)); // power-up garbage
+    DisplayFlush df;
+    uint8_t frame[SSD1306_FLUSH_BYTES] = {};
+    long mismatches = 0;
+
+    srand(1);
+    for (int it = 0; it < 20000; it++)
+    {
+        int ops = rand() % 4;
+        for (int k = 0; k < ops; k++)
+            fillRect(frame, rand() % 128, rand() % 64, 1 + rand() % 40, 1 + rand() % 20, rand() & 1);
+        if (rand() % 500 == 0)
+            df.invalidate();
+        if (rand() % 300 == 0)
+            for (int i = 0; i < SSD1306_FLUSH_BYTES; i++)
+                frame[i] = rand();
+        df.flush(frame, panel);
+        if (memcmp(panel.ram, frame, sizeof(frame)))
+            mismatches++;
+    }
+    CHECK_EQ(mismatches, 0);
+    // Never more than a full frame plus one window's commands
+    CHECK_EQ(df.stats().maxBytes, SSD1306_FLUSH_BYTES + 6);
+}
+
+static void typicalUpdates()
+{
+    Panel panel;
+    DisplayFlush df;
+    uint8_t frame[SSD1306_FLUSH_BYTES] = {};
+
+    // First flush after invalidate() sends everything
+    CHECK_EQ(df.flush(frame, panel), SSD1306_FLUSH_BYTES + 6);
+
+    // No change, nothing on the bus
+    CHECK_EQ(df.flush(frame, panel), 0);
+    CHECK_EQ(df.stats().skipped, 1);
+
+    // Frequency digits: 60x14 pixels over three pages
+    fillRect(frame, 12, 22, 60, 14, true);
+    df.flush(frame, panel);
+    CHECK_EQ(df.stats().lastWindows, 1);
+    CHECK_EQ(df.stats().lastBytes, 186);
+
+    // RSSI bar: 12x8 pixels across a page boundary
+    fillRect(frame, 34, 50, 12, 8, true);
+    df.flush(frame, panel);
+    CHECK_EQ(df.stats().lastWindows, 1);
+    CHECK_EQ(df.stats().lastBytes, 30);
+
+    // Two changes far apart stay separate windows
+    fillRect(frame, 0, 0, 4, 8, true);
+    fillRect(frame, 120, 56, 4, 8, true);
+    df.flush(frame, panel);
+    CHECK_EQ(df.stats().lastWindows, 2);
+    CHECK(df.stats().lastBytes < 40);
+    CHECK(memcmp(panel.ram, frame, sizeof(frame)) == 0);
+}
+
+int main()
+{
+    randomFrames();
+    typicalUpdates();
+    return hostTestResult("displayFlush");
+}
@@ -0,0 +1,251 @@
+// Host FreeRTOS and esp_timer shims: queues, notifications and mutexes
+// across real threads, timeouts and delays on the board clock, and the
+// event bus of SystemEvents.cpp between two tasks.
+#include <Arduino.h>
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "hostBoard.h"
+#include "SystemEvents.h"
+#include "hostTest.h"
+
+static void producer(void *param)
+{
+    QueueHandle_t q = (QueueHandle_t)param;
+    for (int i = 0; i < 100; i++)
+        xQueueSend(q, &i, portMAX_DELAY);
+    vTaskDelete(nullptr);
+}
+
+static void queueOrder()
+{
+    // Room for 4: the producer blocks on a full queue until we catch up
+    QueueHandle_t q = xQueueCreate(4, sizeof(int));
+    xTaskCreatePinnedToCore(producer, "producer", 2048, q, 2, nullptr, 0);
+    for (int i = 0; i < 100; i++)
+    {
+        int v = -1;
+        CHECK(xQueueReceive(q, &v, portMAX_DELAY) == pdTRUE);
+        CHECK_EQ(v, i);
+    }
+    CHECK_EQ(uxQueueMessagesWaiting(q), 0);
+
+    int v = 7;
+    CHECK(xQueueSend(q, &v, 0) == pdPASS);
+    v = 8;
+    CHECK(xQueueSendToFront(q, &v, 0) == pdPASS);
+    CHECK(xQueuePeek(q, &v, 0) == pdTRUE);
+    CHECK_EQ(v, 8);
+    CHECK_EQ(uxQueueSpacesAvailable(q), 2);
+    vQueueDelete(q);
+}
+
+static void timeouts()
+{
+    // Nobody sends: the wait costs the timeout on the board clock
+    QueueHandle_t q = xQueueCreate(1, sizeof(int));
+    int v;
+    uint64_t start = hostClockUs();
+    CHECK(xQueueReceive(q, &v, pdMS_TO_TICKS(20)) == pdFALSE);
+    CHECK_EQ(hostClockUs() - start, 20000);
+
+    v = 1;
+    CHECK(xQueueSend(q, &v, 0) == pdPASS);
+    start = hostClockUs();
+    CHECK(xQueueSend(q, &v, 0) == errQUEUE_FULL);
+    CHECK_EQ(hostClockUs(), start); // no timeout, no wait
+    vQueueDelete(q);
+
+    TickType_t wake = xTaskGetTickCount();
+    for (int i = 0; i < 5; i++)
+    {
+        delay(3); // work that takes less than the period
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(10));
+        CHECK_EQ(xTaskGetTickCount(), wake);
+    }
+}
+
+struct NotifyArgs
+{
+    TaskHandle_t waiter;
+    QueueHandle_t reply;
+};
+
+static void notifyWaiter(void *param)
+{
+    NotifyArgs *a = (NotifyArgs *)param;
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, 0xFFFFFFFF, &bits, portMAX_DELAY);
+    xQueueSend(a->reply, &bits, portMAX_DELAY);
+    uint32_t taken = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    xQueueSend(a->reply, &taken, portMAX_DELAY);
+    vTaskDelete(nullptr);
+    bits = 0xDEAD; // never reached
+    xQueueSend(a->reply, &bits, 0);
+}
+
+static void notifications()
+{
+    NotifyArgs a;
+    a.reply = xQueueCreate(4, sizeof(uint32_t));
+    xTaskCreatePinnedToCore(notifyWaiter, "waiter", 2048, &a, 3, &a.waiter, 1);
+    CHECK(strcmp(pcTaskGetName(a.waiter), "waiter") == 0);
+    CHECK_EQ(uxTaskPriorityGet(a.waiter), 3);
+
+    // Bits set before the waiter gets there are not lost
+    xTaskNotify(a.waiter, 0x5, eSetBits);
+    xTaskNotify(a.waiter, 0x8, eSetBits);
+    uint32_t v = 0;
+    CHECK(xQueueReceive(a.reply, &v, portMAX_DELAY) == pdTRUE);
+    CHECK(v == 0x5 || v == 0xD); // the second may land after the first wake
+
+    xTaskNotifyGive(a.waiter);
+    CHECK(xQueueReceive(a.reply, &v, portMAX_DELAY) == pdTRUE);
+    CHECK(v >= 1);
+    CHECK(xQueueReceive(a.reply, &v, pdMS_TO_TICKS(50)) == pdFALSE);
+    vQueueDelete(a.reply);
+}
+
+struct MutexArgs
+{
+    SemaphoreHandle_t mutex;
+    SemaphoreHandle_t done;
+    volatile int counter;
+};
+
+static void incrementer(void *param)
+{
+    MutexArgs *a = (MutexArgs *)param;
+    for (int i = 0; i < 5000; i++)
+    {
+        xSemaphoreTake(a->mutex, portMAX_DELAY);
+        a->counter = a->counter + 1;
+        xSemaphoreGive(a->mutex);
+    }
+    xSemaphoreGive(a->done);
+    vTaskDelete(nullptr);
+}
+
+static void semaphores()
+{
+    MutexArgs a;
+    a.mutex = xSemaphoreCreateMutex();
+    a.done = xSemaphoreCreateCounting(2, 0);
+    a.counter = 0;
+    xTaskCreatePinnedToCore(incrementer, "inc0", 2048, &a, 1, nullptr, 0);
+    xTaskCreatePinnedToCore(incrementer, "inc1", 2048, &a, 1, nullptr, 1);
+    CHECK(xSemaphoreTake(a.done, portMAX_DELAY) == pdTRUE);
+    CHECK(xSemaphoreTake(a.done, portMAX_DELAY) == pdTRUE);
+    CHECK_EQ(a.counter, 10000);
+
+    // A mutex starts given and holds one
+    CHECK_EQ(uxSemaphoreGetCount(a.mutex), 1);
+    CHECK(xSemaphoreGive(a.mutex) == pdFALSE);
+    SemaphoreHandle_t bin = xSemaphoreCreateBinary();
+    CHECK(xSemaphoreTake(bin, 0) == pdFALSE);
+    CHECK(xSemaphoreGiveFromISR(bin, nullptr) == pdTRUE);
+    CHECK(xSemaphoreTake(bin, 0) == pdTRUE);
+    vSemaphoreDelete(bin);
+    vSemaphoreDelete(a.mutex);
+    vSemaphoreDelete(a.done);
+}
+
+static uint64_t timerFires[16];
+static int timerCount = 0;
+
+static void onTimer(void *arg)
+{
+    if (timerCount < 16)
+        timerFires[timerCount] = esp_timer_get_time();
+    timerCount++;
+    if (timerCount == 10)
+        esp_timer_stop(*(esp_timer_handle_t *)arg);
+}
+
+static void timers()
+{
+    esp_timer_handle_t t;
+    esp_timer_create_args_t args = {};
+    args.callback = onTimer;
+    args.arg = &t;
+    args.name = "test";
+    CHECK(esp_timer_create(&args, &t) == ESP_OK);
+
+    uint64_t start = hostClockUs();
+    CHECK(esp_timer_start_periodic(t, 1000) == ESP_OK);
+    CHECK(esp_timer_start_once(t, 1000) == ESP_ERR_INVALID_STATE);
+    hostClockAdvance(25500);
+    CHECK_EQ(timerCount, 10); // stopped itself at the tenth
+    for (int i = 0; i < 10; i++)
+        CHECK_EQ(timerFires[i] - start, (i + 1) * 1000);
+    CHECK(!esp_timer_is_active(t));
+    CHECK(esp_timer_stop(t) == ESP_ERR_INVALID_STATE);
+
+    // A delay runs due timers at their time, in the middle of the wait
+    timerCount = 0;
+    start = hostClockUs();
+    CHECK(esp_timer_start_once(t, 2500) == ESP_OK);
+    delay(4);
+    CHECK_EQ(timerCount, 1);
+    CHECK_EQ(timerFires[0] - start, 2500);
+    CHECK_EQ(hostClockUs() - start, 4000);
+    CHECK(esp_timer_delete(t) == ESP_OK);
+}
+
+struct BusArgs
+{
+    QueueHandle_t ready;
+    QueueHandle_t reply;
+};
+
+static void busListener(void *param)
+{
+    BusArgs *a = (BusArgs *)param;
+    EventSubscriber sub = eventBusSubscribe("test", SYS_EVENT_MASK(SysEvent::Key));
+    xQueueSend(a->ready, &sub, portMAX_DELAY);
+    for (int got = 0; got < 2;)
+    {
+        eventBusWait(portMAX_DELAY);
+        SysEventRecord rec;
+        while (eventBusPoll(sub, rec))
+        {
+            xQueueSend(a->reply, &rec, portMAX_DELAY);
+            got++;
+        }
+    }
+    vTaskDelete(nullptr);
+}
+
+static void eventBus()
+{
+    BusArgs a;
+    a.ready = xQueueCreate(1, sizeof(EventSubscriber));
+    a.reply = xQueueCreate(4, sizeof(SysEventRecord));
+    xTaskCreatePinnedToCore(busListener, "bus", 2048, &a, 1, nullptr, 1);
+    EventSubscriber sub = -1;
+    xQueueReceive(a.ready, &sub, portMAX_DELAY);
+    CHECK(sub >= 0);
+
+    eventBusPublish(SysEvent::Opto, 3); // not subscribed
+    eventBusPublish(SysEvent::Key, 1, 2);
+    eventBusPublish(SysEvent::Key, 4, 1, 99);
+    SysEventRecord rec;
+    CHECK(xQueueReceive(a.reply, &rec, portMAX_DELAY) == pdTRUE);
+    CHECK(rec.type == SysEvent::Key);
+    CHECK_EQ(rec.arg8, 1);
+    CHECK_EQ(rec.arg16, 2);
+    CHECK(xQueueReceive(a.reply, &rec, portMAX_DELAY) == pdTRUE);
+    CHECK_EQ(rec.arg8, 4);
+    CHECK_EQ(rec.value, 99);
+    CHECK(xQueueReceive(a.reply, &rec, pdMS_TO_TICKS(20)) == pdFALSE);
+}
+
+int main()
+{
+    queueOrder();
+    timeouts();
+    notifications();
+    semaphores();
+    timers();
+    eventBus();
+    return hostTestResult("freertos");
+}
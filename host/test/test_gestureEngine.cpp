@@ -0,0 +1,88 @@
+// Gesture table: input traces sampled every 10 ms and the events the
+// engine must produce for them, as "<type><input>@<ms>" in order
+#include "gestureEngine.h"
+#include "hostTest.h"
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+static const GestureProfile profiles[GESTURE_PROFILES] = {
+    {1000, 0, 0, 0, 0, 0, 0},    // 0: long press after 1 s
+    {0, 0, 500, 200, 50, 25, 0}, // 1: auto-repeat
+    {3000, 300, 0, 0, 0, 0, 0},  // 2: long press and double press
+    {0, 0, 0, 0, 0, 0, 0},       // 3: press/release only
+};
+
+static std::string log_;
+
+static void sink(uint8_t input, KeyEventType type, uint32_t timeUs)
+{
+    static const char *names[] = {"-", "P", "R", "L", "D", "Rp", "C"};
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%s%u@%u ", names[type], input, timeUs / 1000);
+    log_ += buf;
+}
+
+// Inputs 0..3 use profiles 0..3; inputs 0 and 3 together are chord 7
+static std::string run(const std::vector<std::pair<int, uint32_t>> &trace, int endMs, bool *idle = nullptr)
+{
+    GestureEngine g;
+    g.init(profiles);
+    for (uint8_t i = 0; i < 4; i++)
+        g.setInputProfile(i, i);
+    g.addChord(0x9, 0, 7);
+    log_.clear();
+
+    uint32_t state = 0;
+    size_t next = 0;
+    for (int ms = 0; ms <= endMs; ms += 10)
+    {
+        while (next < trace.size() && trace[next].first <= ms)
+            state = trace[next++].second;
+        g.update(state, ms * 1000u, sink);
+    }
+    if (idle)
+        *idle = !g.busy();
+    if (!log_.empty())
+        log_.pop_back();
+    return log_;
+}
+
+struct GestureCase
+{
+    const char *name;
+    std::vector<std::pair<int, uint32_t>> trace; // (ms, input state)
+    int endMs;
+    const char *events;
+};
+
+static const GestureCase cases[] = {
+    {"short press", {{100, 1}, {200, 0}}, 2000, "P0@100 R0@200"},
+    {"long press", {{100, 1}, {1500, 0}}, 2000, "P0@100 L0@1100 R0@1500"},
+    {"auto-repeat", {{100, 2}, {1500, 0}}, 2000,
+     "P1@100 Rp1@600 Rp1@800 Rp1@950 Rp1@1070 Rp1@1160 Rp1@1230 Rp1@1280 Rp1@1330 Rp1@1380 Rp1@1430 Rp1@1480 "
+     "R1@1500"},
+    {"double press", {{100, 4}, {200, 0}, {400, 4}, {500, 0}}, 2000, "P2@100 R2@200 D2@400 R2@500"},
+    {"presses too far apart", {{100, 4}, {200, 0}, {700, 4}, {800, 0}}, 2000, "P2@100 R2@200 P2@700 R2@800"},
+    {"long press, 3 s profile", {{100, 4}, {3500, 0}}, 4000, "P2@100 L2@3100 R2@3500"},
+    {"no gestures", {{100, 8}, {3000, 0}}, 4000, "P3@100 R3@3000"},
+    {"chord", {{100, 1}, {120, 9}, {300, 0}}, 1000, "P0@100 P3@120 C7@120 R0@300 R3@300"},
+};
+
+int main()
+{
+    for (const GestureCase &c : cases)
+    {
+        bool idle = false;
+        std::string got = run(c.trace, c.endMs, &idle);
+        if (got != c.events)
+        {
+            fprintf(stderr, "%s:\n  expected %s\n  got      %s\n", c.name, c.events, got.c_str());
+            hostTestFailures++;
+        }
+        // Every trace ends released with no deadline pending
+        CHECK(idle);
+    }
+    return hostTestResult("gestureEngine");
+}
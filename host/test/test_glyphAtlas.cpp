@@ -0,0 +1,159 @@
+// Glyph atlas against Adafruit_GFX::drawChar(): for random fonts, character
+// sets, baselines and cursor positions, clear + draw from the atlas must
+// give the same frame as clearing the cells and drawing pixel by pixel
+#include "glyphAtlas.h"
+#include "displayFlush.h"
+#include "hostTest.h"
+#include <cstdlib>
+#include <cstring>
+
+#define FONT_FIRST 0x20
+#define FONT_LAST 0x3F // space, '.', digits and the rest up to '?'
+#define FONT_GLYPHS (FONT_LAST - FONT_FIRST + 1)
+
+// A font in the shape of FreeMonoBold: glyph boxes inside their advance,
+// up to 24 rows tall with a few below the baseline
+struct RandomFont
+{
+    GFXglyph glyphs[FONT_GLYPHS];
+    uint8_t bitmap[FONT_GLYPHS * 32 * 32 / 8];
+    GFXfont font;
+
+    RandomFont()
+    {
+        uint8_t advance = 6 + rand() % 12;
+        uint16_t offset = 0;
+        for (int i = 0; i < FONT_GLYPHS; i++)
+        {
+            GFXglyph &g = glyphs[i];
+            g.xAdvance = advance;
+            g.width = i == 0 ? 0 : 1 + rand() % advance;
+            g.height = i == 0 ? 0 : 1 + rand() % 24;
+            g.xOffset = rand() % (advance - g.width + 1);
+            g.yOffset = rand() % 5 - g.height; // descent of 0..4 rows
+            g.bitmapOffset = offset;
+            size_t bytes = ((size_t)g.width * g.height + 7) / 8;
+            for (size_t b = 0; b < bytes; b++)
+                bitmap[offset + b] = rand();
+            offset += bytes;
+        }
+        font = {bitmap, glyphs, FONT_FIRST, FONT_LAST, 30};
+    }
+};
+
+static void setPixel(uint8_t *frame, int x, int y)
+{
+    if (x < 0 || x >= SSD1306_FLUSH_WIDTH || y < 0 || y >= SSD1306_FLUSH_PAGES * 8)
+        return;
+    frame[(y >> 3) * SSD1306_FLUSH_WIDTH + x] |= 1 << (y & 7);
+}
+
+// Adafruit_GFX::drawChar() for a custom font at size 1: set bits only
+static int drawCharRef(uint8_t *frame, const GFXfont &font, int x, int y, char c)
+{
+    const GFXglyph &g = font.glyph[(uint8_t)c - font.first];
+    const uint8_t *bits = font.bitmap + g.bitmapOffset;
+    uint8_t byte = 0;
+    unsigned bit = 0;
+    for (int yy = 0; yy < g.height; yy++)
+        for (int xx = 0; xx < g.width; xx++)
+        {
+            if (!(bit++ & 7))
+                byte = *bits++;
+            if (byte & 0x80)
+                setPixel(frame, x + g.xOffset + xx, y + g.yOffset + yy);
+            byte <<= 1;
+        }
+    return x + g.xAdvance;
+}
+
+static void randomCases()
+{
+    static const char pool[] = " .0123456789:-/";
+    long mismatches = 0, cursorMismatches = 0, built = 0;
+
+    srand(7);
+    for (int it = 0; it < 2000; it++)
+    {
+        RandomFont f;
+
+        // A character set of 1..12 distinct characters from the pool
+        char chars[16] = {};
+        int n = 0;
+        for (int k = 1 + rand() % 12; k > 0; k--)
+        {
+            char c = pool[rand() % (sizeof(pool) - 1)];
+            if (!strchr(chars, c))
+                chars[n++] = c;
+        }
+        int baseline = 8 + rand() % 60;
+
+        GlyphAtlas atlas;
+        if (!atlas.build(&f.font, chars, baseline))
+            continue; // every glyph empty (only spaces) or off screen
+        built++;
+
+        char text[12] = {};
+        int len = 1 + rand() % 10;
+        for (int i = 0; i < len; i++)
+            text[i] = chars[rand() % n];
+        CHECK(atlas.covers(text));
+        int x = -20 + rand() % 150;
+
+        uint8_t background[SSD1306_FLUSH_BYTES];
+        for (int i = 0; i < SSD1306_FLUSH_BYTES; i++)
+            background[i] = rand();
+
+        // Atlas: clear then copy the sprites
+        uint8_t got[SSD1306_FLUSH_BYTES];
+        memcpy(got, background, sizeof(got));
+        int16_t end = atlas.draw(got, x, text);
+
+        // GFX: the cells are cleared on the atlas pages, then the pixels set
+        uint8_t want[SSD1306_FLUSH_BYTES];
+        memcpy(want, background, sizeof(want));
+        int cursor = x;
+        for (int i = 0; i < len; i++)
+            cursor += f.glyphs[(uint8_t)text[i] - FONT_FIRST].xAdvance;
+        atlas.clear(want, x, cursor - 1);
+        cursor = x;
+        for (int i = 0; i < len; i++)
+            cursor = drawCharRef(want, f.font, cursor, baseline, text[i]);
+
+        if (memcmp(got, want, sizeof(got)))
+            mismatches++;
+        if (end != cursor)
+            cursorMismatches++;
+    }
+    CHECK_EQ(mismatches, 0);
+    CHECK_EQ(cursorMismatches, 0);
+    CHECK(built > 1500);
+}
+
+static void limits()
+{
+    srand(3);
+    RandomFont f;
+    GlyphAtlas atlas;
+    CHECK(!atlas.ready());
+
+    // A character outside the font, and a set larger than the atlas
+    CHECK(!atlas.build(&f.font, "0A", 40));
+    CHECK(!atlas.build(&f.font, "0123456789:;<=>?/", 40));
+
+    CHECK(atlas.build(&f.font, "0123456789", 40));
+    CHECK(atlas.covers("0815"));
+    CHECK(!atlas.covers("08.15"));
+
+    // Characters not in the atlas are skipped without moving the cursor
+    uint8_t a[SSD1306_FLUSH_BYTES] = {}, b[SSD1306_FLUSH_BYTES] = {};
+    CHECK_EQ(atlas.draw(a, 10, "1.2"), atlas.draw(b, 10, "12"));
+    CHECK(!memcmp(a, b, sizeof(a)));
+}
+
+int main()
+{
+    randomCases();
+    limits();
+    return hostTestResult("glyphAtlas");
+}
@@ -0,0 +1,139 @@
+// keypadDriver.cpp on the simulated board: pin edges run its interrupt
+// handler, the debounce and hold timers run on the board clock. Checks
+// that contact bounce gives one event stamped with the first edge, that a
+// glitch gives none, and the long press and exit chord.
+#include "keypadDriver.h"
+#include "inputEvents.h"
+#include "setupDriver.h"
+#include "pins_new.h"
+#include "hostBoard.h"
+#include "hostTest.h"
+#include <vector>
+
+static std::vector<InputEvent> takeEvents()
+{
+    std::vector<InputEvent> out;
+    InputEvent evt;
+    while (inputEventPop(evt))
+        out.push_back(evt);
+    return out;
+}
+
+static int countEvents(const std::vector<InputEvent> &evts, uint8_t keys, KeyEventType type)
+{
+    int n = 0;
+    for (const InputEvent &e : evts)
+    {
+        if (e.input == keys && e.type == type)
+            n++;
+    }
+    return n;
+}
+
+// Closing contact: a few bounces, then held; the last edge is at return
+static uint32_t bouncyPress(uint8_t pin)
+{
+    uint32_t first = micros();
+    const uint16_t bounceUs[] = {300, 800, 150, 1200};
+    bool level = LOW;
+    for (uint16_t us : bounceUs)
+    {
+        hostPinDrive(pin, level);
+        delayMicroseconds(us);
+        level = !level;
+    }
+    hostPinDrive(pin, LOW);
+    return first;
+}
+
+static void debounce()
+{
+    uint32_t first = bouncyPress(KEY_NEXT_PIN);
+    uint32_t lastEdge = micros();
+
+    // Quiet for less than KEY_DEBOUNCE_US: nothing yet
+    delayMicroseconds(KEY_DEBOUNCE_US - 100);
+    CHECK(takeEvents().empty());
+    delayMicroseconds(200);
+    std::vector<InputEvent> evts = takeEvents();
+    CHECK_EQ(evts.size(), 1);
+    CHECK_EQ(countEvents(evts, NEXT, KEY_EVENT_PRESS), 1);
+    if (!evts.empty())
+    {
+        CHECK_EQ(evts[0].source, INPUT_SRC_KEYPAD);
+        CHECK_EQ(evts[0].timeUs, first);
+    }
+    KeypadStats st = keypadGetStats();
+    CHECK_EQ(st.lastUs, lastEdge + KEY_DEBOUNCE_US - first);
+    CHECK_EQ(keypadLastEdgeUs(), first);
+
+    hostPinDrive(KEY_NEXT_PIN, HIGH);
+    delay(10);
+    evts = takeEvents();
+    CHECK_EQ(countEvents(evts, NEXT, KEY_EVENT_RELEASE), 1);
+
+    // A 1 ms glitch settles back where it was: no event
+    hostPinDrive(KEY_UP_PIN, LOW);
+    delay(1);
+    hostPinDrive(KEY_UP_PIN, HIGH);
+    delay(20);
+    CHECK(takeEvents().empty());
+}
+
+static void longPress()
+{
+    // GESTURE_PROFILE_KEY: long press after 2 s, reported by the hold timer
+    bouncyPress(KEY_PREVIOUS_PIN);
+    uint32_t pressUs = micros();
+    delay(1990);
+    std::vector<InputEvent> evts = takeEvents();
+    CHECK_EQ(countEvents(evts, PREVIOUS, KEY_EVENT_PRESS), 1);
+    CHECK_EQ(countEvents(evts, PREVIOUS, KEY_EVENT_LONGPRESS), 0);
+    delay(30);
+    evts = takeEvents();
+    CHECK_EQ(countEvents(evts, PREVIOUS, KEY_EVENT_LONGPRESS), 1);
+    CHECK(micros() - pressUs <= 2000000 + KEY_HOLD_TICK_US + 100000);
+
+    hostPinDrive(KEY_PREVIOUS_PIN, HIGH);
+    delay(10);
+    evts = takeEvents();
+    CHECK_EQ(countEvents(evts, PREVIOUS, KEY_EVENT_RELEASE), 1);
+
+    // Nothing held: the hold timer is off and the queue stays quiet
+    uint32_t pushed = inputEventGetStats().pushed;
+    delay(3000);
+    CHECK_EQ(inputEventGetStats().pushed, pushed);
+}
+
+static void chord()
+{
+    // Both within one debounce window: one sample with both keys down
+    hostPinDrive(KEY_PREVIOUS_PIN, LOW);
+    delayMicroseconds(700);
+    hostPinDrive(KEY_NEXT_PIN, LOW);
+    delay(10);
+    std::vector<InputEvent> evts = takeEvents();
+    CHECK_EQ(countEvents(evts, KEY_CHORD_EXIT, KEY_EVENT_CHORD), 1);
+    CHECK_EQ(keypadActiveChord(), KEY_CHORD_EXIT);
+
+    hostPinDrive(KEY_PREVIOUS_PIN, HIGH);
+    hostPinDrive(KEY_NEXT_PIN, HIGH);
+    delay(10);
+    takeEvents();
+    CHECK_EQ(keypadActiveChord(), GESTURE_NO_CHORD);
+}
+
+int main()
+{
+    hostSerialEcho(false);
+    InitSetup();
+    keypadInit();
+    CHECK_EQ(hostPinMode(KEY_DOWN_PIN), INPUT_PULLUP);
+    CHECK(hostPinLevel(KEY_DOWN_PIN)); // pulled up, nothing pressed
+    delay(10);
+
+    debounce();
+    longPress();
+    chord();
+    return hostTestResult("keypadDriver");
+}
@@ -0,0 +1,96 @@
+// Marquee window against a reference: the text repeated with its gap on an
+// endless tape, read at the sum of all steps. Random texts, windows and
+// step sizes; the rest of the frame must stay untouched.
+#include "marquee.h"
+#include "displayFlush.h"
+#include "hostTest.h"
+#include <cstdlib>
+#include <cstring>
+
+static void randomWindows()
+{
+    long mismatches = 0, outside = 0, stepMismatches = 0;
+    static uint8_t text[MARQUEE_MAX_COLS];
+
+    srand(5);
+    for (int it = 0; it < 300; it++)
+    {
+        // Mostly text wider than the window, some that fits, some too long
+        uint16_t cols = rand() % 4 == 0 ? rand() % 100 : rand() % (MARQUEE_MAX_COLS + 64);
+        uint8_t page = rand() % 10;
+        uint8_t c0 = rand() % 128, c1 = c0 + rand() % (140 - c0);
+
+        Marquee m;
+        m.begin(cols, page, c0, c1);
+
+        // Expected clamping of begin()
+        uint16_t textCols = cols > MARQUEE_MAX_COLS - MARQUEE_GAP_COLS ? MARQUEE_MAX_COLS - MARQUEE_GAP_COLS : cols;
+        uint8_t pg = page < SSD1306_FLUSH_PAGES ? page : SSD1306_FLUSH_PAGES - 1;
+        uint8_t x1 = c1 < SSD1306_FLUSH_WIDTH ? c1 : SSD1306_FLUSH_WIDTH - 1;
+        uint16_t w = x1 - c0 + 1;
+        uint16_t period = textCols + MARQUEE_GAP_COLS;
+        bool scrolls = textCols > w;
+
+        memset(text, 0, sizeof(text));
+        for (int k = rand() % 2000; k > 0; k--)
+        {
+            int x = rand() % (MARQUEE_MAX_COLS + 20) - 10, y = rand() % 12 - 2;
+            m.setPixel(x, y);
+            if (x >= 0 && x < textCols && y >= 0 && y < 8)
+                text[x] |= 1 << y;
+        }
+        CHECK_EQ(m.empty(), textCols == 0);
+        CHECK_EQ(m.scrolling(), scrolls);
+
+        uint8_t background[SSD1306_FLUSH_BYTES];
+        for (int i = 0; i < SSD1306_FLUSH_BYTES; i++)
+            background[i] = rand();
+
+        uint32_t travelled = 0;
+        for (int s = 0; s < 700; s++)
+        {
+            uint8_t frame[SSD1306_FLUSH_BYTES];
+            memcpy(frame, background, sizeof(frame));
+            m.blit(frame);
+
+            uint8_t *row = frame + pg * SSD1306_FLUSH_WIDTH;
+            for (uint16_t i = 0; i < w; i++)
+            {
+                uint32_t k = travelled + i;
+                uint8_t want = scrolls ? (k % period < textCols ? text[k % period] : 0) : (i < textCols ? text[i] : 0);
+                if (row[c0 + i] != want)
+                {
+                    mismatches++;
+                    break;
+                }
+            }
+            memcpy(row + c0, background + pg * SSD1306_FLUSH_WIDTH + c0, w);
+            if (memcmp(frame, background, sizeof(frame)))
+                outside++;
+
+            if (s == 350)
+            {
+                memcpy(frame, background, sizeof(frame));
+                m.clear(frame);
+                for (uint16_t i = 0; i < w; i++)
+                    CHECK_EQ(row[c0 + i], 0);
+            }
+
+            uint8_t cols = 1 + rand() % 3;
+            if (m.step(cols) != scrolls)
+                stepMismatches++;
+            if (scrolls)
+                travelled += cols;
+            CHECK_EQ(m.offset(), scrolls ? travelled % period : 0);
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+    CHECK_EQ(outside, 0);
+    CHECK_EQ(stepMismatches, 0);
+}
+
+int main()
+{
+    randomWindows();
+    return hostTestResult("marquee");
+}
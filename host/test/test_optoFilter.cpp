@@ -0,0 +1,62 @@
+// Detection latency of the two opto filters, on the OptoFilterBench
+// waveforms. The bounds are the bench figures plus a few scans of margin,
+// so a change to either filter that moves them shows up here.
+#include "OptoFilterBench.h"
+#include "optoInLogic.h"
+#include "hostTest.h"
+
+// Clean steps: both filters switch on the threshold-th ON sample; the
+// integrator starts its release one count lower (cap WINDOW - 1)
+static void cleanSteps()
+{
+    OptoFilterBenchConfig cfg;
+    cfg.presses = 50;
+    cfg.bounceScans = 0;
+    cfg.noiseProb = 0;
+    OptoFilterResult w, v;
+    runOptoFilterBench(cfg, w, v);
+
+    CHECK_EQ(w.maxPressScans, cfg.threshold - 1);
+    CHECK_EQ(v.maxPressScans, cfg.threshold - 1);
+    CHECK_EQ(w.maxReleaseScans, WINDOW - cfg.threshold);
+    CHECK_EQ(v.maxReleaseScans, WINDOW - cfg.threshold - 1);
+    CHECK(w.meanPressScans == v.meanPressScans);
+    CHECK_EQ(w.missed + v.missed, 0);
+}
+
+// Default bench: 5% sample noise, 3 scans of chatter after each edge
+static void noisyInputs()
+{
+    OptoFilterBenchConfig cfg;
+    OptoFilterResult w, v;
+    runOptoFilterBench(cfg, w, v);
+
+    // Measured: press 26.7/35, release 103.4/115
+    CHECK(w.meanPressScans < 29);
+    CHECK(w.maxPressScans <= 40);
+    CHECK(w.meanReleaseScans < 106);
+    CHECK(w.maxReleaseScans <= 120);
+
+    // Measured: press 34.2/49, release 109.9/134. The integrator loses a
+    // count for every OFF sample, so it is slower under noise both ways.
+    CHECK(v.meanPressScans < 37);
+    CHECK(v.maxPressScans <= 55);
+    CHECK(v.meanReleaseScans < 113);
+    CHECK(v.maxReleaseScans <= 140);
+
+    // Not a drop-in, but within 10 scans (100 ms at the scan rate) of it
+    CHECK(v.meanPressScans - w.meanPressScans < 10);
+    CHECK(v.meanReleaseScans - w.meanReleaseScans < 10);
+
+    CHECK_EQ(w.missed, 0);
+    CHECK_EQ(v.missed, 0);
+    CHECK_EQ(w.falseToggles, 0);
+    CHECK_EQ(v.falseToggles, 0);
+}
+
+int main()
+{
+    cleanSteps();
+    noisyInputs();
+    return hostTestResult("optoFilter");
+}
@@ -0,0 +1,171 @@
+// optoInDriver.cpp on the simulated board: a 2x7 opto matrix answering
+// the row selects, scanned the way OptoKeypadInTask does it. Checks the
+// row and bit mapping, the on/off contacts without events, and that an
+// alarm input beats the decimated path.
+#include "optoInDriver.h"
+#include "inputEvents.h"
+#include "setupDriver.h"
+#include "pins.h"
+#include "hostBoard.h"
+#include "SystemEvents.h"
+#include "hostTest.h"
+
+static const uint8_t optoPins[7] = {optoIn1, optoIn2, optoIn3, optoIn4, optoIn5, optoIn6, optoIn7};
+static uint16_t lit = 0; // inputs whose opto conducts
+
+// The selected row (select line low) pulls its lit inputs low
+static void driveMatrix()
+{
+    int row = !hostPinLevel(selOptoRow1) ? 0 : !hostPinLevel(selOptoRow2) ? 1 : -1;
+    for (int i = 0; i < 7; i++)
+        hostPinDrive(optoPins[i], row < 0 || !((lit >> (row * 7 + i)) & 1));
+}
+
+static void onRowSelect(uint8_t pin, bool level, void *ctx)
+{
+    if (pin == selOptoRow1 || pin == selOptoRow2)
+        driveMatrix();
+}
+
+static void setLit(uint16_t mask)
+{
+    lit = mask;
+    driveMatrix();
+}
+
+static TickType_t wake;
+
+// One 10 ms cycle of OptoKeypadInTask
+static void scanCycle()
+{
+    scanOptos();
+    updateOptoEvents();
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(10));
+}
+
+static void drainEvents()
+{
+    InputEvent evt;
+    while (inputEventPop(evt))
+    {
+    }
+    for (int i = 0; i < NUM_INPUTS; i++)
+        getOptoEvent(i);
+}
+
+// Scan until 'input' raises 'type'; returns its event, type NONE on timeout
+static InputEvent waitEvent(uint8_t input, KeyEventType type, int maxCycles)
+{
+    InputEvent evt = {};
+    for (int c = 0; c < maxCycles; c++)
+    {
+        scanCycle();
+        while (inputEventPop(evt))
+        {
+            if (evt.input == input && evt.type == type)
+                return evt;
+        }
+    }
+    evt.type = KEY_EVENT_NONE;
+    return evt;
+}
+
+static void rowMapping()
+{
+    // One input per row, each must land on its own bit only
+    const uint8_t inputs[] = {2, 6, 7, 13};
+    for (uint8_t in : inputs)
+    {
+        setLit(1 << in);
+        for (int c = 0; c < 60; c++)
+            scanCycle();
+        CHECK_EQ(getOptoInFiltered(), 1 << in);
+        setLit(0);
+        for (int c = 0; c < 130; c++)
+            scanCycle();
+        CHECK_EQ(getOptoInFiltered(), 0);
+    }
+    drainEvents();
+}
+
+static void pressRelease()
+{
+    EventSubscriber sub = eventBusSubscribe("test", SYS_EVENT_MASK(SysEvent::Opto));
+    uint32_t pressUs = micros();
+    setLit(1 << 4);
+    InputEvent evt = waitEvent(4, KEY_EVENT_PRESS, 100);
+    CHECK(evt.type == KEY_EVENT_PRESS);
+    CHECK_EQ(evt.source, INPUT_SRC_OPTO);
+    CHECK_EQ(evt.alarm, 0);
+    CHECK(evt.timeUs - pressUs < 400000); // threshold 30 scans of 10 ms
+    CHECK(getOptoEvent(4) == KEY_EVENT_PRESS);
+    CHECK(getOptoEvent(4) == KEY_EVENT_NONE); // latch cleared
+
+    SysEventRecord rec;
+    CHECK(eventBusPoll(sub, rec));
+    CHECK(rec.type == SysEvent::Opto);
+    CHECK_EQ(rec.arg8, 4);
+    CHECK_EQ(rec.arg16, KEY_EVENT_PRESS);
+
+    setLit(0);
+    evt = waitEvent(4, KEY_EVENT_RELEASE, 200);
+    CHECK(evt.type == KEY_EVENT_RELEASE);
+    drainEvents();
+
+    // Inputs 0 and 1 are on/off contacts: filtered, but no events
+    setLit(0x0003);
+    for (int c = 0; c < 60; c++)
+        scanCycle();
+    CHECK_EQ(getOptoInFiltered(), 0x0003);
+    CHECK_EQ(getOptoEventFlag(), -1);
+    CHECK_EQ(inputEventGetStats().depth, 0);
+    setLit(0);
+    for (int c = 0; c < 130; c++)
+        scanCycle();
+    drainEvents();
+}
+
+static void alarmPath()
+{
+    // Inputs 9 and 10 light together; 9 is an alarm and skips the decimation
+    setOptoAlarmMask(1 << 9);
+    uint32_t alarmUs = 0, otherUs = 0;
+    uint8_t alarmFlag = 0;
+    setLit((1 << 9) | (1 << 10));
+    for (int c = 0; c < 100 && !(alarmUs && otherUs); c++)
+    {
+        scanCycle();
+        InputEvent evt;
+        while (inputEventPop(evt))
+        {
+            if (evt.type != KEY_EVENT_PRESS)
+                continue;
+            if (evt.input == 9 && !alarmUs)
+            {
+                alarmUs = micros();
+                alarmFlag = evt.alarm;
+            }
+            if (evt.input == 10 && !otherUs)
+                otherUs = micros();
+        }
+    }
+    CHECK(alarmUs && otherUs);
+    CHECK_EQ(alarmFlag, 1);
+    CHECK(alarmUs <= otherUs);
+    setLit(0);
+    setOptoAlarmMask(0);
+}
+
+int main()
+{
+    hostSerialEcho(false);
+    InitSetup();
+    hostPinListen(onRowSelect, nullptr);
+    scanOptosInit(30);
+    wake = xTaskGetTickCount();
+
+    rowMapping();
+    pressRelease();
+    alarmPath();
+    return hostTestResult("optoInDriver");
+}
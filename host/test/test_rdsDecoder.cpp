@@ -0,0 +1,198 @@
+// RDS decoding against synthetic captures: two stations, each sending PS
+// (group 0A), RadioText (2A) and clock time (4A), one after the other,
+// with block errors injected at the levels the Si4703 reports. Whatever
+// the decoder publishes must be right; with enough repetitions it must
+// publish everything.
+#include "rdsDecoder.h"
+#include "hostTest.h"
+#include <cstring>
+#include <vector>
+
+struct Station
+{
+    uint16_t pi;
+    uint8_t pty;
+    const char *ps;
+    const char *rt;
+};
+
+static const Station stationA = {0xC201, 10, "RADIO 1 ", "Now playing: Some Artist - Some Song"};
+static const Station stationB = {0x2F3A, 14, "JAZZ FM ", "Smooth sounds all night long"};
+
+static const uint32_t CT_MJD = 60000;
+static const uint8_t CT_HOUR = 13, CT_MINUTE = 42, CT_OFFSET = 2;
+
+static uint32_t nextRandom(uint32_t &s)
+{
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+static RdsGroup group(uint16_t pi, uint8_t type, uint8_t pty, uint16_t low, uint16_t c, uint16_t d)
+{
+    RdsGroup g = {};
+    g.block[RDS_A] = pi;
+    g.block[RDS_B] = (uint16_t)(type << 12 | 1 << 10 | pty << 5 | low); // version A, TP set
+    g.block[RDS_C] = c;
+    g.block[RDS_D] = d;
+    return g;
+}
+
+// One capture: 'reps' cycles of 4 x 0A, 16 x 2A and one 4A
+static std::vector<RdsGroup> capture(const Station &s, int reps)
+{
+    char rt[RDS_RT_LEN];
+    memset(rt, ' ', sizeof(rt));
+    size_t len = strlen(s.rt);
+    memcpy(rt, s.rt, len);
+    if (len < RDS_RT_LEN)
+        rt[len] = 0x0D; // end of text
+
+    std::vector<RdsGroup> v;
+    for (int r = 0; r < reps; r++)
+    {
+        for (int seg = 0; seg < 4; seg++)
+            v.push_back(group(s.pi, 0, s.pty, seg, 0xE0CD, s.ps[2 * seg] << 8 | (uint8_t)s.ps[2 * seg + 1]));
+        for (int seg = 0; seg < 16; seg++)
+            v.push_back(group(s.pi, 2, s.pty, seg, rt[4 * seg] << 8 | (uint8_t)rt[4 * seg + 1],
+                              rt[4 * seg + 2] << 8 | (uint8_t)rt[4 * seg + 3]));
+        v.push_back(group(s.pi, 4, s.pty, (CT_MJD >> 15) & 3, ((CT_MJD & 0x7FFF) << 1) | (CT_HOUR >> 4),
+                          (CT_HOUR & 15) << 12 | CT_MINUTE << 6 | CT_OFFSET));
+    }
+    return v;
+}
+
+// Each block is hit with probability p; level 3 garbles it, levels 1-2
+// leave a wrong bit now and then (a miscorrection)
+static void addErrors(RdsGroup &g, double p, uint32_t &seed)
+{
+    for (int b = 0; b < 4; b++)
+    {
+        if ((nextRandom(seed) & 0xFFFF) >= p * 65536)
+            continue;
+        uint8_t level = 1 + nextRandom(seed) % 3;
+        g.bler[b] = level;
+        if (level == 3 || nextRandom(seed) % 10 == 0)
+            g.block[b] ^= 1 << (nextRandom(seed) % 16);
+        if (level == 3)
+            g.block[b] ^= nextRandom(seed);
+    }
+}
+
+struct NoiseResult
+{
+    int complete;
+    int wrongPs, wrongRt, wrongCt;
+};
+
+static NoiseResult runNoise(double p, int trials)
+{
+    NoiseResult r = {};
+    std::vector<RdsGroup> all = capture(stationA, 12);
+    std::vector<RdsGroup> b = capture(stationB, 12);
+    all.insert(all.end(), b.begin(), b.end());
+
+    for (int t = 0; t < trials; t++)
+    {
+        uint32_t seed = 0x9E3779B9u + t;
+        RdsState st;
+        rdsReset(st);
+        for (RdsGroup g : all)
+        {
+            addErrors(g, p, seed);
+            uint8_t changed = rdsDecodeGroup(st, g);
+            const Station &on = st.pi == stationB.pi ? stationB : stationA;
+            if ((changed & RDS_CHANGED_PS) && strcmp(st.ps, on.ps))
+                r.wrongPs++;
+            if ((changed & RDS_CHANGED_RT) && strcmp(st.rt, on.rt))
+                r.wrongRt++;
+            if ((changed & RDS_CHANGED_CT) &&
+                (st.ct.mjd != CT_MJD || st.ct.hour != CT_HOUR || st.ct.minute != CT_MINUTE || st.ct.offset != CT_OFFSET))
+                r.wrongCt++;
+        }
+        if (st.pi == stationB.pi && st.pty == stationB.pty && st.psValid && !strcmp(st.ps, stationB.ps) &&
+            st.rtValid && !strcmp(st.rt, stationB.rt))
+            r.complete++;
+    }
+    return r;
+}
+
+static void cleanCapture()
+{
+    RdsState st;
+    rdsReset(st);
+    std::vector<RdsGroup> v = capture(stationA, 3);
+    uint8_t seen = 0;
+    for (const RdsGroup &g : v)
+        seen |= rdsDecodeGroup(st, g);
+
+    CHECK(seen & RDS_CHANGED_PI);
+    CHECK_EQ(st.pi, stationA.pi);
+    CHECK_EQ(st.pty, stationA.pty);
+    CHECK(st.tp);
+    CHECK(st.psValid && !strcmp(st.ps, stationA.ps));
+    CHECK(st.rtValid && !strcmp(st.rt, stationA.rt));
+    CHECK(st.ctValid);
+    CHECK_EQ(st.ct.mjd, CT_MJD);
+    CHECK_EQ(st.ct.hour, CT_HOUR);
+    CHECK_EQ(st.ct.minute, CT_MINUTE);
+    CHECK_EQ(st.ct.offset, CT_OFFSET);
+    CHECK_EQ(st.groups, v.size());
+    CHECK_EQ(st.rejected, 0);
+}
+
+// A single reception never publishes text, even error-free
+static void singleReception()
+{
+    RdsState st;
+    rdsReset(st);
+    std::vector<RdsGroup> v = capture(stationA, 1);
+    for (const RdsGroup &g : v)
+        rdsDecodeGroup(st, g);
+    CHECK(!st.psValid);
+    CHECK(!st.rtValid);
+}
+
+// Clock time is taken from error-free groups only
+static void clockNeedsCleanGroup()
+{
+    RdsState st;
+    rdsReset(st);
+    std::vector<RdsGroup> v = capture(stationA, 3);
+    for (RdsGroup &g : v)
+    {
+        if ((g.block[RDS_B] >> 12) == 4)
+            g.bler[RDS_D] = 1;
+        rdsDecodeGroup(st, g);
+    }
+    CHECK(!st.ctValid);
+}
+
+int main()
+{
+    cleanCapture();
+    singleReception();
+    clockNeedsCleanGroup();
+
+    // Up to 20% block errors nothing wrong is published and every trial
+    // ends with the second station complete
+    const double levels[] = {0.0, 0.1, 0.2};
+    for (double p : levels)
+    {
+        NoiseResult r = runNoise(p, 300);
+        CHECK_EQ(r.wrongPs, 0);
+        CHECK_EQ(r.wrongRt, 0);
+        CHECK_EQ(r.wrongCt, 0);
+        CHECK_EQ(r.complete, 300);
+    }
+
+    // At 30% a miscorrected segment address can now and then win a
+    // position on its own; keep that rare
+    NoiseResult r = runNoise(0.3, 300);
+    CHECK(r.wrongPs + r.wrongRt <= 1);
+    CHECK_EQ(r.wrongCt, 0);
+    CHECK(r.complete >= 290);
+    return hostTestResult("rdsDecoder");
+}
@@ -0,0 +1,176 @@
+// Power-loss replay for the settings journal: a run of commits is cut
+// after every possible flash byte (programmed or erased), the journal is
+// reloaded from what reached the flash, and the image must be the one from
+// before or after the interrupted commit, never a mix.
+#include "settingsJournal.h"
+#include "hostTest.h"
+#include <cstring>
+#include <vector>
+
+struct PowerLoss
+{
+};
+
+// NOR flash in RAM that loses power after 'budget' byte operations
+class RamFlash : public FlashIo
+{
+public:
+    static const int SECTOR = 512;
+    static const int SECTORS = 3;
+
+    std::vector<uint8_t> mem;
+    long budget = -1; // < 0: never
+
+    RamFlash() : mem(SECTOR * SECTORS, 0xFF) {}
+    size_t sectorSize() const override { return SECTOR; }
+    uint8_t sectorCount() const override { return SECTORS; }
+    bool read(uint32_t addr, void *buf, size_t len) override
+    {
+        memcpy(buf, &mem[addr], len);
+        return true;
+    }
+    bool write(uint32_t addr, const void *buf, size_t len) override
+    {
+        const uint8_t *p = (const uint8_t *)buf;
+        for (size_t i = 0; i < len; i++)
+        {
+            spend();
+            mem[addr + i] &= p[i];
+        }
+        return true;
+    }
+    bool erase(uint8_t sector) override
+    {
+        for (int i = 0; i < SECTOR; i++)
+        {
+            spend();
+            mem[sector * SECTOR + i] = 0xFF;
+        }
+        return true;
+    }
+
+private:
+    void spend()
+    {
+        if (budget == 0)
+            throw PowerLoss();
+        if (budget > 0)
+            budget--;
+    }
+};
+
+static const int IMAGE = 100;
+static const int STEPS = 120;
+
+typedef std::vector<uint8_t> Image;
+
+// Image after each step: step s stores s in one pseudo-random 32-bit field
+static std::vector<Image> makeHistory()
+{
+    std::vector<Image> h(1, Image(IMAGE, 0));
+    uint32_t seed = 1;
+    for (int s = 1; s <= STEPS; s++)
+    {
+        seed = seed * 1103515245 + 12345;
+        Image img = h.back();
+        uint32_t field = (seed >> 16) % (IMAGE / 4);
+        uint32_t v = s;
+        memcpy(&img[field * 4], &v, 4);
+        h.push_back(img);
+    }
+    return h;
+}
+
+// Commits the whole history; returns the last step that completed
+static int runCommits(RamFlash &flash, const std::vector<Image> &hist)
+{
+    int done = -1;
+    try
+    {
+        SettingsJournal j;
+        Image img = hist[0];
+        j.begin(&flash, img.data(), IMAGE);
+        j.commit(img.data());
+        done = 0;
+        for (int s = 1; s <= STEPS; s++)
+        {
+            j.commit(hist[s].data());
+            done = s;
+        }
+    }
+    catch (PowerLoss &)
+    {
+    }
+    return done;
+}
+
+static void powerLoss(const std::vector<Image> &hist)
+{
+    long cuts = 0;
+    for (long budget = 0;; budget++)
+    {
+        RamFlash flash;
+        flash.budget = budget;
+        int done = runCommits(flash, hist);
+        if (done == STEPS)
+            break;
+        cuts++;
+
+        flash.budget = -1;
+        SettingsJournal j;
+        Image img(IMAGE, 0);
+        bool ok = j.begin(&flash, img.data(), IMAGE);
+        if (done < 0)
+        {
+            // Cut before the first image was complete: nothing, or that image
+            CHECK(!ok || img == hist[0]);
+            continue;
+        }
+        bool before = ok && img == hist[done];
+        bool after = ok && done < STEPS && img == hist[done + 1];
+        if (!before && !after)
+        {
+            fprintf(stderr, "cut after %ld bytes (step %d done): %s\n", budget, done,
+                    ok ? "mixed image" : "journal lost");
+            hostTestFailures++;
+            continue;
+        }
+
+        // The journal keeps working after the reboot
+        CHECK(j.commit(hist[STEPS].data()));
+        SettingsJournal k;
+        Image again(IMAGE, 0);
+        CHECK(k.begin(&flash, again.data(), IMAGE));
+        CHECK(again == hist[STEPS]);
+    }
+    // Every operation of the run was a cut point
+    CHECK(cuts > 1000);
+}
+
+static void wearAndLimits(const std::vector<Image> &hist)
+{
+    RamFlash flash;
+    CHECK_EQ(runCommits(flash, hist), STEPS);
+
+    SettingsJournal j;
+    Image img(IMAGE, 0);
+    CHECK(j.begin(&flash, img.data(), IMAGE));
+    CHECK(img == hist[STEPS]);
+    CHECK(!j.stats().tornRecord);
+    for (int s = 0; s < RamFlash::SECTORS; s++)
+        CHECK(j.stats().sectorErases[s] > 0);
+
+    // An image larger than the cache is refused before anything is copied
+    std::vector<uint8_t> big(SETTINGS_JOURNAL_MAX_IMAGE + 1, 0x5A);
+    SettingsJournal tooBig;
+    CHECK(!tooBig.begin(&flash, big.data(), big.size()));
+    CHECK(big[0] == 0x5A && big.back() == 0x5A);
+}
+
+int main()
+{
+    std::vector<Image> hist = makeHistory();
+    wearAndLimits(hist);
+    powerLoss(hist);
+    return hostTestResult("settingsJournal");
+}
@@ -0,0 +1,122 @@
+// setupDriver.cpp on the simulated flash: the EEPROM fallback, migration
+// to the journal once a "settings" partition exists, failed writes that
+// keep the changes pending, and reloads that see what was flushed.
+#include "setupDriver.h"
+#include "setupSchema.h"
+#include "hostBoard.h"
+#include "SystemEvents.h"
+#include "hostTest.h"
+#include <cstring>
+
+// A reboot: RAM forgets Setup, flash keeps its contents
+static void reboot()
+{
+    memset(&Setup, 0xA5, sizeof(Setup));
+    CHECK(InitSetup());
+}
+
+static void eepromFallback()
+{
+    CHECK(InitSetup());
+    CHECK(!getSetupStoreStats().journal);
+    CHECK(setupSchemaValid(Setup));
+
+    Setup.musicVolume = 42;
+    markSetupDirty();
+    CHECK(setupIsDirty());
+    CHECK(flushSetup());
+    CHECK(!setupIsDirty());
+    reboot();
+    CHECK(!getSetupStoreStats().journal);
+    CHECK_EQ(Setup.musicVolume, 42);
+}
+
+static void migrateToJournal()
+{
+    CHECK(hostPartitionAdd("settings", 4 * 4096));
+    reboot();
+    SetupStoreStats st = getSetupStoreStats();
+    CHECK(st.journal);
+    CHECK(st.j.commits >= 1); // the EEPROM image was copied over
+    CHECK_EQ(Setup.musicVolume, 42);
+
+    // From here on the EEPROM is not read any more
+    hostEepromClear();
+    Setup.musicVolume = 7;
+    markSetupDirty();
+    CHECK(flushSetup());
+    reboot();
+    CHECK(getSetupStoreStats().journal);
+    CHECK_EQ(Setup.musicVolume, 7);
+}
+
+static void failedWrite()
+{
+    hostPartitionFail(true);
+    Setup.radioVolume = 33;
+    markSetupDirty();
+    CHECK(!flushSetup());
+    CHECK(setupIsDirty()); // retried later
+
+    hostPartitionFail(false);
+    CHECK(flushSetup());
+    CHECK(!setupIsDirty());
+    reboot();
+    CHECK_EQ(Setup.radioVolume, 33);
+    CHECK_EQ(Setup.musicVolume, 7);
+}
+
+static void manyWrites()
+{
+    // Enough records to wrap the journal through its sectors
+    for (int i = 0; i < 600; i++)
+    {
+        Setup.lastFrequency = 8750 + i % 200;
+        Setup.musicVolume = i % 101;
+        markSetupDirty();
+        CHECK(flushSetup());
+    }
+    SetupStoreStats st = getSetupStoreStats();
+    CHECK(st.j.compactions > 0);
+    reboot();
+    CHECK_EQ(Setup.lastFrequency, 8750 + 599 % 200);
+    CHECK_EQ(Setup.musicVolume, 599 % 101);
+
+    // Nothing changed, nothing written
+    uint32_t commits = getSetupStoreStats().j.commits;
+    markSetupDirty();
+    CHECK(flushSetup());
+    CHECK_EQ(getSetupStoreStats().j.commits, commits);
+}
+
+static void dirtyEvents()
+{
+    EventSubscriber sub = eventBusSubscribe("test", SYS_EVENT_MASK(SysEvent::SetupDirty));
+    CHECK(!setupIsDirty());
+    uint32_t marks = setupMarkCount();
+    for (int i = 0; i < 5; i++)
+        markSetupDirty();
+    CHECK_EQ(setupMarkCount(), marks + 5);
+
+    // Only the clean to dirty edge is published
+    SysEventRecord rec;
+    int events = 0;
+    while (eventBusPoll(sub, rec))
+        events++;
+    CHECK_EQ(events, 1);
+    CHECK(eventBusWait(0));
+    CHECK(flushSetup());
+    markSetupDirty();
+    CHECK(eventBusPoll(sub, rec));
+}
+
+int main()
+{
+    hostSerialEcho(false);
+    eepromFallback();
+    migrateToJournal();
+    failedWrite();
+    manyWrites();
+    dirtyEvents();
+    return hostTestResult("setupDriver");
+}
@@ -0,0 +1,66 @@
+// Setup import checks: a bit mask field takes only its allowed bits, a
+// rejected import leaves the target untouched, and an export reads back.
+#include "setupSchema.h"
+#include "hostTest.h"
+#include <cstring>
+#include <string>
+
+// Collects the import log so a failed test can show it
+class StringPrint : public Print
+{
+public:
+    std::string text;
+    size_t write(uint8_t c) override
+    {
+        text += (char)c;
+        return 1;
+    }
+};
+
+static bool importJson(const char *json, SETUP &s)
+{
+    StringPrint log;
+    return setupImportJson(json, s, log);
+}
+
+int main()
+{
+    SETUP s;
+    setupSchemaDefaults(s);
+    CHECK(setupSchemaValid(s));
+
+    // Opto 2..13 may raise an alarm, so only bits 0x3FFC are allowed
+    CHECK(importJson("{\"optoAlarmMask\":4}", s));
+    CHECK_EQ(s.optoAlarmMask, 4);
+    CHECK(importJson("{\"optoAlarmMask\":16380}", s));
+    CHECK_EQ(s.optoAlarmMask, 0x3FFC);
+    CHECK(!importJson("{\"optoAlarmMask\":3}", s));
+    CHECK(!importJson("{\"optoAlarmMask\":5}", s));
+    CHECK(!importJson("{\"optoAlarmMask\":16384}", s));
+    CHECK(!importJson("{\"optoAlarmMask\":-4}", s));
+    CHECK_EQ(s.optoAlarmMask, 0x3FFC);
+
+    // A mask with a bad bit in the stored image is reset on load
+    s.optoAlarmMask = 0x0001;
+    CHECK(!setupSchemaValid(s));
+    SetupLoadResult r = setupSchemaLoad(s);
+    CHECK(r.resetMask != 0);
+    CHECK_EQ(s.optoAlarmMask, 0);
+
+    // One bad value rejects the whole import
+    SETUP before = s;
+    CHECK(!importJson("{\"musicVolume\":50,\"optoAlarmMask\":2}", s));
+    CHECK(memcmp(&before, &s, sizeof(SETUP)) == 0);
+
+    // Export and import round trip
+    s.musicVolume = 42;
+    s.optoAlarmMask = 0x0404;
+    StringPrint out;
+    setupExportJson(out, s);
+    SETUP back;
+    setupSchemaDefaults(back);
+    CHECK(importJson(out.text.c_str(), back));
+    CHECK(memcmp(&back, &s, sizeof(SETUP)) == 0);
+
+    return hostTestResult("setupSchema");
+}
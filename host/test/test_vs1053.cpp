@@ -0,0 +1,108 @@
+// The VS1053 library, unchanged, against Vs1053Model on the simulated SPI
+// bus: the begin() sequence, register access, volume and balance, and a
+// stream fed through playChunk() paced by DREQ without losing a byte.
+#include "VS1053.h"
+#include "Vs1053SpiChip.h"
+#include "pins.h"
+#include "hostBoard.h"
+#include "hostTest.h"
+#include <vector>
+
+#define REG_MODE 0x0
+#define REG_CLOCKF 0x3
+#define REG_AUDATA 0x5
+#define REG_VOL 0xB
+#define MODE_SDINEW (1 << 11)
+#define MODE_CANCEL (1 << 3)
+#define MODE_LINE1 (1 << 14)
+
+static Vs1053SpiChip chip(VS1003B_CS_PIN, VS1003B_DCS_PIN, VS1003B_DREQ_PIN);
+static VS1053 player(VS1003B_CS_PIN, VS1003B_DCS_PIN, VS1003B_DREQ_PIN);
+
+// MPEG-1 layer III, 128 kbps, 44.1 kHz: 417-byte frames, 16000 bytes/s
+static std::vector<uint8_t> mp3Stream(size_t frames)
+{
+    std::vector<uint8_t> s;
+    for (size_t f = 0; f < frames; f++)
+    {
+        const uint8_t header[4] = {0xFF, 0xFB, 0x90, 0x64};
+        s.insert(s.end(), header, header + 4);
+        for (int i = 4; i < 417; i++)
+            s.push_back((uint8_t)(f * 31 + i));
+    }
+    return s;
+}
+
+static void startup()
+{
+    uint64_t start = hostClockUs();
+    player.begin();
+    CHECK_EQ(chip.resets(), 1);
+    CHECK(hostClockUs() - start >= 1100000); // the reset and settle delays
+    CHECK_EQ(chip.badSciBytes(), 0);
+
+    CHECK(player.isChipConnected());
+    CHECK_EQ(player.getChipVersion(), 4);
+    CHECK_EQ(player.readRegister(REG_MODE), MODE_SDINEW | MODE_LINE1);
+    CHECK_EQ(player.readRegister(REG_CLOCKF), 6 << 12);
+    CHECK_EQ(player.readRegister(REG_AUDATA), 44101);
+    CHECK(player.testComm("Fast SPI, test\n"));
+}
+
+static void volume()
+{
+    player.setVolume(100);
+    CHECK_EQ(player.readRegister(REG_VOL), 0x0000);
+    player.setVolume(0);
+    CHECK_EQ(player.readRegister(REG_VOL), 0xFEFE);
+    player.setVolume(50);
+    CHECK_EQ(player.readRegister(REG_VOL), 0x7F7F);
+
+    // Balance to the right takes it off the left channel
+    player.setBalance(20);
+    player.setVolume(50);
+    CHECK_EQ(player.readRegister(REG_VOL), 0xB27F);
+    player.setBalance(-20);
+    player.setVolume(50);
+    CHECK_EQ(player.readRegister(REG_VOL), 0x7FB2);
+    player.setBalance(0);
+    CHECK_EQ(player.getVolume(), 50);
+}
+
+static void playback()
+{
+    player.switchToDefaultInput();
+    CHECK_EQ(player.readRegister(REG_MODE) & MODE_LINE1, 0);
+    chip.model().resetStats();
+
+    std::vector<uint8_t> song = mp3Stream(200); // 83400 bytes, about 5.2 s
+    uint64_t start = hostClockUs();
+    player.startSong();
+    for (size_t pos = 0; pos < song.size(); pos += 1024)
+        player.playChunk(song.data() + pos, std::min<size_t>(1024, song.size() - pos));
+    uint64_t feedUs = hostClockUs() - start;
+
+    const Vs1053ModelStats &st = chip.model().stats();
+    CHECK_EQ(st.overflowBytes, 0); // DREQ held the writer back
+    CHECK_EQ(st.bytesIn, song.size() + 10);
+    CHECK_EQ(st.underruns, 0);
+    CHECK_EQ(chip.model().byteRate(), 16000);
+    // Everything but the last FIFO-full went out at the decode rate
+    uint64_t expectUs = (song.size() - Vs1053Model::FIFO_SIZE) * 1000000ull / 16000;
+    CHECK(feedUs + 50000 >= expectUs);
+    CHECK(feedUs <= expectUs + 50000);
+    CHECK(player.getDecodedTime() >= 4);
+
+    player.stopSong();
+    CHECK_EQ(player.readRegister(REG_MODE) & MODE_CANCEL, 0);
+    CHECK_EQ(chip.model().stats().overflowBytes, 0);
+    CHECK_EQ(chip.badSciBytes(), 0);
+}
+
+int main()
+{
+    startup();
+    volume();
+    playback();
+    return hostTestResult("vs1053");
+}
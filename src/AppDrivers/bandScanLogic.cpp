@@ -0,0 +1,62 @@
+#include "bandScanLogic.h"
+#include <cstring>
+
+uint8_t scanFindPeaks(const uint8_t *rssi, uint16_t channels, uint16_t *peaks)
+{
+    uint8_t n = 0;
+    for (uint16_t ch = 0; ch < channels; ch++)
+    {
+        uint8_t r = rssi[ch];
+        if (r < SCAN_MIN_RSSI)
+            continue;
+        if (ch > 0 && r <= rssi[ch - 1])
+            continue;
+        if (ch + 1 < channels && r < rssi[ch + 1])
+            continue;
+
+        // Insert by RSSI; the weakest drops off a full list
+        uint8_t at = n;
+        while (at > 0 && rssi[peaks[at - 1]] < r)
+            at--;
+        if (at >= SCAN_MAX_STATIONS)
+            continue;
+        if (n < SCAN_MAX_STATIONS)
+            n++;
+        memmove(peaks + at + 1, peaks + at, (n - 1 - at) * sizeof(peaks[0]));
+        peaks[at] = ch;
+    }
+    return n;
+}
+
+bool scanAddStation(ScanStation *stations, uint8_t &count, const ScanStation &s)
+{
+    if (count >= SCAN_MAX_STATIONS)
+        return false;
+    // Same programme on another channel: callers add the strongest first
+    for (uint8_t i = 0; s.pi && i < count; i++)
+    {
+        if (stations[i].pi == s.pi)
+            return false;
+    }
+    stations[count++] = s;
+    return true;
+}
+
+void scanRankStations(ScanStation *stations, uint8_t count)
+{
+    for (int i = 1; i < count; i++)
+    {
+        ScanStation s = stations[i];
+        int j = i;
+        while (j > 0)
+        {
+            const ScanStation &p = stations[j - 1];
+            bool before = (s.pi && !p.pi) || ((s.pi != 0) == (p.pi != 0) && s.rssi > p.rssi);
+            if (!before)
+                break;
+            stations[j] = p;
+            j--;
+        }
+        stations[j] = s;
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * @file bandScanLogic.h
+ * @brief Station selection of the FM band scan (tasks/BandScan).
+ *
+ * The scan task measures every channel and reads the PI code of the
+ * candidates; what counts as a station and in which order they are stored
+ * is decided here, on plain arrays, so it builds on the host:
+ *
+ *  - peaks: channels above SCAN_MIN_RSSI that are not weaker than either
+ *    neighbour; of a run of equal levels only the first counts, since a
+ *    station also raises the channels beside it
+ *  - dedupe: one entry per PI code, the first (strongest) one found
+ *  - rank: stations with RDS first, then by RSSI, stable
+ */
+#ifndef BANDSCANLOGIC_H
+#define BANDSCANLOGIC_H
+
+#include <cstdint>
+
+#define SCAN_MIN_RSSI        20     // dBuV, weaker peaks are not stations
+#define SCAN_MAX_STATIONS    40
+
+struct ScanStation {
+    uint16_t freq;             // 10 kHz units
+    uint16_t pi;               // 0 if no RDS
+    uint8_t rssi;              // dBuV
+    bool stereo;
+};
+
+/**
+ * @brief Channels that are RSSI peaks, strongest first
+ * @param rssi level per channel
+ * @param peaks receives up to SCAN_MAX_STATIONS channel numbers; the
+ *        weakest peaks drop off a full list
+ * @return number of peaks
+ */
+uint8_t scanFindPeaks(const uint8_t *rssi, uint16_t channels, uint16_t *peaks);
+
+/**
+ * @brief Append 's' unless a station with the same PI is already listed
+ * @return false if it was dropped (duplicate PI or full list)
+ */
+bool scanAddStation(ScanStation *stations, uint8_t &count, const ScanStation &s);
+
+/**
+ * @brief Sort: stations with RDS first, then by RSSI (stable)
+ */
+void scanRankStations(ScanStation *stations, uint8_t count);
+
+#endif // BANDSCANLOGIC_H
@@ -0,0 +1,52 @@
+#include "barGraph.h"
+#include "displayFlush.h"
+#include <cstring>
+
+void drawBarGraph(uint8_t *frame, const uint8_t *levels, uint8_t count, uint8_t page0, uint8_t page1,
+                  uint8_t col0, uint8_t col1)
+{
+    if (page1 >= SSD1306_FLUSH_PAGES)
+        page1 = SSD1306_FLUSH_PAGES - 1;
+    if (col1 >= SSD1306_FLUSH_WIDTH)
+        col1 = SSD1306_FLUSH_WIDTH - 1;
+    if (page0 > page1 || col0 > col1)
+        return;
+
+    int width = col1 - col0 + 1;
+    int rows = (page1 - page0 + 1) * 8;
+    for (uint8_t page = page0; page <= page1; page++)
+        memset(frame + page * SSD1306_FLUSH_WIDTH + col0, 0, width);
+    if (!count)
+        return;
+
+    int pitch = (width + 1) / count;
+    if (pitch < 1)
+        pitch = 1;
+    int barWidth = pitch > 1 ? pitch - 1 : 1;
+    for (uint8_t b = 0; b < count; b++)
+    {
+        int x = col0 + b * pitch;
+        if (x > col1)
+            break;
+        int h = (levels[b] * rows + 127) / 255;
+        if (!h)
+            continue;
+
+        // Rows top..rows-1 are lit; bit 0 of a page byte is its top row
+        int top = rows - h;
+        for (uint8_t page = page0; page <= page1; page++)
+        {
+            int first = (page - page0) * 8;
+            uint8_t bits;
+            if (top <= first)
+                bits = 0xFF;
+            else if (top >= first + 8)
+                continue;
+            else
+                bits = 0xFF << (top - first);
+            uint8_t *dst = frame + page * SSD1306_FLUSH_WIDTH + x;
+            for (int i = 0; i < barWidth && x + i <= col1; i++)
+                dst[i] = bits;
+        }
+    }
+}
@@ -0,0 +1,18 @@
+/**
+ * @file barGraph.h
+ * @brief Vertical bar graph written straight into an SSD1306 frame.
+ *
+ * The graph covers whole pages, so every byte of its region is written
+ * with the final bits: no clear pass, no per-pixel calls. Bars share the
+ * width evenly with a one-column gap between them.
+ */
+#ifndef BARGRAPH_H
+#define BARGRAPH_H
+
+#include <cstdint>
+
+// Draw 'count' bars (levels 0-255) into pages page0..page1, columns col0..col1
+void drawBarGraph(uint8_t *frame, const uint8_t *levels, uint8_t count, uint8_t page0, uint8_t page1,
+                  uint8_t col0, uint8_t col1);
+
+#endif // BARGRAPH_H
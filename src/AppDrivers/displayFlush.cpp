@@ -0,0 +1,115 @@
+#include "displayFlush.h"
+#include <cstring>
+
+#define CMD_COLUMNADDR 0x21
+#define CMD_PAGEADDR 0x22
+#define WINDOW_OVERHEAD 8 // address commands plus bus framing, in bytes
+
+static uint32_t windowBytes(uint8_t col0, uint8_t col1, uint8_t page0, uint8_t page1)
+{
+    return (uint32_t)(col1 - col0 + 1) * (page1 - page0 + 1);
+}
+
+uint32_t DisplayFlush::sendWindow(const uint8_t *frame, const Window &w, Ssd1306Bus &bus)
+{
+    const uint8_t cmd[] = {CMD_COLUMNADDR, w.col0, w.col1, CMD_PAGEADDR, w.page0, w.page1};
+    bus.command(cmd, sizeof(cmd));
+
+    // Horizontal addressing wraps to the next page at col1, so each page
+    // row of the window is contiguous in the frame
+    size_t width = w.col1 - w.col0 + 1;
+    for (uint8_t page = w.page0; page <= w.page1; page++)
+    {
+        size_t at = page * SSD1306_FLUSH_WIDTH + w.col0;
+        bus.data(frame + at, width);
+        memcpy(shadow + at, frame + at, width);
+    }
+    return sizeof(cmd) + width * (w.page1 - w.page0 + 1);
+}
+
+uint32_t DisplayFlush::flush(const uint8_t *frame, Ssd1306Bus &bus)
+{
+    uint32_t bytes = 0;
+    uint8_t windows = 0;
+
+    if (!shadowValid)
+    {
+        Window all = {0, SSD1306_FLUSH_WIDTH - 1, 0, SSD1306_FLUSH_PAGES - 1};
+        bytes = sendWindow(frame, all, bus);
+        windows = 1;
+        shadowValid = true;
+    }
+    else
+    {
+        Window cur;
+        bool open = false;
+        for (uint8_t page = 0; page < SSD1306_FLUSH_PAGES; page++)
+        {
+            const uint8_t *a = frame + page * SSD1306_FLUSH_WIDTH;
+            const uint8_t *b = shadow + page * SSD1306_FLUSH_WIDTH;
+            int first = 0, last = SSD1306_FLUSH_WIDTH - 1;
+            while (first < SSD1306_FLUSH_WIDTH && a[first] == b[first])
+                first++;
+            if (first == SSD1306_FLUSH_WIDTH)
+            {
+                if (open)
+                {
+                    bytes += sendWindow(frame, cur, bus);
+                    windows++;
+                    open = false;
+                }
+                continue;
+            }
+            while (a[last] == b[last])
+                last--;
+
+            if (open)
+            {
+                // Grow the open window if that is cheaper than a new one
+                uint8_t c0 = first < cur.col0 ? first : cur.col0;
+                uint8_t c1 = last > cur.col1 ? last : cur.col1;
+                uint32_t merged = windowBytes(c0, c1, cur.page0, page);
+                uint32_t split = windowBytes(cur.col0, cur.col1, cur.page0, cur.page1) +
+                                 windowBytes(first, last, page, page) + WINDOW_OVERHEAD;
+                if (merged <= split)
+                {
+                    cur.col0 = c0;
+                    cur.col1 = c1;
+                    cur.page1 = page;
+                    continue;
+                }
+                bytes += sendWindow(frame, cur, bus);
+                windows++;
+            }
+            cur.col0 = first;
+            cur.col1 = last;
+            cur.page0 = cur.page1 = page;
+            open = true;
+        }
+        if (open)
+        {
+            bytes += sendWindow(frame, cur, bus);
+            windows++;
+        }
+    }
+
+    if (!bytes)
+    {
+        st.skipped++;
+        return 0;
+    }
+    st.frames++;
+    st.lastBytes = bytes;
+    st.lastWindows = windows;
+    st.totalBytes += bytes;
+    if (bytes > st.maxBytes)
+        st.maxBytes = bytes;
+    return bytes;
+}
+
+void DisplayFlush::recordTime(uint32_t us)
+{
+    st.lastUs = us;
+    if (us > st.maxUs)
+        st.maxUs = us;
+}
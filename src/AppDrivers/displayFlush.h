@@ -0,0 +1,74 @@
+/**
+ * @file displayFlush.h
+ * @brief Partial SSD1306 update: send only the changed part of the frame.
+ *
+ * The SSD1306 keeps the frame in its own RAM, organised as 8 pages of
+ * 8-pixel rows by 128 columns, one byte per page/column. DisplayFlush keeps
+ * a shadow of what the panel shows, diffs the new frame against it page by
+ * page, and sends one column/page window per changed region using the
+ * controller's horizontal addressing mode (COLUMNADDR + PAGEADDR, then data).
+ * Adjacent pages are merged when the union window costs fewer bytes than
+ * the extra command sequence.
+ *
+ * Bus access goes through Ssd1306Bus, so the flush logic builds on a host.
+ */
+#ifndef DISPLAYFLUSH_H
+#define DISPLAYFLUSH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define SSD1306_FLUSH_WIDTH 128
+#define SSD1306_FLUSH_PAGES 8
+#define SSD1306_FLUSH_BYTES (SSD1306_FLUSH_WIDTH * SSD1306_FLUSH_PAGES)
+
+/**
+ * @brief Minimal command/data transport to the controller.
+ */
+class Ssd1306Bus
+{
+public:
+    virtual ~Ssd1306Bus() {}
+    virtual void command(const uint8_t *cmd, size_t len) = 0;
+    virtual void data(const uint8_t *buf, size_t len) = 0;
+};
+
+struct DisplayFlushStats
+{
+    uint32_t frames;        // flush() calls that sent something
+    uint32_t skipped;       // flush() calls with no change
+    uint32_t lastBytes;     // bytes (commands + data) of the last frame
+    uint32_t maxBytes;
+    uint32_t totalBytes;
+    uint8_t lastWindows;    // address windows in the last frame
+    uint32_t lastUs;        // flush time of the last frame (set by the caller)
+    uint32_t maxUs;
+};
+
+class DisplayFlush
+{
+public:
+    // Forget the panel contents; the next flush sends the full frame
+    void invalidate() { shadowValid = false; }
+
+    // Send what differs between 'frame' (SSD1306 page layout) and the
+    // panel. Returns bytes put on the bus, 0 if nothing changed.
+    uint32_t flush(const uint8_t *frame, Ssd1306Bus &bus);
+
+    void recordTime(uint32_t us);
+    const DisplayFlushStats &stats() const { return st; }
+
+private:
+    struct Window
+    {
+        uint8_t col0, col1, page0, page1;
+    };
+
+    uint32_t sendWindow(const uint8_t *frame, const Window &w, Ssd1306Bus &bus);
+
+    uint8_t shadow[SSD1306_FLUSH_BYTES];
+    bool shadowValid = false;
+    DisplayFlushStats st = {};
+};
+
+#endif // DISPLAYFLUSH_H
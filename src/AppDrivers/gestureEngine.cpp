@@ -0,0 +1,186 @@
+#include "gestureEngine.h"
+#include <cstring>
+
+// Per-input phases
+enum : uint8_t {
+    PH_IDLE = 0,
+    PH_DOWN,     // pressed, waiting for long/repeat
+    PH_HELD,     // long press sent or repeating
+    PH_UP,       // released, waiting for a second press
+    PH_DOWN2,    // second press of a double
+    PH_COUNT
+};
+
+// Signals
+enum : uint8_t {
+    SIG_PRESS = 0,
+    SIG_RELEASE,
+    SIG_TIMEOUT,
+    SIG_COUNT
+};
+
+// What to arm after a transition
+enum : uint8_t {
+    ARM_NONE = 0,
+    ARM_HOLD,   // long press or first repeat
+    ARM_REPEAT, // next repeat, if repeating
+    ARM_DOUBLE, // double-press window
+};
+
+// Emitted event; EMIT_HOLD resolves to REPEAT or LONGPRESS from the profile
+#define EMIT_HOLD 0xFF
+
+struct Transition
+{
+    uint8_t next;
+    uint8_t emit;
+    uint8_t arm;
+};
+
+static const Transition transitions[PH_COUNT][SIG_COUNT] = {
+    //              SIG_PRESS                              SIG_RELEASE                          SIG_TIMEOUT
+    /* IDLE  */ {{PH_DOWN, KEY_EVENT_PRESS, ARM_HOLD},  {PH_IDLE, KEY_EVENT_NONE, ARM_NONE},    {PH_IDLE, KEY_EVENT_NONE, ARM_NONE}},
+    /* DOWN  */ {{PH_DOWN, KEY_EVENT_NONE, ARM_NONE},   {PH_UP, KEY_EVENT_RELEASE, ARM_DOUBLE}, {PH_HELD, EMIT_HOLD, ARM_REPEAT}},
+    /* HELD  */ {{PH_HELD, KEY_EVENT_NONE, ARM_NONE},   {PH_IDLE, KEY_EVENT_RELEASE, ARM_NONE}, {PH_HELD, KEY_EVENT_REPEAT, ARM_REPEAT}},
+    /* UP    */ {{PH_DOWN2, KEY_EVENT_DOUBLE, ARM_HOLD}, {PH_UP, KEY_EVENT_NONE, ARM_NONE},     {PH_IDLE, KEY_EVENT_NONE, ARM_NONE}},
+    /* DOWN2 */ {{PH_DOWN2, KEY_EVENT_NONE, ARM_NONE},  {PH_IDLE, KEY_EVENT_RELEASE, ARM_NONE}, {PH_HELD, EMIT_HOLD, ARM_REPEAT}},
+};
+
+void GestureEngine::init(const GestureProfile *profileTable)
+{
+    profiles = profileTable;
+    memset(inputs, 0, sizeof(inputs));
+    chordCount = 0;
+    chordIndex = 0;
+    chordPending = false;
+    chordFired = false;
+    chordStartUs = 0;
+    prevState = 0;
+    timed = 0;
+    nextDeadlineUs = 0;
+}
+
+void GestureEngine::setInputProfile(uint8_t input, uint8_t profile)
+{
+    if (input < GESTURE_MAX_INPUTS && profile < GESTURE_PROFILES)
+        inputs[input].profile = profile;
+}
+
+bool GestureEngine::addChord(uint32_t mask, uint16_t holdMs, uint8_t id)
+{
+    if (chordCount >= GESTURE_MAX_CHORDS)
+        return false;
+    chords[chordCount++] = {mask, holdMs, id};
+    return true;
+}
+
+void GestureEngine::step(uint8_t input, uint8_t signal, uint32_t nowUs, GestureSink sink)
+{
+    InputState &in = inputs[input];
+    const GestureProfile &p = profiles[in.profile];
+    const Transition &t = transitions[in.phase][signal];
+
+    uint8_t emit = t.emit;
+    if (emit == EMIT_HOLD)
+        emit = p.repeatDelayMs ? KEY_EVENT_REPEAT : KEY_EVENT_LONGPRESS;
+    if (emit != KEY_EVENT_NONE)
+        sink(input, (KeyEventType)emit, nowUs);
+
+    in.phase = t.next;
+    uint32_t delayMs = 0;
+    switch (t.arm)
+    {
+    case ARM_HOLD:
+        in.repeatMs = p.repeatMs;
+        delayMs = p.repeatDelayMs ? p.repeatDelayMs : p.longMs;
+        break;
+    case ARM_REPEAT:
+        if (p.repeatDelayMs)
+        {
+            delayMs = in.repeatMs;
+            uint16_t faster = in.repeatMs - in.repeatMs * p.repeatAccel / 100;
+            in.repeatMs = faster > p.repeatMinMs ? faster : p.repeatMinMs;
+        }
+        break;
+    case ARM_DOUBLE:
+        delayMs = p.doubleMs;
+        if (!delayMs)
+            in.phase = PH_IDLE; // no double press for this input
+        break;
+    default:
+        break;
+    }
+
+    // Every transition replaces the input's pending deadline
+    if (delayMs)
+    {
+        in.deadlineUs = nowUs + delayMs * 1000;
+        if (!timed || (int32_t)(in.deadlineUs - nextDeadlineUs) < 0)
+            nextDeadlineUs = in.deadlineUs;
+        timed |= 1u << input;
+    }
+    else
+    {
+        timed &= ~(1u << input);
+    }
+}
+
+void GestureEngine::update(uint32_t state, uint32_t nowUs, GestureSink sink)
+{
+    uint32_t changed = state ^ prevState;
+    bool due = timed && (int32_t)(nowUs - nextDeadlineUs) >= 0;
+    if (!changed && !due && !chordPending)
+        return;
+
+    // Expired deadlines first, so an edge sees the state it followed
+    if (due)
+    {
+        for (uint32_t m = timed; m; m &= m - 1)
+        {
+            uint8_t i = __builtin_ctz(m);
+            if ((int32_t)(nowUs - inputs[i].deadlineUs) >= 0)
+                step(i, SIG_TIMEOUT, nowUs, sink);
+        }
+        // Earliest remaining deadline
+        bool first = true;
+        for (uint32_t m = timed; m; m &= m - 1)
+        {
+            uint8_t i = __builtin_ctz(m);
+            if (first || (int32_t)(inputs[i].deadlineUs - nextDeadlineUs) < 0)
+                nextDeadlineUs = inputs[i].deadlineUs;
+            first = false;
+        }
+    }
+
+    while (changed)
+    {
+        uint8_t i = __builtin_ctz(changed);
+        changed &= changed - 1;
+        step(i, (state >> i) & 1 ? SIG_PRESS : SIG_RELEASE, nowUs, sink);
+    }
+
+    // Chords: exact combinations, reported once per hold
+    if (state != prevState)
+    {
+        chordPending = false;
+        chordFired = false;
+        for (uint8_t c = 0; c < chordCount; c++)
+        {
+            if (state == chords[c].mask)
+            {
+                chordIndex = c;
+                chordPending = true;
+                chordStartUs = nowUs;
+                break;
+            }
+        }
+    }
+    if (chordPending && nowUs - chordStartUs >= chords[chordIndex].holdMs * 1000u)
+    {
+        chordPending = false;
+        chordFired = true;
+        sink(chords[chordIndex].id, KEY_EVENT_CHORD, nowUs);
+    }
+
+    prevState = state;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file gestureEngine.h
+ * @brief Table-driven press/long/double/repeat/chord recogniser.
+ *
+ * Works on a bitmask of up to 32 inputs sampled with a microsecond
+ * timestamp. Each input follows a small state machine whose transitions
+ * come from one table, with its timing taken from a GestureProfile (these
+ * live in Setup). Chords are exact input combinations held for a time.
+ *
+ * update() only touches inputs that changed, plus those whose deadline
+ * expired, and returns immediately when neither happened. No Arduino
+ * dependencies.
+ */
+#ifndef GESTUREENGINE_H
+#define GESTUREENGINE_H
+
+#include <cstdint>
+#include "optoInLogic.h"
+
+#define GESTURE_MAX_INPUTS 32
+#define GESTURE_MAX_CHORDS 4
+#define GESTURE_PROFILES 4
+#define GESTURE_NO_CHORD 0xFF
+
+/**
+ * @brief Per-input timing, in milliseconds. 0 disables that gesture.
+ */
+typedef struct {
+    uint16_t longMs;        ///< hold time for KEY_EVENT_LONGPRESS
+    uint16_t doubleMs;      ///< max release-to-press gap for KEY_EVENT_DOUBLE
+    uint16_t repeatDelayMs; ///< hold time before the first KEY_EVENT_REPEAT (replaces long press)
+    uint16_t repeatMs;      ///< first repeat interval
+    uint16_t repeatMinMs;   ///< fastest repeat interval
+    uint8_t repeatAccel;    ///< percent taken off the interval after each repeat
+    uint8_t reserved;
+} GestureProfile;
+
+// Events go out as (input index or chord id, type, timestamp)
+typedef void (*GestureSink)(uint8_t input, KeyEventType type, uint32_t timeUs);
+
+struct GestureEngine
+{
+    void init(const GestureProfile *profileTable);
+    void setInputProfile(uint8_t input, uint8_t profile);
+    bool addChord(uint32_t mask, uint16_t holdMs, uint8_t id);
+
+    // Feed the current input state; call on every change and periodically
+    // while anything is held or waiting for a double press
+    void update(uint32_t state, uint32_t nowUs, GestureSink sink);
+
+    uint8_t activeChord() const { return chordFired ? chords[chordIndex].id : GESTURE_NO_CHORD; }
+    bool busy() const { return timed != 0 || chordPending; }
+
+private:
+    struct InputState
+    {
+        uint32_t deadlineUs;
+        uint16_t repeatMs;
+        uint8_t phase;
+        uint8_t profile;
+    };
+    struct Chord
+    {
+        uint32_t mask;
+        uint16_t holdMs;
+        uint8_t id;
+    };
+
+    void step(uint8_t input, uint8_t signal, uint32_t nowUs, GestureSink sink);
+
+    const GestureProfile *profiles;
+    InputState inputs[GESTURE_MAX_INPUTS];
+    Chord chords[GESTURE_MAX_CHORDS];
+    uint8_t chordCount;
+    uint8_t chordIndex;
+    bool chordPending;
+    bool chordFired;
+    uint32_t chordStartUs;
+    uint32_t prevState;
+    uint32_t timed;          // inputs with an armed deadline
+    uint32_t nextDeadlineUs; // earliest of them
+};
+
+#endif // GESTUREENGINE_H
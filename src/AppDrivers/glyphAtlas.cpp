@@ -0,0 +1,137 @@
+#include "glyphAtlas.h"
+#include "displayFlush.h"
+#include <cstring>
+
+static const GFXglyph *fontGlyph(const GFXfont *font, char c)
+{
+    uint8_t code = (uint8_t)c;
+    if (code < font->first || code > font->last)
+        return nullptr;
+    return &font->glyph[code - font->first];
+}
+
+bool GlyphAtlas::build(const GFXfont *font, const char *chars, int16_t baseline)
+{
+    count = 0;
+    used = 0;
+
+    // Rows the whole set covers, so every sprite has the same pages
+    int top = SSD1306_FLUSH_PAGES * 8, bottom = 0;
+    size_t n = 0;
+    for (const char *p = chars; *p; p++, n++)
+    {
+        const GFXglyph *g = fontGlyph(font, *p);
+        if (!g)
+            return false;
+        int y0 = baseline + g->yOffset;
+        int y1 = y0 + g->height;
+        if (g->height && y0 < top)
+            top = y0;
+        if (g->height && y1 > bottom)
+            bottom = y1;
+    }
+    if (n > GLYPH_ATLAS_MAX_GLYPHS || bottom <= top)
+        return false;
+    if (top < 0)
+        top = 0;
+    if (bottom > SSD1306_FLUSH_PAGES * 8)
+        bottom = SSD1306_FLUSH_PAGES * 8;
+    page0 = top / 8;
+    pages = (bottom - 1) / 8 - page0 + 1;
+
+    size_t need = 0;
+    for (const char *p = chars; *p; p++)
+        need += (size_t)fontGlyph(font, *p)->xAdvance * pages;
+    if (need > GLYPH_ATLAS_MAX_BYTES)
+        return false;
+
+    // Same pixel placement as Adafruit_GFX::drawChar() for a custom font:
+    // bits are packed MSB first, row after row, without row padding
+    for (const char *p = chars; *p; p++)
+    {
+        const GFXglyph *g = fontGlyph(font, *p);
+        Sprite &s = sprites[count++];
+        s.c = *p;
+        s.width = g->xAdvance;
+        s.offset = used;
+        uint8_t *cell = data + used;
+        memset(cell, 0, (size_t)s.width * pages);
+        used += (size_t)s.width * pages;
+
+        const uint8_t *bits = font->bitmap + g->bitmapOffset;
+        uint8_t byte = 0;
+        unsigned bit = 0;
+        for (int yy = 0; yy < g->height; yy++)
+        {
+            for (int xx = 0; xx < g->width; xx++)
+            {
+                if (!(bit++ & 7))
+                    byte = *bits++;
+                bool on = byte & 0x80;
+                byte <<= 1;
+                if (!on)
+                    continue;
+                int col = g->xOffset + xx;
+                int row = baseline + g->yOffset + yy - page0 * 8;
+                if (col < 0 || col >= s.width || row < 0 || row >= pages * 8)
+                    continue;
+                cell[col * pages + row / 8] |= 1 << (row & 7);
+            }
+        }
+    }
+    return true;
+}
+
+const GlyphAtlas::Sprite *GlyphAtlas::find(char c) const
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (sprites[i].c == c)
+            return &sprites[i];
+    }
+    return nullptr;
+}
+
+bool GlyphAtlas::covers(const char *text) const
+{
+    for (; *text; text++)
+    {
+        if (!find(*text))
+            return false;
+    }
+    return ready();
+}
+
+void GlyphAtlas::clear(uint8_t *frame, int16_t x0, int16_t x1) const
+{
+    if (x0 < 0)
+        x0 = 0;
+    if (x1 >= SSD1306_FLUSH_WIDTH)
+        x1 = SSD1306_FLUSH_WIDTH - 1;
+    if (x1 < x0)
+        return;
+    for (uint8_t p = 0; p < pages; p++)
+        memset(frame + (page0 + p) * SSD1306_FLUSH_WIDTH + x0, 0, x1 - x0 + 1);
+}
+
+int16_t GlyphAtlas::draw(uint8_t *frame, int16_t x, const char *text) const
+{
+    for (; *text; text++)
+    {
+        const Sprite *s = find(*text);
+        if (!s)
+            continue;
+        const uint8_t *src = data + s->offset;
+        for (uint8_t col = 0; col < s->width; col++, src += pages)
+        {
+            int16_t fx = x + col;
+            if (fx < 0 || fx >= SSD1306_FLUSH_WIDTH)
+                continue;
+            uint8_t *dst = frame + page0 * SSD1306_FLUSH_WIDTH + fx;
+            for (uint8_t p = 0; p < pages; p++, dst += SSD1306_FLUSH_WIDTH)
+                *dst = src[p];
+        }
+        x += s->width;
+    }
+    return x;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file glyphAtlas.h
+ * @brief Pre-rendered 1-bpp glyphs for fixed-position numerals.
+ *
+ * Rasterising a GFX font goes pixel by pixel through drawPixel(). For text
+ * that always sits on the same baseline (the tuner frequency, the volume)
+ * the glyphs can instead be rendered once into sprites in the SSD1306 page
+ * layout: one byte per column per 8-row page, bit 0 at the top. Drawing a
+ * string is then a byte copy per column and page into the frame buffer.
+ *
+ * A sprite covers the glyph's full advance and every page the character
+ * set touches at the given baseline, so drawing a glyph also clears the
+ * cell behind it.
+ */
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <gfxfont.h>
+
+#define GLYPH_ATLAS_MAX_GLYPHS 16
+#define GLYPH_ATLAS_MAX_BYTES 1024
+
+class GlyphAtlas
+{
+public:
+    // Render 'chars' of 'font' for text with its baseline at row 'baseline'.
+    // Returns false if the set does not fit the atlas.
+    bool build(const GFXfont *font, const char *chars, int16_t baseline);
+    bool ready() const { return count > 0; }
+
+    // True if every character of 'text' is in the atlas
+    bool covers(const char *text) const;
+
+    // Zero columns x0..x1 of the atlas pages in 'frame'
+    void clear(uint8_t *frame, int16_t x0, int16_t x1) const;
+
+    // Copy the glyphs of 'text' into 'frame' with the cursor at column 'x',
+    // like print() after setCursor(x, baseline). Characters not in the
+    // atlas are skipped. Returns the cursor after the text.
+    int16_t draw(uint8_t *frame, int16_t x, const char *text) const;
+
+    uint8_t firstPage() const { return page0; }
+    uint8_t pageCount() const { return pages; }
+    size_t bytes() const { return used; }
+
+private:
+    struct Sprite
+    {
+        char c;
+        uint8_t width;     // columns, the glyph's xAdvance
+        uint16_t offset;   // into data[], 'pages' bytes per column
+    };
+
+    const Sprite *find(char c) const;
+
+    Sprite sprites[GLYPH_ATLAS_MAX_GLYPHS];
+    uint8_t count = 0;
+    uint8_t page0 = 0;
+    uint8_t pages = 0;
+    size_t used = 0;
+    uint8_t data[GLYPH_ATLAS_MAX_BYTES];
+};
+
+#endif // GLYPHATLAS_H
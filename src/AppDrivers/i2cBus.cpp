@@ -0,0 +1,294 @@
+#include "i2cBus.h"
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/event_groups.h>
+
+static const uint8_t queueDepth[I2C_PRIO_COUNT] = {4, 4, 12};
+static const char *const deviceNames[I2C_DEV_COUNT] = {"radio", "oled", "codec"};
+
+struct I2cXfer {
+    uint8_t dev;
+    uint8_t addr;
+    uint8_t len;        // bytes in data[] (write), 0 for callbacks/sync
+    int8_t waiter;      // done bit of a blocked caller, -1 if none
+    I2cBusFn fn;        // callback transaction, or null for a write
+    void *ctx;
+    uint32_t queuedUs;
+    uint8_t data[I2C_BUS_XFER_MAX];
+};
+
+static QueueHandle_t queues[I2C_PRIO_COUNT];
+static SemaphoreHandle_t pending = nullptr;     // one count per queued transaction
+static EventGroupHandle_t doneBits = nullptr;   // one bit per waiter slot
+static bool waiterResult[I2C_BUS_WAITERS];
+static uint8_t waiterFree = (1u << I2C_BUS_WAITERS) - 1;
+static portMUX_TYPE waiterLock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t busTask = nullptr;
+
+static volatile uint16_t queuedCount[I2C_DEV_COUNT];
+static uint32_t deviceClock[I2C_DEV_COUNT];
+static uint32_t activeClock = 0;
+static I2cDeviceStats stats[I2C_DEV_COUNT];
+
+static bool syncMarker(void *)
+{
+    return true;
+}
+
+static void selectClock(uint8_t dev)
+{
+    if (deviceClock[dev] && deviceClock[dev] != activeClock)
+    {
+        Wire.setClock(deviceClock[dev]);
+        activeClock = deviceClock[dev];
+    }
+}
+
+static bool execute(I2cXfer &x)
+{
+    if (busTask)
+    {
+        portENTER_CRITICAL(&waiterLock);
+        queuedCount[x.dev]--;
+        portEXIT_CRITICAL(&waiterLock);
+    }
+
+    if (x.fn == syncMarker)
+    {
+        // Only marks a point in the queue, not bus traffic
+        if (x.waiter >= 0)
+        {
+            waiterResult[x.waiter] = true;
+            xEventGroupSetBits(doneBits, 1u << x.waiter);
+        }
+        return true;
+    }
+
+    uint32_t start = micros();
+    I2cDeviceStats &st = stats[x.dev];
+    uint32_t waitUs = start - x.queuedUs;
+    if (waitUs > st.maxWaitUs)
+        st.maxWaitUs = waitUs;
+
+    selectClock(x.dev);
+    bool ok = true;
+    if (x.fn)
+    {
+        ok = x.fn(x.ctx);
+        // Drivers may change the clock themselves (Adafruit restores its own)
+        activeClock = 0;
+    }
+    else if (x.len)
+    {
+        Wire.beginTransmission(x.addr);
+        Wire.write(x.data, x.len);
+        ok = Wire.endTransmission() == 0;
+        st.bytes += x.len;
+    }
+
+    uint32_t us = micros() - start;
+    st.transactions++;
+    st.busUs += us;
+    if (us > st.maxUs)
+        st.maxUs = us;
+    if (!ok)
+        st.errors++;
+
+    if (x.waiter >= 0)
+    {
+        waiterResult[x.waiter] = ok;
+        xEventGroupSetBits(doneBits, 1u << x.waiter);
+    }
+    return ok;
+}
+
+static void i2cBusTask(void *pvParameters)
+{
+    I2cXfer x;
+    while (true)
+    {
+        xSemaphoreTake(pending, portMAX_DELAY);
+        for (int p = 0; p < I2C_PRIO_COUNT; p++)
+        {
+            if (xQueueReceive(queues[p], &x, 0) == pdTRUE)
+            {
+                execute(x);
+                break;
+            }
+        }
+    }
+}
+
+static int8_t takeWaiter()
+{
+    for (;;)
+    {
+        portENTER_CRITICAL(&waiterLock);
+        for (int8_t i = 0; i < I2C_BUS_WAITERS; i++)
+        {
+            if (waiterFree & (1u << i))
+            {
+                waiterFree &= ~(1u << i);
+                portEXIT_CRITICAL(&waiterLock);
+                return i;
+            }
+        }
+        portEXIT_CRITICAL(&waiterLock);
+        vTaskDelay(1);
+    }
+}
+
+static void releaseWaiter(int8_t i)
+{
+    portENTER_CRITICAL(&waiterLock);
+    waiterFree |= 1u << i;
+    portEXIT_CRITICAL(&waiterLock);
+}
+
+static bool enqueue(I2cPriority prio, I2cXfer &x, TickType_t timeout)
+{
+    x.queuedUs = micros();
+    portENTER_CRITICAL(&waiterLock);
+    queuedCount[x.dev]++;
+    portEXIT_CRITICAL(&waiterLock);
+    if (xQueueSend(queues[prio], &x, timeout) != pdTRUE)
+    {
+        portENTER_CRITICAL(&waiterLock);
+        queuedCount[x.dev]--;
+        portEXIT_CRITICAL(&waiterLock);
+        return false;
+    }
+    xSemaphoreGive(pending);
+    return true;
+}
+
+// Queue 'x' and wait for it. The timeout covers queueing only: once
+// queued, the transaction may reference the caller's stack, so we always
+// wait for it to run.
+static bool runAndWait(I2cPriority prio, I2cXfer &x, TickType_t timeout)
+{
+    x.waiter = takeWaiter();
+    xEventGroupClearBits(doneBits, 1u << x.waiter);
+    if (!enqueue(prio, x, timeout))
+    {
+        releaseWaiter(x.waiter);
+        return false;
+    }
+    xEventGroupWaitBits(doneBits, 1u << x.waiter, pdTRUE, pdTRUE, portMAX_DELAY);
+    bool ok = waiterResult[x.waiter];
+    releaseWaiter(x.waiter);
+    return ok;
+}
+
+bool i2cBusBegin(int sda, int scl, uint32_t defaultHz)
+{
+    if (busTask)
+        return true;
+
+    Wire.begin(sda, scl, defaultHz);
+    activeClock = defaultHz;
+    for (int d = 0; d < I2C_DEV_COUNT; d++)
+    {
+        if (!deviceClock[d])
+            deviceClock[d] = defaultHz;
+    }
+
+    for (int p = 0; p < I2C_PRIO_COUNT; p++)
+        queues[p] = xQueueCreate(queueDepth[p], sizeof(I2cXfer));
+    pending = xSemaphoreCreateCounting(32, 0);
+    doneBits = xEventGroupCreate();
+
+    // Above the UI and input tasks, below audio: a transaction is short and
+    // a waiting tune request should not sit behind a screen redraw
+    if (xTaskCreatePinnedToCore(i2cBusTask, "I2cBus", 3072, nullptr, 3, &busTask, 0) != pdPASS)
+    {
+        Serial.println("I2cBus: Failed to create task");
+        busTask = nullptr;
+        return false;
+    }
+    Serial.printf("I2cBus: started, default clock %lu Hz\n", defaultHz);
+    return true;
+}
+
+void i2cBusSetClock(I2cDevice dev, uint32_t hz)
+{
+    deviceClock[dev] = hz;
+}
+
+uint32_t i2cBusGetClock(I2cDevice dev)
+{
+    return deviceClock[dev];
+}
+
+bool i2cBusWrite(I2cDevice dev, I2cPriority prio, uint8_t addr, const uint8_t *data, size_t len, TickType_t timeout)
+{
+    if (len > I2C_BUS_XFER_MAX)
+        return false;
+
+    I2cXfer x;
+    x.dev = dev;
+    x.addr = addr;
+    x.len = len;
+    x.waiter = -1;
+    x.fn = nullptr;
+    x.ctx = nullptr;
+    memcpy(x.data, data, len);
+
+    if (!busTask)
+    {
+        x.queuedUs = micros();
+        return execute(x);
+    }
+    return enqueue(prio, x, timeout);
+}
+
+bool i2cBusRun(I2cDevice dev, I2cPriority prio, I2cBusFn fn, void *ctx, TickType_t timeout)
+{
+    I2cXfer x;
+    x.dev = dev;
+    x.addr = 0;
+    x.len = 0;
+    x.waiter = -1;
+    x.fn = fn;
+    x.ctx = ctx;
+
+    if (!busTask)
+    {
+        x.queuedUs = micros();
+        return execute(x);
+    }
+    return runAndWait(prio, x, timeout);
+}
+
+bool i2cBusSync(I2cDevice dev, I2cPriority prio, TickType_t timeout)
+{
+    if (!busTask)
+        return true;
+    return i2cBusRun(dev, prio, syncMarker, nullptr, timeout);
+}
+
+uint16_t i2cBusPending(I2cDevice dev)
+{
+    return queuedCount[dev];
+}
+
+size_t i2cBusSliceBytes(I2cDevice dev)
+{
+    // About 9 clocks per byte on the wire
+    size_t n = (uint64_t)deviceClock[dev] * I2C_BUS_SLICE_US / 9000000;
+    if (n < 16)
+        n = 16;
+    return n > I2C_BUS_XFER_MAX ? I2C_BUS_XFER_MAX : n;
+}
+
+I2cDeviceStats i2cBusGetStats(I2cDevice dev)
+{
+    I2cDeviceStats st = stats[dev];
+    st.clockHz = deviceClock[dev];
+    return st;
+}
+
+const char *i2cBusDeviceName(I2cDevice dev)
+{
+    return dev < I2C_DEV_COUNT ? deviceNames[dev] : "?";
+}
@@ -0,0 +1,99 @@
+/**
+ * @file i2cBus.h
+ * @brief Owner task for the shared I2C bus (Si4703, SSD1306, codec).
+ *
+ * All Wire traffic is queued to one task, which runs transactions strictly
+ * by priority: radio control (HIGH) before RSSI/status polls (NORMAL)
+ * before display data (LOW). Within a priority the order is FIFO, so a
+ * display flush split into slices still arrives in order, while a tune
+ * request only ever waits for the slice on the bus. Slices are sized from
+ * the device clock so one takes at most I2C_BUS_SLICE_US.
+ *
+ * Two kinds of transaction:
+ *  - i2cBusWrite(): a copied write of up to I2C_BUS_XFER_MAX bytes; returns
+ *    once queued.
+ *  - i2cBusRun(): a callback run on the bus task with exclusive access to
+ *    Wire, for drivers that talk to Wire themselves (Si4703, Adafruit);
+ *    the caller blocks until it has run.
+ *
+ * Before i2cBusBegin() everything runs inline in the caller.
+ */
+#ifndef I2CBUS_H
+#define I2CBUS_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+enum I2cDevice : uint8_t {
+    I2C_DEV_RADIO = 0,  ///< Si4703 FM tuner
+    I2C_DEV_OLED,       ///< SSD1306 display
+    I2C_DEV_CODEC,      ///< ES8388 (board variants)
+    I2C_DEV_COUNT
+};
+
+enum I2cPriority : uint8_t {
+    I2C_PRIO_HIGH = 0,  ///< tune/seek, volume
+    I2C_PRIO_NORMAL,    ///< RSSI and status polls
+    I2C_PRIO_LOW,       ///< display data
+    I2C_PRIO_COUNT
+};
+
+#define I2C_BUS_XFER_MAX 128   // largest queued write, Wire buffer size
+#define I2C_BUS_SLICE_US 2000  // target bus time of one display slice
+#define I2C_BUS_WAITERS 8      // concurrent blocking callers
+
+struct I2cDeviceStats {
+    uint32_t clockHz;
+    uint32_t transactions;
+    uint32_t bytes;        // queued writes only
+    uint32_t errors;       // NACK / failed callbacks
+    uint64_t busUs;        // total time on the bus
+    uint32_t maxUs;        // longest single transaction
+    uint32_t maxWaitUs;    // longest time queued before running
+};
+
+typedef bool (*I2cBusFn)(void *ctx);
+
+/**
+ * @brief Start Wire and the bus task.
+ */
+bool i2cBusBegin(int sda, int scl, uint32_t defaultHz = 100000);
+
+/**
+ * @brief Bus clock used for a device's transactions.
+ */
+void i2cBusSetClock(I2cDevice dev, uint32_t hz);
+uint32_t i2cBusGetClock(I2cDevice dev);
+
+/**
+ * @brief Queue a write to 'addr'. Blocks only while the queue is full.
+ * @return false if len is too large or the queue stayed full for 'timeout'
+ */
+bool i2cBusWrite(I2cDevice dev, I2cPriority prio, uint8_t addr, const uint8_t *data, size_t len,
+                 TickType_t timeout = portMAX_DELAY);
+
+/**
+ * @brief Run fn(ctx) on the bus task and wait for it.
+ * @return fn's result, false on timeout
+ */
+bool i2cBusRun(I2cDevice dev, I2cPriority prio, I2cBusFn fn, void *ctx, TickType_t timeout = portMAX_DELAY);
+
+/**
+ * @brief Wait until everything queued so far at 'prio' for 'dev' has run.
+ */
+bool i2cBusSync(I2cDevice dev, I2cPriority prio, TickType_t timeout = portMAX_DELAY);
+
+/**
+ * @brief Transactions queued for 'dev' that have not run yet.
+ */
+uint16_t i2cBusPending(I2cDevice dev);
+
+/**
+ * @brief Write size that keeps one transaction within I2C_BUS_SLICE_US.
+ */
+size_t i2cBusSliceBytes(I2cDevice dev);
+
+I2cDeviceStats i2cBusGetStats(I2cDevice dev);
+const char *i2cBusDeviceName(I2cDevice dev);
+
+#endif // I2CBUS_H
@@ -0,0 +1,75 @@
+#include <Arduino.h>
+#include "inputEvents.h"
+#include <atomic>
+
+static InputEvent fifo[INPUT_EVENT_QUEUE_LEN];
+static std::atomic<uint32_t> head{0}; // written by the producer
+static std::atomic<uint32_t> tail{0}; // written by the consumer
+
+static portMUX_TYPE pushLock = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t consumerTask = nullptr;
+static uint32_t consumerBits = 0;
+
+static uint32_t pushed = 0;
+static uint32_t overflows = 0;
+static uint16_t highWater = 0;
+static uint32_t popped = 0;    // consumer side
+static uint32_t maxWaitUs = 0;
+
+bool inputEventPush(const InputEvent &evt)
+{
+    portENTER_CRITICAL(&pushLock);
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t depth = h - tail.load(std::memory_order_acquire);
+    if (depth >= INPUT_EVENT_QUEUE_LEN)
+    {
+        overflows++;
+        portEXIT_CRITICAL(&pushLock);
+        return false;
+    }
+
+    fifo[h & (INPUT_EVENT_QUEUE_LEN - 1)] = evt;
+    head.store(h + 1, std::memory_order_release);
+    pushed++;
+    if (depth + 1 > highWater)
+        highWater = depth + 1;
+    portEXIT_CRITICAL(&pushLock);
+
+    if (consumerTask)
+        xTaskNotify(consumerTask, consumerBits, eSetBits);
+    return true;
+}
+
+bool inputEventPop(InputEvent &evt)
+{
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+        return false;
+
+    evt = fifo[t & (INPUT_EVENT_QUEUE_LEN - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    popped++;
+    uint32_t waitUs = micros() - evt.timeUs;
+    if (waitUs > maxWaitUs)
+        maxWaitUs = waitUs;
+    return true;
+}
+
+void inputEventSubscribe(TaskHandle_t task, uint32_t notifyBits)
+{
+    consumerBits = notifyBits;
+    consumerTask = task;
+}
+
+InputEventStats inputEventGetStats()
+{
+    InputEventStats st;
+    st.pushed = pushed;
+    st.overflows = overflows;
+    st.popped = popped;
+    st.maxWaitUs = maxWaitUs;
+    st.depth = head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    st.highWater = highWater;
+    return st;
+}
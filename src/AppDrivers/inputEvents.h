@@ -0,0 +1,56 @@
+/**
+ * @file inputEvents.h
+ * @brief Timestamped FIFO of opto and keypad events.
+ *
+ * Producers (the opto scan task and the keypad timer callbacks) serialize
+ * on a short spinlock; the single consumer pops without locking. Unlike the per-key
+ * latches of getOptoEvent(), events queue up in order and keep the time the
+ * filtered input actually changed, so nothing is lost between polls and the
+ * consumer can measure its own reaction latency.
+ *
+ * The consumer may register its task to be notified on every push. The UI
+ * task is the consumer; the stats record how long events waited for it.
+ */
+#ifndef INPUTEVENTS_H
+#define INPUTEVENTS_H
+
+#include <cstdint>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define INPUT_EVENT_QUEUE_LEN 32 // power of two
+
+enum InputSource : uint8_t {
+    INPUT_SRC_OPTO = 0,
+    INPUT_SRC_KEYPAD,
+};
+
+struct InputEvent
+{
+    uint8_t source;  // InputSource
+    uint8_t input;   // opto index, or Key bitmask for the keypad
+    uint8_t type;    // KeyEventType
+    uint8_t alarm;   // came through the minimum-latency path
+    uint32_t timeUs; // micros() when the filtered input changed
+};
+
+struct InputEventStats
+{
+    uint32_t pushed;
+    uint32_t overflows;  // events dropped because the FIFO was full
+    uint32_t popped;
+    uint32_t maxWaitUs;  // longest input change to pop
+    uint16_t depth;
+    uint16_t highWater;
+};
+
+// Producer side, task context
+bool inputEventPush(const InputEvent &evt);
+
+// Consumer side
+bool inputEventPop(InputEvent &evt);
+void inputEventSubscribe(TaskHandle_t task, uint32_t notifyBits);
+
+InputEventStats inputEventGetStats();
+
+#endif // INPUTEVENTS_H
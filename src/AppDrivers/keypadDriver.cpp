@@ -1,9 +1,41 @@
 #include "keypadDriver.h"
+#include "optoInDriver.h"
+#include "inputEvents.h"
+#include "setupDriver.h"
 #include "pins_new.h"
+#include "soc/gpio_struct.h"
+#include "esp_timer.h"
+#include "../SystemEvents.h"
 
-uint8_t volatile   g_keypadState, lastPressedKey=NONE,KeyUp = NONE;
-uint16_t volatile KeyTimer = 0; // Timer for key press duration
-bool ClearKeyUpFlag=0;
+static uint8_t lastRawKeys = NONE; // for press/release events on the bus
+
+static const uint8_t keyPins[4] = {KEY_PREVIOUS_PIN, KEY_NEXT_PIN, KEY_DOWN_PIN, KEY_UP_PIN};
+static const uint8_t keyBits[4] = {PREVIOUS, NEXT, DOWN, UP};
+static uint32_t keyMaskLo = 0, keyMaskHi = 0; // key pins in GPIO.in / GPIO.in1
+
+static esp_timer_handle_t debounceTimer = nullptr;
+static esp_timer_handle_t holdTimer = nullptr;
+static volatile uint32_t firstEdgeUs = 0;
+static volatile bool edgePending = false;
+
+static GestureEngine keyGestures;
+static KeypadStats keyStats = {};
+static volatile uint32_t lastEdgeUs = 0;
+
+static void keyDebounced(void *);
+static void keyHoldTick(void *);
+
+static void IRAM_ATTR keyEdgeIsr()
+{
+    if (!edgePending)
+    {
+        firstEdgeUs = (uint32_t)esp_timer_get_time();
+        edgePending = true;
+    }
+    // Restart, so the settle time counts from the last bounce
+    esp_timer_stop(debounceTimer);
+    esp_timer_start_once(debounceTimer, KEY_DEBOUNCE_US);
+}
 
 void keypadInit()
 {
@@ -14,72 +46,146 @@ void keypadInit()
 #ifdef NEW_VERSION_PINS
     pinMode(SEL_KEYPAD_PIN, OUTPUT_OPEN_DRAIN);
 #endif
-}
 
-void keypadRead()
-{
-    uint8_t tmpkey=NONE;
-    if (digitalRead(KEY_PREVIOUS_PIN) == LOW) tmpkey = PREVIOUS;
-    if (digitalRead(KEY_NEXT_PIN) == LOW) tmpkey |= NEXT;
-    if (digitalRead(KEY_DOWN_PIN) == LOW) tmpkey |= DOWN;
-    if (digitalRead(KEY_UP_PIN) == LOW) tmpkey |= UP;
-    if (tmpkey != NONE)
+    for (int i = 0; i < 4; i++)
     {
-        if (lastPressedKey != tmpkey)
-        {
-            lastPressedKey = tmpkey;
-            KeyTimer = 0;          // Reset timer for key press
-        }
-        else if (KeyTimer < 65535) KeyTimer+=1; // Increment timer for key press
-        g_keypadState = tmpkey; // Update current key state
+        if (keyPins[i] < 32)
+            keyMaskLo |= 1u << keyPins[i];
+        else
+            keyMaskHi |= 1u << (keyPins[i] - 32);
     }
-    else
-    {
-         if (ClearKeyUpFlag)
+
+    esp_timer_create_args_t args = {};
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.callback = keyDebounced;
+    args.name = "keyDebounce";
+    esp_timer_create(&args, &debounceTimer);
+    args.callback = keyHoldTick;
+    args.name = "keyHold";
+    esp_timer_create(&args, &holdTimer);
+
+    keypadLoadGestures();
+
+    for (int i = 0; i < 4; i++)
+        attachInterrupt(digitalPinToInterrupt(keyPins[i]), keyEdgeIsr, CHANGE);
+}
+
+// All four keys from one read of each GPIO input bank they live in
+static uint8_t readKeyPins()
+{
+    uint32_t lo = keyMaskLo ? GPIO.in : 0;
+    uint32_t hi = keyMaskHi ? GPIO.in1.val : 0;
+    uint8_t keys = NONE;
+    for (int i = 0; i < 4; i++)
     {
-        ClearKeyUpFlag = false; // Reset flag after reading
-        lastPressedKey=NONE;
-    }
-        KeyUp = lastPressedKey; // last pressed key when no key is pressed
-        KeyTimer = 0;
+        uint8_t pin = keyPins[i];
+        uint32_t level = pin < 32 ? (lo >> pin) & 1 : (hi >> (pin - 32)) & 1;
+        if (!level)
+            keys |= keyBits[i];
     }
+    return keys;
 }
 
-uint8_t  getKeypadState()
+static void emitKeyEvent(uint8_t keys, KeyEventType type, uint32_t timeUs)
 {
-  
-    return g_keypadState;
+    eventBusPublish(SysEvent::Key, keys, type);
+    InputEvent evt = {INPUT_SRC_KEYPAD, keys, (uint8_t)type, 0, timeUs};
+    inputEventPush(evt);
 }
 
-void clearCmd()
+// Gesture engine output: key index, or the chord's key mask for chords
+static void onKeyGesture(uint8_t input, KeyEventType type, uint32_t timeUs)
 {
-  g_keypadState = NONE; // Reset after reading
+    emitKeyEvent(type == KEY_EVENT_CHORD ? input : 1 << input, type, timeUs);
 }
 
-void clearUpKeys()
+void keypadLoadGestures()
 {
-    KeyUp = NONE; // Reset after reading
-    lastPressedKey = NONE; // Reset last pressed key
-    KeyTimer = 0; // Reset key timer
-    g_keypadState = NONE; // Reset current key state
+    keyGestures.init(Setup.gestureProfiles);
+    for (int i = 0; i < 4; i++)
+        keyGestures.setInputProfile(i, Setup.gestureProfileMap[GESTURE_KEY_BASE + i]);
+    keyGestures.addChord(PREVIOUS | NEXT, 0, KEY_CHORD_EXIT);
 }
 
-uint8_t  getUpKeys()
+uint8_t keypadActiveChord()
 {
-    return (KeyUp);
+    return keyGestures.activeChord();
 }
 
-bool CheckLongPress(uint16_t val)
+// esp_timer task: pins have been quiet for KEY_DEBOUNCE_US
+static void keyDebounced(void *)
 {
-    if (KeyTimer > val) // Long press threshold
-    {
-        return true;  // Long press detected
-    }
-    return false; // No long press
+    uint32_t edgeUs = firstEdgeUs;
+    edgePending = false;
+    uint8_t keys = readKeyPins();
+    if (keys == lastRawKeys)
+        return; // bounced back to where it was
+
+    bool wasHeld = lastRawKeys != NONE;
+    keypadProcess(keys, edgeUs);
+    if (keys != NONE && !wasHeld)
+        esp_timer_start_periodic(holdTimer, KEY_HOLD_TICK_US);
+    else if (keys == NONE)
+        esp_timer_stop(holdTimer); // nothing held, nothing to poll
 }
 
-void ClearNextUpKeys()
+// esp_timer task: runs only while a key is held, for the long-press and
+// repeat deadlines of the gesture engine
+static void keyHoldTick(void *)
 {
-    ClearKeyUpFlag=1;
-     KeyTimer = 0; // Reset key timer
-}
\ No newline at end of file
+    keypadProcess(lastRawKeys);
+}
+
+KeypadStats keypadGetStats()
+{
+    return keyStats;
+}
+
+uint32_t keypadLastEdgeUs()
+{
+    return lastEdgeUs;
+}
+
+uint8_t keypadReadRaw()
+{
+    uint8_t tmpkey=NONE;
+    if (digitalRead(KEY_PREVIOUS_PIN) == LOW) tmpkey = PREVIOUS;
+    if (digitalRead(KEY_NEXT_PIN) == LOW) tmpkey |= NEXT;
+    if (digitalRead(KEY_DOWN_PIN) == LOW) tmpkey |= DOWN;
+    if (digitalRead(KEY_UP_PIN) == LOW) tmpkey |= UP;
+    return tmpkey;
+}
+
+void keypadRead()
+{
+    keypadProcess(keypadReadRaw());
+}
+
+void keypadProcess(uint8_t tmpkey, uint32_t edgeUs)
+{
+    if (tmpkey != lastRawKeys)
+    {
+        uint32_t now = (uint32_t)micros();
+        if (edgeUs)
+        {
+            uint32_t lat = now - edgeUs;
+            keyStats.events++;
+            keyStats.lastUs = lat;
+            keyStats.sumUs += lat;
+            if (lat > keyStats.maxUs)
+                keyStats.maxUs = lat;
+        }
+        else
+        {
+            edgeUs = now;
+        }
+        lastEdgeUs = edgeUs;
+
+        keyGestures.update(tmpkey, edgeUs, onKeyGesture);
+        lastRawKeys = tmpkey;
+    }
+    else
+    {
+        keyGestures.update(tmpkey, (uint32_t)micros(), onKeyGesture);
+    }
+}
@@ -2,19 +2,41 @@
 
 #include <Arduino.h>
 #include "stdint.h"
+#include "gestureEngine.h"
 
 // Key enum for keypad
 enum Key { NONE, PREVIOUS=1, NEXT=2, DOWN=4, UP=8 };
 
-// Initialize keypad pins (call in setup)
+// Interrupt-driven timing
+#define KEY_DEBOUNCE_US     5000    // pins must be quiet this long after an edge
+#define KEY_HOLD_TICK_US    10000   // keypadProcess() rate while a key is held
+
+// Chord ids reported by keypadActiveChord() (the chord's key mask)
+#define KEY_CHORD_EXIT (PREVIOUS | NEXT)
+
+// Edge-to-event latency of debounced key changes
+struct KeypadStats
+{
+    uint32_t events;
+    uint32_t lastUs;
+    uint32_t maxUs;
+    uint64_t sumUs;
+};
+
+// Initialize keypad pins, edge interrupts and debounce timers (call in setup)
 void keypadInit();
 
 // Read the current key state
 void  keypadRead();
 
-uint8_t  getKeypadState();
-uint8_t  getUpKeys();
-void clearCmd(); // Clear command state after reading
-void clearUpKeys(); // Clear up keys state after reading
-bool CheckLongPress(uint16_t val); // Check if a key is pressed for a long duration
-void ClearNextUpKeys(); // Clear next up keys flag
\ No newline at end of file
+// keypadRead() split in its hardware and logic halves
+uint8_t keypadReadRaw();          // sample the key pins, returns a Key bitmask
+void  keypadProcess(uint8_t raw, uint32_t edgeUs = 0); // update state/timers from one sample
+KeypadStats keypadGetStats();
+uint32_t keypadLastEdgeUs();      // micros() of the pin edge behind the latest key change
+
+// Gesture recognition (long/double/repeat/chord), timing from Setup
+void keypadLoadGestures();   // re-read Setup.gestureProfiles after a change
+uint8_t keypadActiveChord(); // chord currently held, or GESTURE_NO_CHORD
+
+// Key changes and gestures reach the UI as events through inputEvents.h
\ No newline at end of file
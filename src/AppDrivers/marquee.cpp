@@ -0,0 +1,59 @@
+#include "marquee.h"
+#include "displayFlush.h"
+#include <cstring>
+
+void Marquee::begin(uint16_t cols, uint8_t pg, uint8_t c0, uint8_t c1)
+{
+    if (c1 >= SSD1306_FLUSH_WIDTH)
+        c1 = SSD1306_FLUSH_WIDTH - 1;
+    if (c0 > c1)
+        c0 = c1;
+    if (cols > MARQUEE_MAX_COLS - MARQUEE_GAP_COLS)
+        cols = MARQUEE_MAX_COLS - MARQUEE_GAP_COLS;
+    page = pg < SSD1306_FLUSH_PAGES ? pg : SSD1306_FLUSH_PAGES - 1;
+    col0 = c0;
+    col1 = c1;
+    textCols = cols;
+    period = cols + MARQUEE_GAP_COLS;
+    pos = 0;
+    memset(strip, 0, sizeof(strip));
+}
+
+void Marquee::setPixel(int16_t x, int16_t y)
+{
+    if (x < 0 || x >= textCols || y < 0 || y > 7)
+        return;
+    strip[x] |= 1 << y;
+}
+
+bool Marquee::step(uint8_t cols)
+{
+    if (!scrolling())
+        return false;
+    pos = (pos + cols) % period;
+    return true;
+}
+
+void Marquee::blit(uint8_t *frame) const
+{
+    uint8_t *dst = frame + page * SSD1306_FLUSH_WIDTH + col0;
+    uint16_t w = width();
+    if (!scrolling())
+    {
+        memcpy(dst, strip, textCols);
+        memset(dst + textCols, 0, w - textCols);
+        return;
+    }
+
+    // Window may wrap from the gap back to the start of the text
+    uint16_t first = period - pos;
+    if (first > w)
+        first = w;
+    memcpy(dst, strip + pos, first);
+    memcpy(dst + first, strip, w - first);
+}
+
+void Marquee::clear(uint8_t *frame) const
+{
+    memset(frame + page * SSD1306_FLUSH_WIDTH + col0, 0, width());
+}
@@ -0,0 +1,58 @@
+/**
+ * @file marquee.h
+ * @brief One-page scrolling text strip for the SSD1306.
+ *
+ * The text is rendered once into a strip in the SSD1306 page layout (one
+ * byte per column, 8 rows). Scrolling moves a window over the strip and
+ * copies it into one page of the frame buffer, so a step costs a column
+ * copy and, after DisplayFlush, one page window on the bus. Text that fits
+ * the window is shown without scrolling.
+ *
+ * The SSD1306 hardware scroll is not used: it only rotates the 128 columns
+ * already in the controller's RAM, so it cannot bring in text wider than
+ * the panel, and every other write has to stop it first.
+ */
+#ifndef MARQUEE_H
+#define MARQUEE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define MARQUEE_MAX_COLS 512   // strip width, about 80 characters of the 6 px font
+#define MARQUEE_GAP_COLS 24    // blank columns between the end and the restart
+
+class Marquee
+{
+public:
+    // Clear the strip for new text 'textCols' wide, shown on 'page' between
+    // columns col0..col1. Draw the text with setPixel() afterwards.
+    void begin(uint16_t textCols, uint8_t page, uint8_t col0, uint8_t col1);
+    void setPixel(int16_t x, int16_t y);
+
+    bool empty() const { return textCols == 0; }
+    bool scrolling() const { return textCols > width(); }
+
+    // Move the window 'cols' to the left; false if nothing moved
+    bool step(uint8_t cols);
+
+    // Copy the visible window into 'frame' (SSD1306 page layout)
+    void blit(uint8_t *frame) const;
+
+    // Blank the window in 'frame'
+    void clear(uint8_t *frame) const;
+
+    uint16_t offset() const { return pos; }
+
+private:
+    uint16_t width() const { return col1 - col0 + 1; }
+
+    uint8_t strip[MARQUEE_MAX_COLS];
+    uint16_t textCols = 0;
+    uint16_t period = 0;     // text plus gap, the scroll wraps here
+    uint16_t pos = 0;
+    uint8_t page = 0;
+    uint8_t col0 = 0;
+    uint8_t col1 = 0;
+};
+
+#endif // MARQUEE_H
@@ -1,24 +1,22 @@
-#define WINDOW 128
 #include <Arduino.h>
 #include "soc/gpio_struct.h"
 #include "pins.h"
 #include "optoInDriver.h"
+#include "inputEvents.h"
+#include "gestureEngine.h"
+#include "setupDriver.h"
+#include "../SystemEvents.h"
 
-uint16_t sample_buffer[WINDOW];
-uint8_t acc[NUM_INPUTS] = {0};
-uint8_t pos = 0;
 uint16_t optoInFiltered = 0;
-uint8_t THRESHOLD = 35;
 
-#define LONG_PRESS_TICKS 300 // 3 seconds win 10ms every loop
-#define DOUBLE_PRESS_TICKS 30
-
-static uint16_t prevOptoInFiltered = 0;
-static uint16_t longPressCounter[NUM_INPUTS] = {0};
-static uint16_t doublePressCounter[NUM_INPUTS] = {0};
-static uint8_t doublePressPending[NUM_INPUTS] = {0};
+static OptoFilter optoFilter;
+static GestureEngine optoGestures;
+static uint16_t optoGestureState = 0; // filtered word as the gesture engine sees it
+static uint8_t optoDecimation = 0;
 static KeyEventType KeyEventTypeArr[NUM_INPUTS] = {KEY_EVENT_NONE};
 static uint16_t KeyEventFlag = 0;
+static uint16_t optoAlarmMask = 0;
+static uint32_t optoChangeUs[NUM_INPUTS]; // when each filtered bit last changed
 
 /**
  * @brief Initialize opto input scanning hardware and buffers.
@@ -40,14 +38,11 @@ void scanOptosInit(uint8_t threshold)
     pinMode(optoIn7, INPUT_PULLUP);
 
     // Clear accumulators and sample buffer
-    for (int i = 0; i < NUM_INPUTS; i++)
-        acc[i] = 0;
-    for (int i = 0; i < WINDOW; i++)
-        sample_buffer[i] = 0;
-
-    pos = 0;
+    optoFilter.init(threshold);
     optoInFiltered = 0;
-    THRESHOLD = threshold;
+    optoGestureState = 0;
+    loadOptoGestures();
+    setOptoAlarmMask(Setup.optoAlarmMask);
 }
 
 /**
@@ -78,21 +73,15 @@ void scanOptos(void)
     {
         optoIn_assembled = ((optoInHi << 7) + optoInLo) ^ 0x3fff;
         // All rows scanned, process the 16-bit word
-        uint16_t old_sample = sample_buffer[pos];
-        sample_buffer[pos] = optoIn_assembled;
-
-        for (int i = 0; i < NUM_INPUTS; i++)
+        uint16_t changed = optoInFiltered ^ optoFilter.update(optoIn_assembled);
+        optoInFiltered ^= changed;
+        if (changed)
         {
-            acc[i] -= (old_sample >> i) & 1;
-            acc[i] += (optoIn_assembled >> i) & 1;
-            if (acc[i] >= THRESHOLD)
-                optoInFiltered |= (1 << i);
-            else
-                optoInFiltered &= ~(1 << i);
+            uint32_t now = micros();
+            for (int i = 0; i < NUM_INPUTS; i++)
+                if ((changed >> i) & 1)
+                    optoChangeUs[i] = now;
         }
-        pos++;
-        if (pos >= WINDOW)
-            pos = 0;
         optoIn_assembled = 0; // Reset for next scan cycle
         current_row = 0;
     }
@@ -107,62 +96,48 @@ uint16_t getOptoInFiltered(void)
     return optoInFiltered;
 }
 
+// Latch the event for the getOptoEvent() pollers and publish it on the bus
+static void onOptoEvent(uint8_t input, KeyEventType type, uint32_t timeUs)
+{
+    KeyEventTypeArr[input] = type;
+    KeyEventFlag |= (1 << input);
+    eventBusPublish(SysEvent::Opto, input, type);
+
+    InputEvent evt;
+    evt.source = INPUT_SRC_OPTO;
+    evt.input = input;
+    evt.type = type;
+    evt.alarm = (optoAlarmMask >> input) & 1;
+    evt.timeUs = type == KEY_EVENT_PRESS || type == KEY_EVENT_RELEASE ? optoChangeUs[input] : timeUs;
+    inputEventPush(evt);
+}
+
 /**
  * @brief Update key event states for opto inputs (press, release, longpress).
  *        Should be called periodically after scanOptos().
  */
 void updateOptoEvents()
 {
-    static uint8_t cnt = 0;
-    static bool longPressDetected[NUM_INPUTS] = {0};  // Prevents duplicate longpresses
- scanOptos();
-
-    if (cnt < 10)
-    {
-        cnt++;
-        return;
-    } // ~30ms debounce
-    cnt = 0;
-//2 is since 0,1 we use for on/off
-    for (int i = 2; i < NUM_INPUTS; i++)
-    {
-        bool prev = (prevOptoInFiltered >> i) & 1;
-        bool curr = (optoInFiltered >> i) & 1;
-
-        // Just pressed (rising edge)
-        if (!prev && curr)
-        {
-            KeyEventTypeArr[i] = KEY_EVENT_PRESS;
-            KeyEventFlag |= (1 << i);
-            longPressCounter[i] = 0;
-            longPressDetected[i] = false;
-        }
-        // Just released (falling edge)
-        else if (prev && !curr)
-        {
-            KeyEventTypeArr[i] = KEY_EVENT_RELEASE;
-            KeyEventFlag |= (1 << i);
-            longPressCounter[i] = 0;
-            longPressDetected[i] = false;
-        }
-        // Still pressed
-        else if (curr)
-        {
-            if (!longPressDetected[i])
-            {
-                longPressCounter[i]++;
-                if (longPressCounter[i] >= LONG_PRESS_TICKS)
-                {
-                    KeyEventTypeArr[i] = KEY_EVENT_LONGPRESS;
-                    KeyEventFlag |= (1 << i);
-                    longPressDetected[i] = true; // Only one longpress per hold
-                }
-            }
-        }
-        // Not pressed at all, do nothing
-    }
+    scanOptos();
+
+    // Inputs 0,1 are on/off contacts and raise no events. The rest are
+    // sampled every OPTO_EVENT_DECIMATION+1 scans (~30ms debounce), alarm
+    // inputs on every scan.
+    bool full = optoDecimation >= OPTO_EVENT_DECIMATION;
+    optoDecimation = full ? 0 : optoDecimation + 1;
+    uint16_t mask = (full ? 0xFFFF : optoAlarmMask) & ~0x0003;
+    optoGestureState = (optoGestureState & ~mask) | (optoInFiltered & mask);
+    optoGestures.update(optoGestureState, micros(), onOptoEvent);
+}
 
-    prevOptoInFiltered = optoInFiltered;
+/**
+ * @brief (Re)load gesture timing for the opto inputs from Setup.
+ */
+void loadOptoGestures()
+{
+    optoGestures.init(Setup.gestureProfiles);
+    for (int i = 0; i < NUM_INPUTS; i++)
+        optoGestures.setInputProfile(i, Setup.gestureProfileMap[GESTURE_OPTO_BASE + i]);
 }
 
 // Call this to get and clear the event for a key
@@ -200,4 +175,22 @@ int32_t getOptoEventFlag(void)
         }
     }
     return -1;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Select the inputs that bypass the event decimation (alarms).
+ *        With OPTO_FILTER_VERTICAL they also get a short integrator
+ *        (ON after 4 samples, OFF after 4) instead of the full window.
+ * @param mask Bitmask of opto inputs.
+ */
+void setOptoAlarmMask(uint16_t mask)
+{
+    optoAlarmMask = mask;
+#ifdef OPTO_FILTER_VERTICAL
+    for (int i = 0; i < NUM_INPUTS; i++)
+    {
+        if ((mask >> i) & 1)
+            optoFilter.setInputLevels(i, 4, 3, 7);
+    }
+#endif
+}
@@ -13,28 +13,19 @@
  *  - getOptoInFiltered(): Get the current filtered opto input bitmask.
  *  - getOptoEvent(uint8_t keyIndex): Get and clear the event for a specific key.
  *  - getOptoEventFlag(): Get the index of the first key with a pending event.
+ *  - setOptoAlarmMask(uint16_t mask): Minimum-latency handling for alarm inputs.
+ *
+ * Every event is also queued with its timestamp in inputEvents.h.
+ *
+ * The filtering logic lives in optoInLogic.h, gestures in gestureEngine.h.
  */
 #ifndef OPTOINDRIVER_H
 #define OPTOINDRIVER_H
 
 #include <cstdint>
+#include "optoInLogic.h"
 
-#define NUM_INPUTS 14
-#define WINDOW 128
-
-typedef enum {
-    KEY_EVENT_NONE      = 0,
-    KEY_EVENT_PRESS     = 1,
-    KEY_EVENT_RELEASE   = 2,
-    KEY_EVENT_LONGPRESS = 3,
-    KEY_EVENT_DOUBLE    = 4,
-} KeyEventType;
-
-extern uint16_t sample_buffer[WINDOW];
-extern uint8_t acc[NUM_INPUTS];
-extern uint8_t pos;
 extern uint16_t optoInFiltered;
-extern uint8_t THRESHOLD;
 
 void scanOptosInit(uint8_t threshold);
 void updateOptoEvents();
@@ -42,5 +33,7 @@ uint16_t getOptoInFiltered(void);
 void scanOptos(void);
 KeyEventType getOptoEvent(uint8_t keyIndex);
 int32_t getOptoEventFlag(void);
+void setOptoAlarmMask(uint16_t mask);
+void loadOptoGestures();
 
 #endif // OPTOINDRIVER_H
\ No newline at end of file
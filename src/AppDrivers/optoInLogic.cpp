@@ -0,0 +1,108 @@
+#include "optoInLogic.h"
+#include <cstring>
+
+void OptoWindowFilter::init(uint8_t thresh)
+{
+    memset(samples, 0, sizeof(samples));
+    memset(acc, 0, sizeof(acc));
+    pos = 0;
+    threshold = thresh;
+    filtered = 0;
+}
+
+uint16_t OptoWindowFilter::update(uint16_t raw)
+{
+    uint16_t old_sample = samples[pos];
+    samples[pos] = raw;
+
+    for (int i = 0; i < NUM_INPUTS; i++)
+    {
+        acc[i] -= (old_sample >> i) & 1;
+        acc[i] += (raw >> i) & 1;
+        if (acc[i] >= threshold)
+            filtered |= (1 << i);
+        else
+            filtered &= ~(1 << i);
+    }
+    pos++;
+    if (pos >= WINDOW)
+        pos = 0;
+    return filtered;
+}
+
+// Store 'value' for one input into a bit-sliced constant
+static void setSliced(uint32_t *planes, uint8_t input, uint8_t value)
+{
+    for (int k = 0; k < OPTO_VC_BITS; k++)
+    {
+        if (value & (1 << k))
+            planes[k] |= 1u << input;
+        else
+            planes[k] &= ~(1u << input);
+    }
+}
+
+// Per input: 1 where counter >= level
+static uint32_t slicedAtLeast(const uint32_t *c, const uint32_t *level)
+{
+    uint32_t gt = 0, eq = 0xFFFFFFFF;
+    for (int k = OPTO_VC_BITS - 1; k >= 0; k--)
+    {
+        gt |= eq & c[k] & ~level[k];
+        eq &= ~(c[k] ^ level[k]);
+    }
+    return gt | eq;
+}
+
+// Per input: 1 where counter == level
+static uint32_t slicedEqual(const uint32_t *c, const uint32_t *level)
+{
+    uint32_t eq = 0xFFFFFFFF;
+    for (int k = 0; k < OPTO_VC_BITS; k++)
+        eq &= ~(c[k] ^ level[k]);
+    return eq;
+}
+
+void OptoVerticalFilter::init(uint8_t thresh)
+{
+    memset(plane, 0, sizeof(plane));
+    state = 0;
+    filtered = 0;
+    if (thresh < 1)
+        thresh = 1;
+    for (uint8_t i = 0; i < OPTO_VC_MAX_INPUTS; i++)
+        setInputLevels(i, thresh, thresh - 1, WINDOW - 1);
+}
+
+void OptoVerticalFilter::setInputLevels(uint8_t input, uint8_t on, uint8_t off, uint8_t capLevel)
+{
+    if (input >= OPTO_VC_MAX_INPUTS)
+        return;
+    setSliced(onLevel, input, on);
+    setSliced(offLevel, input, off);
+    setSliced(cap, input, capLevel);
+}
+
+uint32_t OptoVerticalFilter::update32(uint32_t raw)
+{
+    uint32_t nonZero = 0;
+    for (int k = 0; k < OPTO_VC_BITS; k++)
+        nonZero |= plane[k];
+
+    // Count up where ON and below cap, down where OFF and above zero
+    uint32_t carry = raw & ~slicedEqual(plane, cap);
+    uint32_t borrow = ~raw & nonZero;
+    for (int k = 0; k < OPTO_VC_BITS; k++)
+    {
+        uint32_t c = plane[k];
+        plane[k] = c ^ carry ^ borrow;
+        carry &= c;
+        borrow &= ~c;
+    }
+
+    // Hysteresis: switch on at onLevel, off at or below offLevel
+    uint32_t on = slicedAtLeast(plane, onLevel);
+    uint32_t aboveOff = ~slicedAtLeast(offLevel, plane);
+    state = (state | on) & (on | aboveOff);
+    return state;
+}
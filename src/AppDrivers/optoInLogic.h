@@ -0,0 +1,92 @@
+/**
+ * @file optoInLogic.h
+ * @brief Hardware-independent part of the opto input driver.
+ *
+ * The filters only see the raw 14-bit input word and a
+ * scan tick, so they build on any C++ toolchain. optoInDriver.cpp wires them
+ * to the opto matrix GPIOs; host tools and simulators can feed them
+ * recorded or synthetic waveforms instead.
+ */
+#ifndef OPTOINLOGIC_H
+#define OPTOINLOGIC_H
+
+#include <cstdint>
+
+#define NUM_INPUTS 14
+#define WINDOW 128
+
+#define OPTO_EVENT_DECIMATION 10 // event detection runs every 10th call
+
+#define OPTO_VC_BITS 7     // vertical counter width, counts 0..127
+#define OPTO_VC_MAX_INPUTS 32
+
+// Uncomment to filter the optos with OptoVerticalFilter instead of the
+// 128-sample moving window
+// #define OPTO_FILTER_VERTICAL
+
+typedef enum {
+    KEY_EVENT_NONE      = 0,
+    KEY_EVENT_PRESS     = 1,
+    KEY_EVENT_RELEASE   = 2,
+    KEY_EVENT_LONGPRESS = 3,
+    KEY_EVENT_DOUBLE    = 4,
+    KEY_EVENT_REPEAT    = 5,
+    KEY_EVENT_CHORD     = 6, // two or more keys went down together
+} KeyEventType;
+
+/**
+ * @brief Moving-window filter: an input is ON while at least 'threshold'
+ *        of the last WINDOW samples were ON.
+ */
+struct OptoWindowFilter
+{
+    uint16_t samples[WINDOW];
+    uint8_t acc[NUM_INPUTS];
+    uint8_t pos;
+    uint8_t threshold;
+    uint16_t filtered;
+
+    void init(uint8_t thresh);
+    uint16_t update(uint16_t raw); // one matrix scan, returns filtered word
+};
+
+/**
+ * @brief Bit-sliced saturating integrators, one per input
+ *
+ * Counter bit k of every input lives in plane[k], so a scan updates all
+ * inputs (up to 32) with word-wide logic ops and keeps no sample history.
+ * Each counter counts up while its input is ON and down while OFF,
+ * saturating at 0 and at its cap. The output turns ON at onLevel and OFF
+ * at offLevel, each stored bit-sliced so every input can have its own
+ * time constants and hysteresis.
+ *
+ * init(threshold) takes the window filter's threshold (ON at 'threshold',
+ * OFF below it, cap WINDOW - 1) but is not a drop-in for it: an integrator
+ * loses a count on every OFF sample, where the window only forgets samples
+ * WINDOW scans old. On clean edges both switch on the same scan; with 5%
+ * sample noise and contact bounce it reacts about 8 scans later on press
+ * and 7 on release (host/test/test_optoFilter.cpp).
+ */
+struct OptoVerticalFilter
+{
+    uint32_t plane[OPTO_VC_BITS];
+    uint32_t onLevel[OPTO_VC_BITS];
+    uint32_t offLevel[OPTO_VC_BITS];
+    uint32_t cap[OPTO_VC_BITS];
+    uint32_t state;
+    uint16_t filtered;
+
+    void init(uint8_t thresh);
+    // Per-input levels: on > off, cap >= on, all below 1 << OPTO_VC_BITS
+    void setInputLevels(uint8_t input, uint8_t on, uint8_t off, uint8_t capLevel);
+    uint32_t update32(uint32_t raw); // up to 32 inputs
+    uint16_t update(uint16_t raw) { return filtered = (uint16_t)update32(raw); }
+};
+
+#ifdef OPTO_FILTER_VERTICAL
+typedef OptoVerticalFilter OptoFilter;
+#else
+typedef OptoWindowFilter OptoFilter;
+#endif
+
+#endif // OPTOINLOGIC_H
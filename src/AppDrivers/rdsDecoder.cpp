@@ -0,0 +1,276 @@
+#include "rdsDecoder.h"
+#include <cstring>
+
+// Vote weight by block error level
+static const uint8_t blerWeight[4] = {3, 2, 1, 0};
+
+static void voteReset(RdsVote &v)
+{
+    v.best = v.rival = 0;
+    v.bestScore = v.rivalScore = 0;
+}
+
+// Add one reception of 'value'; true if the accepted value changed
+static bool vote(RdsVote &v, uint16_t value, uint8_t weight)
+{
+    bool wasAccepted = v.bestScore >= RDS_VOTE_ACCEPT;
+    uint16_t was = v.best;
+
+    if (value == v.best)
+    {
+        v.bestScore += weight;
+        if (v.bestScore > RDS_VOTE_MAX)
+            v.bestScore = RDS_VOTE_MAX;
+    }
+    else
+    {
+        v.bestScore = v.bestScore > weight ? v.bestScore - weight : 0;
+        if (value == v.rival)
+        {
+            v.rivalScore += weight;
+            if (v.rivalScore > RDS_VOTE_MAX)
+                v.rivalScore = RDS_VOTE_MAX;
+        }
+        else
+        {
+            v.rival = value;
+            v.rivalScore = weight;
+        }
+        if (v.rivalScore > v.bestScore)
+        {
+            RdsVote s = v;
+            v.best = s.rival;
+            v.bestScore = s.rivalScore;
+            v.rival = s.best;
+            v.rivalScore = s.bestScore;
+        }
+    }
+
+    bool accepted = v.bestScore >= RDS_VOTE_ACCEPT;
+    return accepted != wasAccepted || (accepted && v.best != was);
+}
+
+static bool accepted(const RdsVote &v)
+{
+    return v.bestScore >= RDS_VOTE_ACCEPT;
+}
+
+// RDS uses its own character table; keep printable ASCII
+static uint8_t rdsChar(uint8_t c)
+{
+    return c >= 0x20 && c < 0x7F ? c : (c == 0x0D ? c : '?');
+}
+
+static void resetText(RdsState &st)
+{
+    for (int i = 0; i < RDS_RT_LEN; i++)
+        voteReset(st.rtVote[i]);
+    st.rtEnd = RDS_RT_LEN;
+    st.rtValid = false;
+    st.rt[0] = 0;
+}
+
+void rdsReset(RdsState &st)
+{
+    memset(&st, 0, sizeof(st));
+    st.rtEnd = RDS_RT_LEN;
+}
+
+// Rebuild the PS string once every position is accepted
+static uint8_t updatePs(RdsState &st)
+{
+    for (int i = 0; i < RDS_PS_LEN; i++)
+    {
+        if (!accepted(st.psVote[i]))
+            return 0;
+    }
+    char ps[RDS_PS_LEN + 1];
+    for (int i = 0; i < RDS_PS_LEN; i++)
+        ps[i] = (char)st.psVote[i].best;
+    ps[RDS_PS_LEN] = 0;
+    if (st.psValid && strcmp(ps, st.ps) == 0)
+        return 0;
+    memcpy(st.ps, ps, sizeof(ps));
+    st.psValid = true;
+    return RDS_CHANGED_PS;
+}
+
+// Rebuild the RadioText once every position up to its end is accepted
+static uint8_t updateRt(RdsState &st)
+{
+    uint8_t end = RDS_RT_LEN;
+    for (uint8_t i = 0; i < RDS_RT_LEN; i++)
+    {
+        if (!accepted(st.rtVote[i]))
+        {
+            if (i >= st.rtEnd)
+                break;
+            return 0;
+        }
+        if (st.rtVote[i].best == 0x0D)
+        {
+            end = i;
+            break;
+        }
+    }
+    if (end > st.rtEnd)
+        end = st.rtEnd;
+
+    char rt[RDS_RT_LEN + 1];
+    for (uint8_t i = 0; i < end; i++)
+        rt[i] = (char)st.rtVote[i].best;
+    while (end && rt[end - 1] == ' ')
+        end--;
+    rt[end] = 0;
+    if (st.rtValid && strcmp(rt, st.rt) == 0)
+        return 0;
+    memcpy(st.rt, rt, end + 1);
+    st.rtValid = true;
+    return RDS_CHANGED_RT;
+}
+
+static bool textChars(RdsVote *votes, int pos, uint16_t block, uint8_t weight)
+{
+    uint8_t hi = rdsChar(block >> 8), lo = rdsChar(block & 0xFF);
+    bool changed = vote(votes[pos], hi, weight);
+    changed |= vote(votes[pos + 1], lo, weight);
+    return changed;
+}
+
+static uint8_t decodeClock(RdsState &st, const RdsGroup &g)
+{
+    // Time moves, so only error-free blocks are used
+    if (g.bler[RDS_B] || g.bler[RDS_C] || g.bler[RDS_D])
+        return 0;
+    uint16_t b = g.block[RDS_B], c = g.block[RDS_C], d = g.block[RDS_D];
+    RdsClock ct;
+    ct.mjd = ((uint32_t)(b & 0x3) << 15) | (c >> 1);
+    ct.hour = ((c & 1) << 4) | (d >> 12);
+    ct.minute = (d >> 6) & 0x3F;
+    ct.offset = (d & 0x1F) * ((d & 0x20) ? -1 : 1);
+    if (ct.hour > 23 || ct.minute > 59 || ct.mjd < 15079) // 15079 = 1900-03-01
+        return 0;
+    st.ct = ct;
+    st.ctValid = true;
+    return RDS_CHANGED_CT;
+}
+
+uint8_t rdsDecodeGroup(RdsState &st, const RdsGroup &g)
+{
+    uint8_t changed = 0;
+
+    // Block B carries the group type; a wrong one would misfile the data
+    if (g.bler[RDS_B] > 1)
+    {
+        st.rejected++;
+        return 0;
+    }
+    st.groups++;
+
+    // PI from block A (and C' in version B groups)
+    bool versionB = g.block[RDS_B] & 0x0800;
+    uint8_t wA = blerWeight[g.bler[RDS_A]];
+    if (wA && vote(st.piVote, g.block[RDS_A], wA) && accepted(st.piVote))
+    {
+        // Another station: start over with its PI
+        RdsVote piVote = st.piVote;
+        uint32_t groups = st.groups, corrected = st.corrected, rejected = st.rejected;
+        rdsReset(st);
+        st.piVote = piVote;
+        st.groups = groups;
+        st.corrected = corrected;
+        st.rejected = rejected;
+        st.pi = piVote.best;
+        changed |= RDS_CHANGED_PI;
+    }
+    if (versionB && g.bler[RDS_C] <= 1 && g.block[RDS_C] != st.pi && st.pi)
+    {
+        st.rejected++;
+        return changed;
+    }
+    if (st.pi && g.bler[RDS_A] <= 1 && g.block[RDS_A] != st.pi)
+    {
+        st.rejected++;
+        return changed;
+    }
+
+    if (g.bler[RDS_A] || g.bler[RDS_B] || g.bler[RDS_C] || g.bler[RDS_D])
+        st.corrected++;
+
+    uint16_t b = g.block[RDS_B];
+    uint8_t wB = blerWeight[g.bler[RDS_B]];
+    uint8_t wC = blerWeight[g.bler[RDS_C]];
+    uint8_t wD = blerWeight[g.bler[RDS_D]];
+    uint8_t type = b >> 12;
+
+    bool tp = b & 0x0400;
+    if (tp != st.tp)
+    {
+        st.tp = tp;
+        changed |= RDS_CHANGED_FLAGS;
+    }
+    if (vote(st.ptyVote, (b >> 5) & 0x1F, wB) && accepted(st.ptyVote))
+    {
+        st.pty = st.ptyVote.best;
+        changed |= RDS_CHANGED_PTY;
+    }
+
+    switch (type)
+    {
+    case 0: {
+        // Basic tuning: TA, MS and two PS characters in block D
+        bool ta = b & 0x0010, ms = b & 0x0008;
+        if (ta != st.ta || ms != st.ms)
+        {
+            st.ta = ta;
+            st.ms = ms;
+            changed |= RDS_CHANGED_FLAGS;
+        }
+        if (wD && textChars(st.psVote, (b & 0x3) * 2, g.block[RDS_D], wD))
+            changed |= updatePs(st);
+        break;
+    }
+
+    case 2: {
+        // RadioText: a new A/B flag means a new text. Only a clean block B
+        // may clear it; a corrected one could have the flag wrong.
+        uint8_t ab = (b >> 4) & 1;
+        if (ab != st.rtAb && g.bler[RDS_B])
+            break;
+        if (ab != st.rtAb)
+        {
+            st.rtAb = ab;
+            resetText(st);
+        }
+        uint8_t seg = b & 0xF;
+        bool any = false;
+        if (versionB)
+        {
+            // 2B texts are 32 characters; trust the version bit when clean
+            if (!g.bler[RDS_B])
+                st.rtEnd = RDS_RT_LEN / 2;
+            if (wD)
+                any |= textChars(st.rtVote, seg * 2, g.block[RDS_D], wD);
+        }
+        else
+        {
+            if (wC)
+                any |= textChars(st.rtVote, seg * 4, g.block[RDS_C], wC);
+            if (wD)
+                any |= textChars(st.rtVote, seg * 4 + 2, g.block[RDS_D], wD);
+        }
+        if (any)
+            changed |= updateRt(st);
+        break;
+    }
+
+    case 4:
+        if (!versionB)
+            changed |= decodeClock(st, g);
+        break;
+
+    default:
+        break;
+    }
+    return changed;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file rdsDecoder.h
+ * @brief RDS group decoder: PI, PTY, PS name, RadioText and clock time.
+ *
+ * Input is one group as read from the tuner: blocks A-D with the block
+ * error level the Si4703 reports in verbose mode (0 none, 1 = 1-2 bits,
+ * 2 = 3-5 bits corrected, 3 uncorrectable). Decoding is a pure function
+ * of the state and the group, so it runs the same on a host against
+ * recorded captures.
+ *
+ * A block whose errors were corrected may still be wrong, so text is not
+ * taken from single receptions. Every PS and RadioText position keeps two
+ * candidate characters with a score; a reception adds 3, 2 or 1 to its
+ * character by error level and takes as much from the other one. A
+ * position is accepted at RDS_VOTE_ACCEPT, and the name or text is only
+ * published once all its positions are. PI and PTY are voted the same
+ * way. Clock time cannot be voted (it moves), so it is only taken from
+ * error-free groups.
+ */
+#ifndef RDSDECODER_H
+#define RDSDECODER_H
+
+#include <cstdint>
+
+#define RDS_PS_LEN 8
+#define RDS_RT_LEN 64
+#define RDS_VOTE_ACCEPT 5
+#define RDS_VOTE_MAX 9
+
+enum RdsBlock : uint8_t { RDS_A = 0, RDS_B, RDS_C, RDS_D };
+
+struct RdsGroup {
+    uint16_t block[4];
+    uint8_t bler[4];       // block error level 0-3
+};
+
+// Bits returned by rdsDecodeGroup()
+enum RdsChange : uint8_t {
+    RDS_CHANGED_PI = 1 << 0,
+    RDS_CHANGED_PTY = 1 << 1,
+    RDS_CHANGED_PS = 1 << 2,
+    RDS_CHANGED_RT = 1 << 3,
+    RDS_CHANGED_CT = 1 << 4,
+    RDS_CHANGED_FLAGS = 1 << 5,   // TP/TA/MS
+};
+
+struct RdsVote {
+    uint16_t best;
+    uint16_t rival;
+    uint8_t bestScore;
+    uint8_t rivalScore;
+};
+
+struct RdsClock {
+    uint32_t mjd;          // modified Julian day
+    uint8_t hour;          // UTC
+    uint8_t minute;
+    int8_t offset;         // local offset in half hours
+};
+
+struct RdsState {
+    uint16_t pi;           // 0 until accepted
+    uint8_t pty;
+    bool tp, ta, ms;
+    bool psValid, rtValid, ctValid;
+    char ps[RDS_PS_LEN + 1];
+    char rt[RDS_RT_LEN + 1];
+    RdsClock ct;
+
+    // Voting state
+    RdsVote piVote;
+    RdsVote ptyVote;
+    RdsVote psVote[RDS_PS_LEN];
+    RdsVote rtVote[RDS_RT_LEN];
+    uint8_t rtAb;          // A/B flag of the text being collected
+    uint8_t rtEnd;         // first position after the text (end marker or size)
+
+    // Counters
+    uint32_t groups;
+    uint32_t corrected;    // groups used with corrected blocks
+    uint32_t rejected;     // groups dropped (block B uncorrectable, other PI)
+};
+
+void rdsReset(RdsState &st);
+
+// Decode one group into 'st'; returns RdsChange bits for what changed
+uint8_t rdsDecodeGroup(RdsState &st, const RdsGroup &g);
+
+#endif // RDSDECODER_H
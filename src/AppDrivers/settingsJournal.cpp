@@ -0,0 +1,254 @@
+#include "settingsJournal.h"
+#include <cstring>
+
+#define JOURNAL_MAGIC 0x4E524A53 // "SJRN"
+#define RECORD_TAG 0xA5
+#define RECORD_OVERHEAD 6        // offset, length, tag, CRC
+#define MAX_RUN 64               // longest delta record payload
+#define MERGE_GAP 4              // join runs separated by fewer equal bytes
+#define SNAPSHOT_CHUNK 248
+
+uint16_t settingsCrc16(const void *buf, size_t len, uint16_t crc)
+{
+    const uint8_t *data = (const uint8_t *)buf;
+    while (len--)
+    {
+        crc ^= (uint16_t)*data++ << 8;
+        for (int i = 0; i < 8; i++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+static uint32_t recordSize(uint8_t len)
+{
+    return (RECORD_OVERHEAD + len + 3) & ~3u;
+}
+
+bool SettingsJournal::readHeader(uint8_t sector, Header &h)
+{
+    if (!flash->read(sector * sectorSize, &h, sizeof(h)))
+        return false;
+    return h.magic == JOURNAL_MAGIC && h.imageSize == imageSize &&
+           h.crc == settingsCrc16((const uint8_t *)&h, offsetof(Header, crc));
+}
+
+bool SettingsJournal::begin(FlashIo *io, void *image, size_t size)
+{
+    flash = io;
+    imageSize = size;
+    sectorSize = io->sectorSize();
+    sectors = io->sectorCount();
+    if (sectors > SETTINGS_JOURNAL_MAX_SECTORS)
+        sectors = SETTINGS_JOURNAL_MAX_SECTORS;
+    memset(&st, 0, sizeof(st));
+    valid = false;
+    needCompact = false;
+    if (size > SETTINGS_JOURNAL_MAX_IMAGE || sectors < 2)
+        return false;
+    memcpy(cache, image, size);
+
+    // Newest valid sector wins
+    for (uint8_t s = 0; s < sectors; s++)
+    {
+        Header h;
+        if (!readHeader(s, h))
+            continue;
+        st.sectorErases[s] = h.eraseCount;
+        if (!valid || (int32_t)(h.sequence - sequence) > 0)
+        {
+            valid = true;
+            active = s;
+            sequence = h.sequence;
+        }
+    }
+    if (!valid)
+        return false;
+
+    replay();
+    memcpy(image, cache, size);
+    return true;
+}
+
+void SettingsJournal::replay()
+{
+    uint32_t base = active * sectorSize;
+    uint32_t pos = sizeof(Header);
+    uint8_t buf[4 + 255 + 2];
+
+    while (pos + RECORD_OVERHEAD <= sectorSize)
+    {
+        if (!flash->read(base + pos, buf, 4))
+            break;
+        if (buf[0] == 0xFF && buf[1] == 0xFF && buf[2] == 0xFF && buf[3] == 0xFF)
+            break; // erased: end of journal
+
+        uint16_t offset = buf[0] | (buf[1] << 8);
+        uint8_t len = buf[2];
+        uint32_t rsize = recordSize(len);
+        bool ok = buf[3] == RECORD_TAG && len && offset + len <= imageSize && pos + rsize <= sectorSize &&
+                  flash->read(base + pos + 4, buf + 4, len + 2);
+        if (ok)
+        {
+            uint16_t crc = buf[4 + len] | (buf[5 + len] << 8);
+            ok = crc == settingsCrc16(buf, 4 + len);
+        }
+        if (!ok)
+        {
+            // Torn write; nothing after it can be trusted or reprogrammed
+            st.tornRecord = true;
+            needCompact = true;
+            break;
+        }
+        memcpy(cache + offset, buf + 4, len);
+        pos += rsize;
+    }
+    writePos = pos;
+    st.activeSector = active;
+    st.used = pos;
+}
+
+bool SettingsJournal::appendRecord(uint16_t offset, const uint8_t *data, uint8_t len)
+{
+    uint8_t buf[4 + 255 + 2 + 3];
+    uint32_t rsize = recordSize(len);
+
+    buf[0] = offset & 0xFF;
+    buf[1] = offset >> 8;
+    buf[2] = len;
+    buf[3] = RECORD_TAG;
+    memcpy(buf + 4, data, len);
+    uint16_t crc = settingsCrc16(buf, 4 + len);
+    buf[4 + len] = crc & 0xFF;
+    buf[5 + len] = crc >> 8;
+    memset(buf + 6 + len, 0xFF, rsize - RECORD_OVERHEAD - len);
+
+    if (!flash->write(active * sectorSize + writePos, buf, rsize))
+        return false;
+    writePos += rsize;
+    st.bytesWritten += rsize;
+    st.used = writePos;
+    return true;
+}
+
+bool SettingsJournal::dirty(const void *image) const
+{
+    return !valid || needCompact || memcmp(cache, image, imageSize) != 0;
+}
+
+bool SettingsJournal::commit(const void *image)
+{
+    if (!flash)
+        return false;
+    if (!valid || needCompact)
+        return compact(image);
+
+    const uint8_t *img = (const uint8_t *)image;
+
+    // Collect changed runs first, so a commit that doesn't fit compacts
+    // instead of being split across sectors
+    uint16_t runStart[SETTINGS_JOURNAL_MAX_IMAGE / (MERGE_GAP + 1) + 1];
+    uint8_t runLen[SETTINGS_JOURNAL_MAX_IMAGE / (MERGE_GAP + 1) + 1];
+    int runs = 0;
+    uint32_t need = 0;
+    size_t i = 0;
+    while (i < imageSize)
+    {
+        if (img[i] == cache[i])
+        {
+            i++;
+            continue;
+        }
+        size_t start = i, end = i + 1, same = 0;
+        for (i++; i < imageSize && i - start < MAX_RUN; i++)
+        {
+            if (img[i] != cache[i])
+            {
+                end = i + 1;
+                same = 0;
+            }
+            else if (++same >= MERGE_GAP)
+                break;
+        }
+        runStart[runs] = start;
+        runLen[runs] = end - start;
+        need += recordSize(end - start);
+        runs++;
+        i = end;
+    }
+    if (!runs)
+        return true;
+
+    if (writePos + need > sectorSize)
+        return compact(image);
+
+    for (int r = 0; r < runs; r++)
+    {
+        if (!appendRecord(runStart[r], img + runStart[r], runLen[r]))
+        {
+            needCompact = true;
+            return false;
+        }
+        memcpy(cache + runStart[r], img + runStart[r], runLen[r]);
+        st.records++;
+    }
+    st.commits++;
+    return true;
+}
+
+bool SettingsJournal::compact(const void *image)
+{
+    if (!flash || imageSize > SETTINGS_JOURNAL_MAX_IMAGE)
+        return false;
+
+    uint8_t target = valid ? (active + 1) % sectors : 0;
+    Header old;
+    uint32_t erases = readHeader(target, old) ? old.eraseCount : st.sectorErases[target];
+
+    if (!flash->erase(target))
+        return false;
+    st.erases++;
+    st.sectorErases[target] = ++erases;
+
+    // Snapshot first, header last: the sector only counts once complete
+    uint8_t prevActive = active;
+    uint32_t prevWritePos = writePos;
+    active = target;
+    writePos = sizeof(Header);
+    const uint8_t *img = (const uint8_t *)image;
+    for (size_t off = 0; off < imageSize; off += SNAPSHOT_CHUNK)
+    {
+        size_t len = imageSize - off < SNAPSHOT_CHUNK ? imageSize - off : SNAPSHOT_CHUNK;
+        if (writePos + recordSize(len) > sectorSize || !appendRecord(off, img + off, len))
+        {
+            active = prevActive;
+            writePos = prevWritePos;
+            needCompact = true;
+            return false;
+        }
+    }
+
+    Header h;
+    h.magic = JOURNAL_MAGIC;
+    h.sequence = sequence + 1;
+    h.eraseCount = erases;
+    h.imageSize = imageSize;
+    h.crc = settingsCrc16((const uint8_t *)&h, offsetof(Header, crc));
+    if (!flash->write(target * sectorSize, &h, sizeof(h)))
+    {
+        active = prevActive;
+        writePos = prevWritePos;
+        needCompact = true;
+        return false;
+    }
+
+    sequence = h.sequence;
+    valid = true;
+    needCompact = false;
+    memcpy(cache, image, imageSize);
+    st.compactions++;
+    st.commits++;
+    st.activeSector = active;
+    st.used = writePos;
+    return true;
+}
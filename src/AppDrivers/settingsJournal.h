@@ -0,0 +1,105 @@
+/**
+ * @file settingsJournal.h
+ * @brief Append-only, wear-levelled journal for a fixed-size settings image.
+ *
+ * The image (the SETUP struct) is stored as a snapshot followed by delta
+ * records, each covering one changed byte run, inside one flash sector. When
+ * the sector fills, the current image is compacted into the next sector of
+ * the ring, so erases rotate over all sectors.
+ *
+ * Layout of a sector:
+ *   [header 16 B][record][record]...[0xFF...]
+ *   header: magic, sequence, erase count, image size, CRC-16
+ *   record: offset u16, length u8, tag 0xA5, data, CRC-16, padded to 4 B
+ *
+ * The header is written after the snapshot, so a sector only becomes valid
+ * once it holds a complete image. A torn record fails its CRC and ends the
+ * replay; the next commit then compacts. Power loss therefore leaves every
+ * field either at its old or its new value.
+ *
+ * Flash access goes through FlashIo, so the journal builds on a host too.
+ */
+#ifndef SETTINGSJOURNAL_H
+#define SETTINGSJOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define SETTINGS_JOURNAL_MAX_IMAGE 512
+#define SETTINGS_JOURNAL_MAX_SECTORS 8
+
+/**
+ * @brief Minimal NOR flash interface: programming only clears bits,
+ *        erase sets a whole sector back to 0xFF.
+ */
+class FlashIo
+{
+public:
+    virtual ~FlashIo() {}
+    virtual size_t sectorSize() const = 0;
+    virtual uint8_t sectorCount() const = 0;
+    virtual bool read(uint32_t addr, void *buf, size_t len) = 0;
+    virtual bool write(uint32_t addr, const void *buf, size_t len) = 0;
+    virtual bool erase(uint8_t sector) = 0;
+};
+
+struct SettingsJournalStats
+{
+    uint32_t commits;       // commit() calls that wrote something
+    uint32_t records;       // delta records appended
+    uint32_t bytesWritten;
+    uint32_t compactions;
+    uint32_t erases;        // this session
+    uint32_t sectorErases[SETTINGS_JOURNAL_MAX_SECTORS]; // lifetime, from headers
+    uint16_t used;          // bytes used in the active sector
+    uint8_t activeSector;
+    bool tornRecord;        // replay stopped on a bad record
+};
+
+class SettingsJournal
+{
+public:
+    // Load the latest image into 'image'. Returns false (image untouched)
+    // when the flash holds no valid journal yet.
+    bool begin(FlashIo *flash, void *image, size_t size);
+
+    // Persist whatever differs from the last committed image
+    bool commit(const void *image);
+
+    // Rewrite the image into the next sector
+    bool compact(const void *image);
+
+    bool dirty(const void *image) const;
+    const SettingsJournalStats &stats() const { return st; }
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t sequence;
+        uint32_t eraseCount;
+        uint16_t imageSize;
+        uint16_t crc;
+    };
+
+    bool readHeader(uint8_t sector, Header &h);
+    bool appendRecord(uint16_t offset, const uint8_t *data, uint8_t len);
+    void replay();
+
+    FlashIo *flash = nullptr;
+    size_t imageSize = 0;
+    size_t sectorSize = 0;
+    uint8_t sectors = 0;
+    uint8_t active = 0;
+    uint32_t sequence = 0;
+    uint32_t writePos = 0;
+    bool valid = false;         // active sector holds a complete image
+    bool needCompact = false;
+    uint8_t cache[SETTINGS_JOURNAL_MAX_IMAGE]; // image as stored in flash
+    SettingsJournalStats st = {};
+};
+
+// CRC-16/CCITT-FALSE, as used for headers and records
+uint16_t settingsCrc16(const void *data, size_t len, uint16_t crc = 0xFFFF);
+
+#endif // SETTINGSJOURNAL_H
@@ -2,11 +2,58 @@
 #include <EEPROM.h>
 #include <cstring> // For memcmp
 #include "setupDriver.h"
+#include "settingsJournal.h"
+#include "setupSchema.h"
+#include "esp_partition.h"
+#include <freertos/semphr.h>
+#include "../SystemEvents.h"
 
 SETUP Setup;
 
+// Journal on the "settings" data partition; without one we fall back to
+// the EEPROM emulation
+#define SETUP_PARTITION_LABEL "settings"
+#define SETUP_SECTOR_SIZE 4096
+
+class PartitionFlash : public FlashIo
+{
+public:
+  bool begin()
+  {
+    part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, SETUP_PARTITION_LABEL);
+    return part && part->size >= 2 * SETUP_SECTOR_SIZE;
+  }
+  size_t sectorSize() const override { return SETUP_SECTOR_SIZE; }
+  uint8_t sectorCount() const override { return part->size / SETUP_SECTOR_SIZE; }
+  bool read(uint32_t addr, void *buf, size_t len) override
+  {
+    return esp_partition_read(part, addr, buf, len) == ESP_OK;
+  }
+  bool write(uint32_t addr, const void *buf, size_t len) override
+  {
+    return esp_partition_write(part, addr, buf, len) == ESP_OK;
+  }
+  bool erase(uint8_t sector) override
+  {
+    return esp_partition_erase_range(part, sector * SETUP_SECTOR_SIZE, SETUP_SECTOR_SIZE) == ESP_OK;
+  }
+
+private:
+  const esp_partition_t *part = nullptr;
+};
+
+static PartitionFlash setupFlash;
+static SettingsJournal setupJournal;
+static_assert(sizeof(SETUP) <= SETTINGS_JOURNAL_MAX_IMAGE, "SETUP no longer fits the journal cache");
+static bool useJournal = false;
+static uint32_t lastWriteUs = 0;
+static uint32_t maxWriteUs = 0;
+
 unsigned long setupDirtyTime = 0;
-bool setupDirty = false;
+volatile bool setupDirty = false;
+static uint32_t setupMarks = 0;
+static volatile uint32_t flashSeq = 0;
+static SemaphoreHandle_t storeLock = nullptr;
 
 bool saveSetup()
 {
@@ -19,6 +66,22 @@ bool saveSetup()
   }
   Serial.println();
 
+  if (useJournal)
+  {
+    // Other tasks keep writing Setup; the journal must see a stable image
+    // or a record's CRC may not match the bytes that reach flash
+    static SETUP snapshot;
+    snapshot = Setup;
+    uint32_t start = micros();
+    bool ok = setupJournal.commit(&snapshot);
+    lastWriteUs = micros() - start;
+    if (lastWriteUs > maxWriteUs)
+      maxWriteUs = lastWriteUs;
+    Serial.printf("Setup journal %s in %lu us (sector %u, %u bytes used)\n", ok ? "updated" : "write FAILED",
+                  lastWriteUs, setupJournal.stats().activeSector, setupJournal.stats().used);
+    return ok;
+  }
+
   EEPROM.put(0, Setup);
   if (EEPROM.commit())
   {
@@ -32,110 +95,153 @@ bool saveSetup()
   }
 }
 
-void saveSetupIfChanged()
+bool saveSetupIfChanged()
 {
+  if (useJournal)
+  {
+    // The journal keeps the stored image in RAM, no read-back needed
+    if (setupJournal.dirty(&Setup))
+      return saveSetup();
+    return true;
+  }
+
   SETUP temp;
   EEPROM.get(0, temp);
 
   // Compare the memory of both structures
   if (memcmp(&temp, &Setup, sizeof(SETUP)) != 0)
   {
-    saveSetup();
     Serial.printf("setup changed, saving new setup.\n");
+    return saveSetup();
   }
+  return true;
 }
 
 bool InitSetup()
 {
-  bool init = 0;
-  EEPROM.begin(sizeof(SETUP));
-  Serial.printf("EEPROM initialized with %d bytes for SETUP structure\n", sizeof(SETUP));
+  if (!storeLock)
+    storeLock = xSemaphoreCreateMutex();
 
-  EEPROM.get(0, Setup);
-  Serial.printf("Loaded setup from EEPROM - InitState: 0x%08X\n", Setup.InitState);
-
-  if (Setup.InitState != 0xDEADBEEF)
+  bool migrate = false;
+  useJournal = setupFlash.begin();
+  if (useJournal && setupJournal.begin(&setupFlash, &Setup, sizeof(SETUP)))
   {
-    Serial.println("InitState invalid, will reset to defaults");
-    init = 1;
+    Serial.printf("Loaded setup from journal - InitState: 0x%08X, sector %u\n", Setup.InitState,
+                  setupJournal.stats().activeSector);
+    if (setupJournal.stats().tornRecord)
+      Serial.println("Setup journal: interrupted write discarded");
   }
-  if (Setup.lastFrequency < 8750 || Setup.lastFrequency > 10800 || Setup.radioVolume > 100)
-  {
-    Serial.printf("Invalid frequency (%d) or volume (%d), will reset\n", Setup.lastFrequency, Setup.radioVolume);
-    init = 1;
-  }
-  for (int i = 0; i < 20; i++)
+  else
   {
-    if (Setup.freqMemories[i] < 8750 || Setup.freqMemories[i] > 10800)
-    {
-      Serial.printf("Invalid memory %d frequency: %d, will reset\n", i + 1, Setup.freqMemories[i]);
-      init = 1;
-      break;
-    }
+    // No journal yet (or no partition): start from the legacy EEPROM image
+    EEPROM.begin(sizeof(SETUP));
+    Serial.printf("EEPROM initialized with %d bytes for SETUP structure\n", sizeof(SETUP));
+
+    EEPROM.get(0, Setup);
+    Serial.printf("Loaded setup from EEPROM - InitState: 0x%08X\n", Setup.InitState);
+    migrate = useJournal;
   }
 
-  if (init)
-  {
-    // First run or invalid data, initialize with defaults
-    Serial.println("Initializing setup with default values...");
-    Setup.radioVolume = 90;            // Radio volume (0-15)
-    Setup.lastFrequency = 10110;  // 101.1 MHz
-    Setup.musicVolume = 90;          // SD card volume (0-100)
-     Setup.webVolume = 90;          // SD card volume (0-100)
-     Setup.announcementVolume = 90; // Announcement volume (0-100)
-    Setup.currentMusicSource = SRC_RADIO; // Default to FM radio (0=FM, 1=WEB, 2=SD)
-    Setup.playMode = 0;           // Default to single play mode
-    Setup.eqPreset = 0;           // Default to flat EQ
-    Setup.baseFloor = -1;              // Default floor number
-    strcpy(Setup.lastSDFile, ""); // No last file initially
-    strcpy(Setup.lastWebURL, ""); // No last web URL initially
-
-    Setup.eqPreset=0;
-
-    // Initialize frequency memories with common FM stations
-    Setup.freqMemories[0] = 10110;  // 101.1 MHz
-    Setup.freqMemories[1] = 10140;  // 101.4 MHz  
-    Setup.freqMemories[2] = 10170;  // 101.7 MHz
-    Setup.freqMemories[3] = 10200;  // 102.0 MHz
-    Setup.freqMemories[4] = 10230;  // 102.3 MHz
-    Setup.freqMemories[5] = 10260;  // 102.6 MHz
-    // Fill rest with default frequency
-    for (int i = 6; i < 20; i++)
-      Setup.freqMemories[i] = 10110; 
-
-    // Clear reserved area
-    memset(Setup.reserved, 0, sizeof(Setup.reserved));
-
-    Setup.InitState = 0xDEADBEEF; // Set a valid state
-    saveSetup();                  // Save the initialized setup
-    Serial.println("Setup initialized and saved with defaults");
+  uint32_t start = micros();
+  SetupLoadResult r = setupSchemaLoad(Setup);
+  uint32_t checkUs = micros() - start;
+
+  if (r.fresh)
+  {
+    // First run or unrecognised data
+    Serial.println("Setup: no valid image, initialized with defaults");
   }
   else
   {
-    Serial.println("Setup loaded successfully from EEPROM");
-    Serial.printf("Current music source: %d (0=FM, 1=WEB, 2=SD)\n", Setup.currentMusicSource);
-    Serial.printf("Base Floor: %d, Volume: %d, SD Volume: %d\n", Setup.baseFloor, Setup.radioVolume, Setup.musicVolume);
-    Serial.print("Memory frequencies: ");
-    for (int i = 0; i < 6; i++)
+    Serial.printf("Setup: schema version %u (current %u), checked in %lu us\n", r.version, SETUP_SCHEMA_VERSION,
+                  checkUs);
+    for (int i = 0; i < setupSchemaCount; i++)
     {
-      Serial.printf("M%d:%.1f ", i + 1, Setup.freqMemories[i] / 100.0);
+      if (r.addedMask & (1u << i))
+        Serial.printf("Setup: new field '%s' set to default\n", setupSchema[i].name);
+      if (r.resetMask & (1u << i))
+        Serial.printf("Setup: invalid field '%s' reset to default\n", setupSchema[i].name);
     }
-    Serial.println();
+    Serial.printf("Current music source: %d (0=FM, 1=WEB, 2=SD)\n", Setup.currentMusicSource);
+    Serial.printf("Base Floor: %d, Volume: %d, SD Volume: %d\n", Setup.baseFloor, Setup.radioVolume, Setup.musicVolume);
   }
+
+  // Anything the load changed (including the version tag) goes back to flash
+  if (r.fresh || r.version != SETUP_SCHEMA_VERSION || r.resetMask || r.addedMask || migrate)
+    saveSetup();
   return true;
 }
 
+SetupStoreStats getSetupStoreStats()
+{
+  SetupStoreStats st;
+  st.journal = useJournal;
+  st.lastWriteUs = lastWriteUs;
+  st.maxWriteUs = maxWriteUs;
+  st.j = setupJournal.stats();
+  return st;
+}
+
 void markSetupDirty()
 {
-  setupDirty = true;
   setupDirtyTime = millis();
+  setupMarks++;
+  if (!setupDirty)
+  {
+    // Only the clean->dirty edge goes on the bus, the writer coalesces the rest
+    setupDirty = true;
+    eventBusPublish(SysEvent::SetupDirty);
+  }
+}
+
+bool setupIsDirty(unsigned long *lastMarkMs)
+{
+  if (lastMarkMs)
+    *lastMarkMs = setupDirtyTime;
+  return setupDirty;
+}
+
+uint32_t setupMarkCount()
+{
+  return setupMarks;
 }
 
-void CheckSetupDirty()
+bool flushSetup()
 {
-  if (setupDirty && (millis() - setupDirtyTime > 2000))
-  { // 5 seconds threshold
-    saveSetupIfChanged();
-    setupDirty = false; // Reset dirty flag after saving
+  if (storeLock)
+    xSemaphoreTake(storeLock, portMAX_DELAY);
+
+  // Cleared first, so a change made during the write marks it dirty again
+  setupDirty = false;
+  flashSeq++;
+  bool ok = saveSetupIfChanged();
+  flashSeq++;
+
+  if (!ok)
+  {
+    // Keep the changes pending; the settings task retries after a quiet period
+    setupDirtyTime = millis();
+    setupDirty = true;
   }
+
+  if (storeLock)
+    xSemaphoreGive(storeLock);
+  return ok;
+}
+
+void setupLock()
+{
+  if (storeLock)
+    xSemaphoreTake(storeLock, portMAX_DELAY);
+}
+
+void setupUnlock()
+{
+  if (storeLock)
+    xSemaphoreGive(storeLock);
+}
+
+uint32_t setupFlashSeq()
+{
+  return flashSeq;
 }
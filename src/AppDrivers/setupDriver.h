@@ -2,6 +2,8 @@
 #define SETUP_DRIVER_H
 
 #include <Arduino.h>
+#include "gestureEngine.h"
+#include "settingsJournal.h"
 
 enum SOURCEMODE {
     SRC_MUSIC_SD = 0,
@@ -15,15 +17,29 @@ enum RetriggerMode : uint8_t {
   NextTrackOnRelease
 };
 
+// Gesture profiles (Setup.gestureProfiles) and input slots (Setup.gestureProfileMap)
+enum GestureProfileId : uint8_t {
+  GESTURE_PROFILE_KEY = 0,    ///< long press, e.g. seek
+  GESTURE_PROFILE_KEY_REPEAT, ///< accelerating auto-repeat, volume/menu keys
+  GESTURE_PROFILE_OPTO,       ///< long and double press
+  GESTURE_PROFILE_ALARM,      ///< press/release only
+};
+#define GESTURE_KEY_BASE   0  ///< keypad bits 0-3 (PREVIOUS, NEXT, DOWN, UP)
+#define GESTURE_OPTO_BASE  4  ///< opto inputs 0-13
+#define GESTURE_MAP_INPUTS 18
+
 // Play mode flags
 #define PLAY_MODE_NEXT_SONG       0    ///< After power off, play next song
 #define PLAY_MODE_SAME_SONG       1    ///< After power off, play same song from start
 
 /**
  * @brief Structure to hold setup parameters for the device.
+ *
+ * Every field must have a descriptor in setupSchema.cpp; the build fails
+ * if the two disagree.
  */
 typedef struct _SETUP {
-    uint32_t InitState; ///< Initialization state marker
+    uint32_t InitState; ///< Schema version tag, see setupSchema.h
 
     uint16_t freqMemories[20]; ///< Array of frequency memories
     // Individual source volumes (0-100 scale)
@@ -40,6 +56,9 @@ typedef struct _SETUP {
     uint8_t reserved[5]; ///< Reserved for future use (increased from 2 to 5 due to removed fields)
     int8_t baseFloor;
     RetriggerMode retriggerMode;
+    GestureProfile gestureProfiles[GESTURE_PROFILES]; ///< Gesture timing profiles
+    uint8_t gestureProfileMap[GESTURE_MAP_INPUTS]; ///< Profile index per key/opto input
+    uint16_t optoAlarmMask; ///< Opto inputs on the minimum-latency path (bit per input, 2..13)
 } SETUP;
 
 extern SETUP Setup;
@@ -52,8 +71,9 @@ bool saveSetup();
 
 /**
  * @brief Compare EEPROM contents to Setup and save if different.
+ * @return true if nothing changed or the save succeeded, false if the write failed.
  */
-void saveSetupIfChanged();
+bool saveSetupIfChanged();
 
 /**
  * @brief Initialize the Setup structure from EEPROM or set defaults if invalid.
@@ -61,7 +81,50 @@ void saveSetupIfChanged();
  */
 bool InitSetup();
 
+/**
+ * @brief Settings storage figures: journal state, erase counts, write latency.
+ */
+struct SetupStoreStats {
+  bool journal;          ///< false when running on the EEPROM fallback
+  uint32_t lastWriteUs;
+  uint32_t maxWriteUs;
+  SettingsJournalStats j;
+};
+
+SetupStoreStats getSetupStoreStats();
+
+/**
+ * @brief Note that Setup changed. Cheap and never touches flash; the
+ *        settings task writes the changes after a quiet period.
+ */
 void markSetupDirty();
 
-void CheckSetupDirty();
+/**
+ * @brief True if Setup has unsaved changes; optionally the millis() of the last mark.
+ */
+bool setupIsDirty(unsigned long *lastMarkMs = nullptr);
+
+/**
+ * @brief Number of markSetupDirty() calls since boot.
+ */
+uint32_t setupMarkCount();
+
+/**
+ * @brief Write pending changes now. Blocks until the flash write is done;
+ *        safe to call from any task (serialised with the settings task).
+ * @return false if the write failed; the changes then stay pending.
+ */
+bool flushSetup();
+
+/**
+ * @brief Keep the settings writer out while several fields change together,
+ *        so no flush stores half of the change. Do not flush while holding it.
+ */
+void setupLock();
+void setupUnlock();
+
+/**
+ * @brief Counter bumped before and after every flush; odd while one is in progress.
+ */
+uint32_t setupFlashSeq();
 #endif // SETUP_DRIVER_H
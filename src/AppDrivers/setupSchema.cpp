@@ -0,0 +1,508 @@
+#include "setupSchema.h"
+#include "settingsJournal.h"
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
+
+#define SETUP_MEMBER(f) (((SETUP *)0)->f)
+
+#define SF_SCALAR(type, f, d, lo, hi, ver) \
+    {#f, offsetof(SETUP, f), sizeof(SETUP_MEMBER(f)), 1, type, ver, d, lo, hi, nullptr, nullptr}
+#define SF_ARRAY(type, f, defs, lo, hi, ver)                                                       \
+    {#f, offsetof(SETUP, f), sizeof(SETUP_MEMBER(f)[0]),                                          \
+     sizeof(SETUP_MEMBER(f)) / sizeof(SETUP_MEMBER(f)[0]), type, ver, lo, lo, hi, defs, nullptr}
+#define SF_BITS(f, d, bits, ver) \
+    {#f, offsetof(SETUP, f), sizeof(SETUP_MEMBER(f)), 1, SF_MASK, ver, d, 0, bits, nullptr, nullptr}
+#define SF_STRING(f, ver) \
+    {#f, offsetof(SETUP, f), sizeof(SETUP_MEMBER(f)), 1, SF_STR, ver, 0, 0, 0, nullptr, nullptr}
+#define SF_BYTES(f, defs, chk, ver) \
+    {#f, offsetof(SETUP, f), sizeof(SETUP_MEMBER(f)), 1, SF_BLOB, ver, 0, 0, 0, defs, chk}
+
+static constexpr int32_t defaultFreqMemories[20] = {
+    10110, 10140, 10170, 10200, 10230, 10260, 10110, 10110, 10110, 10110,
+    10110, 10110, 10110, 10110, 10110, 10110, 10110, 10110, 10110, 10110,
+};
+
+static constexpr int32_t defaultGestureMap[GESTURE_MAP_INPUTS] = {
+    GESTURE_PROFILE_KEY,        // PREVIOUS
+    GESTURE_PROFILE_KEY,        // NEXT
+    GESTURE_PROFILE_KEY_REPEAT, // DOWN
+    GESTURE_PROFILE_KEY_REPEAT, // UP
+    GESTURE_PROFILE_OPTO, GESTURE_PROFILE_OPTO, GESTURE_PROFILE_OPTO, GESTURE_PROFILE_OPTO,
+    GESTURE_PROFILE_OPTO, GESTURE_PROFILE_OPTO, GESTURE_PROFILE_OPTO, GESTURE_PROFILE_OPTO,
+    GESTURE_PROFILE_OPTO, GESTURE_PROFILE_OPTO, GESTURE_PROFILE_OPTO, GESTURE_PROFILE_OPTO,
+    GESTURE_PROFILE_OPTO, GESTURE_PROFILE_OPTO,
+};
+
+static constexpr GestureProfile defaultGestureProfiles[GESTURE_PROFILES] = {
+    {2000, 0, 0, 0, 0, 0, 0},    // GESTURE_PROFILE_KEY
+    {0, 0, 500, 200, 50, 20, 0}, // GESTURE_PROFILE_KEY_REPEAT
+    {3000, 300, 0, 0, 0, 0, 0},  // GESTURE_PROFILE_OPTO
+    {0, 0, 0, 0, 0, 0, 0},       // GESTURE_PROFILE_ALARM
+};
+
+static bool gestureProfilesValid(const void *field)
+{
+    const GestureProfile *p = (const GestureProfile *)field;
+    for (int i = 0; i < GESTURE_PROFILES; i++)
+    {
+        if (p[i].repeatDelayMs && (p[i].repeatMs == 0 || p[i].repeatMinMs > p[i].repeatMs || p[i].repeatAccel > 90))
+            return false;
+    }
+    return true;
+}
+
+// In layout order. Fields not listed (InitState, reserved) are not persisted
+// state: InitState is the version tag, reserved stays zero.
+extern const SetupField setupSchema[];
+constexpr SetupField setupSchema[] = {
+    SF_ARRAY(SF_UINT, freqMemories, defaultFreqMemories, 8750, 10800, 1),
+    SF_SCALAR(SF_UINT, musicVolume, 90, 0, 100, 1),
+    SF_SCALAR(SF_UINT, webVolume, 90, 0, 100, 1),
+    SF_SCALAR(SF_UINT, radioVolume, 90, 0, 100, 1),
+    SF_SCALAR(SF_UINT, announcementVolume, 90, 0, 100, 1),
+    SF_SCALAR(SF_UINT, eqPreset, 0, 0, 4, 1),
+    SF_SCALAR(SF_UINT, currentMusicSource, SRC_RADIO, SRC_MUSIC_SD, SRC_SPIFFS, 1),
+    SF_SCALAR(SF_UINT, lastFrequency, 10110, 8750, 10800, 1),
+    SF_STRING(lastSDFile, 1),
+    SF_STRING(lastWebURL, 1),
+    SF_SCALAR(SF_UINT, playMode, PLAY_MODE_NEXT_SONG, PLAY_MODE_NEXT_SONG, PLAY_MODE_SAME_SONG, 1),
+    SF_SCALAR(SF_INT, baseFloor, -1, -9, 99, 1),
+    SF_SCALAR(SF_UINT, retriggerMode, ResumeOnRelease, ResumeOnRelease, NextTrackOnRelease, 1),
+    SF_BYTES(gestureProfiles, defaultGestureProfiles, gestureProfilesValid, 2),
+    SF_ARRAY(SF_UINT, gestureProfileMap, defaultGestureMap, 0, GESTURE_PROFILES - 1, 2),
+    SF_BITS(optoAlarmMask, 0, 0x3FFC, 3),
+};
+
+#define SCHEMA_COUNT (sizeof(setupSchema) / sizeof(setupSchema[0]))
+const uint8_t setupSchemaCount = SCHEMA_COUNT;
+
+// Layout checks, evaluated by the compiler
+constexpr uint32_t fieldEnd(size_t i)
+{
+    return setupSchema[i].offset + (uint32_t)setupSchema[i].size * setupSchema[i].count;
+}
+
+constexpr bool fieldOk(const SetupField &f)
+{
+    return f.since >= 1 && f.since <= SETUP_SCHEMA_VERSION && f.count >= 1 &&
+           ((f.type != SF_UINT && f.type != SF_INT && f.type != SF_MASK) ||
+            ((f.size == 1 || f.size == 2 || f.size == 4) && f.min <= f.def && f.def <= f.max &&
+             (f.type == SF_INT || f.min >= 0) && (f.type != SF_MASK || (f.def & ~f.max) == 0) &&
+             (f.size == 4 || (f.type != SF_INT ? f.max < (1L << (8 * f.size)) : f.max < (1L << (8 * f.size - 1)) &&
+                                                                                    f.min >= -(1L << (8 * f.size - 1)))))) &&
+           (f.type != SF_BLOB || f.defaults != nullptr);
+}
+
+constexpr bool schemaOk(size_t i)
+{
+    return i >= SCHEMA_COUNT ||
+           (fieldOk(setupSchema[i]) && setupSchema[i].offset >= sizeof(uint32_t) &&
+            (i + 1 < SCHEMA_COUNT ? fieldEnd(i) <= setupSchema[i + 1].offset : fieldEnd(i) <= sizeof(SETUP)) &&
+            schemaOk(i + 1));
+}
+
+static_assert(SCHEMA_COUNT <= 32, "reset/added masks hold 32 fields");
+static_assert(schemaOk(0), "setupSchema does not match SETUP: order, overlap, size or range");
+static_assert(offsetof(SETUP, InitState) == 0, "InitState must stay first");
+
+static int32_t getElement(const uint8_t *p, const SetupField &f)
+{
+    switch (f.size)
+    {
+    case 1:
+        return f.type == SF_INT ? (int32_t)(int8_t)p[0] : (int32_t)p[0];
+    case 2: {
+        uint16_t v;
+        memcpy(&v, p, 2);
+        return f.type == SF_INT ? (int32_t)(int16_t)v : (int32_t)v;
+    }
+    default: {
+        int32_t v;
+        memcpy(&v, p, 4);
+        return v;
+    }
+    }
+}
+
+static void setElement(uint8_t *p, const SetupField &f, int32_t v)
+{
+    if (f.size == 1)
+        p[0] = (uint8_t)v;
+    else if (f.size == 2)
+    {
+        uint16_t u = (uint16_t)v;
+        memcpy(p, &u, 2);
+    }
+    else
+        memcpy(p, &v, 4);
+}
+
+static bool elementValid(const SetupField &f, int32_t v)
+{
+    if (f.type == SF_MASK)
+        return (v & ~f.max) == 0;
+    return v >= f.min && v <= f.max;
+}
+
+static bool fieldValid(const uint8_t *base, const SetupField &f)
+{
+    const uint8_t *p = base + f.offset;
+    switch (f.type)
+    {
+    case SF_STR:
+        return memchr(p, 0, f.size) != nullptr;
+    case SF_BLOB:
+        return !f.check || f.check(p);
+    default:
+        for (int i = 0; i < f.count; i++, p += f.size)
+        {
+            if (!elementValid(f, getElement(p, f)))
+                return false;
+        }
+        return true;
+    }
+}
+
+static void fieldDefault(uint8_t *base, const SetupField &f)
+{
+    uint8_t *p = base + f.offset;
+    switch (f.type)
+    {
+    case SF_STR:
+        memset(p, 0, f.size);
+        if (f.defaults)
+            strncpy((char *)p, (const char *)f.defaults, f.size - 1);
+        break;
+    case SF_BLOB:
+        memcpy(p, f.defaults, f.size);
+        break;
+    default:
+        for (int i = 0; i < f.count; i++, p += f.size)
+            setElement(p, f, f.defaults ? ((const int32_t *)f.defaults)[i] : f.def);
+        break;
+    }
+}
+
+void setupSchemaDefaults(SETUP &s)
+{
+    memset(&s, 0, sizeof(s));
+    for (size_t i = 0; i < SCHEMA_COUNT; i++)
+        fieldDefault((uint8_t *)&s, setupSchema[i]);
+    s.InitState = SETUP_MAGIC;
+}
+
+bool setupSchemaValid(const SETUP &s)
+{
+    for (size_t i = 0; i < SCHEMA_COUNT; i++)
+    {
+        if (!fieldValid((const uint8_t *)&s, setupSchema[i]))
+            return false;
+    }
+    return true;
+}
+
+SetupLoadResult setupSchemaLoad(SETUP &s)
+{
+    SetupLoadResult r = {0, false, 0, 0};
+    if (s.InitState == SETUP_LEGACY_MAGIC)
+        r.version = 1;
+    else if ((s.InitState & 0xFFFF0000u) == SETUP_MAGIC_BASE)
+        r.version = s.InitState & 0xFFFF;
+
+    if (r.version == 0)
+    {
+        setupSchemaDefaults(s);
+        r.fresh = true;
+        return r;
+    }
+
+    uint8_t *base = (uint8_t *)&s;
+    for (size_t i = 0; i < SCHEMA_COUNT; i++)
+    {
+        const SetupField &f = setupSchema[i];
+        if (f.since > r.version)
+        {
+            // Bytes written by an older layout, or never written at all
+            fieldDefault(base, f);
+            r.addedMask |= 1u << i;
+        }
+        else if (!fieldValid(base, f))
+        {
+            fieldDefault(base, f);
+            r.resetMask |= 1u << i;
+        }
+    }
+    s.InitState = SETUP_MAGIC;
+    return r;
+}
+
+// ---------------------------------------------------------------------------
+// Export
+
+static void printHex(Print &out, const uint8_t *p, size_t len)
+{
+    static const char digits[] = "0123456789abcdef";
+    while (len--)
+    {
+        out.write(digits[*p >> 4]);
+        out.write(digits[*p++ & 15]);
+    }
+}
+
+void setupExportJson(Print &out, const SETUP &s)
+{
+    const uint8_t *base = (const uint8_t *)&s;
+    out.printf("{\"version\":%d", SETUP_SCHEMA_VERSION);
+    for (size_t i = 0; i < SCHEMA_COUNT; i++)
+    {
+        const SetupField &f = setupSchema[i];
+        const uint8_t *p = base + f.offset;
+        out.printf(",\"%s\":", f.name);
+        switch (f.type)
+        {
+        case SF_STR:
+            out.write('"');
+            for (size_t n = 0; n < f.size && p[n]; n++)
+            {
+                if (p[n] == '"' || p[n] == '\\')
+                    out.write('\\');
+                if (p[n] >= 0x20)
+                    out.write(p[n]);
+            }
+            out.write('"');
+            break;
+        case SF_BLOB:
+            out.write('"');
+            printHex(out, p, f.size);
+            out.write('"');
+            break;
+        default:
+            if (f.count > 1)
+                out.write('[');
+            for (int n = 0; n < f.count; n++, p += f.size)
+                out.printf(n ? ",%ld" : "%ld", (long)getElement(p, f));
+            if (f.count > 1)
+                out.write(']');
+            break;
+        }
+    }
+    out.println("}");
+}
+
+void setupExportBinary(Print &out, const SETUP &s)
+{
+    out.printf("SETUP %d %u %04x ", SETUP_SCHEMA_VERSION, (unsigned)sizeof(SETUP),
+               settingsCrc16(&s, sizeof(SETUP)));
+    printHex(out, (const uint8_t *)&s, sizeof(SETUP));
+    out.println();
+}
+
+// ---------------------------------------------------------------------------
+// Import
+
+static int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+static size_t parseHex(const char *&p, uint8_t *out, size_t max)
+{
+    size_t n = 0;
+    int hi, lo;
+    while (n < max && (hi = hexDigit(p[0])) >= 0 && (lo = hexDigit(p[1])) >= 0)
+    {
+        out[n++] = (hi << 4) | lo;
+        p += 2;
+    }
+    return n;
+}
+
+static const SetupField *findField(const char *name, size_t len)
+{
+    for (size_t i = 0; i < SCHEMA_COUNT; i++)
+    {
+        if (strlen(setupSchema[i].name) == len && strncmp(setupSchema[i].name, name, len) == 0)
+            return &setupSchema[i];
+    }
+    return nullptr;
+}
+
+static void skipWs(const char *&p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+        p++;
+}
+
+// Parse one JSON value into field 'f' of 'base' (f may be null: skip it)
+static bool parseValue(const char *&p, const SetupField *f, uint8_t *base)
+{
+    skipWs(p);
+    if (*p == '"')
+    {
+        char buf[128];
+        size_t n = 0;
+        for (p++; *p && *p != '"'; p++)
+        {
+            if (*p == '\\' && p[1])
+                p++;
+            if (n < sizeof(buf) - 1)
+                buf[n++] = *p;
+        }
+        if (*p++ != '"')
+            return false;
+        buf[n] = 0;
+        if (!f)
+            return true;
+        if (f->type == SF_STR)
+        {
+            if (n >= f->size)
+                return false;
+            memset(base + f->offset, 0, f->size);
+            memcpy(base + f->offset, buf, n);
+            return true;
+        }
+        if (f->type == SF_BLOB)
+        {
+            const char *h = buf;
+            return n == 2u * f->size && parseHex(h, base + f->offset, f->size) == f->size;
+        }
+        return false;
+    }
+
+    bool array = *p == '[';
+    if (array)
+        p++;
+    if (f && (f->type == SF_STR || f->type == SF_BLOB || array != (f->count > 1)))
+        return false;
+    for (int n = 0;; n++)
+    {
+        skipWs(p);
+        char *end;
+        long v = strtol(p, &end, 10);
+        if (end == p)
+            return false;
+        p = end;
+        if (f)
+        {
+            if (n >= f->count || v < f->min || v > f->max || !elementValid(*f, v))
+                return false;
+            setElement(base + f->offset + n * f->size, *f, v);
+        }
+        skipWs(p);
+        if (!array)
+            return true;
+        if (*p == ']')
+        {
+            p++;
+            return !f || n + 1 == f->count;
+        }
+        if (*p++ != ',')
+            return false;
+    }
+}
+
+bool setupImportJson(const char *text, SETUP &s, Print &log)
+{
+    SETUP staged = s;
+    const char *p = text;
+    int applied = 0;
+
+    skipWs(p);
+    if (*p++ != '{')
+    {
+        log.println("Import: expected '{'");
+        return false;
+    }
+    for (;;)
+    {
+        skipWs(p);
+        if (*p == '}')
+            break;
+        if (*p++ != '"')
+        {
+            log.println("Import: expected a field name");
+            return false;
+        }
+        const char *name = p;
+        while (*p && *p != '"')
+            p++;
+        size_t len = p - name;
+        if (*p++ != '"')
+            return false;
+        skipWs(p);
+        if (*p++ != ':')
+            return false;
+
+        const SetupField *f = findField(name, len);
+        if (!parseValue(p, f, (uint8_t *)&staged))
+        {
+            log.printf("Import: bad value for '%.*s'\n", (int)len, name);
+            return false;
+        }
+        if (f)
+            applied++;
+
+        skipWs(p);
+        if (*p == ',')
+            p++;
+        else if (*p != '}')
+        {
+            log.println("Import: expected ',' or '}'");
+            return false;
+        }
+    }
+
+    if (!setupSchemaValid(staged))
+    {
+        log.println("Import: values fail validation, nothing changed");
+        return false;
+    }
+    staged.InitState = SETUP_MAGIC;
+    s = staged;
+    log.printf("Import: %d fields applied\n", applied);
+    return true;
+}
+
+bool setupImportBinary(const char *line, SETUP &s, Print &log)
+{
+    unsigned version, size, crc;
+    int used = 0;
+    if (sscanf(line, " SETUP %u %u %x %n", &version, &size, &crc, &used) != 3 || !used)
+    {
+        log.println("Import: expected 'SETUP <version> <size> <crc> <hex>'");
+        return false;
+    }
+    static SETUP staged;
+    uint8_t image[SETTINGS_JOURNAL_MAX_IMAGE];
+    const char *p = line + used;
+    if (size > sizeof(image) || parseHex(p, image, size) != size)
+    {
+        log.println("Import: image truncated");
+        return false;
+    }
+    if (settingsCrc16(image, size) != crc)
+    {
+        log.println("Import: CRC mismatch");
+        return false;
+    }
+
+    // Same path as a boot-time load: an older image is migrated, a newer
+    // one is cut to the fields this firmware knows
+    memset(&staged, 0, sizeof(staged));
+    memcpy(&staged, image, size < sizeof(SETUP) ? size : sizeof(SETUP));
+    SetupLoadResult r = setupSchemaLoad(staged);
+    if (r.fresh || r.resetMask)
+    {
+        log.println("Import: image fails validation, nothing changed");
+        return false;
+    }
+    s = staged;
+    log.printf("Import: version %u image applied\n", version);
+    return true;
+}
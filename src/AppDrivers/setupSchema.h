@@ -0,0 +1,98 @@
+/**
+ * @file setupSchema.h
+ * @brief Versioned description of the SETUP layout.
+ *
+ * Every persisted field has a constexpr descriptor (offset, element size and
+ * count, default, range, and the schema version that introduced it). Loading,
+ * defaulting, migration and serial export/import all walk this one table, and
+ * the layout is checked against the struct with static_assert.
+ *
+ * InitState holds SETUP_MAGIC_BASE | version. Images tagged with the old
+ * 0xDEADBEEF marker are treated as version 1.
+ *
+ * Changing the layout:
+ *  - new field: append it to SETUP, add a descriptor with since = the new
+ *    version and bump SETUP_SCHEMA_VERSION. Older images get its default,
+ *    every other field is kept.
+ *  - field whose meaning changes: give it a new name (and version), so old
+ *    values are not read with the new meaning.
+ */
+#ifndef SETUPSCHEMA_H
+#define SETUPSCHEMA_H
+
+#include <Arduino.h>
+#include "setupDriver.h"
+
+#define SETUP_SCHEMA_VERSION 3
+#define SETUP_MAGIC_BASE 0x53550000u  // "SU" + version in the low 16 bits
+#define SETUP_MAGIC (SETUP_MAGIC_BASE | SETUP_SCHEMA_VERSION)
+#define SETUP_LEGACY_MAGIC 0xDEADBEEFu // version 1 images
+
+enum SetupFieldType : uint8_t {
+    SF_UINT = 0,  ///< unsigned integer (or enum), element size 1, 2 or 4
+    SF_INT,       ///< signed integer, element size 1, 2 or 4
+    SF_STR,       ///< NUL-terminated string, size = buffer length
+    SF_BLOB,      ///< opaque bytes checked by 'check', exported as hex
+    SF_MASK,      ///< unsigned bit mask, 'max' holds the bits that may be set
+};
+
+struct SetupField {
+    const char *name;
+    uint16_t offset;
+    uint8_t size;           ///< bytes per element (whole buffer for STR/BLOB)
+    uint8_t count;          ///< elements, 1 for scalars
+    SetupFieldType type;
+    uint8_t since;          ///< schema version that introduced the field
+    int32_t def;            ///< default for scalars
+    int32_t min;
+    int32_t max;            ///< upper bound, or the allowed bits of an SF_MASK
+    const void *defaults;   ///< per-element int32_t defaults, or default bytes/string
+    bool (*check)(const void *field); ///< extra validation for BLOB fields
+};
+
+extern const SetupField setupSchema[];
+extern const uint8_t setupSchemaCount;
+
+/**
+ * @brief Outcome of setupSchemaLoad().
+ */
+struct SetupLoadResult {
+    uint16_t version;   ///< version found in the image, 0 if unrecognised
+    bool fresh;         ///< no valid image, everything defaulted
+    uint32_t resetMask; ///< bit per schema index: field was invalid and defaulted
+    uint32_t addedMask; ///< bit per schema index: field newer than the image
+};
+
+/**
+ * @brief Bring a loaded image up to the current version: fields added
+ *        since the image was written get their defaults, invalid fields are
+ *        reset individually. Sets InitState to SETUP_MAGIC.
+ */
+SetupLoadResult setupSchemaLoad(SETUP &s);
+
+/**
+ * @brief Fill the whole structure with defaults.
+ */
+void setupSchemaDefaults(SETUP &s);
+
+/**
+ * @brief True if every field of 's' is within its range.
+ */
+bool setupSchemaValid(const SETUP &s);
+
+/**
+ * @brief Export as one JSON object, or as one line
+ *        "SETUP <version> <size> <crc16> <hex image>".
+ */
+void setupExportJson(Print &out, const SETUP &s);
+void setupExportBinary(Print &out, const SETUP &s);
+
+/**
+ * @brief Apply an export to 's'. JSON may carry any subset of the fields;
+ *        unknown names are skipped. Nothing is changed unless all values
+ *        are valid. Problems are reported on 'log'.
+ */
+bool setupImportJson(const char *text, SETUP &s, Print &log);
+bool setupImportBinary(const char *line, SETUP &s, Print &log);
+
+#endif // SETUPSCHEMA_H
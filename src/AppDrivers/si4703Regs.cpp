@@ -0,0 +1,56 @@
+#include "si4703Regs.h"
+#include <Wire.h>
+
+static const uint16_t bandBottom[4] = {8750, 7600, 7600, 7600};
+static const uint16_t bandTop[4] = {10800, 10800, 9000, 10800};
+static const uint8_t bandSpacing[4] = {20, 10, 5, 5};
+
+bool si4703Read(Si4703Regs &r, uint8_t count)
+{
+    if (count > SI4703_REG_COUNT)
+        count = SI4703_REG_COUNT;
+    uint8_t bytes = count * 2;
+    if (Wire.requestFrom((uint8_t)SI4703_ADDR, bytes) != bytes)
+        return false;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t hi = Wire.read();
+        r.reg[(SI4703_STATUSRSSI + i) & 0x0F] = (hi << 8) | Wire.read();
+    }
+    return true;
+}
+
+bool si4703Write(const Si4703Regs &r, uint8_t last)
+{
+    Wire.beginTransmission(SI4703_ADDR);
+    for (uint8_t reg = SI4703_POWERCFG; reg <= last; reg++)
+    {
+        Wire.write(r.reg[reg] >> 8);
+        Wire.write(r.reg[reg] & 0xFF);
+    }
+    return Wire.endTransmission() == 0;
+}
+
+Si4703Band si4703Band(const Si4703Regs &r)
+{
+    uint16_t cfg = r.reg[SI4703_SYSCONFIG2];
+    Si4703Band b;
+    b.bottom = bandBottom[(cfg >> 6) & 3];
+    b.top = bandTop[(cfg >> 6) & 3];
+    b.spacing = bandSpacing[(cfg >> 4) & 3];
+    return b;
+}
+
+uint16_t si4703ChannelFreq(const Si4703Band &band, uint16_t channel)
+{
+    return band.bottom + channel * band.spacing;
+}
+
+uint16_t si4703FreqChannel(const Si4703Band &band, uint16_t freq)
+{
+    if (freq <= band.bottom)
+        return 0;
+    if (freq > band.top)
+        freq = band.top;
+    return (freq - band.bottom + band.spacing / 2) / band.spacing;
+}
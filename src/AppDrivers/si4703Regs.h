@@ -0,0 +1,76 @@
+/**
+ * @file si4703Regs.h
+ * @brief Register-level access to the Si4703 for code that runs beside the
+ *        tuner driver (RDS, band scan, seek).
+ *
+ * The chip has no register address pointer: a read always starts at 0x0A
+ * and wraps through 0x0F to 0x00, a write always starts at 0x02. Each
+ * register is two bytes, high byte first. Si4703Regs is indexed by
+ * register number, so a partial read or write touches only its slots.
+ *
+ * The functions talk to Wire directly; call them from an i2cBusRun()
+ * callback. The tuner driver keeps its own shadow and may write its view
+ * of 0x02-0x07 back at any time, so bits set here must be checked again
+ * after the driver has tuned.
+ */
+#ifndef SI4703REGS_H
+#define SI4703REGS_H
+
+#include <cstdint>
+
+#define SI4703_ADDR 0x10
+
+enum Si4703Reg : uint8_t {
+    SI4703_POWERCFG = 0x02,
+    SI4703_CHANNEL = 0x03,
+    SI4703_SYSCONFIG1 = 0x04,
+    SI4703_SYSCONFIG2 = 0x05,
+    SI4703_STATUSRSSI = 0x0A,
+    SI4703_READCHAN = 0x0B,
+    SI4703_RDSA = 0x0C,
+    SI4703_RDSB = 0x0D,
+    SI4703_RDSC = 0x0E,
+    SI4703_RDSD = 0x0F,
+    SI4703_REG_COUNT = 16
+};
+
+// POWERCFG
+#define SI4703_DMUTE      (1u << 14)   // 1 = audio on
+#define SI4703_RDSM       (1u << 11)   // verbose RDS: block error levels
+#define SI4703_SKMODE     (1u << 10)   // 1 = seek stops at the band limit
+#define SI4703_SEEKUP     (1u << 9)
+#define SI4703_SEEK       (1u << 8)
+// CHANNEL
+#define SI4703_TUNE       (1u << 15)
+#define SI4703_CHAN_MASK  0x03FF      // also READCHAN
+// SYSCONFIG1
+#define SI4703_RDS        (1u << 12)
+// STATUSRSSI
+#define SI4703_RDSR       (1u << 15)
+#define SI4703_STC        (1u << 14)
+#define SI4703_SFBL       (1u << 13)   // seek hit the band limit
+#define SI4703_ST         (1u << 8)    // stereo
+#define SI4703_RSSI_MASK  0x00FF
+
+struct Si4703Regs {
+    uint16_t reg[SI4703_REG_COUNT];
+};
+
+// Band and channel spacing from SYSCONFIG2, in 10 kHz units
+struct Si4703Band {
+    uint16_t bottom;
+    uint16_t top;
+    uint8_t spacing;
+};
+
+// Read 'count' registers starting at 0x0A (1 = STATUSRSSI only, 16 = all)
+bool si4703Read(Si4703Regs &r, uint8_t count);
+
+// Write registers 0x02..last from 'r'
+bool si4703Write(const Si4703Regs &r, uint8_t last);
+
+Si4703Band si4703Band(const Si4703Regs &r);
+uint16_t si4703ChannelFreq(const Si4703Band &band, uint16_t channel);
+uint16_t si4703FreqChannel(const Si4703Band &band, uint16_t freq);
+
+#endif // SI4703REGS_H
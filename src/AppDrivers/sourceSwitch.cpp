@@ -0,0 +1,135 @@
+#include "sourceSwitch.h"
+#include <cmath>
+
+// SCI registers and SCI_MODE bits used here
+#define SCI_MODE        0x0
+#define SCI_WRAM        0x6
+#define SCI_WRAMADDR    0x7
+#define SCI_VOL         0xB
+#define SM_CANCEL       (1 << 3)
+#define SM_SDINEW       (1 << 11)
+#define SM_LINE1        (1 << 14)
+#define PARAM_END_FILL  0x1E06 // endFillByte in the parametric block
+#define SDI_CHUNK       32
+
+static float attGain(uint8_t att)
+{
+    return att >= SOURCE_SWITCH_MUTE ? 0.0f : powf(10.0f, -att / 40.0f);
+}
+
+static uint8_t gainAtt(float gain)
+{
+    if (gain <= 0.0f)
+        return SOURCE_SWITCH_MUTE;
+    long att = lroundf(-40.0f * log10f(gain));
+    if (att < 0)
+        return 0;
+    return att < SOURCE_SWITCH_MUTE ? (uint8_t)att : SOURCE_SWITCH_MUTE;
+}
+
+void SourceSwitch::begin(AudioInput input, uint8_t att)
+{
+    mode = SM_SDINEW | (input == AudioInput::Line1 ? SM_LINE1 : 0);
+    port.sciWrite(SCI_MODE, mode);
+    writeVolume(att);
+    current = input;
+    decoderFed = false;
+}
+
+void SourceSwitch::writeVolume(uint8_t att)
+{
+    volume = att;
+    port.sciWrite(SCI_VOL, (uint16_t)att << 8 | att);
+}
+
+// Equal amplitude steps: the largest output step is 1/STEPS of the louder
+// end, where equal dB steps would put most of the level in the first one
+void SourceSwitch::ramp(uint8_t target)
+{
+    if (target == volume)
+        return;
+    float from = attGain(volume);
+    float to = attGain(target);
+    for (int i = 1; i <= SOURCE_SWITCH_STEPS; i++)
+    {
+        uint8_t att = i == SOURCE_SWITCH_STEPS ? target : gainAtt(from + (to - from) * i / SOURCE_SWITCH_STEPS);
+        if (att != volume)
+            writeVolume(att);
+        if (i < SOURCE_SWITCH_STEPS)
+            port.waitUs(SOURCE_SWITCH_STEP_US);
+    }
+}
+
+void SourceSwitch::flushDecoder()
+{
+    port.sciWrite(SCI_WRAMADDR, PARAM_END_FILL);
+    uint8_t fill = port.sciRead(SCI_WRAM) & 0xFF;
+
+    port.sciWrite(SCI_MODE, mode | SM_CANCEL);
+    uint32_t sent = 0;
+    bool cleared = false;
+    while (!cleared && sent < SOURCE_SWITCH_CANCEL_MAX)
+    {
+        port.sdiFill(fill, SDI_CHUNK);
+        sent += SDI_CHUNK;
+        cleared = !(port.sciRead(SCI_MODE) & SM_CANCEL);
+    }
+    st.flushes++;
+    if (sent > st.cancelBytesMax)
+        st.cancelBytesMax = sent;
+
+    if (cleared)
+    {
+        port.sdiFill(fill, SOURCE_SWITCH_END_FILL);
+    }
+    else
+    {
+        // Should not happen. The reset sets SCI_VOL to full level, so both
+        // shadows are written again at once
+        st.resets++;
+        port.softReset();
+        port.sciWrite(SCI_MODE, mode);
+        writeVolume(volume);
+    }
+    decoderFed = false;
+}
+
+void SourceSwitch::select(AudioInput input, uint8_t att)
+{
+    uint32_t startUs = port.nowUs();
+    ramp(SOURCE_SWITCH_MUTE);
+    st.lastMuteUs = port.nowUs() - startUs;
+
+    if (decoderFed)
+        flushDecoder();
+
+    uint16_t next = input == AudioInput::Line1 ? mode | SM_LINE1 : mode & ~SM_LINE1;
+    if (next != mode)
+    {
+        mode = next;
+        port.sciWrite(SCI_MODE, mode);
+    }
+    current = input;
+    decoderFed = input == AudioInput::Decoder;
+
+    ramp(att);
+    st.switches++;
+    st.lastUs = port.nowUs() - startUs;
+    if (st.lastUs > st.maxUs)
+        st.maxUs = st.lastUs;
+}
+
+void SourceSwitch::stop()
+{
+    ramp(SOURCE_SWITCH_MUTE);
+    if (decoderFed)
+        flushDecoder();
+}
+
+void SourceSwitch::setVolume(uint8_t att, bool ramped)
+{
+    if (ramped)
+        ramp(att);
+    else if (att != volume)
+        writeVolume(att);
+}
@@ -0,0 +1,104 @@
+/**
+ * @file sourceSwitch.h
+ * @brief Click-free input changes on the VS1053 (FM line input <-> decoder).
+ *
+ * A hard change of SCI_MODE or a decoder stop at listening level puts the
+ * step between the old and the new signal (and their DC offsets) on the
+ * output. SourceSwitch runs every change as one sequence:
+ *
+ *  1. ramp SCI_VOL down to mute in SOURCE_SWITCH_STEPS steps of equal
+ *     amplitude (not equal dB), so no step is larger than 1/STEPS of the level
+ *  2. if the decoder was fed since the last flush, cancel it as the datasheet
+ *     describes: SM_CANCEL, endFillByte 32 bytes at a time until the bit
+ *     clears, then 2052 endFillByte bytes; a soft reset if it does not clear
+ *     within SOURCE_SWITCH_CANCEL_MAX bytes
+ *  3. write SCI_MODE, with or without SM_LINE1, under mute
+ *  4. ramp up to the target volume
+ *
+ * SCI_MODE and SCI_VOL are written from shadows and never read back to build
+ * a value; the only reads are of SM_CANCEL and of endFillByte. Volumes are
+ * SCI_VOL attenuation in 0.5 dB steps (0 loudest, SOURCE_SWITCH_MUTE silent).
+ *
+ * Chip access goes through Vs1053Port, so the sequence runs unchanged in the
+ * host simulator (host/sim/SourceSwitchBench).
+ */
+#ifndef SOURCESWITCH_H
+#define SOURCESWITCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define SOURCE_SWITCH_STEPS      8      // ramp steps each way
+#define SOURCE_SWITCH_STEP_US    1000   // time per ramp step: one tick, the task sleeps through it
+#define SOURCE_SWITCH_MUTE       0xFE   // SCI_VOL attenuation that is silent
+#define SOURCE_SWITCH_CANCEL_MAX 2048   // endFill bytes before giving up on SM_CANCEL
+#define SOURCE_SWITCH_END_FILL   2052   // endFill bytes after a cancel
+
+enum class AudioInput : uint8_t {
+    Decoder,    // SDI data (files, streams, announcements)
+    Line1       // FM tuner on the line input
+};
+
+/**
+ * @brief SCI/SDI access to the chip.
+ */
+class Vs1053Port
+{
+public:
+    virtual ~Vs1053Port() {}
+    virtual uint16_t sciRead(uint8_t reg) = 0;
+    virtual void sciWrite(uint8_t reg, uint16_t value) = 0;
+    // Send 'len' bytes of 'fill' over SDI, waiting for DREQ every 32 bytes
+    virtual void sdiFill(uint8_t fill, size_t len) = 0;
+    // Soft reset with the patches reloaded; SCI_MODE and SCI_VOL are
+    // rewritten by the caller afterwards
+    virtual void softReset() = 0;
+    virtual void waitUs(uint32_t us) = 0;
+    virtual uint32_t nowUs() = 0;
+};
+
+struct SourceSwitchStats
+{
+    uint32_t switches;
+    uint32_t flushes;          // decoder cancels
+    uint32_t resets;           // SM_CANCEL did not clear
+    uint32_t lastUs, maxUs;    // request to the new input at full level
+    uint32_t lastMuteUs;       // request to silence
+    uint32_t cancelBytesMax;   // endFill bytes until SM_CANCEL cleared
+};
+
+class SourceSwitch
+{
+public:
+    explicit SourceSwitch(Vs1053Port &port) : port(port) {}
+
+    // Take over after the chip init: writes SCI_MODE and SCI_VOL once
+    void begin(AudioInput input, uint8_t att);
+
+    // Change to 'input' at attenuation 'att'; also restarts the decoder
+    // when it is selected again
+    void select(AudioInput input, uint8_t att);
+
+    // Ramp down and flush the decoder; stays muted until the next select()
+    void stop();
+
+    // Volume without a source change; 'ramped' for large changes (mute)
+    void setVolume(uint8_t att, bool ramped = false);
+
+    AudioInput input() const { return current; }
+    const SourceSwitchStats &stats() const { return st; }
+
+private:
+    void ramp(uint8_t target);
+    void writeVolume(uint8_t att);
+    void flushDecoder();
+
+    Vs1053Port &port;
+    uint16_t mode = 0;         // SCI_MODE shadow
+    uint8_t volume = 0;        // SCI_VOL shadow, both channels
+    AudioInput current = AudioInput::Decoder;
+    bool decoderFed = false;   // data may have been sent since the last flush
+    SourceSwitchStats st = {};
+};
+
+#endif // SOURCESWITCH_H
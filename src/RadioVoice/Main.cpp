@@ -17,6 +17,10 @@
 #include "../Tasks/OptoKeypadInTask.h"
 #include "../Tasks/userUi.h"
 #include "AudioTask.h"
+#include "../Tasks/SettingsTask.h"
+#include "../Tasks/RdsTask.h"
+#include "../Tasks/BandScan.h"
+#include "../Tasks/TunerTask.h"
 #include <setupDriver.h>
 
 
@@ -27,6 +31,7 @@ uint8_t vol = 15;
 void setup()
 {
   InitSetup();
+  initSettingsTask();
   SerialMonitor_Init();
   Serial.println("Setup start");
   initOptoKeypadInTask();
@@ -35,6 +40,9 @@ void setup()
   // Initialize UserUI system
   Serial.println("Initializing UserUI system...");
   audioTask.begin();
+  initRdsTask();
+  initBandScanTask();
+  initTunerTask();
   startScreenManager();
   Serial.println("UI system initialization complete");
 
@@ -1,16 +1,217 @@
 #include "SystemEvents.h"
+#include <atomic>
 
-// Global event group
-EventGroupHandle_t audioEvents = nullptr;
+// ─────────────────────────────────────────────────────────────────────────────
+// Event bus
 
-// Global audio status
-AudioStatus currentAudioStatus = {"", "", 0, false};
+// Each slot carries a sequence number: 2*pos+1 while record 'pos' is being
+// written, 2*pos+2 once it is complete. Readers compare it with the value
+// they expect for their cursor to detect empty, in-progress and overwritten
+// slots without taking a lock.
+struct EventSlot {
+    std::atomic<uint32_t> seq{0};
+    SysEventRecord        rec;
+};
 
-void initSystemEvents() {
-    audioEvents = xEventGroupCreate();
-    if (audioEvents == nullptr) {
-        Serial.println("SystemEvents: Failed to create event group");
-    } else {
-        Serial.println("SystemEvents: Event group created successfully");
+struct Subscriber {
+    const char           *name;
+    TaskHandle_t          task;
+    uint32_t              mask;
+    uint32_t              cursor;
+    std::atomic<uint32_t> drops{0};
+};
+
+static EventSlot eventRing[EVENT_BUS_SIZE];
+static std::atomic<uint32_t> eventHead{0};
+static Subscriber subscribers[EVENT_BUS_MAX_SUBS];
+static std::atomic<int> subscriberCount{0};
+static portMUX_TYPE subscribeLock = portMUX_INITIALIZER_UNLOCKED;
+
+EventSubscriber eventBusSubscribe(const char *name, uint32_t mask, TaskHandle_t task) {
+    if (task == nullptr) {
+        task = xTaskGetCurrentTaskHandle();
+    }
+
+    portENTER_CRITICAL(&subscribeLock);
+    int id = subscriberCount.load(std::memory_order_relaxed);
+    if (id < EVENT_BUS_MAX_SUBS) {
+        Subscriber &s = subscribers[id];
+        s.name = name;
+        s.task = task;
+        s.mask = mask;
+        s.cursor = eventHead.load(std::memory_order_relaxed);
+        s.drops.store(0, std::memory_order_relaxed);
+        // Publishers only look at entries below the count
+        subscriberCount.store(id + 1, std::memory_order_release);
+    }
+    portEXIT_CRITICAL(&subscribeLock);
+
+    if (id >= EVENT_BUS_MAX_SUBS) {
+        Serial.printf("SystemEvents: No room for subscriber %s\n", name);
+        return -1;
+    }
+    return id;
+}
+
+void eventBusPublish(SysEvent type, uint8_t arg8, uint16_t arg16, uint32_t value) {
+    uint32_t pos = eventHead.fetch_add(1, std::memory_order_relaxed);
+    EventSlot &slot = eventRing[pos & (EVENT_BUS_SIZE - 1)];
+
+    slot.seq.store(2 * pos + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.rec = {type, arg8, arg16, value, (uint32_t)millis()};
+    slot.seq.store(2 * pos + 2, std::memory_order_release);
+
+    uint32_t bit = SYS_EVENT_MASK(type);
+    int count = subscriberCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; i++) {
+        if (subscribers[i].mask & bit) {
+            xTaskNotify(subscribers[i].task, EVENT_BUS_NOTIFY_BIT, eSetBits);
+        }
+    }
+}
+
+bool eventBusPoll(EventSubscriber sub, SysEventRecord &out) {
+    if (sub < 0 || sub >= subscriberCount.load(std::memory_order_acquire)) {
+        return false;
+    }
+    Subscriber &s = subscribers[sub];
+
+    for (;;) {
+        EventSlot &slot = eventRing[s.cursor & (EVENT_BUS_SIZE - 1)];
+        uint32_t expect = 2 * s.cursor + 2;
+        uint32_t seq = slot.seq.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(seq - expect);
+
+        if (diff < 0) {
+            return false; // not published yet (or still being written)
+        }
+        if (diff == 0) {
+            SysEventRecord rec = slot.rec;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == seq) {
+                s.cursor++;
+                if (s.mask & SYS_EVENT_MASK(rec.type)) {
+                    out = rec;
+                    return true;
+                }
+                continue;
+            }
+        }
+
+        // Lapped by the publishers: skip to the oldest record still in the ring
+        uint32_t head = eventHead.load(std::memory_order_acquire);
+        uint32_t oldest = head - EVENT_BUS_SIZE;
+        if ((int32_t)(oldest - s.cursor) > 0) {
+            s.drops.fetch_add(oldest - s.cursor, std::memory_order_relaxed);
+            s.cursor = oldest;
+        } else {
+            s.drops.fetch_add(1, std::memory_order_relaxed);
+            s.cursor++;
+        }
+    }
+}
+
+bool eventBusWait(TickType_t timeout) {
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, EVENT_BUS_NOTIFY_BIT, &bits, timeout);
+    return (bits & EVENT_BUS_NOTIFY_BIT) != 0;
+}
+
+int eventBusSubscriberCount() {
+    return subscriberCount.load(std::memory_order_acquire);
+}
+
+bool eventBusSubscriberInfo(int index, const char **name, uint32_t *mask, uint32_t *drops) {
+    if (index < 0 || index >= eventBusSubscriberCount()) {
+        return false;
+    }
+    *name = subscribers[index].name;
+    *mask = subscribers[index].mask;
+    *drops = subscribers[index].drops.load(std::memory_order_relaxed);
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Snapshots: one writer, a sequence counter that is odd while it writes.
+// A write copies at most a few hundred bytes, but the writer is not always
+// the higher-priority side (RdsTask publishes at priority 1, its readers run
+// above it), so a reader that finds the counter odd may have preempted the
+// writer on its own core. After a few spins it sleeps a tick to let the
+// writer finish instead of livelocking.
+#define SEQ_READ_SPINS 8
+static void seqWrite(std::atomic<uint32_t> &seq, void *dst, const void *src, size_t size) {
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(dst, src, size);
+    seq.store(s + 2, std::memory_order_release);
+}
+
+static uint32_t seqRead(const std::atomic<uint32_t> &seq, void *dst, const void *src, size_t size) {
+    for (uint32_t tries = 1;; tries++) {
+        if (tries % SEQ_READ_SPINS == 0) {
+            vTaskDelay(1);
+        }
+        uint32_t before = seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        memcpy(dst, src, size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == before) {
+            return before / 2;
+        }
+    }
+}
+
+static AudioStatus audioStatus = {};
+static std::atomic<uint32_t> audioStatusSeq{0};
+
+void publishAudioStatus(const AudioStatus &status) {
+    seqWrite(audioStatusSeq, &audioStatus, &status, sizeof(AudioStatus));
+}
+
+void readAudioStatus(AudioStatus &out) {
+    seqRead(audioStatusSeq, &out, &audioStatus, sizeof(AudioStatus));
+}
+
+// Level meter snapshot and the time of the last read
+static AudioMeter audioMeter = {};
+static std::atomic<uint32_t> audioMeterSeq{0};
+static std::atomic<uint32_t> audioMeterReadMs{0};
+static std::atomic<bool> audioMeterRead{false};
+
+void publishAudioMeter(const AudioMeter &meter) {
+    seqWrite(audioMeterSeq, &audioMeter, &meter, sizeof(AudioMeter));
+}
+
+uint32_t readAudioMeter(AudioMeter &out) {
+    audioMeterReadMs.store(millis(), std::memory_order_relaxed);
+    audioMeterRead.store(true, std::memory_order_relaxed);
+    return seqRead(audioMeterSeq, &out, &audioMeter, sizeof(AudioMeter));
+}
+
+bool audioMeterWanted() {
+    return audioMeterRead.load(std::memory_order_relaxed) &&
+           millis() - audioMeterReadMs.load(std::memory_order_relaxed) < AUDIO_METER_LEASE_MS;
+}
+
+static RdsStatus rdsStatus = {};
+static std::atomic<uint32_t> rdsStatusSeq{0};
+
+void publishRdsStatus(const RdsStatus &status) {
+    seqWrite(rdsStatusSeq, &rdsStatus, &status, sizeof(RdsStatus));
+}
+
+uint32_t readRdsStatus(RdsStatus &out) {
+    return seqRead(rdsStatusSeq, &out, &rdsStatus, sizeof(RdsStatus));
+}
+
+uint32_t audioStatusHash(const char *s) {
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h = (h ^ (uint8_t)*s++) * 16777619u;
     }
+    return h;
 }
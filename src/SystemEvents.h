@@ -1,23 +1,132 @@
 #pragma once
 #include <Arduino.h>
 #include <freertos/FreeRTOS.h>
-#include <freertos/event_groups.h>
+#include <freertos/task.h>
 
-// Global event group handle
-extern EventGroupHandle_t audioEvents;
+// ─────────────────────────────────────────────────────────────────────────────
+// Event bus
+//
+// Publishers append fixed-size records to one lock-free ring shared by all
+// tasks. Each subscriber keeps its own read cursor, registers a mask of the
+// event types it wants and gets a task notification when one is published.
+// A subscriber that falls more than EVENT_BUS_SIZE records behind loses the
+// oldest ones; those are counted in its drop counter.
 
-// Event bits
-#define AUDIO_EVENT_NEW_SONG_PLAYING  (1 << 0)
+enum class SysEvent : uint8_t {
+    TrackChanged = 0,  // value = path/URL hash
+    BufferLevel,       // arg16 = buffer fill 0-100 %
+    SourceChanged,     // arg8  = PlaybackType
+    Key,               // arg8  = key bits, arg16 = KeyEventType
+    Opto,              // arg8  = input index, arg16 = KeyEventType
+    SetupDirty,        // Setup changed and awaits a flash write
+    RdsChanged,        // arg8  = RdsChange bits, arg16 = PI
+    TunerProgress,     // arg8  = TunerPhase, arg16 = channel (10 kHz), value = ms since start
+    Count
+};
+
+#define SYS_EVENT_MASK(e)   (1u << (uint8_t)(e))
+#define SYS_EVENT_ALL       ((1u << (uint8_t)SysEvent::Count) - 1)
+
+struct SysEventRecord {
+    SysEvent type;
+    uint8_t  arg8;
+    uint16_t arg16;
+    uint32_t value;
+    uint32_t timeMs;
+};
+
+#define EVENT_BUS_SIZE        64         // ring slots, power of two
+#define EVENT_BUS_MAX_SUBS    8
+#define EVENT_BUS_NOTIFY_BIT  (1u << 31) // task notification bit used by the bus
+
+typedef int8_t EventSubscriber;          // -1 if subscription failed
+
+// Register the calling task (or 'task') for the event types in 'mask'
+EventSubscriber eventBusSubscribe(const char *name, uint32_t mask, TaskHandle_t task = nullptr);
+
+// Publish an event from task context; never blocks
+void eventBusPublish(SysEvent type, uint8_t arg8 = 0, uint16_t arg16 = 0, uint32_t value = 0);
+
+// Fetch the next event matching the subscriber's mask
+bool eventBusPoll(EventSubscriber sub, SysEventRecord &out);
+
+// Block the calling task until an event is published for it or timeout
+bool eventBusWait(TickType_t timeout);
+
+// Subscriber statistics for diagnostics
+int eventBusSubscriberCount();
+bool eventBusSubscriberInfo(int index, const char **name, uint32_t *mask, uint32_t *drops);
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Shared audio status snapshot. Fixed size, no heap: the audio task is the
+// only writer and publishes it through a sequence lock, so any task can
+// poll it at any rate without locking or seeing a torn copy.
+#define AUDIO_STATUS_NAME_LEN 64
 
-// Shared audio status structure
 struct AudioStatus {
-    String currentFile;
-    String currentTitle;
-    uint8_t currentSource;  // 0=FM, 1=WEB, 2=SD
-    bool isPlaying;
+    uint8_t  source;         // PlaybackType of the current source
+    uint8_t  playState;      // PlayState of the audio task
+    uint8_t  volume;         // 0-100
+    uint8_t  bufferFill;     // input buffer fill, 0-100 %
+    bool     muted;
+    uint16_t bitrateKbps;    // from the decoder, 0 if unknown
+    uint16_t radioFreq;      // 10 kHz units, FM source only
+    uint16_t decodeSec;      // decoded time in seconds
+    uint32_t filePos;        // byte offset in the current file
+    uint32_t pathHash;       // FNV-1a of the path/URL, 0 if none
+    char     shortName[AUDIO_STATUS_NAME_LEN]; // file or host name, truncated
+};
+
+// Publish a new snapshot (audio task only)
+void publishAudioStatus(const AudioStatus &status);
+
+// Copy the latest snapshot; safe from any task
+void readAudioStatus(AudioStatus &out);
+
+// Hash used for AudioStatus::pathHash
+uint32_t audioStatusHash(const char *s);
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Level meter snapshot, same sequence lock as AudioStatus. The audio task
+// only reads the decoder's meter while a reader has asked for it within
+// AUDIO_METER_LEASE_MS, so the feature costs nothing when no screen shows it.
+#define AUDIO_METER_BANDS    16
+#define AUDIO_METER_LEASE_MS 500
+
+struct AudioMeter {
+    uint8_t bands;                     // 2 for the VU meter (left, right), else spectrum bands
+    uint8_t level[AUDIO_METER_BANDS];  // 0-255, full scale 255
+};
+
+// Publish new levels (audio task only)
+void publishAudioMeter(const AudioMeter &meter);
+
+// Copy the latest levels and renew the lease; returns the update count
+uint32_t readAudioMeter(AudioMeter &out);
+
+// True while a reader holds the lease
+bool audioMeterWanted();
+
+// ─────────────────────────────────────────────────────────────────────────────
+// RDS data of the tuned FM station, same sequence lock. Written by the RDS
+// task; text fields are empty until the decoder has accepted them.
+struct RdsStatus {
+    uint16_t freq;          // channel the data belongs to, 10 kHz units
+    uint16_t pi;            // 0 if no RDS
+    uint8_t  rssi;          // signal level of the channel, dBuV
+    bool     stereo;
+    uint8_t  pty;
+    bool     tp, ta;
+    char     ps[9];
+    char     rt[65];
+    bool     ctValid;
+    uint8_t  ctHour, ctMinute;  // local time at ctMs
+    uint32_t ctMjd;
+    uint32_t ctMs;          // millis() when the clock group arrived
 };
 
-extern AudioStatus currentAudioStatus;
+// Publish new RDS data (RDS task only)
+void publishRdsStatus(const RdsStatus &status);
 
-// Initialize the event system
-void initSystemEvents();
+// Copy the latest RDS data; returns the update count
+uint32_t readRdsStatus(RdsStatus &out);
@@ -432,6 +432,20 @@ void VS1053::clearDecodedTime() {
     writeRegister(SCI_DECODE_TIME, 0x00);
 }
 
+/**
+ * Provides the average data rate of the stream being decoded, in bytes per second
+ *
+ * Read from the byteRate field of the parametric structure in X memory
+ * (0x1e05). A write to SCI_DECODE_TIME resets the calculation.
+ *
+ * @see VS1053b Datasheet (1.31) / 10.11 Extra Parameters
+ *
+ * @return byte rate, 0 if no data has been decoded yet
+ */
+uint16_t VS1053::getByteRate() {
+    return wram_read(0x1e05);
+}
+
 /**
  * Fine tune the data rate
  */
@@ -207,6 +207,9 @@ public:
     // Clears SCI_DECODE_TIME register (sets 0x00)
     void clearDecodedTime();
 
+    // Provides the average byte rate of the current stream (bytes per second)
+    uint16_t getByteRate();
+
     uint16_t readRegister(uint8_t _reg) const;
 
     // Writes to VS10xx's SCI (serial command interface) SPI bus.
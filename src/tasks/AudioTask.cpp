@@ -2,6 +2,26 @@
 #include "Arduino.h"
 #include "pins.h"
 #include "setupDriver.h"
+#include "Profiler.h"
+#include "SettingsTask.h"
+#include "i2cBus.h"
+#include "TunerTask.h"
+
+// Optional VLSI spectrum analyzer plugin: the .plg renamed to
+// spectrum1053b.h with its array renamed to spectrum_plugin[]
+#if __has_include(<spectrum1053b.h>)
+#include <spectrum1053b.h>
+#define AUDIO_SPECTRUM_PLUGIN 1
+#define SPECTRUM_BANDS_ADDR  0x1802 // band count (read), per the plugin docs
+#define SPECTRUM_VALUES_ADDR 0x1804 // one word per band, bits 5:0 level
+#endif
+
+// SCI registers/bits not exported by the VS1053 library
+#define VS_SCI_STATUS    0x1
+#define VS_SCI_WRAM      0x6
+#define VS_SCI_WRAMADDR  0x7
+#define VS_SCI_AICTRL3   0xF
+#define VS_SS_VU_ENABLE  (1 << 9)   // VU meter of the firmware patches
 
 AudioTask audioTask;
 
@@ -13,8 +33,8 @@ void AudioTask::begin()
 {
     Serial.println("AudioManager: Starting initialization...");
 
-    // I2C init (shared by FM radio & display)
-    Wire.begin(PIN_I2C_SDA, PIN_I2C_SCL, 100000);
+    // I2C bus owner (shared by FM radio & display)
+    i2cBusBegin(PIN_I2C_SDA, PIN_I2C_SCL, 100000);
 
     // Reset VS1053 pins
     pinMode(VS1003B_RST_PIN, OUTPUT);
@@ -28,6 +48,10 @@ void AudioTask::begin()
     SPI.begin(VS1003B_CLK_PIN, VS1003B_MISO_PIN, VS1003B_MOSI_PIN);
     player.begin();
 
+    // Firmware patches: decoder fixes plus the VU meter for the level display
+    player.loadDefaultVs1053Patches();
+    initMeter();
+
     // SI4703 reset sequence
     pinMode(RST_PIN, OUTPUT);
     digitalWrite(RST_PIN, LOW);
@@ -36,10 +60,14 @@ void AudioTask::begin()
     digitalWrite(42, HIGH);
     delay(10);
 
-    fmradio.start();
-    fmradio.setMono(false);
-    fmradio.setVolume(14);
-    fmradio.setChannel(Setup.lastFrequency);
+    i2cBusRun(I2C_DEV_RADIO, I2C_PRIO_HIGH, [](void *ctx) {
+        Si4703 &radio = ((AudioTask *)ctx)->fmradio;
+        radio.start();
+        radio.setMono(false);
+        radio.setVolume(14);
+        radio.setChannel(Setup.lastFrequency);
+        return true;
+    }, this);
 
     // SD Card & VS1053 init
     SD_MMC.setPins(PIN_SD_MMC_CLK, PIN_SD_MMC_CMD, PIN_SD_MMC_D0);
@@ -47,14 +75,21 @@ void AudioTask::begin()
     // Load volumes
     musicVolume = Setup.musicVolume;
     announcementVolume = Setup.announcementVolume;
-    setHWVolume(musicVolume);
+
+    // The library leaves the line input selected; from here on SCI_MODE and
+    // SCI_VOL are only written from the sequencer's shadows
+    sourceSwitch.begin(AudioInput::Line1, volumeAtt(musicVolume));
+    takeSwitchStats();
 
     // Load retrigger mode
     loadRetriggerMode();
 
     // Create queue & start task
     cmdQueue = xQueueCreate(QUEUE_LEN, sizeof(AudioCommand));
-    xTaskCreate(taskEntry, "AudioTask", 8192, nullptr, configMAX_PRIORITIES - 1, nullptr);
+    xTaskCreate(taskEntry, "AudioTask", 8192, nullptr, configMAX_PRIORITIES - 1, &taskHandle);
+
+    // DREQ rising edge wakes the task when the VS1053 FIFO has room again
+    attachInterrupt(digitalPinToInterrupt(VS1003B_DREQ_PIN), dreqIsr, RISING);
 }
 
 void AudioTask::taskEntry(void *pv)
@@ -62,24 +97,62 @@ void AudioTask::taskEntry(void *pv)
     audioTask.taskLoop();
 }
 
+void IRAM_ATTR AudioTask::dreqIsr()
+{
+    BaseType_t woken = pdFALSE;
+    if (audioTask.taskHandle)
+    {
+        xTaskNotifyFromISR(audioTask.taskHandle, NOTIFY_DREQ, eSetBits, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
 void AudioTask::taskLoop()
 {
     AudioCommand cmd;
+    uint32_t passStartUs = micros();
 
     for (;;)
     {
-        // 1) Non-blocking queue check
+        PlayState prevState = state;
+        uint32_t prevPassUs = passStartUs;
+        passStartUs = micros();
+        uint32_t flashSeq = setupFlashSeq();
+        passProgress = false;
+
+        // 1) Non-blocking queue check, one command per pass
         if (xQueueReceive(cmdQueue, &cmd, 0) == pdTRUE)
         {
+            PROF_TRACE(PROF_AUDIO_CMD, (uint32_t)cmd.type);
             handleCommand(cmd);
+            statusDirty = true;
+            passProgress = true;
         }
 
         // 2) State machine
         switch (state)
         {
         case PlayState::PlaybackInit:
-            initPlayback();
-            state = PlayState::PlaybackPlay;
+            if (initPlayback())
+            {
+                openFailures = 0;
+                state = PlayState::PlaybackPlay;
+                passProgress = true;
+            }
+            else if (currentType == PlaybackType::File &&
+                     mode == Mode::Normal && ++openFailures < MAX_OPEN_FAILURES)
+            {
+                // A file that cannot be opened is skipped like one that
+                // played to the end. Each failed pass still blocks a tick.
+                onPlaybackFinished();
+            }
+            else
+            {
+                // Nothing to play: wait for the next command instead of
+                // cycling through the playlist without ever blocking
+                openFailures = 0;
+                state = PlayState::Idle;
+            }
             break;
 
         case PlayState::PlaybackPlay:
@@ -106,9 +179,214 @@ void AudioTask::taskLoop()
             break;
         }
 
-        // 3) Yield
-        vTaskDelay(pdMS_TO_TICKS(1));
+        // 3) Publish status on changes, and periodically while playing
+        if (state != prevState)
+        {
+            statusDirty = true;
+        }
+        if (statusDirty || (state == PlayState::PlaybackPlay && millis() - lastStatusMs >= STATUS_PERIOD_MS))
+        {
+            publishStatus();
+        }
+
+        // 4) Level meter, after feeding so the decoder FIFO is full
+        pollMeter();
+
+        settingsAudioPass(flashSeq, micros() - passStartUs);
+        if (profEnabled)
+        {
+            profAudioPass(micros() - passStartUs, passStartUs - prevPassUs, prevState == PlayState::PlaybackPlay);
+        }
+
+        // 5) Block until there is something to do. A pass that did no work
+        // always blocks for a tick, so a source that keeps failing (empty
+        // files, a dead stream) cannot starve the core at this priority.
+        TickType_t timeout = min(nextWaitTimeout(), meterWaitTicks());
+        if (timeout == 0 && !passProgress)
+        {
+            timeout = 1;
+        }
+        if (timeout)
+        {
+            waitForEvents(timeout);
+        }
+    }
+}
+
+// How long the loop may sleep before the next pass; 0 means run again now
+TickType_t AudioTask::nextWaitTimeout()
+{
+    if (uxQueueMessagesWaiting(cmdQueue))
+        return 0;
+
+    switch (state)
+    {
+    case PlayState::Idle:
+        return portMAX_DELAY;
+
+    case PlayState::PlaybackPlay:
+        if (currentType == PlaybackType::Radio)
+            return portMAX_DELAY; // line-in, nothing to feed
+        if (!player.data_request())
+            return DREQ_WAIT_TICKS;
+        if (currentType == PlaybackType::Stream && !httpClient.available())
+            return IO_WAIT_TICKS;
+        return 0;
+
+    case PlayState::AnnouncementPlay:
+        return player.data_request() ? 0 : DREQ_WAIT_TICKS;
+
+    default:
+        return 0;
+    }
+}
+
+void AudioTask::waitForEvents(TickType_t timeout)
+{
+    uint32_t bits = 0;
+    uint32_t t0 = micros();
+    BaseType_t woke = xTaskNotifyWait(0, UINT32_MAX, &bits, timeout);
+    uint32_t t1 = micros();
+
+    portENTER_CRITICAL(&cmdLock);
+    loopStats.activeUs += t0 - lastWakeUs;
+    loopStats.blockedUs += t1 - t0;
+    loopStats.wakeups[(int)state]++;
+    if (woke != pdTRUE)
+        loopStats.timeouts++;
+    portEXIT_CRITICAL(&cmdLock);
+    lastWakeUs = t1;
+
+    if (profEnabled)
+    {
+        if (timeout == DREQ_WAIT_TICKS)
+            profDreqWait(t1 - t0);
+        PROF_TRACE(PROF_AUDIO_WAKE, (uint32_t)state);
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Level meter
+void AudioTask::initMeter()
+{
+#ifdef AUDIO_SPECTRUM_PLUGIN
+    player.loadUserCode(spectrum_plugin, sizeof(spectrum_plugin) / sizeof(spectrum_plugin[0]));
+    player.writeRegister(VS_SCI_WRAMADDR, SPECTRUM_BANDS_ADDR);
+    meterBands = min((int)player.readRegister(VS_SCI_WRAM), AUDIO_METER_BANDS);
+    if (meterBands)
+    {
+        Serial.printf("AudioManager: Spectrum analyzer, %d bands\n", meterBands);
+        meterStats.bands = meterBands;
+        return;
+    }
+#endif
+    player.writeRegister(VS_SCI_STATUS, player.readRegister(VS_SCI_STATUS) | VS_SS_VU_ENABLE);
+    meterBands = 2;
+    meterStats.bands = meterBands;
+}
+
+void AudioTask::pollMeter()
+{
+    if (!meterBands || !audioMeterWanted())
+        return;
+
+    bool playing = state == PlayState::PlaybackPlay || state == PlayState::AnnouncementPlay;
+    if (!playing)
+    {
+        // Nothing decoding: show empty bars once, no SCI traffic
+        if (!meterIdle)
+        {
+            AudioMeter m = {};
+            m.bands = meterBands;
+            publishAudioMeter(m);
+            meterIdle = true;
+        }
+        return;
+    }
+
+    uint32_t now = millis();
+    uint32_t late = now - meterLastMs;
+    if (late < meterIntervalMs)
+        return;
+
+    // Read only while the decoder FIFO is full (DREQ low): the SCI access
+    // then uses time the decoder does not need. Line-in radio has no FIFO.
+    // A display bus that is already backed up would only queue the bars.
+    bool decoding = state == PlayState::AnnouncementPlay || currentType != PlaybackType::Radio;
+    bool busy = (decoding && player.data_request()) || i2cBusPending(I2C_DEV_OLED) > METER_I2C_BACKLOG ||
+                i2cBusPending(I2C_DEV_RADIO);
+    if (busy)
+    {
+        // Missed a whole slot: slow down
+        if (late >= 2 * meterIntervalMs)
+        {
+            portENTER_CRITICAL(&cmdLock);
+            meterStats.deferred++;
+            portEXIT_CRITICAL(&cmdLock);
+            meterIntervalMs = min(meterIntervalMs * 2, METER_MAX_INTERVAL_MS);
+            meterLastMs = now;
+        }
+        return;
+    }
+
+    AudioMeter m = {};
+    m.bands = meterBands;
+    uint32_t t0 = micros();
+#ifdef AUDIO_SPECTRUM_PLUGIN
+    if (meterBands > 2)
+    {
+        player.writeRegister(VS_SCI_WRAMADDR, SPECTRUM_VALUES_ADDR);
+        for (uint8_t b = 0; b < meterBands; b++)
+            m.level[b] = (player.readRegister(VS_SCI_WRAM) & 0x3F) * 255 / 63;
+    }
+    else
+#endif
+    {
+        // High byte left, low byte right, 0-96 dB
+        uint16_t vu = player.readRegister(VS_SCI_AICTRL3);
+        m.level[0] = min((vu >> 8) * 255 / 96, 255);
+        m.level[1] = min((vu & 0xFF) * 255 / 96, 255);
     }
+    uint32_t us = micros() - t0;
+    publishAudioMeter(m);
+    meterIdle = false;
+    meterLastMs = now;
+    meterIntervalMs = max(meterIntervalMs * 3 / 4, METER_MIN_INTERVAL_MS);
+
+    portENTER_CRITICAL(&cmdLock);
+    meterStats.polls++;
+    meterStats.spiUs += us;
+    if (us > meterStats.spiMaxUs)
+        meterStats.spiMaxUs = us;
+    meterStats.intervalMs = meterIntervalMs;
+    portEXIT_CRITICAL(&cmdLock);
+}
+
+// Line-in radio has no DREQ wakeups; come back for the next meter read
+TickType_t AudioTask::meterWaitTicks() const
+{
+    if (!meterBands || state != PlayState::PlaybackPlay || !audioMeterWanted())
+        return portMAX_DELAY;
+    uint32_t late = millis() - meterLastMs;
+    return late >= meterIntervalMs ? 1 : pdMS_TO_TICKS(meterIntervalMs - late);
+}
+
+AudioMeterStats AudioTask::getMeterStats() const
+{
+    AudioMeterStats st;
+    portENTER_CRITICAL(&cmdLock);
+    st = meterStats;
+    portEXIT_CRITICAL(&cmdLock);
+    return st;
+}
+
+AudioLoopStats AudioTask::getLoopStats() const
+{
+    AudioLoopStats st;
+    portENTER_CRITICAL(&cmdLock);
+    st = loopStats;
+    portEXIT_CRITICAL(&cmdLock);
+    return st;
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -125,38 +403,42 @@ void AudioTask::handleCommand(const AudioCommand &cmd)
         case AudioCommandType::SetMusicVol:
         case AudioCommandType::SetAnnounceVol:
         case AudioCommandType::MuteToggle:
+        case AudioCommandType::RadioTuned:
             // only these commands allowed
             break;
         default:
             // ignore everything else
+            releaseString(cmd.str);
             return;
         }
     }
 
+    // Copy the interned path/URL into nextParamBuf and free its slot
+    if (cmd.str != AUDIO_STR_NONE)
+    {
+        takeParam(cmd);
+    }
+
     switch (cmd.type)
     {
     case AudioCommandType::PlayMusic:
         currentType = PlaybackType::File;
-        memcpy(nextParamBuf, cmd.param.str, sizeof(nextParamBuf));
         nextValue = 0;
         state = PlayState::PlaybackInit;
         return;
 
     case AudioCommandType::StreamMusic:
         currentType = PlaybackType::Stream;
-        memcpy(nextParamBuf, cmd.param.str, sizeof(nextParamBuf));
         state = PlayState::PlaybackInit;
         return;
 
     case AudioCommandType::PlayRadio:
         currentType = PlaybackType::Radio;
-        memcpy(nextParamBuf, cmd.param.str, sizeof(nextParamBuf));
         state = PlayState::PlaybackInit;
         return;
 
     case AudioCommandType::PlayAnnouncement:
         savedStateBeforeTest = currentState;
-        memcpy(nextParamBuf, cmd.param.str, sizeof(nextParamBuf));
         state = PlayState::AnnouncementInit;
         return;
 
@@ -167,11 +449,11 @@ void AudioTask::handleCommand(const AudioCommand &cmd)
 
     case AudioCommandType::PlayTestSource:
         // decide type by string content
-        if (strncmp(cmd.param.str, "http", 4) == 0)
+        if (strncmp(nextParamBuf, "http", 4) == 0)
         {
             currentType = PlaybackType::Stream;
         }
-        else if (strchr(cmd.param.str, '.') == nullptr)
+        else if (strchr(nextParamBuf, '.') == nullptr)
         {
             currentType = PlaybackType::Radio;
         }
@@ -179,13 +461,12 @@ void AudioTask::handleCommand(const AudioCommand &cmd)
         {
             currentType = PlaybackType::File;
         }
-        memcpy(nextParamBuf, cmd.param.str, sizeof(nextParamBuf));
         nextValue = 0;
         state = PlayState::PlaybackInit;
         return;
 
     case AudioCommandType::StopTest:
-        player.stopSong();
+        stopOutput();
         mode = Mode::Normal;
         restorePreviousSource();
         state = PlayState::Idle;
@@ -229,28 +510,67 @@ void AudioTask::handleCommand(const AudioCommand &cmd)
         return;
 
     case AudioCommandType::Stop:
-        player.stop();
+        stopOutput();
         currentState = {"", 0, "", 0.0f};
         state = PlayState::Idle;
         return;
 
-    case AudioCommandType::SetMusicVol:
-        musicVolume = constrain(cmd.param.value, 0, 100);
-        VolumeManager::getInstance().setMusicVolume(musicVolume);
-        VolumeManager::getInstance().saveToFlash();
+    case AudioCommandType::SetMusicVol: {
+        // Latched value: only the newest volume is applied
+        portENTER_CRITICAL(&cmdLock);
+        uint8_t vol = latchMusicVol;
+        latchPending &= ~LATCH_MUSIC_VOL;
+        portEXIT_CRITICAL(&cmdLock);
+
+        musicVolume = constrain(vol, 0, 100);
+        Setup.musicVolume = musicVolume;
+        markSetupDirty(); // written later by the settings task, never from here
         if (!muted)
             setHWVolume(musicVolume);
         return;
+    }
+
+    case AudioCommandType::SetAnnounceVol: {
+        portENTER_CRITICAL(&cmdLock);
+        uint8_t vol = latchAnnVol;
+        latchPending &= ~LATCH_ANN_VOL;
+        portEXIT_CRITICAL(&cmdLock);
 
-    case AudioCommandType::SetAnnounceVol:
-        announcementVolume = constrain(cmd.param.value, 0, 100);
-        VolumeManager::getInstance().setAnnouncementVolume(announcementVolume);
-        VolumeManager::getInstance().saveToFlash();
+        announcementVolume = constrain(vol, 0, 100);
+        Setup.announcementVolume = announcementVolume;
+        markSetupDirty();
         return;
+    }
+
+    case AudioCommandType::MuteToggle: {
+        // An even number of pending toggles cancels out
+        portENTER_CRITICAL(&cmdLock);
+        uint8_t toggles = latchMuteToggles;
+        latchMuteToggles = 0;
+        latchPending &= ~LATCH_MUTE;
+        portEXIT_CRITICAL(&cmdLock);
 
-    case AudioCommandType::MuteToggle:
-        toggleMute();
+        if (toggles & 1)
+            applyMuteToggle();
         return;
+    }
+
+    case AudioCommandType::RadioTuned: {
+        portENTER_CRITICAL(&cmdLock);
+        uint16_t freq = latchRadioFreq;
+        latchPending &= ~LATCH_RADIO;
+        portEXIT_CRITICAL(&cmdLock);
+
+        // Tuning is the tuner task's; only the record is kept here
+        if (currentType == PlaybackType::Radio)
+            currentState.radioFreq = freq / 100.0f;
+        if (Setup.lastFrequency != freq)
+        {
+            Setup.lastFrequency = freq;
+            markSetupDirty();
+        }
+        return;
+    }
 
     default:
         return;
@@ -259,10 +579,10 @@ void AudioTask::handleCommand(const AudioCommand &cmd)
 
 // ─────────────────────────────────────────────────────────────────────────────
 //  Unified playback init/step
-void AudioTask::initPlayback()
+bool AudioTask::initPlayback()
 {
-    player.stop();
-    setHWVolume(musicVolume);
+    switchInput(currentType == PlaybackType::Radio ? AudioInput::Line1 : AudioInput::Decoder,
+                muted ? SOURCE_SWITCH_MUTE : volumeAtt(musicVolume));
 
     switch (currentType)
     {
@@ -276,13 +596,15 @@ void AudioTask::initPlayback()
         {
             fileHandle = SD_MMC.open(nextParamBuf);
         }
-        if (fileHandle)
+        if (!fileHandle)
         {
-            currentState = {String(nextParamBuf), nextValue, "", 0.0f};
-            if (nextValue)
-            {
-                fileHandle.seek(nextValue);
-            }
+            Serial.printf("AudioManager: Cannot open %s\n", nextParamBuf);
+            return false;
+        }
+        currentState = {String(nextParamBuf), nextValue, "", 0.0f};
+        if (nextValue)
+        {
+            fileHandle.seek(nextValue);
         }
         break;
 
@@ -307,13 +629,14 @@ void AudioTask::initPlayback()
 
     case PlaybackType::Radio:
         currentState = {"", 0, "", atof(nextParamBuf)};
-        fmRadio.setFrequency(currentState.radioFreq);
-        player.sciWriteRegister(SCI_MODE, SM_LINE1_ENABLE | SM_SDINEW);
+        // The tuner task tunes in the background and reports back
+        tunerTune((uint16_t)(currentState.radioFreq * 100 + 0.5f));
         break;
 
     default:
         break;
     }
+    return true;
 }
 
 bool AudioTask::stepPlayback()
@@ -329,6 +652,7 @@ bool AudioTask::stepPlayback()
         fileHandle.read(buf, BUF_SZ);
         player.playChunk(buf, BUF_SZ);
         currentState.filePos = fileHandle.position();
+        passProgress = true;
         return true;
 
     case PlaybackType::Stream:
@@ -340,7 +664,11 @@ bool AudioTask::stepPlayback()
         if (httpClient.available())
         {
             int n = httpClient.read(buf, BUF_SZ);
-            player.playChunk(buf, n);
+            if (n > 0)
+            {
+                player.playChunk(buf, n);
+                passProgress = true;
+            }
         }
         return true;
 
@@ -374,8 +702,7 @@ void AudioTask::initAnnouncement()
     annHandle = SD.open(nextParamBuf);
     if (annHandle)
     {
-        setHWVolume(announcementVolume);
-        player.stopSong();
+        switchInput(AudioInput::Decoder, volumeAtt(announcementVolume));
     }
 }
 
@@ -388,6 +715,7 @@ bool AudioTask::stepAnnouncement()
     }
     annHandle.read(buf, BUF_SZ);
     player.playChunk(buf, BUF_SZ);
+    passProgress = true;
     return true;
 }
 
@@ -422,27 +750,104 @@ void AudioTask::saveTestState()
     savedStateBeforeTest = currentState;
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+//  Source switching
+uint16_t AudioTask::PlayerPort::sciRead(uint8_t reg)
+{
+    return owner.player.readRegister(reg);
+}
+
+void AudioTask::PlayerPort::sciWrite(uint8_t reg, uint16_t value)
+{
+    owner.player.writeRegister(reg, value);
+}
+
+void AudioTask::PlayerPort::sdiFill(uint8_t fill, size_t len)
+{
+    uint8_t chunk[32];
+    memset(chunk, fill, sizeof(chunk));
+    while (len)
+    {
+        size_t n = min(len, sizeof(chunk));
+        owner.player.playChunk(chunk, n);
+        len -= n;
+    }
+}
+
+void AudioTask::PlayerPort::softReset()
+{
+    owner.player.softReset();
+    owner.player.loadDefaultVs1053Patches();
+    owner.initMeter();
+}
+
+// Ramp steps are whole ticks: sleep, so the ramp does not hold the core
+// at this priority
+void AudioTask::PlayerPort::waitUs(uint32_t us)
+{
+    TickType_t ticks = pdMS_TO_TICKS((us + 999) / 1000);
+    vTaskDelay(ticks ? ticks : 1);
+}
+
+uint32_t AudioTask::PlayerPort::nowUs()
+{
+    return micros();
+}
+
+// Same scale as VS1053::setVolume(): 0..100 % to 0xFE..0 (0.5 dB steps)
+uint8_t AudioTask::volumeAtt(uint8_t vol)
+{
+    return map(vol, 0, 100, SOURCE_SWITCH_MUTE, 0);
+}
+
+void AudioTask::switchInput(AudioInput input, uint8_t att)
+{
+    sourceSwitch.select(input, att);
+    takeSwitchStats();
+}
+
+void AudioTask::stopOutput()
+{
+    sourceSwitch.stop();
+    takeSwitchStats();
+}
+
+void AudioTask::takeSwitchStats()
+{
+    portENTER_CRITICAL(&cmdLock);
+    switchStats = sourceSwitch.stats();
+    portEXIT_CRITICAL(&cmdLock);
+}
+
+SourceSwitchStats AudioTask::getSwitchStats() const
+{
+    SourceSwitchStats st;
+    portENTER_CRITICAL(&cmdLock);
+    st = switchStats;
+    portEXIT_CRITICAL(&cmdLock);
+    return st;
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  Volume & Mute
 void AudioTask::setHWVolume(uint8_t vol)
 {
-    uint8_t v = map(vol, 0, 100, 255, 0);
-    player.setVolume(v);
+    sourceSwitch.setVolume(volumeAtt(vol));
 }
 
-void AudioTask::toggleMute()
+void AudioTask::applyMuteToggle()
 {
     if (muted)
     {
         muted = false;
-        setHWVolume(backupMusicVol);
+        sourceSwitch.setVolume(volumeAtt(backupMusicVol), true);
     }
     else
     {
         muted = true;
         backupMusicVol = musicVolume;
         backupAnnVol = announcementVolume;
-        player.setVolume(255);
+        sourceSwitch.setVolume(SOURCE_SWITCH_MUTE, true);
     }
 }
 
@@ -489,108 +894,311 @@ PlaybackType AudioTask::getPlaybackType() const
     return currentType;
 }
 
-PlaybackState AudioTask::getCurrentState() const
+void AudioTask::getStatus(AudioStatus &out) const
 {
-    return currentState;
+    readAudioStatus(out);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Status snapshot
+void AudioTask::publishStatus()
+{
+    AudioStatus st = {};
+    st.source = (uint8_t)currentType;
+    st.playState = (uint8_t)state;
+    st.volume = musicVolume;
+    st.muted = muted;
+
+    const char *name = "";
+    switch (currentType)
+    {
+    case PlaybackType::File: {
+        const char *path = currentState.filePath.c_str();
+        const char *slash = strrchr(path, '/');
+        name = slash ? slash + 1 : path;
+        st.pathHash = *path ? audioStatusHash(path) : 0;
+        st.filePos = currentState.filePos;
+        st.bufferFill = fileHandle ? 100 : 0;
+        break;
+    }
+
+    case PlaybackType::Stream: {
+        const char *url = currentState.streamUrl.c_str();
+        const char *host = strstr(url, "://");
+        name = host ? host + 3 : url;
+        st.pathHash = *url ? audioStatusHash(url) : 0;
+        int avail = httpClient.available();
+        st.bufferFill = min(avail, STREAM_FILL_NOMINAL) * 100 / STREAM_FILL_NOMINAL;
+        break;
+    }
+
+    case PlaybackType::Radio:
+        st.radioFreq = (uint16_t)(currentState.radioFreq * 100.0f + 0.5f);
+        break;
+
+    default:
+        break;
+    }
+
+    // Copy the name; a stream keeps only its host part
+    size_t n = 0;
+    while (name[n] && n < sizeof(st.shortName) - 1)
+    {
+        if (currentType == PlaybackType::Stream && name[n] == '/')
+            break;
+        st.shortName[n] = name[n];
+        n++;
+    }
+    st.shortName[n] = '\0';
+
+    if (state == PlayState::PlaybackPlay &&
+        (currentType == PlaybackType::File || currentType == PlaybackType::Stream))
+    {
+        st.bitrateKbps = (uint32_t)player.getByteRate() * 8 / 1000;
+        st.decodeSec = player.getDecodedTime();
+    }
+
+    publishAudioStatus(st);
+
+    // Push the changes that UI and web readers react to
+    if (st.source != lastPublished.source)
+    {
+        eventBusPublish(SysEvent::SourceChanged, st.source);
+    }
+    if (st.pathHash != lastPublished.pathHash && st.pathHash)
+    {
+        eventBusPublish(SysEvent::TrackChanged, st.source, 0, st.pathHash);
+    }
+    if (abs((int)st.bufferFill - (int)lastPublished.bufferFill) >= 10)
+    {
+        eventBusPublish(SysEvent::BufferLevel, st.source, st.bufferFill);
+    }
+    lastPublished = st;
+
+    statusDirty = false;
+    lastStatusMs = millis();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Command queue
+bool AudioTask::sendCommand(AudioCommandType type, uint32_t value, const char *str)
+{
+    AudioCommand cmd{type, 0, AUDIO_STR_NONE, value};
+
+    if (str)
+    {
+        cmd.str = internString(str);
+        if (cmd.str == AUDIO_STR_NONE)
+        {
+            portENTER_CRITICAL(&cmdLock);
+            queueStats.dropped++;
+            portEXIT_CRITICAL(&cmdLock);
+            return false;
+        }
+    }
+
+    if (xQueueSend(cmdQueue, &cmd, 0) != pdTRUE)
+    {
+        releaseString(cmd.str);
+        portENTER_CRITICAL(&cmdLock);
+        queueStats.dropped++;
+        portEXIT_CRITICAL(&cmdLock);
+        return false;
+    }
+
+    uint8_t depth = uxQueueMessagesWaiting(cmdQueue);
+    portENTER_CRITICAL(&cmdLock);
+    queueStats.sent++;
+    if (depth > queueStats.highWater)
+        queueStats.highWater = depth;
+    portEXIT_CRITICAL(&cmdLock);
+
+    if (taskHandle)
+        xTaskNotify(taskHandle, NOTIFY_CMD, eSetBits);
+    return true;
+}
+
+// Queue a latched command unless one is already waiting. The caller has
+// already stored the new value in the latch.
+bool AudioTask::sendLatched(AudioCommandType type, uint8_t bit)
+{
+    portENTER_CRITICAL(&cmdLock);
+    bool pending = latchPending & bit;
+    latchPending |= bit;
+    if (pending)
+        queueStats.coalesced++;
+    portEXIT_CRITICAL(&cmdLock);
+
+    if (pending)
+        return true;
+
+    if (!sendCommand(type))
+    {
+        portENTER_CRITICAL(&cmdLock);
+        latchPending &= ~bit;
+        portEXIT_CRITICAL(&cmdLock);
+        return false;
+    }
+    return true;
+}
+
+void AudioTask::takeParam(const AudioCommand &cmd)
+{
+    memcpy(nextParamBuf, strPool[cmd.str], sizeof(nextParamBuf));
+    releaseString(cmd.str);
+}
+
+uint16_t AudioTask::internString(const char *s)
+{
+    uint16_t h = AUDIO_STR_NONE;
+
+    portENTER_CRITICAL(&cmdLock);
+    // Share a slot with an identical queued string (repeated key presses)
+    for (int i = 0; i < STR_SLOTS; i++)
+    {
+        if (strRefs[i] && strncmp(strPool[i], s, STR_LEN - 1) == 0)
+        {
+            strRefs[i]++;
+            h = i;
+            break;
+        }
+    }
+    if (h == AUDIO_STR_NONE)
+    {
+        for (int i = 0; i < STR_SLOTS; i++)
+        {
+            if (!strRefs[i])
+            {
+                strncpy(strPool[i], s, STR_LEN - 1);
+                strPool[i][STR_LEN - 1] = '\0';
+                strRefs[i] = 1;
+                h = i;
+                break;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&cmdLock);
+    return h;
+}
+
+void AudioTask::releaseString(uint16_t h)
+{
+    if (h >= STR_SLOTS)
+        return;
+    portENTER_CRITICAL(&cmdLock);
+    if (strRefs[h])
+        strRefs[h]--;
+    portEXIT_CRITICAL(&cmdLock);
+}
+
+AudioQueueStats AudioTask::getQueueStats() const
+{
+    AudioQueueStats st;
+    portENTER_CRITICAL(&cmdLock);
+    st = queueStats;
+    st.stringsInUse = 0;
+    for (int i = 0; i < STR_SLOTS; i++)
+    {
+        if (strRefs[i])
+            st.stringsInUse++;
+    }
+    portEXIT_CRITICAL(&cmdLock);
+    st.depth = cmdQueue ? uxQueueMessagesWaiting(cmdQueue) : 0;
+    return st;
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 //  Public API wrappers
 void AudioTask::playMusic(const char *p)
 {
-    AudioCommand cmd{AudioCommandType::PlayMusic};
-    strncpy(cmd.param.str, p, sizeof(cmd.param.str));
-    xQueueSend(cmdQueue, &cmd, 0);
+    sendCommand(AudioCommandType::PlayMusic, 0, p);
 }
 
 void AudioTask::streamMusic(const char *p)
 {
-    AudioCommand cmd{AudioCommandType::StreamMusic};
-    strncpy(cmd.param.str, p, sizeof(cmd.param.str));
-    xQueueSend(cmdQueue, &cmd, 0);
+    sendCommand(AudioCommandType::StreamMusic, 0, p);
 }
 
 void AudioTask::playRadio(const char *p)
 {
-    AudioCommand cmd{AudioCommandType::PlayRadio};
-    strncpy(cmd.param.str, p, sizeof(cmd.param.str));
-    xQueueSend(cmdQueue, &cmd, 0);
+    sendCommand(AudioCommandType::PlayRadio, 0, p);
 }
 
 void AudioTask::playAnnouncement(const char *p)
 {
-    AudioCommand cmd{AudioCommandType::PlayAnnouncement};
-    strncpy(cmd.param.str, p, sizeof(cmd.param.str));
-    xQueueSend(cmdQueue, &cmd, 0);
+    sendCommand(AudioCommandType::PlayAnnouncement, 0, p);
 }
 
 void AudioTask::startTest()
 {
-    AudioCommand cmd{AudioCommandType::StartTest};
-    xQueueSend(cmdQueue, &cmd, 0);
+    sendCommand(AudioCommandType::StartTest);
 }
 
 void AudioTask::playTestSource(const char *p)
 {
-    AudioCommand cmd{AudioCommandType::PlayTestSource};
-    strncpy(cmd.param.str, p, sizeof(cmd.param.str));
-    xQueueSend(cmdQueue, &cmd, 0);
+    sendCommand(AudioCommandType::PlayTestSource, 0, p);
 }
 
 void AudioTask::stopTest()
 {
-    AudioCommand cmd{AudioCommandType::StopTest};
-    xQueueSend(cmdQueue, &cmd, 0);
+    sendCommand(AudioCommandType::StopTest);
 }
 
 void AudioTask::nextTrack()
 {
-    AudioCommand cmd{AudioCommandType::NextTrack};
-    xQueueSend(cmdQueue, &cmd, 0);
+    sendCommand(AudioCommandType::NextTrack);
 }
 
 void AudioTask::prevTrack()
 {
-    AudioCommand cmd{AudioCommandType::PrevTrack};
-    xQueueSend(cmdQueue, &cmd, 0);
+    sendCommand(AudioCommandType::PrevTrack);
 }
 
 void AudioTask::pause()
 {
-    AudioCommand cmd{AudioCommandType::Pause};
-    xQueueSend(cmdQueue, &cmd, 0);
+    sendCommand(AudioCommandType::Pause);
 }
 
 void AudioTask::resume()
 {
-    AudioCommand cmd{AudioCommandType::Resume};
-    xQueueSend(cmdQueue, &cmd, 0);
+    sendCommand(AudioCommandType::Resume);
 }
 
 void AudioTask::stop()
 {
-    AudioCommand cmd{AudioCommandType::Stop};
-    xQueueSend(cmdQueue, &cmd, 0);
+    sendCommand(AudioCommandType::Stop);
 }
 
 void AudioTask::setMusicVolume(uint8_t v)
 {
-    AudioCommand cmd{AudioCommandType::SetMusicVol};
-    cmd.param.value = v;
-    xQueueSend(cmdQueue, &cmd, 0);
+    portENTER_CRITICAL(&cmdLock);
+    latchMusicVol = v;
+    portEXIT_CRITICAL(&cmdLock);
+    sendLatched(AudioCommandType::SetMusicVol, LATCH_MUSIC_VOL);
 }
 
 void AudioTask::setAnnouncementVolume(uint8_t v)
 {
-    AudioCommand cmd{AudioCommandType::SetAnnounceVol};
-    cmd.param.value = v;
-    xQueueSend(cmdQueue, &cmd, 0);
+    portENTER_CRITICAL(&cmdLock);
+    latchAnnVol = v;
+    portEXIT_CRITICAL(&cmdLock);
+    sendLatched(AudioCommandType::SetAnnounceVol, LATCH_ANN_VOL);
 }
 
 void AudioTask::toggleMute()
 {
-    AudioCommand cmd{AudioCommandType::MuteToggle};
-    xQueueSend(cmdQueue, &cmd, 0);
+    portENTER_CRITICAL(&cmdLock);
+    latchMuteToggles ^= 1;
+    portEXIT_CRITICAL(&cmdLock);
+    sendLatched(AudioCommandType::MuteToggle, LATCH_MUTE);
+}
+
+void AudioTask::radioTuned(uint16_t freq)
+{
+    portENTER_CRITICAL(&cmdLock);
+    latchRadioFreq = freq;
+    portEXIT_CRITICAL(&cmdLock);
+    sendLatched(AudioCommandType::RadioTuned, LATCH_RADIO);
 }
 
 AudioFormat AudioTask::detectFormat(File &file, uint8_t *buf)
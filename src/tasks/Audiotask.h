@@ -13,6 +13,8 @@
 #include "stdint.h"
 #include "string.h"
 #include "setupDriver.h"
+#include "sourceSwitch.h"
+#include "../SystemEvents.h"
 #include <Wire.h>
 
 //#include "VolumeManager.h"
@@ -35,15 +37,51 @@ enum class AudioCommandType : uint8_t {
   Stop,
   SetMusicVol,
   SetAnnounceVol,
-  MuteToggle
+  MuteToggle,
+  RadioTuned
 };
 
+// Queue record. String parameters (file path, URL, frequency string) are
+// interned in the task's string pool and travel as a 16-bit handle, so a
+// command is 8 bytes on the queue instead of 68.
+static constexpr uint16_t AUDIO_STR_NONE = 0xFFFF;
+
 struct AudioCommand {
   AudioCommandType type;
-  union {
-    char     str[64];    // file path, URL, frequency string
-    uint32_t value;      // numeric param (e.g. resume offset)
-  } param;
+  uint8_t          reserved;
+  uint16_t         str;      // interned string handle or AUDIO_STR_NONE
+  uint32_t         value;    // numeric param (e.g. resume offset)
+};
+static_assert(sizeof(AudioCommand) == 8, "AudioCommand must stay 8 bytes");
+
+// Queue statistics, readable from any task
+struct AudioQueueStats {
+  uint32_t sent;         // commands accepted by the queue
+  uint32_t dropped;      // commands rejected (queue full or string pool full)
+  uint32_t coalesced;    // idempotent commands merged into a pending one
+  uint8_t  depth;        // commands currently waiting
+  uint8_t  highWater;    // maximum depth seen
+  uint8_t  stringsInUse; // interned strings currently held
+};
+
+// Task loop statistics: why and how often the task wakes up
+static constexpr int AUDIO_NUM_PLAY_STATES = 5;
+
+struct AudioLoopStats {
+  uint32_t wakeups[AUDIO_NUM_PLAY_STATES]; // wakeups per PlayState
+  uint32_t timeouts;     // waits that ended without an event
+  uint64_t blockedUs;    // time spent blocked waiting for events
+  uint64_t activeUs;     // time spent running between waits
+};
+
+// Level meter cost, readable from any task
+struct AudioMeterStats {
+  uint32_t polls;        // meter reads from the decoder
+  uint32_t deferred;     // read slots skipped for audio or I2C load
+  uint32_t spiUs;        // total SCI time of the reads
+  uint32_t spiMaxUs;
+  uint16_t intervalMs;   // current read interval
+  uint8_t  bands;        // 2 = VU meter, more = spectrum plugin, 0 = off
 };
 
 //─────────────────────────────────────────────────────────────────────────────
@@ -82,7 +120,7 @@ enum class PlayState : uint8_t {
   AnnouncementPlay
 };
 
-// Save/restore info
+// Save/restore info (audio task only; other tasks read AudioStatus)
 struct PlaybackState {
   String   filePath;
   uint32_t filePos;
@@ -118,23 +156,61 @@ public:
   void toggleMute();
   bool isMuted() const;
 
+  // The tuner task reports the channel it tuned to (10 kHz units)
+  void radioTuned(uint16_t freq);
+
   void setRetriggerMode(RetriggerMode m);
   RetriggerMode getRetriggerMode() const;
 
   Mode         getMode() const;
   PlaybackType getPlaybackType() const;
-  PlaybackState getCurrentState() const;
+  void         getStatus(AudioStatus& out) const;
+  AudioQueueStats getQueueStats() const;
+  AudioLoopStats  getLoopStats() const;
+  AudioMeterStats getMeterStats() const;
+  SourceSwitchStats getSwitchStats() const;
 
 private:
   // RTOS task
   static void     taskEntry(void* pv);
   void            taskLoop();
+  static void     dreqIsr();
+
+  // Event wait: the loop blocks on task notifications instead of polling
+  static constexpr uint32_t NOTIFY_CMD        = 1 << 0;
+  static constexpr uint32_t NOTIFY_DREQ       = 1 << 1;
+  static constexpr TickType_t DREQ_WAIT_TICKS = pdMS_TO_TICKS(10); // guard against a missed edge
+  static constexpr TickType_t IO_WAIT_TICKS   = pdMS_TO_TICKS(5);  // network has no wakeup source
+  TickType_t      nextWaitTimeout();
+  void            waitForEvents(TickType_t timeout);
+
+  // Level meter: VU from the firmware patches, or the spectrum plugin if
+  // built in. Read only while someone displays it (audioMeterWanted()).
+  static constexpr uint32_t METER_MIN_INTERVAL_MS = 50;
+  static constexpr uint32_t METER_MAX_INTERVAL_MS = 400;
+  static constexpr uint16_t METER_I2C_BACKLOG     = 4;  // queued display writes that count as busy
+  void            initMeter();
+  void            pollMeter();
+  TickType_t      meterWaitTicks() const;
+
+  // Status snapshot for other tasks
+  static constexpr uint32_t STATUS_PERIOD_MS    = 500;
+  static constexpr int      STREAM_FILL_NOMINAL = 4096; // bytes counted as a full stream buffer
+  void            publishStatus();
 
   // Command handling
+  bool            sendCommand(AudioCommandType type, uint32_t value = 0, const char* str = nullptr);
+  bool            sendLatched(AudioCommandType type, uint8_t bit);
   void            handleCommand(const AudioCommand& cmd);
+  void            takeParam(const AudioCommand& cmd);
+
+  // String interning for queued commands
+  uint16_t        internString(const char* s);
+  void            releaseString(uint16_t h);
 
   // Unified playback
-  void            initPlayback();
+  static constexpr uint8_t MAX_OPEN_FAILURES = 8; // unreadable files skipped before going idle
+  bool            initPlayback();    // false when there is nothing to play
   bool            stepPlayback();
   void            onPlaybackFinished();
 
@@ -146,8 +222,27 @@ private:
   // Test mode
   void            saveTestState();
 
+  // Source changes: ramp, flush and SCI_MODE through SourceSwitch
+  class PlayerPort : public Vs1053Port {
+  public:
+    explicit PlayerPort(AudioTask& owner) : owner(owner) {}
+    uint16_t sciRead(uint8_t reg) override;
+    void     sciWrite(uint8_t reg, uint16_t value) override;
+    void     sdiFill(uint8_t fill, size_t len) override;
+    void     softReset() override;
+    void     waitUs(uint32_t us) override;
+    uint32_t nowUs() override;
+  private:
+    AudioTask& owner;
+  };
+  static uint8_t  volumeAtt(uint8_t vol);
+  void            switchInput(AudioInput input, uint8_t att);
+  void            stopOutput();
+  void            takeSwitchStats();
+
   // Helpers
   void            setHWVolume(uint8_t vol);
+  void            applyMuteToggle();
   void            loadRetriggerMode();
   void            saveRetriggerMode();
 
@@ -157,10 +252,48 @@ private:
   // Hardware interfaces
   VS1053               player;
   Si4703               fmradio;
+  PlayerPort           playerPort{*this};
+  SourceSwitch         sourceSwitch{playerPort};
+  SourceSwitchStats    switchStats       = {};
+
+  TaskHandle_t         taskHandle        = nullptr;
+  AudioLoopStats       loopStats         = {};
+  uint32_t             lastWakeUs        = 0;
+  bool                 statusDirty       = true;
+  bool                 passProgress      = false; // this pass handled a command or fed data
+  uint8_t              openFailures      = 0;     // files skipped in a row because they did not open
+  uint32_t             lastStatusMs      = 0;
+  AudioStatus          lastPublished     = {};
+  uint8_t              meterBands        = 0;
+  uint32_t             meterLastMs       = 0;
+  uint32_t             meterIntervalMs   = METER_MIN_INTERVAL_MS;
+  bool                 meterIdle         = true;
+  AudioMeterStats      meterStats        = {};
 
   // Queue and buffer
   static constexpr int QUEUE_LEN = 12;
   QueueHandle_t        cmdQueue;
+  mutable portMUX_TYPE cmdLock           = portMUX_INITIALIZER_UNLOCKED;
+  AudioQueueStats      queueStats        = {};
+
+  // Interned strings: one per queued command plus one spare
+  static constexpr int STR_SLOTS = QUEUE_LEN + 1;
+  static constexpr int STR_LEN   = 64;
+  char                 strPool[STR_SLOTS][STR_LEN];
+  uint8_t              strRefs[STR_SLOTS] = {};
+
+  // Last-writer-wins latches for idempotent commands. Only the first
+  // request while a latch is pending goes through the queue; later ones
+  // just overwrite the latched value.
+  static constexpr uint8_t LATCH_MUSIC_VOL = 1 << 0;
+  static constexpr uint8_t LATCH_ANN_VOL   = 1 << 1;
+  static constexpr uint8_t LATCH_MUTE      = 1 << 2;
+  static constexpr uint8_t LATCH_RADIO     = 1 << 3;
+  uint8_t              latchPending      = 0;
+  uint8_t              latchMusicVol     = 0;
+  uint8_t              latchAnnVol       = 0;
+  uint8_t              latchMuteToggles  = 0;
+  uint16_t             latchRadioFreq    = 0;
   static constexpr int BUF_SZ    = 64;
   uint8_t              buf[BUF_SZ];
 
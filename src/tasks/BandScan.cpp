@@ -0,0 +1,359 @@
+#include "BandScan.h"
+#include "Audiotask.h"
+#include "../AppDrivers/i2cBus.h"
+#include "../AppDrivers/si4703Regs.h"
+#include "../AppDrivers/setupDriver.h"
+#include "../SystemEvents.h"
+
+// Range of Setup.freqMemories in the settings schema
+#define MEMORY_FREQ_MIN 8750
+#define MEMORY_FREQ_MAX 10800
+
+static TaskHandle_t scanTaskHandle = nullptr;
+static volatile bool scanActive = false;
+static volatile bool cancelRequested = false;
+
+// Scan task only
+static Si4703Regs regs;          // its view of the tuner registers
+static ScanResult work;
+static uint8_t rssiTable[SCAN_MAX_CHANNELS];
+static uint8_t stereoBits[(SCAN_MAX_CHANNELS + 7) / 8];
+static uint16_t startFreq;       // AudioStatus radio frequency at the start
+
+// Copy for other tasks
+static portMUX_TYPE resultLock = portMUX_INITIALIZER_UNLOCKED;
+static ScanResult result;
+
+static void publishProgress()
+{
+    portENTER_CRITICAL(&resultLock);
+    result = work;
+    portEXIT_CRITICAL(&resultLock);
+}
+
+static bool readFn(void *ctx)
+{
+    return si4703Read(regs, (uint8_t)(uintptr_t)ctx);
+}
+
+static bool writeFn(void *ctx)
+{
+    return si4703Write(regs, (uint8_t)(uintptr_t)ctx);
+}
+
+static bool readRegs(uint8_t count)
+{
+    work.busTransactions++;
+    return i2cBusRun(I2C_DEV_RADIO, I2C_PRIO_NORMAL, readFn, (void *)(uintptr_t)count);
+}
+
+static bool writeRegs(uint8_t last)
+{
+    work.busTransactions++;
+    return i2cBusRun(I2C_DEV_RADIO, I2C_PRIO_NORMAL, writeFn, (void *)(uintptr_t)last);
+}
+
+// The audio task tuned the radio (new source or channel): it owns the tuner
+static bool tunedElsewhere()
+{
+    AudioStatus audio;
+    readAudioStatus(audio);
+    return audio.source == (uint8_t)PlaybackType::Radio && audio.radioFreq != startFreq;
+}
+
+static bool stopRequested()
+{
+    return cancelRequested || tunedElsewhere();
+}
+
+// Tune to 'channel', sleeping between STC polls. The status of the tuned
+// channel (RSSI, stereo) is left in regs.
+static bool tune(uint16_t channel)
+{
+    regs.reg[SI4703_POWERCFG] &= ~SI4703_SEEK;
+    regs.reg[SI4703_CHANNEL] = (regs.reg[SI4703_CHANNEL] & ~SI4703_CHAN_MASK) | SI4703_TUNE | channel;
+    if (!writeRegs(SI4703_CHANNEL))
+        return false;
+
+    uint32_t start = millis();
+    bool complete = false;
+    bool ok = true;
+    while (ok && !complete && millis() - start < SCAN_TUNE_TIMEOUT_MS)
+    {
+        vTaskDelay(pdMS_TO_TICKS(SCAN_STC_POLL_MS));
+        ok = readRegs(1);
+        complete = regs.reg[SI4703_STATUSRSSI] & SI4703_STC;
+    }
+    uint16_t status = regs.reg[SI4703_STATUSRSSI];
+
+    // STC drops once TUNE is cleared; the next tune needs it low
+    regs.reg[SI4703_CHANNEL] &= ~SI4703_TUNE;
+    ok = writeRegs(SI4703_CHANNEL) && ok;
+    for (int i = 0; ok && i < 3; i++)
+    {
+        ok = readRegs(1);
+        if (!(regs.reg[SI4703_STATUSRSSI] & SI4703_STC))
+            break;
+        vTaskDelay(1);
+    }
+    regs.reg[SI4703_STATUSRSSI] = status;
+    return ok && complete;
+}
+
+// Wait for the same PI in two different groups with an error-free block A
+static uint16_t readPi(uint32_t &dwellMs)
+{
+    uint32_t start = millis();
+    uint16_t candidate = 0;
+    uint16_t lastB = 0;
+    uint16_t pi = 0;
+    while (!pi && millis() - start < SCAN_PI_DWELL_MS && !stopRequested())
+    {
+        vTaskDelay(pdMS_TO_TICKS(SCAN_PI_POLL_MS));
+        // STATUSRSSI, READCHAN, RDSA, RDSB
+        if (!readRegs(4))
+            continue;
+        uint16_t status = regs.reg[SI4703_STATUSRSSI];
+        if (!(status & SI4703_RDSR) || ((status >> 9) & 3))
+            continue;
+        uint16_t a = regs.reg[SI4703_RDSA];
+        uint16_t b = regs.reg[SI4703_RDSB];
+        if (a && a == candidate && b != lastB)
+            pi = a;
+        candidate = a;
+        lastB = b;
+    }
+    dwellMs = millis() - start;
+    return pi;
+}
+
+static uint8_t storeMemories()
+{
+    const int slots = sizeof(Setup.freqMemories) / sizeof(Setup.freqMemories[0]);
+    uint16_t mem[slots];
+    int n = 0;
+    for (int i = 0; i < work.stations && n < slots; i++)
+    {
+        uint16_t f = work.station[i].freq;
+        if (f >= MEMORY_FREQ_MIN && f <= MEMORY_FREQ_MAX)
+            mem[n++] = f;
+    }
+    if (!n)
+        return 0;
+
+    // Unused slots repeat the best station, as the defaults do
+    for (int i = n; i < slots; i++)
+        mem[i] = mem[0];
+
+    // All slots change in one step for the settings writer
+    setupLock();
+    memcpy(Setup.freqMemories, mem, sizeof(mem));
+    markSetupDirty();
+    setupUnlock();
+    return n;
+}
+
+static void runScan()
+{
+    uint32_t scanStart = millis();
+    memset(&work, 0, sizeof(work));
+    memset(rssiTable, 0, sizeof(rssiTable));
+    memset(stereoBits, 0, sizeof(stereoBits));
+    AudioStatus audio;
+    readAudioStatus(audio);
+    startFreq = audio.source == (uint8_t)PlaybackType::Radio ? audio.radioFreq : 0;
+    work.state = ScanState::Sweep;
+    publishProgress();
+
+    if (!readRegs(SI4703_REG_COUNT))
+    {
+        work.state = ScanState::Failed;
+        work.totalMs = millis() - scanStart;
+        publishProgress();
+        Serial.println("BandScan: tuner not responding");
+        return;
+    }
+    uint16_t savedPower = regs.reg[SI4703_POWERCFG];
+    uint16_t home = regs.reg[SI4703_READCHAN] & SI4703_CHAN_MASK;
+    Si4703Band band = si4703Band(regs);
+    uint16_t channels = (band.top - band.bottom) / band.spacing + 1;
+    if (channels > SCAN_MAX_CHANNELS)
+        channels = SCAN_MAX_CHANNELS;
+    work.channels = channels;
+
+    // Muted for the scan; RDS on for the PI codes
+    regs.reg[SI4703_POWERCFG] = (savedPower & ~(SI4703_DMUTE | SI4703_SEEK)) | SI4703_RDSM;
+    regs.reg[SI4703_CHANNEL] &= ~SI4703_TUNE;
+    regs.reg[SI4703_SYSCONFIG1] |= SI4703_RDS;
+    bool ok = writeRegs(SI4703_SYSCONFIG1);
+    ScanState end = ScanState::Done;
+
+    uint32_t passStart = millis();
+    for (uint16_t ch = 0; ok && ch < channels; ch++)
+    {
+        if (stopRequested())
+        {
+            end = ScanState::Cancelled;
+            break;
+        }
+        uint32_t us = micros();
+        ok = tune(ch);
+        us = micros() - us;
+        if (us > work.sweepDwellMaxUs)
+            work.sweepDwellMaxUs = us;
+
+        uint16_t status = regs.reg[SI4703_STATUSRSSI];
+        rssiTable[ch] = status & SI4703_RSSI_MASK;
+        if (status & SI4703_ST)
+            stereoBits[ch / 8] |= 1 << (ch % 8);
+        work.progress = ch + 1;
+        publishProgress();
+    }
+    work.sweepMs = millis() - passStart;
+
+    if (ok && end == ScanState::Done)
+    {
+        uint16_t peaks[SCAN_MAX_STATIONS];
+        uint8_t count = scanFindPeaks(rssiTable, channels, peaks);
+        work.state = ScanState::Identify;
+        work.progress = 0;
+        publishProgress();
+
+        passStart = millis();
+        for (uint8_t i = 0; ok && i < count; i++)
+        {
+            if (stopRequested())
+            {
+                end = ScanState::Cancelled;
+                break;
+            }
+            uint16_t ch = peaks[i];
+            uint32_t dwellMs = 0;
+            uint16_t pi = 0;
+            ok = tune(ch);
+            if (ok)
+                pi = readPi(dwellMs);
+            if (dwellMs > work.identifyDwellMaxMs)
+                work.identifyDwellMaxMs = dwellMs;
+
+            // Same programme on another channel: peaks come strongest first
+            ScanStation s;
+            s.freq = si4703ChannelFreq(band, ch);
+            s.pi = pi;
+            s.rssi = rssiTable[ch];
+            s.stereo = stereoBits[ch / 8] & (1 << (ch % 8));
+            scanAddStation(work.station, work.stations, s);
+            work.progress = i + 1;
+            publishProgress();
+        }
+        work.identifyMs = millis() - passStart;
+        scanRankStations(work.station, work.stations);
+    }
+    if (!ok)
+        end = ScanState::Failed;
+
+    // Back to the channel we found, unless the audio task has tuned since;
+    // then restore the mute bit on top of what its driver wrote
+    if (!tunedElsewhere())
+        tune(home);
+    if (readRegs(SI4703_REG_COUNT))
+    {
+        regs.reg[SI4703_POWERCFG] = (regs.reg[SI4703_POWERCFG] & ~(SI4703_DMUTE | SI4703_SEEK)) |
+                                    (savedPower & SI4703_DMUTE);
+        writeRegs(SI4703_POWERCFG);
+    }
+
+    if (end == ScanState::Done)
+        work.memories = storeMemories();
+    work.state = end;
+    work.totalMs = millis() - scanStart;
+    publishProgress();
+    Serial.printf("BandScan: %s, %u channels in %lu ms, %u stations, %u memories\n", bandScanStateName(end),
+                  channels, work.totalMs, work.stations, work.memories);
+}
+
+static void scanTask(void *pvParameters)
+{
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        runScan();
+        scanActive = false;
+    }
+}
+
+bool initBandScanTask()
+{
+    if (scanTaskHandle != nullptr)
+    {
+        Serial.println("BandScan: Task already running");
+        return false;
+    }
+
+    // Lowest application priority: every step only waits on the tuner
+    BaseType_t result = xTaskCreatePinnedToCore(
+        scanTask,
+        "BandScan",
+        3072,
+        nullptr,
+        tskIDLE_PRIORITY + 1,
+        &scanTaskHandle,
+        0);
+
+    if (result != pdPASS)
+    {
+        Serial.println("BandScan: Failed to create task");
+        scanTaskHandle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool bandScanStart()
+{
+    if (!scanTaskHandle || scanActive)
+        return false;
+    cancelRequested = false;
+    scanActive = true;
+    xTaskNotifyGive(scanTaskHandle);
+    return true;
+}
+
+void bandScanCancel()
+{
+    if (scanActive)
+        cancelRequested = true;
+}
+
+bool bandScanActive()
+{
+    return scanActive;
+}
+
+ScanResult bandScanGetResult()
+{
+    portENTER_CRITICAL(&resultLock);
+    ScanResult r = result;
+    portEXIT_CRITICAL(&resultLock);
+    return r;
+}
+
+const char *bandScanStateName(ScanState state)
+{
+    switch (state)
+    {
+    case ScanState::Idle:
+        return "idle";
+    case ScanState::Sweep:
+        return "sweeping";
+    case ScanState::Identify:
+        return "reading RDS";
+    case ScanState::Done:
+        return "done";
+    case ScanState::Cancelled:
+        return "cancelled";
+    case ScanState::Failed:
+        return "failed";
+    }
+    return "?";
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <Arduino.h>
+#include "../AppDrivers/bandScanLogic.h"
+
+/**
+ * @brief BandScan - background FM band scan that fills the station memories
+ *
+ * A low-priority task steps the Si4703 across the band through the I2C bus
+ * task at NORMAL priority, so tune requests still go first and the UI and
+ * audio tasks never wait for it. Each step is a short transaction followed
+ * by a sleep while the tuner settles.
+ *
+ * - Sweep: tune every channel and record RSSI and the stereo flag
+ * - Identify: revisit channels that are local RSSI peaks above
+ *   SCAN_MIN_RSSI and wait up to SCAN_PI_DWELL_MS for the RDS PI code
+ * - Rank: one entry per PI (the strongest), stations with RDS first, then
+ *   by RSSI; the list is written to Setup.freqMemories with a single
+ *   markSetupDirty(). Peak finding, PI dedupe and ranking are in
+ *   AppDrivers/bandScanLogic.
+ *
+ * The tuner is muted and retuned to the original channel at the end. A
+ * cancel, or a tune request from elsewhere, stops the scan; memories are
+ * only written by a scan that completed.
+ */
+
+#define SCAN_STC_POLL_MS     4      // tune-complete polling interval
+#define SCAN_TUNE_TIMEOUT_MS 200
+#define SCAN_PI_DWELL_MS     600    // longest wait for a PI on a candidate
+#define SCAN_PI_POLL_MS      20
+#define SCAN_MAX_CHANNELS    641    // 76-108 MHz at 50 kHz
+
+enum class ScanState : uint8_t {
+    Idle,
+    Sweep,
+    Identify,
+    Done,
+    Cancelled,
+    Failed
+};
+
+struct ScanResult {
+    ScanState state;
+    uint16_t channels;         // channels in the band
+    uint16_t progress;         // channels done in the current pass
+    uint8_t stations;          // ranked entries in station[]
+    ScanStation station[SCAN_MAX_STATIONS];
+    uint8_t memories;          // entries written to Setup.freqMemories
+    uint32_t totalMs;          // whole scan, including restore
+    uint32_t sweepMs;
+    uint32_t sweepDwellMaxUs;  // per channel: tune, settle, measure
+    uint32_t identifyMs;
+    uint32_t identifyDwellMaxMs;
+    uint32_t busTransactions;
+};
+
+/**
+ * @brief Create the scan task (idle until bandScanStart())
+ */
+bool initBandScanTask();
+
+/**
+ * @brief Start a scan
+ * @return False if one is running or the task does not exist
+ */
+bool bandScanStart();
+
+/**
+ * @brief Stop a running scan; the tuner returns to its channel
+ */
+void bandScanCancel();
+
+/**
+ * @brief True while the scan owns the tuner (other pollers pause)
+ */
+bool bandScanActive();
+
+/**
+ * @brief Copy of the latest result, also while a scan runs
+ */
+ScanResult bandScanGetResult();
+
+const char *bandScanStateName(ScanState state);
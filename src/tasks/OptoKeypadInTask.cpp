@@ -2,6 +2,7 @@
 #include "../AppDrivers/keypadDriver.h"
 #include "../AppDrivers/optoInDriver.h"
 #include "userUi.h"
+#include "Profiler.h"
 #include <Arduino.h>
 
 // Task handle for the OptoKeypadInTask
@@ -32,9 +33,9 @@ void optoKeypadInTask(void *pvParameters)
     while (true)
     {
         // --- Core input scanning operations ---
+        uint32_t scanStartUs = micros();
         
-        // Scan keypad inputs (debouncing handled internally)
-        keypadRead();
+        // Keypad is interrupt driven (see keypadInit), only optos are polled
         
         // Scan opto inputs and update filtered values
         scanOptos();
@@ -42,6 +43,7 @@ void optoKeypadInTask(void *pvParameters)
         // Update opto event states (press, release, longpress, etc.)
         updateOptoEvents();
         
+        PROF_TRACE(PROF_INPUT_SCAN, micros() - scanStartUs);
        
         // --- Precise timing control ---
         // Use vTaskDelayUntil for precise periodic execution
@@ -0,0 +1,167 @@
+#include "Profiler.h"
+#include "SerialMonitor.h"
+#include <atomic>
+
+volatile bool profEnabled = false;
+
+// Trace ring
+struct ProfTraceEntry {
+    uint32_t timeUs;
+    uint16_t arg;
+    uint8_t  id;
+    uint8_t  core;
+};
+
+static ProfTraceEntry traceRing[PROF_TRACE_LEN];
+static std::atomic<uint32_t> traceHead{0};
+
+// AudioTask timing
+static uint32_t audioPasses = 0;
+static uint32_t audioMaxPassUs = 0;
+static uint32_t audioMaxPlayGapUs = 0;
+static uint32_t dreqHist[PROF_HIST_BUCKETS];
+static uint32_t dreqMaxUs = 0;
+
+// Previous run-time counters, to report CPU share since the last sample
+#define PROF_MAX_TASKS 24
+static uint32_t prevTaskNumber[PROF_MAX_TASKS];
+static uint32_t prevTaskRuntime[PROF_MAX_TASKS];
+static uint32_t prevTotalRuntime = 0;
+
+static const char *const pointNames[PROF_POINT_COUNT] = {
+    "audio-cmd", "audio-wake", "audio-dreq", "input-scan", "ui-wake"};
+
+void profTrace(uint8_t id, uint32_t arg)
+{
+    uint32_t pos = traceHead.fetch_add(1, std::memory_order_relaxed);
+    ProfTraceEntry &e = traceRing[pos & (PROF_TRACE_LEN - 1)];
+    e.timeUs = micros();
+    e.arg = arg > 0xFFFF ? 0xFFFF : arg;
+    e.id = id;
+    e.core = xPortGetCoreID();
+}
+
+void profAudioPass(uint32_t passUs, uint32_t gapUs, bool playing)
+{
+    audioPasses++;
+    if (passUs > audioMaxPassUs)
+        audioMaxPassUs = passUs;
+    if (playing && gapUs > audioMaxPlayGapUs)
+        audioMaxPlayGapUs = gapUs;
+}
+
+void profDreqWait(uint32_t waitUs)
+{
+    int bucket = 0;
+    for (uint32_t limit = 64; bucket < PROF_HIST_BUCKETS - 1 && waitUs >= limit; limit <<= 1)
+        bucket++;
+    dreqHist[bucket]++;
+    if (waitUs > dreqMaxUs)
+        dreqMaxUs = waitUs;
+    PROF_TRACE(PROF_AUDIO_DREQ, waitUs);
+}
+
+void profSetEnabled(bool on)
+{
+    profEnabled = on;
+}
+
+void profReset()
+{
+    audioPasses = 0;
+    audioMaxPassUs = 0;
+    audioMaxPlayGapUs = 0;
+    dreqMaxUs = 0;
+    memset(dreqHist, 0, sizeof(dreqHist));
+    traceHead.store(0, std::memory_order_relaxed);
+    memset(traceRing, 0, sizeof(traceRing));
+}
+
+static void printTasks()
+{
+#if configUSE_TRACE_FACILITY
+    static TaskStatus_t tasks[PROF_MAX_TASKS];
+    uint32_t totalRuntime = 0;
+    UBaseType_t n = uxTaskGetSystemState(tasks, PROF_MAX_TASKS, &totalRuntime);
+
+    SerPrintf("  %-16s %4s %5s %6s %6s\n", "Task", "Core", "Prio", "Stack", "CPU%");
+    for (UBaseType_t i = 0; i < n; i++)
+    {
+        const TaskStatus_t &t = tasks[i];
+        float cpu = -1.0f;
+#if configGENERATE_RUN_TIME_STATS
+        uint32_t totalDelta = totalRuntime - prevTotalRuntime;
+        for (int j = 0; j < PROF_MAX_TASKS; j++)
+        {
+            if (prevTaskNumber[j] == t.xTaskNumber && totalDelta)
+            {
+                cpu = 100.0f * (t.ulRunTimeCounter - prevTaskRuntime[j]) / totalDelta;
+                break;
+            }
+        }
+#endif
+        int core = t.xCoreID > 1 ? -1 : (int)t.xCoreID;
+        if (cpu >= 0.0f)
+            SerPrintf("  %-16s %4d %5u %6lu %5.1f\n", t.pcTaskName, core, t.uxCurrentPriority,
+                      (unsigned long)t.usStackHighWaterMark, cpu);
+        else
+            SerPrintf("  %-16s %4d %5u %6lu %6s\n", t.pcTaskName, core, t.uxCurrentPriority,
+                      (unsigned long)t.usStackHighWaterMark, "-");
+    }
+
+    // Remember this sample for the next report
+    for (int j = 0; j < PROF_MAX_TASKS; j++)
+    {
+        prevTaskNumber[j] = j < (int)n ? tasks[j].xTaskNumber : 0;
+        prevTaskRuntime[j] = j < (int)n ? tasks[j].ulRunTimeCounter : 0;
+    }
+    prevTotalRuntime = totalRuntime;
+#else
+    SerPrintf("  Task list unavailable (configUSE_TRACE_FACILITY is off)\n");
+#endif
+}
+
+void profPrintReport()
+{
+    SerPrintf("\n=== Profiler (%s) ===\n", profEnabled ? "on" : "off");
+    SerPrintf("Tasks (stack = free bytes at high-water mark, CPU since last report):\n");
+    printTasks();
+
+    SerPrintf("AudioTask: %lu passes, max pass %lu us, max gap while playing %lu us\n",
+              audioPasses, audioMaxPassUs, audioMaxPlayGapUs);
+
+    SerPrintf("DREQ wait histogram (max %lu us):\n", dreqMaxUs);
+    uint32_t limit = 64;
+    for (int i = 0; i < PROF_HIST_BUCKETS; i++, limit <<= 1)
+    {
+        if (i < PROF_HIST_BUCKETS - 1)
+            SerPrintf("  < %6lu us: %lu\n", limit, dreqHist[i]);
+        else
+            SerPrintf("  >=%6lu us: %lu\n", limit >> 1, dreqHist[i]);
+    }
+    SerPrintf("Trace points recorded: %lu\n", traceHead.load(std::memory_order_relaxed));
+}
+
+void profPrintTrace(int count)
+{
+    if (count <= 0)
+    {
+        SerPrintf("Trace count must be positive\n");
+        return;
+    }
+    uint32_t head = traceHead.load(std::memory_order_relaxed);
+    uint32_t n = (uint32_t)count;
+    if (n > PROF_TRACE_LEN)
+        n = PROF_TRACE_LEN;
+    if (n > head)
+        n = head;
+
+    uint32_t prevUs = 0;
+    for (uint32_t pos = head - n; pos != head; pos++)
+    {
+        const ProfTraceEntry &e = traceRing[pos & (PROF_TRACE_LEN - 1)];
+        SerPrintf("  %10lu us  +%7lu  core%u  %-10s %u\n", e.timeUs, pos == head - n ? 0 : e.timeUs - prevUs,
+                  e.core, e.id < PROF_POINT_COUNT ? pointNames[e.id] : "?", e.arg);
+        prevUs = e.timeUs;
+    }
+}
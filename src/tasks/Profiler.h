@@ -0,0 +1,56 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * @brief Lightweight runtime profiler
+ *
+ * - Per-task CPU share and stack high-water marks, sampled on request
+ * - Worst-case AudioTask pass time and gap between passes while playing
+ * - Histogram of time spent waiting for VS1053 DREQ
+ * - Ring buffer of timestamped trace points on the hot paths
+ *
+ * Everything except the task sampling is gated by profEnabled, so a
+ * disabled trace point costs one load and branch.
+ */
+
+// Trace point identifiers
+enum ProfPoint : uint8_t {
+    PROF_AUDIO_CMD = 0,   // arg: AudioCommandType
+    PROF_AUDIO_WAKE,      // arg: PlayState
+    PROF_AUDIO_DREQ,      // arg: wait time in us (saturated)
+    PROF_INPUT_SCAN,      // arg: scan time in us
+    PROF_UI_WAKE,         // arg: event mask
+    PROF_POINT_COUNT
+};
+
+#define PROF_TRACE_LEN      128  // trace ring entries, power of two
+#define PROF_HIST_BUCKETS   12   // <64us, <128us, ... , >=64ms
+
+extern volatile bool profEnabled;
+
+#define PROF_TRACE(id, arg)               \
+    do {                                  \
+        if (profEnabled)                  \
+            profTrace((id), (arg));       \
+    } while (0)
+
+// Record a trace point (use PROF_TRACE)
+void profTrace(uint8_t id, uint32_t arg);
+
+// AudioTask hooks: pass duration, and gap since the previous pass while playing
+void profAudioPass(uint32_t passUs, uint32_t gapUs, bool playing);
+
+// AudioTask hook: time blocked waiting for DREQ
+void profDreqWait(uint32_t waitUs);
+
+// Control and output (serial monitor)
+void profSetEnabled(bool on);
+void profReset();
+void profPrintReport();
+void profPrintTrace(int count);
+
+#endif // PROFILER_H
@@ -0,0 +1,241 @@
+#include "RdsTask.h"
+#include "Audiotask.h"
+#include "BandScan.h"
+#include "../AppDrivers/i2cBus.h"
+#include "../AppDrivers/rdsDecoder.h"
+#include "../AppDrivers/si4703Regs.h"
+#include "../SystemEvents.h"
+
+static TaskHandle_t rdsTaskHandle = nullptr;
+static RdsTaskStats stats;
+static RdsState decoder;
+static uint8_t rssi;
+static bool stereo;
+
+// Poll: STATUSRSSI, READCHAN and the four RDS blocks
+#define RDS_POLL_REGS 6
+
+static bool readGroup(void *ctx)
+{
+    return si4703Read(*(Si4703Regs *)ctx, RDS_POLL_REGS);
+}
+
+// Set RDS on and verbose mode, leaving the other bits as the driver set them
+static bool enableRds(void *ctx)
+{
+    Si4703Regs r;
+    if (!si4703Read(r, SI4703_REG_COUNT))
+        return false;
+    r.reg[SI4703_POWERCFG] |= SI4703_RDSM;
+    r.reg[SI4703_SYSCONFIG1] |= SI4703_RDS;
+    return si4703Write(r, SI4703_SYSCONFIG1);
+}
+
+static void publish(uint16_t freq, uint32_t ctMs)
+{
+    RdsStatus s = {};
+    s.freq = freq;
+    s.pi = decoder.pi;
+    s.rssi = freq ? rssi : 0;
+    s.stereo = freq && stereo;
+    s.pty = decoder.pty;
+    s.tp = decoder.tp;
+    s.ta = decoder.ta;
+    if (decoder.psValid)
+        memcpy(s.ps, decoder.ps, sizeof(s.ps));
+    if (decoder.rtValid)
+        memcpy(s.rt, decoder.rt, sizeof(s.rt));
+    if (decoder.ctValid)
+    {
+        // UTC plus the local offset, carried into the day
+        int32_t minutes = decoder.ct.hour * 60 + decoder.ct.minute + decoder.ct.offset * 30;
+        int32_t mjd = decoder.ct.mjd;
+        if (minutes < 0)
+        {
+            minutes += 1440;
+            mjd--;
+        }
+        else if (minutes >= 1440)
+        {
+            minutes -= 1440;
+            mjd++;
+        }
+        s.ctValid = true;
+        s.ctMjd = mjd;
+        s.ctHour = minutes / 60;
+        s.ctMinute = minutes % 60;
+        s.ctMs = ctMs;
+    }
+    publishRdsStatus(s);
+}
+
+static bool radioPlaying(AudioStatus &a)
+{
+    readAudioStatus(a);
+    return a.source == (uint8_t)PlaybackType::Radio;
+}
+
+static void rdsTask(void *pvParameters)
+{
+    EventSubscriber sub = eventBusSubscribe("RDS", SYS_EVENT_MASK(SysEvent::SourceChanged));
+    SysEventRecord ev;
+    AudioStatus audio;
+    uint16_t freq = 0;
+    uint32_t lastGroupMs = 0;
+    uint32_t ctMs = 0;
+    RdsGroup last = {};
+    TickType_t wake = xTaskGetTickCount();
+
+    rdsReset(decoder);
+    while (true)
+    {
+        if (!radioPlaying(audio))
+        {
+            if (freq)
+            {
+                // Off FM: drop the station's data
+                freq = 0;
+                rdsReset(decoder);
+                publish(0, 0);
+                eventBusPublish(SysEvent::RdsChanged, RDS_CHANGED_PI);
+            }
+            eventBusWait(portMAX_DELAY);
+            while (eventBusPoll(sub, ev))
+                ;
+            wake = xTaskGetTickCount();
+            continue;
+        }
+        while (eventBusPoll(sub, ev))
+            ;
+
+        // The band scan has the tuner; its channels are not ours
+        if (bandScanActive())
+        {
+            lastGroupMs = millis();
+            vTaskDelayUntil(&wake, pdMS_TO_TICKS(RDS_POLL_MS));
+            continue;
+        }
+
+        uint32_t now = millis();
+        if (audio.radioFreq != freq || now - lastGroupMs >= RDS_RESTART_MS)
+        {
+            if (audio.radioFreq != freq)
+            {
+                bool had = decoder.pi != 0;
+                freq = audio.radioFreq;
+                rdsReset(decoder);
+                memset(&last, 0, sizeof(last));
+                publish(freq, 0);
+                if (had)
+                    eventBusPublish(SysEvent::RdsChanged, RDS_CHANGED_PI);
+            }
+            if (i2cBusRun(I2C_DEV_RADIO, I2C_PRIO_NORMAL, enableRds, nullptr))
+                stats.enables++;
+            else
+                stats.i2cErrors++;
+            lastGroupMs = now;
+        }
+
+        Si4703Regs r;
+        uint32_t start = micros();
+        bool ok = i2cBusRun(I2C_DEV_RADIO, I2C_PRIO_NORMAL, readGroup, &r);
+        stats.busUs += micros() - start;
+        stats.busBytes += RDS_POLL_REGS * 2;
+        stats.polls++;
+
+        uint16_t status = r.reg[SI4703_STATUSRSSI];
+        bool levelChanged = false;
+        if (ok)
+        {
+            uint8_t level = status & SI4703_RSSI_MASK;
+            bool st = status & SI4703_ST;
+            levelChanged = abs(level - rssi) >= RDS_RSSI_STEP || st != stereo;
+            if (levelChanged)
+            {
+                rssi = level;
+                stereo = st;
+            }
+        }
+        if (!ok)
+        {
+            stats.i2cErrors++;
+        }
+        else if (status & SI4703_RDSR)
+        {
+            // BLERA is in STATUSRSSI, BLERB-D in READCHAN
+            RdsGroup g;
+            uint16_t readChan = r.reg[SI4703_READCHAN];
+            for (int i = 0; i < 4; i++)
+                g.block[i] = r.reg[SI4703_RDSA + i];
+            g.bler[RDS_A] = (status >> 9) & 3;
+            g.bler[RDS_B] = (readChan >> 14) & 3;
+            g.bler[RDS_C] = (readChan >> 12) & 3;
+            g.bler[RDS_D] = (readChan >> 10) & 3;
+
+            // RDSR stays set until the next group, so a fast poll sees it twice
+            if (memcmp(&g, &last, sizeof(g)) == 0)
+            {
+                stats.duplicates++;
+            }
+            else
+            {
+                last = g;
+                lastGroupMs = now;
+                uint32_t t0 = micros();
+                uint8_t changed = rdsDecodeGroup(decoder, g);
+                uint32_t us = micros() - t0;
+                stats.decodeUs += us;
+                if (us > stats.decodeMaxUs)
+                    stats.decodeMaxUs = us;
+                stats.groups++;
+                if (changed & RDS_CHANGED_CT)
+                    ctMs = now;
+                if (changed)
+                {
+                    publish(freq, ctMs);
+                    eventBusPublish(SysEvent::RdsChanged, changed, decoder.pi);
+                    levelChanged = false;
+                }
+            }
+        }
+        if (levelChanged)
+            publish(freq, ctMs);
+        stats.corrected = decoder.corrected;
+        stats.rejected = decoder.rejected;
+
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(RDS_POLL_MS));
+    }
+}
+
+bool initRdsTask()
+{
+    if (rdsTaskHandle != nullptr)
+    {
+        Serial.println("RdsTask: Task already running");
+        return false;
+    }
+
+    // With the UI: a late poll only costs a duplicate read or one group
+    BaseType_t result = xTaskCreatePinnedToCore(
+        rdsTask,
+        "RdsTask",
+        3072,
+        nullptr,
+        1,
+        &rdsTaskHandle,
+        0);
+
+    if (result != pdPASS)
+    {
+        Serial.println("RdsTask: Failed to create task");
+        rdsTaskHandle = nullptr;
+        return false;
+    }
+    Serial.printf("RdsTask: started, poll every %u ms\n", RDS_POLL_MS);
+    return true;
+}
+
+RdsTaskStats rdsGetStats()
+{
+    return stats;
+}
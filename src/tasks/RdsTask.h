@@ -0,0 +1,47 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <Arduino.h>
+
+/**
+ * @brief RdsTask - reads RDS groups from the Si4703 while FM is playing
+ *
+ * The tuner holds one group at a time and a new one arrives every 88 ms,
+ * so the task polls its status registers every RDS_POLL_MS through the
+ * I2C bus task at NORMAL priority: after tune requests, ahead of display
+ * data. Groups go through the voting decoder (rdsDecoder) and whatever it
+ * accepts is published as the RdsStatus snapshot with a RdsChanged event.
+ * The signal level from the same reads goes into the snapshot too, without
+ * an event, when it moves by RDS_RSSI_STEP.
+ *
+ * The task sleeps on the event bus while another source is playing. A
+ * channel change resets the decoder, so text of the old station is never
+ * shown with the new frequency. Polling pauses while a band scan has
+ * the tuner.
+ */
+
+#define RDS_POLL_MS      40     // less than half a group period
+#define RDS_RESTART_MS   2000   // re-enable RDS after this long without groups
+#define RDS_RSSI_STEP    2      // dB; smaller changes are noise
+
+struct RdsTaskStats {
+    uint32_t polls;            // status reads
+    uint32_t groups;           // new groups decoded
+    uint32_t duplicates;       // reads of a group already decoded
+    uint32_t enables;          // RDS (re)enabled in the tuner
+    uint32_t i2cErrors;
+    uint64_t busUs;            // time of our reads on the bus
+    uint32_t busBytes;
+    uint64_t decodeUs;         // decoder CPU time
+    uint32_t decodeMaxUs;
+    uint32_t corrected;        // from the decoder
+    uint32_t rejected;
+};
+
+/**
+ * @brief Create the RDS task (after the tuner has been started)
+ */
+bool initRdsTask();
+
+RdsTaskStats rdsGetStats();
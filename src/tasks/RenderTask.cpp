@@ -0,0 +1,421 @@
+#include "RenderTask.h"
+#include "userUi.h"
+#include "../AppDrivers/i2cBus.h"
+#include "../AppDrivers/barGraph.h"
+#include "../SystemEvents.h"
+
+// SSD1306 transport through the bus task: control byte 0x00 for commands,
+// 0x40 for data. Data goes out in slices so radio requests can cut in.
+class QueuedSsd1306Bus : public Ssd1306Bus
+{
+public:
+    void command(const uint8_t *cmd, size_t len) override
+    {
+        send(0x00, cmd, len);
+    }
+    void data(const uint8_t *buf, size_t len) override
+    {
+        size_t slice = i2cBusSliceBytes(I2C_DEV_OLED) - 1;
+        while (len)
+        {
+            size_t n = len < slice ? len : slice;
+            send(0x40, buf, n);
+            buf += n;
+            len -= n;
+        }
+    }
+
+private:
+    void send(uint8_t control, const uint8_t *buf, size_t len)
+    {
+        uint8_t xfer[I2C_BUS_XFER_MAX];
+        xfer[0] = control;
+        memcpy(xfer + 1, buf, len);
+        i2cBusWrite(I2C_DEV_OLED, I2C_PRIO_LOW, SCREEN_ADDRESS, xfer, len + 1);
+    }
+};
+
+static TaskHandle_t renderTaskHandle = nullptr;
+static DisplayFlush displayFlusher;
+static QueuedSsd1306Bus oledBus;
+static RenderStats stats;
+
+// Latest submission, written by the UI task
+static portMUX_TYPE submitLock = portMUX_INITIALIZER_UNLOCKED;
+static RenderFn pendingFn = nullptr;
+static uint8_t pendingModel[RENDER_MODEL_MAX];
+static uint8_t pendingLen = 0;
+static uint32_t pendingCause = 0;
+static volatile bool pendingFrame = false;
+
+// What the back buffer holds (render task only)
+static RenderFn shownFn = nullptr;
+static uint8_t shownModel[RENDER_MODEL_MAX];
+static uint8_t shownLen = 0;
+static volatile bool forceRedraw = true;
+
+// Frame on the bus
+static bool inFlight = false;
+static uint32_t flightStartUs = 0;
+static uint32_t flightCause = 0;
+
+// Marquee text, written by the UI task; the strip is render task only
+static char pendingMarqueeText[RENDER_MARQUEE_TEXT_MAX];
+static uint8_t pendingMarqueePage, pendingMarqueeCol0, pendingMarqueeCol1;
+static RenderFn pendingMarqueeFn = nullptr;
+static volatile bool marqueePending = false;
+static Marquee marquee;
+static RenderFn marqueeFn = nullptr;
+static uint32_t lastStepMs = 0;
+
+// Level meter region, set by the UI task
+static RenderFn meterFn = nullptr;
+static uint8_t meterPage0, meterPage1, meterCol0, meterCol1;
+static uint32_t meterSeq = 0;
+static uint32_t lastMeterMs = 0;
+
+// Bus rate over one-second windows
+static uint32_t rateStartMs = 0;
+static uint32_t rateBytes = 0;
+
+// GFX target that draws straight into the marquee strip
+class MarqueeCanvas : public Adafruit_GFX
+{
+public:
+    MarqueeCanvas() : Adafruit_GFX(MARQUEE_MAX_COLS, 8) {}
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override
+    {
+        if (color)
+            marquee.setPixel(x, y);
+    }
+};
+
+static void completeFrame()
+{
+    i2cBusSync(I2C_DEV_OLED, I2C_PRIO_LOW);
+    uint32_t now = micros();
+    displayFlusher.recordTime(now - flightStartUs);
+    if (flightCause)
+    {
+        uint32_t lat = now - flightCause;
+        stats.latencyCount++;
+        stats.latencyLastUs = lat;
+        stats.latencySumUs += lat;
+        if (lat > stats.latencyMaxUs)
+            stats.latencyMaxUs = lat;
+    }
+    inFlight = false;
+}
+
+static void countBusBytes(uint32_t bytes)
+{
+    uint32_t now = millis();
+    rateBytes += bytes;
+    if (now - rateStartMs >= 1000)
+    {
+        stats.busBytesPerSec = (uint64_t)rateBytes * 1000 / (now - rateStartMs);
+        rateBytes = 0;
+        rateStartMs = now;
+    }
+}
+
+// Send the back buffer; waits for the bus unless another frame is queued.
+// Returns the bytes put on the bus.
+static uint32_t present(uint32_t cause)
+{
+    if (inFlight)
+        completeFrame();
+
+    flightStartUs = micros();
+    uint32_t bytes = displayFlusher.flush(display.getBuffer(), oledBus);
+    if (bytes)
+    {
+        inFlight = true;
+        flightCause = cause;
+    }
+    countBusBytes(bytes);
+
+    // Nothing else to draw: wait for this frame here so its latency is exact
+    if (inFlight && !pendingFrame)
+        completeFrame();
+    return bytes;
+}
+
+static bool marqueeShown()
+{
+    return marqueeFn && marqueeFn == shownFn && !marquee.empty();
+}
+
+// Render a new marquee text into the strip
+static void takeMarquee()
+{
+    char text[RENDER_MARQUEE_TEXT_MAX];
+    uint8_t page, col0, col1;
+
+    // Remove the old text from the screen
+    bool wasShown = marqueeShown();
+    if (wasShown)
+        marquee.clear(display.getBuffer());
+
+    portENTER_CRITICAL(&submitLock);
+    memcpy(text, pendingMarqueeText, sizeof(text));
+    page = pendingMarqueePage;
+    col0 = pendingMarqueeCol0;
+    col1 = pendingMarqueeCol1;
+    marqueeFn = pendingMarqueeFn;
+    marqueePending = false;
+    portEXIT_CRITICAL(&submitLock);
+
+    // Default 5x7 font, 6 columns per character
+    marquee.begin(strlen(text) * 6, page, col0, col1);
+    MarqueeCanvas canvas;
+    canvas.setTextWrap(false);
+    canvas.setTextColor(1);
+    canvas.setCursor(0, 0);
+    canvas.print(text);
+    lastStepMs = millis();
+
+    // Show the new text now if its screen is up
+    if (marqueeShown())
+        marquee.blit(display.getBuffer());
+    if (marqueeShown() || wasShown)
+        present(0);
+}
+
+// One scroll step between frames: only the marquee page changes
+static void stepMarquee()
+{
+    lastStepMs = millis();
+    if (!marquee.step(1))
+        return;
+    marquee.blit(display.getBuffer());
+    stats.marqueeSteps++;
+    present(0);
+}
+
+static bool meterShown()
+{
+    RenderFn fn;
+    portENTER_CRITICAL(&submitLock);
+    fn = meterFn;
+    portEXIT_CRITICAL(&submitLock);
+    return fn && fn == shownFn;
+}
+
+// Draw the latest levels into the back buffer; false if they are not new
+static bool drawMeter(bool force)
+{
+    AudioMeter m;
+    uint32_t seq = readAudioMeter(m);
+    if (!force && seq == meterSeq)
+        return false;
+    meterSeq = seq;
+
+    uint8_t page0, page1, col0, col1;
+    portENTER_CRITICAL(&submitLock);
+    page0 = meterPage0;
+    page1 = meterPage1;
+    col0 = meterCol0;
+    col1 = meterCol1;
+    portEXIT_CRITICAL(&submitLock);
+    drawBarGraph(display.getBuffer(), m.level, m.bands, page0, page1, col0, col1);
+    return true;
+}
+
+// Level update between frames: only the meter region changes
+static void stepMeter()
+{
+    lastMeterMs = millis();
+    if (!drawMeter(false))
+        return;
+    stats.meterFrames++;
+    stats.meterBytes += present(0);
+}
+
+static TickType_t waitTicks(uint32_t lastMs, uint32_t periodMs)
+{
+    uint32_t since = millis() - lastMs;
+    return since >= periodMs ? 0 : pdMS_TO_TICKS(periodMs - since);
+}
+
+static TickType_t marqueeWait()
+{
+    if (!marqueeShown() || !marquee.scrolling())
+        return portMAX_DELAY;
+    return waitTicks(lastStepMs, RENDER_MARQUEE_STEP_MS);
+}
+
+static TickType_t meterWait()
+{
+    if (!meterShown())
+        return portMAX_DELAY;
+    return waitTicks(lastMeterMs, RENDER_METER_MS);
+}
+
+static void renderTask(void *pvParameters)
+{
+    RenderFn fn;
+    uint8_t model[RENDER_MODEL_MAX];
+    uint8_t len;
+    uint32_t cause;
+    uint32_t lastFrameMs = 0;
+    int defers = 0;
+
+    while (true)
+    {
+        TickType_t wait = min(marqueeWait(), meterWait());
+        ulTaskNotifyTake(pdTRUE, pendingFrame || marqueePending ? 0 : wait);
+        if (marqueePending)
+            takeMarquee();
+        if (!pendingFrame)
+        {
+            if (marqueeWait() == 0)
+                stepMarquee();
+            if (meterWait() == 0)
+                stepMeter();
+            continue;
+        }
+
+        // Frame-rate cap; submissions made meanwhile are merged into this frame
+        uint32_t since = millis() - lastFrameMs;
+        if (since < RENDER_MIN_FRAME_MS)
+            vTaskDelay(pdMS_TO_TICKS(RENDER_MIN_FRAME_MS - since));
+
+        // Radio traffic first: skip this slot while a tune or poll is queued
+        if (i2cBusPending(I2C_DEV_RADIO) && defers < RENDER_MAX_DEFER)
+        {
+            defers++;
+            stats.deferred++;
+            vTaskDelay(pdMS_TO_TICKS(RENDER_DEFER_MS));
+            continue;
+        }
+        defers = 0;
+
+        portENTER_CRITICAL(&submitLock);
+        fn = pendingFn;
+        len = pendingLen;
+        memcpy(model, pendingModel, len);
+        cause = pendingCause;
+        pendingCause = 0;
+        pendingFrame = false;
+        portEXIT_CRITICAL(&submitLock);
+
+        if (!forceRedraw && fn == shownFn && len == shownLen && memcmp(model, shownModel, len) == 0)
+        {
+            stats.unchanged++;
+            continue;
+        }
+        forceRedraw = false;
+
+        // Draw into the back buffer while the previous frame may still be
+        // going out over the bus
+        // Every frame starts from the default text state, whatever the
+        // previous screen left set
+        uint32_t drawStart = micros();
+        display.setFont();
+        display.setTextSize(1);
+        display.setTextColor(SSD1306_WHITE);
+        fn(&display, model);
+        uint32_t drawUs = micros() - drawStart;
+        if (drawUs > stats.drawUsMax)
+            stats.drawUsMax = drawUs;
+        shownFn = fn;
+        shownLen = len;
+        memcpy(shownModel, model, len);
+        if (marqueeShown())
+            marquee.blit(display.getBuffer());
+        if (meterShown())
+            drawMeter(true);
+
+        present(cause);
+        stats.frames++;
+        lastFrameMs = millis();
+    }
+}
+
+bool initRenderTask()
+{
+    if (renderTaskHandle != nullptr)
+        return false;
+
+    // Same priority as the UI task: screens react first, drawing follows
+    BaseType_t result = xTaskCreate(renderTask, "RenderTask", 4096, nullptr, 1, &renderTaskHandle);
+    if (result != pdPASS)
+    {
+        Serial.println("RenderTask: Failed to create task");
+        renderTaskHandle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void renderSubmit(RenderFn fn, const void *model, size_t len, uint32_t causeUs)
+{
+    if (len > RENDER_MODEL_MAX)
+        len = RENDER_MODEL_MAX;
+
+    portENTER_CRITICAL(&submitLock);
+    pendingFn = fn;
+    memcpy(pendingModel, model, len);
+    pendingLen = len;
+    // Keep the oldest unshown cause: latency counts from the first key press
+    if (causeUs && !pendingCause)
+        pendingCause = causeUs;
+    pendingFrame = true;
+    stats.submits++;
+    portEXIT_CRITICAL(&submitLock);
+
+    if (renderTaskHandle)
+        xTaskNotifyGive(renderTaskHandle);
+}
+
+void renderMarquee(RenderFn fn, const char *text, uint8_t page, uint8_t col0, uint8_t col1)
+{
+    portENTER_CRITICAL(&submitLock);
+    strncpy(pendingMarqueeText, text ? text : "", sizeof(pendingMarqueeText) - 1);
+    pendingMarqueeText[sizeof(pendingMarqueeText) - 1] = 0;
+    pendingMarqueeFn = fn;
+    pendingMarqueePage = page;
+    pendingMarqueeCol0 = col0;
+    pendingMarqueeCol1 = col1;
+    marqueePending = true;
+    portEXIT_CRITICAL(&submitLock);
+
+    if (renderTaskHandle)
+        xTaskNotifyGive(renderTaskHandle);
+}
+
+void renderMeter(RenderFn fn, uint8_t page0, uint8_t page1, uint8_t col0, uint8_t col1)
+{
+    portENTER_CRITICAL(&submitLock);
+    meterFn = fn;
+    meterPage0 = page0;
+    meterPage1 = page1;
+    meterCol0 = col0;
+    meterCol1 = col1;
+    portEXIT_CRITICAL(&submitLock);
+
+    if (renderTaskHandle)
+        xTaskNotifyGive(renderTaskHandle);
+}
+
+void renderInvalidate()
+{
+    displayFlusher.invalidate();
+    forceRedraw = true;
+}
+
+RenderStats renderGetStats()
+{
+    RenderStats st = stats;
+    // The window only closes on a flush; an idle display reads as its average
+    uint32_t elapsed = millis() - rateStartMs;
+    if (elapsed >= 2000)
+        st.busBytesPerSec = (uint64_t)rateBytes * 1000 / elapsed;
+    return st;
+}
+
+DisplayFlushStats getDisplayFlushStats()
+{
+    return displayFlusher.stats();
+}
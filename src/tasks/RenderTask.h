@@ -0,0 +1,93 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+#include "../AppDrivers/displayFlush.h"
+#include "../AppDrivers/marquee.h"
+
+/**
+ * @brief RenderTask - owns the display and draws screen models
+ *
+ * Screens only update a small model struct and submit it together with the
+ * function that draws it. This task draws the latest submitted model into
+ * the back buffer (the Adafruit frame buffer) and presents it through
+ * DisplayFlush, whose shadow is the front buffer: only changed pages go to
+ * the bus. Submissions that arrive while a frame is being drawn or sent
+ * are coalesced, so a burst of key presses costs one frame.
+ *
+ * - A model identical to the one on screen is not redrawn
+ * - At most one frame per RENDER_MIN_FRAME_MS
+ * - While radio transactions are queued on the I2C bus the frame is
+ *   deferred (up to RENDER_MAX_DEFER times)
+ * - Key-to-pixel latency: from the key's pin edge (cause) to the last byte
+ *   of the frame that shows it
+ *
+ * A screen may also attach one marquee line and one level meter to its draw
+ * function. The task renders the marquee text once and scrolls it, and
+ * redraws the meter bars from the audio task's AudioMeter snapshot, both
+ * between frames and without redrawing the screen; only their region goes
+ * to the bus.
+ */
+
+#define RENDER_MODEL_MAX     64   // bytes of model per submission
+#define RENDER_MIN_FRAME_MS  40   // frame-rate cap, 25 fps
+#define RENDER_DEFER_MS      5    // retry delay while the bus is busy with the radio
+#define RENDER_MAX_DEFER     4
+#define RENDER_MARQUEE_STEP_MS 40 // one column per step, 25 px/s
+#define RENDER_MARQUEE_TEXT_MAX 64
+#define RENDER_METER_MS      50   // level meter refresh, at most
+
+// Draws 'model' into 'display' (no flush)
+typedef void (*RenderFn)(Adafruit_SSD1306 *display, const void *model);
+
+struct RenderStats {
+    uint32_t submits;
+    uint32_t frames;           // frames drawn and sent
+    uint32_t unchanged;        // submissions equal to what is on screen
+    uint32_t deferred;         // frame slots given to radio traffic
+    uint32_t drawUsMax;
+    uint32_t latencyCount;     // frames with a key cause
+    uint32_t latencyLastUs;
+    uint32_t latencyMaxUs;
+    uint64_t latencySumUs;
+    uint32_t marqueeSteps;     // scroll steps sent without a redraw
+    uint32_t busBytesPerSec;   // display bytes on the bus over the last second
+    uint32_t meterFrames;      // level meter updates sent without a redraw
+    uint32_t meterBytes;       // bus bytes of those updates
+};
+
+/**
+ * @brief Create the render task (after initDisplay())
+ */
+bool initRenderTask();
+
+/**
+ * @brief Queue a model for drawing; only the newest submission is drawn
+ * @param causeUs micros() of the input that caused the change, 0 if none
+ */
+void renderSubmit(RenderFn fn, const void *model, size_t len, uint32_t causeUs = 0);
+
+/**
+ * @brief Scroll 'text' on 'page', columns col0..col1, while frames of 'fn'
+ *        are shown. Text that fits is shown still; an empty text removes it.
+ *        'fn' must leave that page area blank.
+ */
+void renderMarquee(RenderFn fn, const char *text, uint8_t page, uint8_t col0 = 0,
+                   uint8_t col1 = SSD1306_FLUSH_WIDTH - 1);
+
+/**
+ * @brief Show the audio level meter as bars in pages page0..page1, columns
+ *        col0..col1, while frames of 'fn' are shown; null 'fn' removes it.
+ *        'fn' must leave that area blank.
+ */
+void renderMeter(RenderFn fn, uint8_t page0, uint8_t page1, uint8_t col0, uint8_t col1);
+
+/**
+ * @brief Forget the panel contents; the next frame is sent in full
+ */
+void renderInvalidate();
+
+RenderStats renderGetStats();
+DisplayFlushStats getDisplayFlushStats();
@@ -24,6 +24,23 @@ const MenuItem menuItems[] = {
 
 const int menuItemCount = sizeof(menuItems) / sizeof(MenuItem);
 
+// Everything the menu frame depends on
+struct MainMenuModel
+{
+    int32_t selectedItem;
+};
+
+static void renderMenu(Adafruit_SSD1306 *display, const void *model)
+{
+    MainMenuHelpers::drawMenu(display, ((const MainMenuModel *)model)->selectedItem);
+}
+
+static void showMenu(int selectedItem, uint32_t causeUs)
+{
+    MainMenuModel model = {selectedItem};
+    renderSubmit(renderMenu, &model, sizeof(model), causeUs);
+}
+
 /**
  * @brief Main MenuScreen function
  * @return ScreenID Next screen to display
@@ -36,7 +53,7 @@ ScreenID MainMenuScreen()
     int selectedItem = 0;
 
     // Draw initial UI and reset brightness
-    MainMenuHelpers::drawMenu(&display, selectedItem);
+    showMenu(selectedItem, 0);
     resetScreenBrightness();
 
     Serial.printf("MainMenuScreen: Menu initialized with %d items\n", menuItemCount);
@@ -44,68 +61,51 @@ ScreenID MainMenuScreen()
     // Main menu loop
     while (true)
     {
-        // Handle key input
-        static unsigned long lastDebounce = 0;
-        static uint8_t lastKey = NONE;
-
-        uint8_t key = getKeypadState();
-
-        // Debounce
-        if (key != lastKey)
-        {
-            lastDebounce = millis();
-            lastKey = key;
-        }
-
-        bool shouldProcessKeys = (millis() - lastDebounce >= 50);
+        // Key events in the order they happened; UP/DOWN move and repeat
+        // while held, a click of NEXT selects
         bool keyPressed = false;
-
-        // Handle key releases
-        if (shouldProcessKeys)
+        InputEvent evt;
+        while (nextKeyEvent(evt))
         {
-            uint8_t upKeys = getUpKeys();
-            if (upKeys != NONE)
+            keyPressed = true;
+            bool step = evt.type == KEY_EVENT_PRESS || evt.type == KEY_EVENT_DOUBLE || evt.type == KEY_EVENT_REPEAT;
+            bool click = evt.type == KEY_EVENT_RELEASE;
+
+            if (step && evt.input == UP)
+            {
+                // Move up in menu
+                selectedItem--;
+                if (selectedItem < 0)
+                    selectedItem = menuItemCount - 1;
+                showMenu(selectedItem, evt.timeUs);
+            }
+            else if (step && evt.input == DOWN)
             {
-                keyPressed = true;
-
-                if (upKeys == UP)
-                {
-                    // Move up in menu
-                    selectedItem--;
-                    if (selectedItem < 0)
-                        selectedItem = menuItemCount - 1;
-                    MainMenuHelpers::drawMenu(&display, selectedItem);
-                }
-                else if (upKeys == DOWN)
-                {
-                    // Move down in menu
-                    selectedItem++;
-                    if (selectedItem >= menuItemCount)
-                        selectedItem = 0;
-                    MainMenuHelpers::drawMenu(&display, selectedItem);
-                }
-                else if (upKeys == NEXT)
-                {
-                    // Select current item
-                    Serial.printf("MainMenuScreen: Selected item %d: %s\n", selectedItem, menuItems[selectedItem].name);
-                    return menuItems[selectedItem].screenId;
-                }
-                else if (upKeys == PREVIOUS)
-                {
-                    // Go to normal operation screen
-                    Serial.println("MainMenuScreen: Going to normal operation screen");
-                    return SCREEN_OPERATION;
-                }
-
-                clearUpKeys();
+                // Move down in menu
+                selectedItem++;
+                if (selectedItem >= menuItemCount)
+                    selectedItem = 0;
+                showMenu(selectedItem, evt.timeUs);
+            }
+            else if (click && evt.input == NEXT)
+            {
+                // Select current item
+                Serial.printf("MainMenuScreen: Selected item %d: %s\n", selectedItem, menuItems[selectedItem].name);
+                return menuItems[selectedItem].screenId;
+            }
+            else if (click && evt.input == PREVIOUS)
+            {
+                // Go to normal operation screen
+                Serial.println("MainMenuScreen: Going to normal operation screen");
+                return SCREEN_OPERATION;
             }
         }
 
         // Handle brightness timeout using common function
         handleScreenBrightness(keyPressed);
 
-        // Small delay to prevent excessive CPU usage
-        delay(10);
+        // Sleep until a key/opto/audio event or the next periodic check
+        waitForUiEvent(UI_IDLE_TICKS);
     }
 }
 
@@ -155,7 +155,5 @@ void MainMenuHelpers::drawMenu(Adafruit_SSD1306 *display, int selectedItem)
     display->drawFastHLine(0, 52, 128, SSD1306_WHITE);
     display->setCursor(0, 56);
     display->print("UP/DN:Select NEXT:Go");
-
-    display->display();
 }
 
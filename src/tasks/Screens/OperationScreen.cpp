@@ -8,6 +8,31 @@
 #include <pins.h>
 #include <Wire.h>
 
+// Track/host name line, scrolled by the render task
+#define NAME_PAGE 3
+
+// Level meter beside the volume and floor lines
+#define METER_PAGE0 4
+#define METER_PAGE1 5
+#define METER_COL0 72
+
+// Everything the status frame depends on
+struct OperationModel
+{
+    uint32_t nameHash;
+    uint16_t frequency;
+    uint8_t source;
+    uint8_t volume;
+    uint8_t floor;
+    uint8_t reserved[3];
+};
+
+static void renderStatus(Adafruit_SSD1306 *display, const void *model)
+{
+    const OperationModel *m = (const OperationModel *)model;
+    OperationHelpers::drawStatus(display, m->source, m->volume, m->floor, m->frequency);
+}
+
 /**
  * @brief Main OperationScreen function - shows current music source status
  * @return ScreenID Next screen to display
@@ -20,117 +45,70 @@ ScreenID OperationScreen()
    // audioManager.switchAudioSource(Setup.currentMusicSource,audioManager.getCurrentSourceString());                // Get current source content from Setup);
 
     // Initialize state variables
-    uint8_t lastSource = 255; // Force initial update
-    uint8_t lastVolume = 90;
-    uint8_t lastFloor = 255;
-    String lastStatus = "";
-    unsigned long lastUpdate = 0;
+    OperationModel shown;
+    memset(&shown, 0xFF, sizeof(shown)); // Force initial update
 
     // Reset brightness
     resetScreenBrightness();
+    renderMeter(renderStatus, METER_PAGE0, METER_PAGE1, METER_COL0, SCREEN_WIDTH - 1);
 
     Serial.println("OperationScreen: Starting status monitoring");
 
     // Main operation monitoring loop
     while (true)
     {
-        // Check for exit to main menu (Button 1 long press or PREV+NEXT)
-        if (checkExitCombo() || CheckLongPress(1000))
-        {
-            Serial.println("OperationScreen: Exit detected, going to main menu");
-            // Remove audioManager.saveSetup() - not needed for screen transitions
-            return SCREEN_MAIN_MENU;
-        }
-
-        // Handle key input for volume control
-        static unsigned long lastDebounce = 0;
-        static uint8_t lastKey = NONE;
+        AudioStatus audio;
+        readAudioStatus(audio);
 
-        uint8_t key = getKeypadState();
-
-        // Debounce
-        if (key != lastKey)
-        {
-            lastDebounce = millis();
-            lastKey = key;
-        }
-
-        bool shouldProcessKeys = (millis() - lastDebounce >= 50);
+        // Key events in the order they happened: PREV+NEXT or a long press
+        // of PREV or NEXT exits, UP/DOWN change the volume and repeat while held
         bool keyPressed = false;
-
-        // Handle key releases
-        if (shouldProcessKeys)
+        uint32_t causeUs = 0;
+        InputEvent evt;
+        while (nextKeyEvent(evt))
         {
-            uint8_t upKeys = getUpKeys();
-            if (upKeys != NONE)
+            keyPressed = true;
+            if (checkExitCombo(evt) || evt.type == KEY_EVENT_LONGPRESS)
             {
-                keyPressed = true;
-
-                if (upKeys == UP)
-                {
-                    if (audioManager.getCurrentSourceVolume() < 100)
-                    {
-                        audioManager.setCurrentSourceVolume(audioManager.getCurrentSourceVolume() + 5);
-                        // markSetupDirty() is called inside sdSetVolume()
-                    }
-                }
+                Serial.println("OperationScreen: Exit detected, going to main menu");
+                return SCREEN_MAIN_MENU;
             }
-            else if (upKeys == DOWN)
+            bool step = evt.type == KEY_EVENT_PRESS || evt.type == KEY_EVENT_DOUBLE || evt.type == KEY_EVENT_REPEAT;
+            if (step && (evt.input == UP || evt.input == DOWN))
             {
-                if (audioManager.getCurrentSourceVolume() > 0)
-                {
-                    audioManager.setCurrentSourceVolume(audioManager.getCurrentSourceVolume() - 5);
-                    // markSetupDirty() is called inside sdSetVolume()
-                }   
+                // The audio task applies it and marks Setup dirty
+                audio.volume = constrain(audio.volume + (evt.input == UP ? 5 : -5), 0, 100);
+                audioTask.setMusicVolume(audio.volume);
+                causeUs = evt.timeUs;
             }
-
-            clearUpKeys();
         }
 
     // Handle brightness timeout using common function
     handleScreenBrightness(keyPressed);
 
-    // Update display every 500ms or when values change
-    if (millis() - lastUpdate > 500)
+    // Submit the model when any shown value changed; drawing and the
+    // bus transfer happen in the render task
+    OperationModel model = {};
+    model.nameHash = audio.pathHash;
+    model.frequency = Setup.lastFrequency;
+    model.source = Setup.currentMusicSource;
+    model.volume = audio.volume;
+    model.floor = Setup.baseFloor;
+    if (memcmp(&model, &shown, sizeof(model)) != 0)
     {
-        bool needsUpdate = false;
-
-        if (Setup.currentMusicSource != lastSource)
-        {
-            lastSource = Setup.currentMusicSource;
-            needsUpdate = true;
-        }
-
-        uint8_t currentVolume = audioManager.getCurrentSourceVolume();
-        if (currentVolume != lastVolume)
-        {
-            lastVolume = currentVolume;
-            needsUpdate = true;
-        }
-
-        if (Setup.baseFloor != lastFloor)
-        {
-            lastFloor = Setup.baseFloor;
-            needsUpdate = true;
-        }
-
-        if (needsUpdate)
-        {
-            OperationHelpers::drawStatus(&display, lastSource, lastVolume, lastFloor);
-        }
-
-        lastUpdate = millis();
+        if (model.nameHash != shown.nameHash)
+            renderMarquee(renderStatus, audio.shortName, NAME_PAGE);
+        shown = model;
+        renderSubmit(renderStatus, &model, sizeof(model), causeUs);
     }
 
-    // Check setup dirty flag
-    CheckSetupDirty();
-
-    // Small delay to prevent excessive CPU usage
-    delay(10);
+    // Sleep until a key/opto/audio event or the next periodic check
+    waitForUiEvent(UI_IDLE_TICKS);
 }
 }
 
-void OperationHelpers::drawStatus(Adafruit_SSD1306 *display, uint8_t source, uint8_t volume, uint8_t floor)
+void OperationHelpers::drawStatus(Adafruit_SSD1306 *display, uint8_t source, uint8_t volume, uint8_t floor,
+                                  uint16_t frequency)
 {
     display->clearDisplay();
     display->setTextColor(SSD1306_WHITE);
@@ -142,12 +120,12 @@ void OperationHelpers::drawStatus(Adafruit_SSD1306 *display, uint8_t source, uin
     display->drawFastHLine(0, 12, 128, SSD1306_WHITE);
 
     // Current source
-    display->setCursor(0, 18);
+    display->setCursor(0, 16);
     display->print("Source: ");
     switch (source)
     {
     case 0:
-        display->printf("FM %.1f MHz", Setup.lastFrequency / 100.0);
+        display->printf("FM %.1f MHz", frequency / 100.0);
         break;
     case 1:
         display->print("Web Radio");
@@ -160,29 +138,20 @@ void OperationHelpers::drawStatus(Adafruit_SSD1306 *display, uint8_t source, uin
         break;
     }
 
-    // Volume
-    display->setCursor(0, 30);
-    if (source == 0)
-    {
-        display->printf("Volume: %d%% (0-15)", (volume * 100) / 15);
-    }
-    else
-    {
-        display->printf("Volume: %d%% (0-100)", volume);
-    }
+    // Page NAME_PAGE (rows 24-31) is left to the name marquee
+
+    // Volume, the same 0-100 % for every source
+    display->setCursor(0, 32);
+    display->printf("Vol: %d%%", volume);
 
     // Floor number
-    display->setCursor(0, 42);
+    display->setCursor(0, 40);
     display->printf("Floor: %d", floor);
 
-    // Music state
-    display->setCursor(70, 42);
-    display->print("READY");
+    // Pages METER_PAGE0-METER_PAGE1 right of METER_COL0 hold the level meter
 
     // Instructions
     display->drawFastHLine(0, 52, 128, SSD1306_WHITE);
     display->setCursor(0, 56);
     display->print("UP/DN:Vol HOLD:Menu");
-
-    display->display();
 }
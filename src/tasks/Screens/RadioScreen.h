@@ -3,22 +3,34 @@
 #include <Arduino.h>
 #include <Adafruit_SSD1306.h>
 #include "../userUi.h"  // For ScreenID enumeration
-#include "AudioTask.h" // For audioManager object
+#include "AudioTask.h" // For audioTask (volume) and AudioStatus
 
 /**
  * @brief RadioScreen function for FM radio parameter adjustment
  * 
  * Called from UserUI when user wants to adjust radio parameters.
  * Runs its own loop until user presses PREVIOUS+NEXT to exit.
- * Uses global audioManager object declared in main.cpp.
+ * Volume changes go to the audio task; signal level and station name
+ * come from the RDS task.
  * 
  * @return ScreenID Next screen to display (determined by user input)
  */
 ScreenID RadioScreen();
 
+// Cycles per frequency update, GFX text vs glyph atlas
+struct GlyphBench {
+    uint32_t gfxCycles;
+    uint32_t atlasCycles;
+    size_t atlasBytes;
+};
+
 // Helper functions (can be used internally by RadioScreen)
 namespace RadioScreenHelpers {
+    void drawScreen(Adafruit_SSD1306* display, const void* model);  // RenderFn for the radio model
+    void buildGlyphs();     // pre-render the frequency/volume numerals (startup)
+    GlyphBench benchmarkGlyphs(int iterations);
     void drawStaticUI(Adafruit_SSD1306* display);
+    void updateTitle(Adafruit_SSD1306* display, const char* ps);   // RDS name, or "FM Tuner"
     void updateFrequency(Adafruit_SSD1306* display, int freq);
     void updateRSSI(Adafruit_SSD1306* display, uint8_t rssi);
     void updateVolume(Adafruit_SSD1306* display, uint8_t volume);
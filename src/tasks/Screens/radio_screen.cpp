@@ -1,7 +1,75 @@
 #include "RadioScreen.h"
 #include "userUi.h"
+#include "../AppDrivers/glyphAtlas.h"
+#include "../AppDrivers/rdsDecoder.h"
+#include "TunerTask.h"
 #include <Arduino.h>
 
+// Everything the radio frame depends on
+struct RadioModel
+{
+    uint16_t frequency;
+    uint8_t volume;         // 0-100 %
+    uint8_t rssi;
+    char ps[RDS_PS_LEN];    // station name from RDS, zero-filled if none
+};
+
+// RadioText scrolls in the page the divider line used to take
+#define RT_PAGE 5
+
+// Pre-rendered numerals for the two large fields
+#define FREQ_BASELINE 36
+#define FREQ_X 12
+#define VOLUME_BASELINE 63
+#define VOLUME_X 90
+static GlyphAtlas freqGlyphs;
+static GlyphAtlas volumeGlyphs;
+
+static RdsStatus rds = {};
+
+// Volume change per UP/DOWN key, in %
+#define VOLUME_STEP 5
+
+static void showRadio(uint16_t freq, uint8_t volume, uint32_t causeUs)
+{
+    RadioModel model = {freq, volume, 0};
+    // Only show RDS data and signal level that belong to the channel on screen
+    if (rds.freq == freq)
+    {
+        model.rssi = rds.rssi;
+        memcpy(model.ps, rds.ps, sizeof(model.ps));
+    }
+    renderSubmit(RadioScreenHelpers::drawScreen, &model, sizeof(model), causeUs);
+}
+
+// Pick up new RDS data; true if the PS, RadioText or signal level changed
+static bool refreshRds(uint16_t freq, uint32_t &seq)
+{
+    RdsStatus next;
+    uint32_t s = readRdsStatus(next);
+    if (s == seq)
+        return false;
+    seq = s;
+    if (next.freq != freq)
+        memset(&next, 0, sizeof(next));
+    bool changed = strcmp(next.ps, rds.ps) != 0 || strcmp(next.rt, rds.rt) != 0 || next.rssi != rds.rssi;
+    if (strcmp(next.rt, rds.rt) != 0)
+        renderMarquee(RadioScreenHelpers::drawScreen, next.rt, RT_PAGE);
+    rds = next;
+    return changed;
+}
+
+// One channel up or down in the tuner's band and spacing, wrapping at the edges
+static uint16_t stepFreq(uint16_t freq, bool up)
+{
+    Si4703Band band = tunerGetBand();
+    if (band.spacing == 0)
+        return freq;
+    if (up)
+        return freq + band.spacing > band.top ? band.bottom : freq + band.spacing;
+    return freq < band.bottom + band.spacing ? band.top : freq - band.spacing;
+}
+
 /**
  * @brief Main RadioScreen function
  * @return ScreenID Next screen to display
@@ -14,21 +82,26 @@ ScreenID RadioScreen()
 //audioManager.switchAudioSource(SRC_RADIO,"");
     //audioManager.switchMusicSource(_SOURCE_FM_RADIO);
     // Initialize state variables using Setup values
+    // The FM line input is played at the music volume of the audio task
+    AudioStatus audio;
+    readAudioStatus(audio);
     uint16_t lastFreq = Setup.lastFrequency;
-    uint8_t lastRSSI = 0;
-    uint8_t lastVolume = Setup.radioVolume;
+    uint8_t lastVolume = audio.volume;
 
-
-    unsigned long lastRSSIUpdate = 0;
+    uint32_t rdsSeq = 0;
+    uint32_t tunerSeq = tunerGetStatus().seq;
+    bool seeking = false;
+    uint8_t ignoredKeys = NONE;   // pressed to stop a seek, do nothing else
+    uint32_t cancelCauseUs = 0;
 
     // Reset brightness
     resetScreenBrightness();
 
-    // Draw initial UI
-    RadioScreenHelpers::drawStaticUI(&display);
-    RadioScreenHelpers::updateFrequency(&display, lastFreq);
-    RadioScreenHelpers::updateVolume(&display, lastVolume);
-    RadioScreenHelpers::updateRSSI(&display, lastRSSI);
+    // Draw initial UI; RDS text of a previous visit is stale
+    memset(&rds, 0, sizeof(rds));
+    renderMarquee(RadioScreenHelpers::drawScreen, "", RT_PAGE);
+    refreshRds(lastFreq, rdsSeq);
+    showRadio(lastFreq, lastVolume, 0);
 
     Serial.printf("RadioScreen: Display initialized with frequency %.1f MHz, volume %d\n",
                   lastFreq / 100.0, lastVolume);
@@ -36,137 +109,94 @@ ScreenID RadioScreen()
     // Main radio adjustment loop
     while (true)
     {
-        // Check for exit combo first
-        if (checkExitCombo())
-        {
-            Serial.println("RadioScreen: Exit combo detected, returning to main menu");
-            return SCREEN_MAIN_MENU;
-        }
-
-        // Handle key input
-        static unsigned long lastDebounce = 0;
-        static uint8_t lastKey = NONE;
-
-        uint8_t key = getKeypadState();
-
-        // Debounce
-        if (key != lastKey)
-        {
-            lastDebounce = millis();
-            lastKey = key;
-        }
-
-        bool shouldProcessKeys = (millis() - lastDebounce >= 50);
- // Handle brightness timeout using common function
-        handleScreenBrightness(key);
-        // Handle key presses
-        if (shouldProcessKeys && key != NONE)
+        // Key events in the order they happened
+        bool keyPressed = false;
+        InputEvent evt;
+        while (nextKeyEvent(evt))
         {
-           
-
-            // Handle long press for seek operations
-            if ((key == NEXT) && CheckLongPress(200))
-            {
-                int newFreq = audioManager.radioSeekUp();
-                lastFreq = newFreq;
-                RadioScreenHelpers::updateFrequency(&display, lastFreq);
-                Setup.lastFrequency = lastFreq;
-                markSetupDirty();
-                ClearNextUpKeys();
-            }
-            else if ((key == PREVIOUS) && CheckLongPress(200))
+            keyPressed = true;
+            if (checkExitCombo(evt))
             {
-                int newFreq = audioManager.radioSeekDown();
-                lastFreq = newFreq;
-                RadioScreenHelpers::updateFrequency(&display, lastFreq);
-                Setup.lastFrequency = lastFreq;
-                markSetupDirty();
-                ClearNextUpKeys();
+                Serial.println("RadioScreen: Exit combo detected, returning to main menu");
+                return SCREEN_MAIN_MENU;
             }
 
-            clearCmd();
-        }
-
-        // Handle key releases (step and volume control)
-        if (shouldProcessKeys)
-        {
-            uint8_t upKeys = getUpKeys();
-            if (upKeys != NONE)
+            bool press = evt.type == KEY_EVENT_PRESS || evt.type == KEY_EVENT_DOUBLE;
+            if (press)
             {
-                if (upKeys == PREVIOUS)
+                // A new key press stops a seek; the key does nothing else
+                ignoredKeys &= ~evt.input;
+                if (seeking)
                 {
-                    // Step down by 0.1 MHz
-                    uint16_t currentFreq = audioManager.radioGetChannel();
-                    uint16_t newFreq = currentFreq - 10;
-                    if (newFreq < 8750)
-                        newFreq = 10800; // Wrap around
-
-                    audioManager.radioSetChannel(newFreq);
-                    lastFreq = newFreq;
-                    RadioScreenHelpers::updateFrequency(&display, lastFreq);
-                    Setup.lastFrequency = lastFreq;
-                    markSetupDirty();
+                    tunerCancel();
+                    cancelCauseUs = evt.timeUs;
+                    seeking = false;
+                    ignoredKeys |= evt.input;
                 }
-                else if (upKeys == NEXT)
+            }
+            if (evt.input & ignoredKeys)
+                continue;
+
+            if (evt.input == PREVIOUS || evt.input == NEXT)
+            {
+                if (evt.type == KEY_EVENT_LONGPRESS)
                 {
-                    // Step up by 0.1 MHz
-                    uint16_t currentFreq = audioManager.radioGetChannel();
-                    uint16_t newFreq = currentFreq + 10;
-                    if (newFreq > 10800)
-                        newFreq = 8750; // Wrap around
-
-                    audioManager.radioSetChannel(newFreq);
-                    lastFreq = newFreq;
-                    RadioScreenHelpers::updateFrequency(&display, lastFreq);
-                    Setup.lastFrequency = lastFreq;
-                    markSetupDirty();
+                    // Long press seeks in the background; the display follows it
+                    tunerSeek(evt.input == NEXT);
+                    seeking = true;
                 }
-                else if (upKeys == UP)
+                else if (evt.type == KEY_EVENT_RELEASE)
                 {
-                    // Volume up
-                    uint8_t vol = audioManager.radioGetVolume();
-                    if (vol < 15)
+                    // A click steps one channel down or up
+                    uint16_t newFreq = stepFreq(lastFreq, evt.input == NEXT);
+                    if (newFreq != lastFreq)
                     {
-                        audioManager.radioSetVolume(vol + 1);
-                        lastVolume = vol + 1;
-                        RadioScreenHelpers::updateVolume(&display, lastVolume);
-                         audioManager.setCurrentSourceVolume( lastVolume);
+                        tunerTune(newFreq);
+                        lastFreq = newFreq;
+                        showRadio(lastFreq, lastVolume, evt.timeUs);
                     }
                 }
-                else if (upKeys == DOWN)
+            }
+            else if ((evt.input == UP || evt.input == DOWN) && (press || evt.type == KEY_EVENT_REPEAT))
+            {
+                // Volume on the press and on every repeat while held, through
+                // the audio task, which owns the decoder
+                int vol = constrain(lastVolume + (evt.input == UP ? VOLUME_STEP : -VOLUME_STEP), 0, 100);
+                if (vol != lastVolume)
                 {
-                    // Volume down
-                    uint8_t vol = audioManager.radioGetVolume();
-                    if (vol > 0)
-                    {
-                        audioManager.radioSetVolume(vol - 1);
-                        lastVolume = vol - 1;
-                        RadioScreenHelpers::updateVolume(&display, lastVolume);
-                        audioManager.setCurrentSourceVolume( lastVolume);
-                    }
+                    lastVolume = vol;
+                    audioTask.setMusicVolume(lastVolume);
+                    showRadio(lastFreq, lastVolume, evt.timeUs);
                 }
-
-                clearUpKeys();
             }
         }
+        handleScreenBrightness(keyPressed);
 
-        // Update RSSI every second
-        if (millis() - lastRSSIUpdate > 1000)
+        // Channels a seek passes, and where the last request ended; a
+        // tune replaced by the next key press is not shown. The audio task
+        // records the final channel in Setup.
+        TunerStatus tuner = tunerGetStatus();
+        if (tuner.seq != tunerSeq)
         {
-            uint8_t rssi = audioManager.radioGetRSSI();
-            if (rssi != lastRSSI)
+            tunerSeq = tuner.seq;
+            bool settled = !tunerBusy();
+            if (settled)
+                seeking = false;
+            if ((settled || tuner.phase == TunerPhase::Seeking) && tuner.freq && tuner.freq != lastFreq)
             {
-                lastRSSI = rssi;
-                RadioScreenHelpers::updateRSSI(&display, lastRSSI);
+                lastFreq = tuner.freq;
+                showRadio(lastFreq, lastVolume, tuner.phase == TunerPhase::Cancelled ? cancelCauseUs : 0);
             }
-            lastRSSIUpdate = millis();
         }
 
-    
-        // Check setup dirty flag
-        CheckSetupDirty();
-        // Small delay to prevent excessive CPU usage
-        delay(10);
+        // Station name, RadioText and signal level from the RDS task
+        if (refreshRds(lastFreq, rdsSeq))
+        {
+            showRadio(lastFreq, lastVolume, 0);
+        }
+
+        // Sleep until a key/opto/audio/RDS event or the next periodic check
+        waitForUiEvent(UI_IDLE_TICKS);
     }
 }
 
@@ -174,36 +204,78 @@ ScreenID RadioScreen()
  * @brief Helper Functions Implementation
  */
 
+void RadioScreenHelpers::drawScreen(Adafruit_SSD1306 *display, const void *model)
+{
+    const RadioModel *m = (const RadioModel *)model;
+    drawStaticUI(display);
+    updateTitle(display, m->ps);
+    updateFrequency(display, m->frequency);
+    updateVolume(display, m->volume);
+    updateRSSI(display, m->rssi);
+}
+
 void RadioScreenHelpers::drawStaticUI(Adafruit_SSD1306 *display)
 {
     display->clearDisplay();
     display->setTextColor(SSD1306_WHITE);
 
-    // Top: FM Tuner
+    // Top: title line, see updateTitle()
     display->setTextSize(1);
-    display->setCursor(36, 0);
-    display->print("FM Tuner");
     display->drawFastHLine(0, 12, 128, SSD1306_WHITE);
     display->setCursor(105, 30);
     display->print("MHZ");
-    display->drawFastHLine(0, 46, 128, SSD1306_WHITE);
 
     // Bottom: RSSI and Vol labels
     display->setCursor(0, 56);
     display->print("RSSI:");
     display->setCursor(63, 56);
     display->print("VOL:");
-    display->display();
+}
+
+void RadioScreenHelpers::updateTitle(Adafruit_SSD1306 *display, const char *ps)
+{
+    // The PS name is always eight characters, as wide as "FM Tuner"
+    char title[RDS_PS_LEN + 1] = "FM Tuner";
+    if (ps[0])
+    {
+        memcpy(title, ps, RDS_PS_LEN);
+        title[RDS_PS_LEN] = 0;
+    }
+    display->setFont();
+    display->setTextSize(1);
+    display->setCursor(36, 0);
+    display->setTextColor(SSD1306_WHITE);
+    display->print(title);
+}
+
+void RadioScreenHelpers::buildGlyphs()
+{
+    if (!freqGlyphs.build(&FreeMonoBold12pt7b, "0123456789.", FREQ_BASELINE) ||
+        !volumeGlyphs.build(&FreeMonoBold9pt7b, "0123456789%", VOLUME_BASELINE))
+    {
+        Serial.println("RadioScreen: Glyph atlas too small, using GFX text");
+        return;
+    }
+    Serial.printf("RadioScreen: Glyph atlas %u + %u bytes\n", freqGlyphs.bytes(), volumeGlyphs.bytes());
 }
 
 void RadioScreenHelpers::updateFrequency(Adafruit_SSD1306 *display, int freq)
 {
+    char text[12];
+    snprintf(text, sizeof(text), "%03d.%02d", freq / 100, freq % 100);
+    if (freqGlyphs.covers(text))
+    {
+        uint8_t *frame = display->getBuffer();
+        freqGlyphs.clear(frame, 0, 98);
+        freqGlyphs.draw(frame, FREQ_X, text);
+        return;
+    }
+
     display->setFont(&FreeMonoBold12pt7b);
     display->fillRect(0, 22, 99, 16, SSD1306_BLACK);
-    display->setCursor(12, 36);
+    display->setCursor(FREQ_X, FREQ_BASELINE);
     display->setTextColor(SSD1306_WHITE);
-    display->printf("%03d.%02d", freq / 100, freq % 100);
-    display->display();
+    display->print(text);
 }
 
 void RadioScreenHelpers::updateRSSI(Adafruit_SSD1306 *display, uint8_t rssi)
@@ -214,15 +286,58 @@ void RadioScreenHelpers::updateRSSI(Adafruit_SSD1306 *display, uint8_t rssi)
     display->setCursor(34, 56);
     display->setTextColor(SSD1306_WHITE);
     display->print(rssi);
-    display->display();
 }
 
 void RadioScreenHelpers::updateVolume(Adafruit_SSD1306 *display, uint8_t volume)
 {
+    char text[8];
+    snprintf(text, sizeof(text), "%02d%%", volume);
+    if (volumeGlyphs.covers(text))
+    {
+        uint8_t *frame = display->getBuffer();
+        volumeGlyphs.clear(frame, VOLUME_X, SCREEN_WIDTH - 1);
+        volumeGlyphs.draw(frame, VOLUME_X, text);
+        return;
+    }
+
     display->setFont(&FreeMonoBold9pt7b);
     display->fillRect(90, 50, 38, 18, SSD1306_BLACK);
-    display->setCursor(90, 63);
+    display->setCursor(VOLUME_X, VOLUME_BASELINE);
     display->setTextColor(SSD1306_WHITE);
-    display->printf("%02d%%", volume * 100 / 15);
-    display->display();
+    display->print(text);
+}
+
+GlyphBench RadioScreenHelpers::benchmarkGlyphs(int iterations)
+{
+    // Off-screen targets, so the render task's buffer is not touched
+    static uint8_t frame[SCREEN_WIDTH * SCREEN_HEIGHT / 8];
+    GFXcanvas1 canvas(SCREEN_WIDTH, SCREEN_HEIGHT);
+    GlyphBench b = {};
+    b.atlasBytes = freqGlyphs.bytes();
+    if (!freqGlyphs.ready() || !canvas.getBuffer() || iterations <= 0)
+        return b;
+
+    char text[12];
+    uint64_t gfx = 0, atlas = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        int freq = 8750 + (i * 10) % 2060;
+        snprintf(text, sizeof(text), "%03d.%02d", freq / 100, freq % 100);
+
+        uint32_t start = ESP.getCycleCount();
+        canvas.setFont(&FreeMonoBold12pt7b);
+        canvas.fillRect(0, 22, 99, 16, 0);
+        canvas.setCursor(FREQ_X, FREQ_BASELINE);
+        canvas.setTextColor(1);
+        canvas.print(text);
+        gfx += ESP.getCycleCount() - start;
+
+        start = ESP.getCycleCount();
+        freqGlyphs.clear(frame, 0, 98);
+        freqGlyphs.draw(frame, FREQ_X, text);
+        atlas += ESP.getCycleCount() - start;
+    }
+    b.gfxCycles = gfx / iterations;
+    b.atlasCycles = atlas / iterations;
+    return b;
 }
\ No newline at end of file
@@ -1,7 +1,19 @@
 #include "SerialMonitor.h"
 #include "Audiotask.h"
+#include "Profiler.h"
+#include "RenderTask.h"
+#include "SettingsTask.h"
+#include "RdsTask.h"
+#include "BandScan.h"
+#include "TunerTask.h"
+#include "userUi.h"
+#include "Screens/RadioScreen.h"
 #include <stdarg.h>
 #include <setupDriver.h>
+#include <setupSchema.h>
+#include <inputEvents.h>
+#include <keypadDriver.h>
+#include <i2cBus.h>
 
 // Task handle
 static TaskHandle_t serialMonitorTaskHandle = NULL;
@@ -27,6 +39,12 @@ const struct command_d commands[] = {
     {cmd_source, "src", "Set source [radio|card|web]"},
     {cmd_freq, "freq", "Set radio frequency [87.5-108.0]"},
     {cmd_status, "stat", "Show system status"},
+    {cmd_prof, "prof", "Profiler [on|off|reset|trace [n]|watch <s>]"},
+    {cmd_save, "save", "Write settings now [quiet <ms>]"},
+    {cmd_setup, "setup", "Settings [json|bin|import|defaults]"},
+    {cmd_glyph, "glyph", "Glyph atlas vs GFX text benchmark [n]"},
+    {cmd_scan, "scan", "FM band scan [start|stop]"},
+    {cmd_tune, "tune", "Tuner [<MHz>|up|down|stop]"},
     {cmd_pwd, "pwd", "Enter password [8010]"},
     {cmd_exit, "exit", "Exit monitor (task continues)"}};
 
@@ -434,7 +452,108 @@ void cmd_status(int argc, char **argv)
        // SerPrintf("Radio Stereo: %s\n", audioManager->radioGetStereo() ? "Yes" : "No");
     
     
-    SerPrintf("Current Track: Unknown\n");
+    AudioStatus a;
+    readAudioStatus(a);
+    static const char *const sourceNames[] = {"none", "file", "stream", "radio", "announcement", "test"};
+    SerPrintf("Current Source: %s%s\n", a.source < 6 ? sourceNames[a.source] : "?", a.muted ? " (muted)" : "");
+    if (a.source == (uint8_t)PlaybackType::Radio)
+    {
+        SerPrintf("Current Track: FM %.2f MHz\n", a.radioFreq / 100.0);
+    }
+    else
+    {
+        SerPrintf("Current Track: %s [%08lX]\n", a.shortName[0] ? a.shortName : "Unknown", a.pathHash);
+        SerPrintf("Position: %u s, byte %lu, %u kbps, buffer %u%%\n", a.decodeSec, a.filePos, a.bitrateKbps, a.bufferFill);
+    }
+
+    AudioQueueStats q = audioTask.getQueueStats();
+    SerPrintf("Audio Queue: depth %u (max %u), sent %lu, coalesced %lu, dropped %lu, strings %u\n",
+              q.depth, q.highWater, q.sent, q.coalesced, q.dropped, q.stringsInUse);
+
+    AudioLoopStats l = audioTask.getLoopStats();
+    uint64_t total = l.blockedUs + l.activeUs;
+    SerPrintf("Audio Wakeups: idle %lu, init %lu, play %lu, ann-init %lu, ann-play %lu, timeouts %lu\n",
+              l.wakeups[0], l.wakeups[1], l.wakeups[2], l.wakeups[3], l.wakeups[4], l.timeouts);
+    SerPrintf("Audio Task: blocked %.1f%% of %.1f s\n",
+              total ? 100.0 * l.blockedUs / total : 0.0, total / 1e6);
+
+    InputEventStats in = inputEventGetStats();
+    SerPrintf("Input Events: pushed %lu, popped %lu, depth %u (max %u), overflows %lu, max wait %lu us\n", in.pushed,
+              in.popped, in.depth, in.highWater, in.overflows, in.maxWaitUs);
+    SetupStoreStats ss = getSetupStoreStats();
+    if (ss.journal)
+    {
+        SerPrintf("Setup Journal: sector %u, %u bytes used, %lu records, %lu compactions, erases",
+                  ss.j.activeSector, ss.j.used, ss.j.records, ss.j.compactions);
+        for (int i = 0; i < SETTINGS_JOURNAL_MAX_SECTORS && ss.j.sectorErases[i]; i++)
+            SerPrintf(" %lu", ss.j.sectorErases[i]);
+        SerPrintf(", write last %lu us max %lu us\n", ss.lastWriteUs, ss.maxWriteUs);
+    }
+    else
+    {
+        SerPrintf("Setup Store: EEPROM (no settings partition)\n");
+    }
+    SettingsTaskStats sts = settingsGetStats();
+    SerPrintf("Settings Writer: %lu marks, %lu batches (last %lu us), %lu flushes, quiet %lu ms\n", sts.marks,
+              sts.writes, sts.lastBatchUs, sts.flushes, settingsGetQuietPeriod());
+    SerPrintf("Audio vs Flash: %lu passes during writes, max %lu us (max %lu us otherwise)\n", sts.audioPasses,
+              sts.audioBlockedMaxUs, sts.audioPassMaxUs);
+    DisplayFlushStats ds = getDisplayFlushStats();
+    SerPrintf("Display Flush: %lu frames (%lu unchanged), last %lu B in %u windows, max %lu B, avg %lu B, "
+              "time last %lu us max %lu us\n",
+              ds.frames, ds.skipped, ds.lastBytes, ds.lastWindows, ds.maxBytes,
+              ds.frames ? ds.totalBytes / ds.frames : 0, ds.lastUs, ds.maxUs);
+    RenderStats rs = renderGetStats();
+    SerPrintf("Render: %lu submits, %lu frames, %lu unchanged, %lu deferred for radio, draw max %lu us\n",
+              rs.submits, rs.frames, rs.unchanged, rs.deferred, rs.drawUsMax);
+    SerPrintf("Marquee: %lu scroll steps, display bus %lu B/s over the last second\n", rs.marqueeSteps,
+              rs.busBytesPerSec);
+    AudioMeterStats ms = audioTask.getMeterStats();
+    SerPrintf("Level Meter: %u bands, %lu reads every %u ms, %lu skipped, SPI %lu us total max %lu us, "
+              "%lu updates %lu B on I2C\n",
+              ms.bands, ms.polls, ms.intervalMs, ms.deferred, ms.spiUs, ms.spiMaxUs, rs.meterFrames, rs.meterBytes);
+    SourceSwitchStats sw = audioTask.getSwitchStats();
+    SerPrintf("Source Switch: %lu changes (last %lu us, silent after %lu us, max %lu us), %lu decoder flushes "
+              "(SM_CANCEL after max %lu B), %lu resets\n",
+              sw.switches, sw.lastUs, sw.lastMuteUs, sw.maxUs, sw.flushes, sw.cancelBytesMax, sw.resets);
+    RdsTaskStats rds = rdsGetStats();
+    RdsStatus rdsNow;
+    readRdsStatus(rdsNow);
+    SerPrintf("RDS: PI %04X PS \"%s\", %lu polls, %lu groups (%lu corrected, %lu rejected, %lu repeats), "
+              "%lu enables, %lu errors\n",
+              rdsNow.pi, rdsNow.ps, rds.polls, rds.groups, rds.corrected, rds.rejected, rds.duplicates,
+              rds.enables, rds.i2cErrors);
+    SerPrintf("RDS cost: I2C %lu B, %lu ms, decode %lu us total max %lu us\n", rds.busBytes,
+              (uint32_t)(rds.busUs / 1000), (uint32_t)rds.decodeUs, rds.decodeMaxUs);
+    TunerStats ts = tunerGetStats();
+    SerPrintf("Tuner: %lu tunes (last %lu ms, max %lu ms), %lu seeks (last %lu ms, max %lu ms), %lu cancelled, "
+              "%lu failed, %lu bus transactions\n",
+              ts.tunes, ts.tuneLastMs, ts.tuneMaxMs, ts.seeks, ts.seekLastMs, ts.seekMaxMs, ts.cancels, ts.failures,
+              ts.polls);
+    ScanResult scan = bandScanGetResult();
+    SerPrintf("Band Scan: %s, %u stations, %lu ms\n", bandScanStateName(scan.state), scan.stations, scan.totalMs);
+    SerPrintf("Key to Pixel: %lu frames, last %lu us, avg %lu us, max %lu us\n", rs.latencyCount, rs.latencyLastUs,
+              rs.latencyCount ? (uint32_t)(rs.latencySumUs / rs.latencyCount) : 0, rs.latencyMaxUs);
+    for (int d = 0; d < I2C_DEV_COUNT; d++)
+    {
+        I2cDeviceStats is = i2cBusGetStats((I2cDevice)d);
+        SerPrintf("I2C %-5s: %lu kHz, %lu xfers, %lu B, %lu errors, bus %lu ms, max %lu us, max queued %lu us\n",
+                  i2cBusDeviceName((I2cDevice)d), is.clockHz / 1000, is.transactions, is.bytes, is.errors,
+                  (uint32_t)(is.busUs / 1000), is.maxUs, is.maxWaitUs);
+    }
+    KeypadStats ks = keypadGetStats();
+    SerPrintf("Key Latency: %lu events, last %lu us, avg %lu us, max %lu us\n", ks.events, ks.lastUs,
+              ks.events ? (uint32_t)(ks.sumUs / ks.events) : 0, ks.maxUs);
+
+    for (int i = 0; i < eventBusSubscriberCount(); i++)
+    {
+        const char *name;
+        uint32_t mask, drops;
+        if (eventBusSubscriberInfo(i, &name, &mask, &drops))
+        {
+            SerPrintf("Event Subscriber %s: mask 0x%02lX, dropped %lu\n", name, mask, drops);
+        }
+    }
     SerPrintf("=====================\n");
 }
 
@@ -463,4 +582,244 @@ void cmd_exit(int argc, char **argv)
     SerPrintf("Monitor task continues running in background.\n");
     SerPrintf("Commands still available via serial.\n");
     // Task continues running, just acknowledges the exit command
-}
\ No newline at end of file
+}
+
+void cmd_prof(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        profPrintReport();
+    }
+    else if (strcmp(argv[1], "on") == 0)
+    {
+        profReset();
+        profSetEnabled(true);
+        SerPrintf("Profiler enabled\n");
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+        profSetEnabled(false);
+        SerPrintf("Profiler disabled\n");
+    }
+    else if (strcmp(argv[1], "reset") == 0)
+    {
+        profReset();
+        SerPrintf("Profiler counters cleared\n");
+    }
+    else if (strcmp(argv[1], "trace") == 0)
+    {
+        profPrintTrace(argc > 2 ? atoi(argv[2]) : 32);
+    }
+    else if (strcmp(argv[1], "watch") == 0 && argc > 2)
+    {
+        // Periodic report, one per second
+        int seconds = constrain(atoi(argv[2]), 1, 300);
+        for (int i = 0; i < seconds; i++)
+        {
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            profPrintReport();
+        }
+    }
+    else
+    {
+        SerPrintf("Usage: prof [on|off|reset|trace [n]|watch <seconds>]\n");
+    }
+}
+
+void cmd_save(int argc, char **argv)
+{
+    if (argc == 1)
+    {
+        bool pending = setupIsDirty();
+        uint32_t start = micros();
+        bool ok = settingsFlush();
+        SerPrintf("Settings %s in %lu us\n", !ok ? "write FAILED" : pending ? "written" : "unchanged",
+                  micros() - start);
+    }
+    else if (argc == 3 && strcmp(argv[1], "quiet") == 0)
+    {
+        settingsSetQuietPeriod(constrain(atoi(argv[2]), 100, SETTINGS_MAX_DELAY_MS));
+        SerPrintf("Settings quiet period %lu ms\n", settingsGetQuietPeriod());
+    }
+    else
+    {
+        SerPrintf("Usage: save [quiet <ms>]\n");
+    }
+}
+
+void cmd_glyph(int argc, char **argv)
+{
+    int iterations = argc > 1 ? constrain(atoi(argv[1]), 1, 10000) : 200;
+    GlyphBench b = RadioScreenHelpers::benchmarkGlyphs(iterations);
+    if (!b.atlasCycles)
+    {
+        SerPrintf("Glyph atlas not built\n");
+        return;
+    }
+    SerPrintf("Frequency update, %d runs: GFX %lu cycles, atlas %lu cycles (%lux), atlas %u bytes\n", iterations,
+              b.gfxCycles, b.atlasCycles, b.gfxCycles / b.atlasCycles, b.atlasBytes);
+}
+
+void cmd_scan(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "start") == 0)
+    {
+        SerPrintf(bandScanStart() ? "Band scan started\n" : "Band scan already running\n");
+        return;
+    }
+    if (argc > 1 && strcmp(argv[1], "stop") == 0)
+    {
+        bandScanCancel();
+        SerPrintf("Band scan stopping\n");
+        return;
+    }
+    if (argc > 1)
+    {
+        SerPrintf("Usage: scan [start|stop]\n");
+        return;
+    }
+
+    ScanResult r = bandScanGetResult();
+    SerPrintf("Band scan %s: %u/%u channels, %u stations, %u memories written\n", bandScanStateName(r.state),
+              r.progress, r.channels, r.stations, r.memories);
+    SerPrintf("Time: total %lu ms, sweep %lu ms (%lu us/channel avg, max %lu us), RDS %lu ms (max %lu ms), "
+              "%lu bus transactions\n",
+              r.totalMs, r.sweepMs, r.channels ? r.sweepMs * 1000 / r.channels : 0, r.sweepDwellMaxUs,
+              r.identifyMs, r.identifyDwellMaxMs, r.busTransactions);
+    for (int i = 0; i < r.stations; i++)
+    {
+        const ScanStation &s = r.station[i];
+        SerPrintf("%2d  %6.2f MHz  RSSI %2u  %s  ", i + 1, s.freq / 100.0, s.rssi, s.stereo ? "stereo" : "mono  ");
+        if (s.pi)
+            SerPrintf("PI %04X\n", s.pi);
+        else
+            SerPrintf("no RDS\n");
+    }
+}
+
+void cmd_tune(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        if (strcmp(argv[1], "up") == 0 || strcmp(argv[1], "down") == 0)
+            tunerSeek(argv[1][0] == 'u');
+        else if (strcmp(argv[1], "stop") == 0)
+            tunerCancel();
+        else if (atof(argv[1]) > 0)
+        {
+            // Checked before the cast, which would wrap above 655.35 MHz
+            Si4703Band band = tunerGetBand();
+            double mhz = atof(argv[1]);
+            if (band.spacing == 0 || mhz * 100 < band.bottom || mhz * 100 > band.top)
+            {
+                SerPrintf("Frequency outside the tuner band (%.2f - %.2f MHz)\n", band.bottom / 100.0,
+                          band.top / 100.0);
+                return;
+            }
+            tunerTune((uint16_t)(mhz * 100 + 0.5));
+        }
+        else
+        {
+            SerPrintf("Usage: tune [<MHz>|up|down|stop]\n");
+            return;
+        }
+    }
+
+    TunerStatus st = tunerGetStatus();
+    SerPrintf("Tuner %s%s: %.2f MHz (from %.2f), %lu ms%s\n", tunerPhaseName(st.phase),
+              st.phase == TunerPhase::Seeking ? (st.up ? " up" : " down") : "", st.freq / 100.0,
+              st.startFreq / 100.0, st.elapsedMs, st.bandLimit ? ", no station found" : "");
+}
+
+// Read pasted text: one line, or a JSON object that may span lines
+static size_t readImportText(char *buf, size_t size, uint32_t timeoutMs)
+{
+    size_t n = 0;
+    int depth = 0;
+    bool json = false, inString = false;
+    uint32_t last = millis();
+
+    while (millis() - last < timeoutMs)
+    {
+        if (!Serial.available())
+        {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        char ch = Serial.read();
+        last = millis();
+        if (n == 0 && (ch == '\r' || ch == '\n' || ch == ' '))
+            continue;
+        if (n == 0)
+            json = ch == '{';
+        if (!json && (ch == '\r' || ch == '\n'))
+            break;
+        if (n < size - 1)
+            buf[n++] = ch;
+        if (json)
+        {
+            if (ch == '"' && (n < 2 || buf[n - 2] != '\\'))
+                inString = !inString;
+            else if (!inString && ch == '{')
+                depth++;
+            else if (!inString && ch == '}' && --depth == 0)
+                break;
+        }
+    }
+    buf[n] = 0;
+    return n;
+}
+
+// Swap a complete new Setup in. The settings writer never stores half of
+// it, and the audio task drops the volumes it caches.
+static void applySetup(const SETUP &staged)
+{
+    setupLock();
+    Setup = staged;
+    setupUnlock();
+    markSetupDirty();
+    audioTask.setMusicVolume(staged.musicVolume);
+    audioTask.setAnnouncementVolume(staged.announcementVolume);
+    audioTask.setRetriggerMode(staged.retriggerMode);
+}
+
+void cmd_setup(int argc, char **argv)
+{
+    if (argc < 2 || strcmp(argv[1], "json") == 0)
+    {
+        setupExportJson(Serial, Setup);
+    }
+    else if (strcmp(argv[1], "bin") == 0)
+    {
+        setupExportBinary(Serial, Setup);
+    }
+    else if (strcmp(argv[1], "import") == 0)
+    {
+        static char text[1536];
+        SerPrintf("Paste JSON or SETUP line (10 s timeout):\n");
+        if (!readImportText(text, sizeof(text), 10000))
+        {
+            SerPrintf("Nothing received\n");
+            return;
+        }
+        // Imported into a copy; Setup only changes once the whole import is valid
+        static SETUP staged;
+        setupLock();
+        staged = Setup;
+        setupUnlock();
+        bool ok = text[0] == '{' ? setupImportJson(text, staged, Serial) : setupImportBinary(text, staged, Serial);
+        if (ok)
+            applySetup(staged);
+    }
+    else if (strcmp(argv[1], "defaults") == 0)
+    {
+        static SETUP staged;
+        setupSchemaDefaults(staged);
+        applySetup(staged);
+        SerPrintf("Settings reset to defaults\n");
+    }
+    else
+    {
+        SerPrintf("Usage: setup [json|bin|import|defaults]\n");
+    }
+}
@@ -29,6 +29,12 @@ void cmd_volume(int argc, char **argv);
 void cmd_source(int argc, char **argv);
 void cmd_freq(int argc, char **argv);
 void cmd_status(int argc, char **argv);
+void cmd_prof(int argc, char **argv);
+void cmd_save(int argc, char **argv);
+void cmd_setup(int argc, char **argv);
+void cmd_glyph(int argc, char **argv);
+void cmd_scan(int argc, char **argv);
+void cmd_tune(int argc, char **argv);
 void cmd_pwd(int argc, char **argv);
 void cmd_exit(int argc, char **argv);
 
@@ -0,0 +1,125 @@
+#include "SettingsTask.h"
+#include "../AppDrivers/setupDriver.h"
+#include "../SystemEvents.h"
+#include "esp_system.h"
+
+static TaskHandle_t settingsTaskHandle = nullptr;
+static volatile uint32_t quietPeriodMs = SETTINGS_QUIET_MS;
+static SettingsTaskStats stats;
+
+static void writeBatch()
+{
+    uint32_t start = micros();
+    flushSetup();
+    stats.lastBatchUs = micros() - start;
+    stats.writes++;
+}
+
+static void settingsTask(void *pvParameters)
+{
+    EventSubscriber sub = eventBusSubscribe("Settings", SYS_EVENT_MASK(SysEvent::SetupDirty));
+    SysEventRecord ev;
+
+    while (true)
+    {
+        unsigned long lastMark;
+        if (!setupIsDirty(&lastMark))
+        {
+            eventBusWait(portMAX_DELAY);
+            while (eventBusPoll(sub, ev))
+                ;
+            continue;
+        }
+
+        // Coalesce: keep waiting while changes keep coming, but not forever
+        unsigned long firstMark = millis();
+        while (setupIsDirty(&lastMark))
+        {
+            unsigned long now = millis();
+            uint32_t quiet = quietPeriodMs;
+            if (now - lastMark >= quiet || now - firstMark >= SETTINGS_MAX_DELAY_MS)
+            {
+                writeBatch();
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(quiet - (now - lastMark)) + 1);
+        }
+        while (eventBusPoll(sub, ev))
+            ;
+    }
+}
+
+static void settingsShutdownHandler()
+{
+    if (setupIsDirty())
+        settingsFlush();
+}
+
+bool initSettingsTask(uint32_t quietMs)
+{
+    if (settingsTaskHandle != nullptr)
+    {
+        Serial.println("SettingsTask: Task already running");
+        return false;
+    }
+    quietPeriodMs = quietMs;
+
+    // Below the UI task: a write only ever delays work nobody is waiting on
+    BaseType_t result = xTaskCreatePinnedToCore(
+        settingsTask,
+        "SettingsTask",
+        4096,
+        nullptr,
+        tskIDLE_PRIORITY + 1,
+        &settingsTaskHandle,
+        0);
+
+    if (result != pdPASS)
+    {
+        Serial.println("SettingsTask: Failed to create task");
+        settingsTaskHandle = nullptr;
+        return false;
+    }
+    esp_register_shutdown_handler(settingsShutdownHandler);
+    Serial.printf("SettingsTask: started, quiet period %lu ms\n", quietMs);
+    return true;
+}
+
+void settingsSetQuietPeriod(uint32_t quietMs)
+{
+    quietPeriodMs = quietMs;
+}
+
+uint32_t settingsGetQuietPeriod()
+{
+    return quietPeriodMs;
+}
+
+bool settingsFlush()
+{
+    stats.flushes++;
+    return flushSetup();
+}
+
+void settingsAudioPass(uint32_t flashSeqAtStart, uint32_t passUs)
+{
+    // A pass that started during a write, or saw one start, was exposed to
+    // the cache-disabled window of the flash operation
+    if ((flashSeqAtStart & 1) || setupFlashSeq() != flashSeqAtStart)
+    {
+        stats.audioPasses++;
+        if (passUs > stats.audioBlockedMaxUs)
+            stats.audioBlockedMaxUs = passUs;
+    }
+    else if (passUs > stats.audioPassMaxUs)
+    {
+        stats.audioPassMaxUs = passUs;
+    }
+}
+
+SettingsTaskStats settingsGetStats()
+{
+    SettingsTaskStats st = stats;
+    st.marks = setupMarkCount();
+    return st;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <Arduino.h>
+
+/**
+ * @brief SettingsTask - background writer for the Setup structure
+ *
+ * markSetupDirty() only flags the change. This low-priority task waits
+ * until no further change has been made for the quiet period (or the
+ * change has been pending for SETTINGS_MAX_DELAY_MS) and then writes
+ * everything in one batch, so flash erase/program stalls never land on
+ * the UI or audio task that made the change.
+ *
+ * Before a restart the pending changes are flushed from a shutdown
+ * handler; before deep sleep call settingsFlush() explicitly.
+ */
+
+#define SETTINGS_QUIET_MS      2000   // default quiet period before a write
+#define SETTINGS_MAX_DELAY_MS  30000  // longest a change may stay unsaved
+
+struct SettingsTaskStats {
+    uint32_t marks;            // markSetupDirty() calls
+    uint32_t writes;           // batches written by the task
+    uint32_t flushes;          // on-demand flushes
+    uint32_t lastBatchUs;      // duration of the last batch
+    uint32_t audioPasses;      // audio passes overlapping a flash write
+    uint32_t audioBlockedMaxUs;// longest such pass
+    uint32_t audioPassMaxUs;   // longest audio pass without a flash write
+};
+
+/**
+ * @brief Create the settings task and register the restart flush
+ * @param quietMs Quiet period after the last change before writing
+ * @return True if task creation successful
+ */
+bool initSettingsTask(uint32_t quietMs = SETTINGS_QUIET_MS);
+
+/**
+ * @brief Change the quiet period at runtime
+ */
+void settingsSetQuietPeriod(uint32_t quietMs);
+uint32_t settingsGetQuietPeriod();
+
+/**
+ * @brief Write pending changes now and wait for completion
+ * @return True if nothing was pending or the write succeeded
+ */
+bool settingsFlush();
+
+/**
+ * @brief AudioTask hook: pass duration and the setupFlashSeq() read at the
+ *        start of the pass, to attribute stalls to flash writes
+ */
+void settingsAudioPass(uint32_t flashSeqAtStart, uint32_t passUs);
+
+SettingsTaskStats settingsGetStats();
@@ -0,0 +1,405 @@
+#include "TunerTask.h"
+#include "Audiotask.h"
+#include "BandScan.h"
+#include "../AppDrivers/i2cBus.h"
+#include "../AppDrivers/si4703Regs.h"
+#include "../SystemEvents.h"
+
+enum class Request : uint8_t {
+    None,
+    Tune,
+    Seek,
+    Cancel
+};
+
+enum class Step : uint8_t {
+    Idle,
+    WaitStc,      // operation running
+    WaitClear     // TUNE/SEEK cleared, waiting for STC to drop
+};
+
+static TaskHandle_t tunerTaskHandle = nullptr;
+
+// Latest request, written by any task
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+static Request pendingRequest = Request::None;
+static uint16_t pendingFreq = 0;
+static bool pendingUp = false;
+static volatile bool busy = false;
+
+// Tuner task only
+static Si4703Regs regs;
+static Si4703Band band;
+static Step step = Step::Idle;
+static TunerPhase operation = TunerPhase::Idle;
+static TunerPhase outcome = TunerPhase::Done;
+static uint32_t operationStartMs = 0;
+static uint16_t lastChannel = 0;
+static bool bandLimit = false;
+static bool replacing = false;   // aborting for a new request, stay busy
+static TunerStats stats;
+
+// Under the lock
+static TunerStatus status;
+static Si4703Band publishedBand;
+
+static bool readFn(void *ctx)
+{
+    return si4703Read(regs, (uint8_t)(uintptr_t)ctx);
+}
+
+static bool writeFn(void *ctx)
+{
+    return si4703Write(regs, (uint8_t)(uintptr_t)ctx);
+}
+
+static bool readRegs(uint8_t count)
+{
+    stats.polls++;
+    return i2cBusRun(I2C_DEV_RADIO, I2C_PRIO_HIGH, readFn, (void *)(uintptr_t)count);
+}
+
+static bool writeRegs(uint8_t last)
+{
+    stats.polls++;
+    return i2cBusRun(I2C_DEV_RADIO, I2C_PRIO_HIGH, writeFn, (void *)(uintptr_t)last);
+}
+
+static void readBand()
+{
+    band = si4703Band(regs);
+    portENTER_CRITICAL(&lock);
+    publishedBand = band;
+    portEXIT_CRITICAL(&lock);
+}
+
+static uint16_t currentFreq()
+{
+    return si4703ChannelFreq(band, regs.reg[SI4703_READCHAN] & SI4703_CHAN_MASK);
+}
+
+static void update(TunerPhase phase, uint16_t freq)
+{
+    uint32_t elapsed = millis() - operationStartMs;
+    portENTER_CRITICAL(&lock);
+    status.phase = phase;
+    status.freq = freq;
+    status.bandLimit = bandLimit;
+    status.elapsedMs = elapsed;
+    status.seq++;
+    portEXIT_CRITICAL(&lock);
+    eventBusPublish(SysEvent::TunerProgress, (uint8_t)phase, freq, elapsed);
+}
+
+static void finish(TunerPhase phase, uint16_t freq)
+{
+    uint32_t ms = millis() - operationStartMs;
+    if (operation == TunerPhase::Seeking)
+    {
+        stats.seekLastMs = ms;
+        if (ms > stats.seekMaxMs)
+            stats.seekMaxMs = ms;
+    }
+    else
+    {
+        stats.tuneLastMs = ms;
+        if (ms > stats.tuneMaxMs)
+            stats.tuneMaxMs = ms;
+    }
+    if (phase == TunerPhase::Cancelled)
+        stats.cancels++;
+    else if (phase == TunerPhase::Failed)
+        stats.failures++;
+
+    step = Step::Idle;
+    operation = TunerPhase::Idle;
+
+    // Not busy before the final update, so a reader of it sees it settled
+    portENTER_CRITICAL(&lock);
+    if (!replacing && (pendingRequest == Request::None || pendingRequest == Request::Cancel))
+        busy = false;
+    portEXIT_CRITICAL(&lock);
+    update(phase, freq);
+    if (freq)
+        audioTask.radioTuned(freq);
+}
+
+// Clear TUNE and SEEK; the chip drops STC shortly after
+static bool clearOperation()
+{
+    regs.reg[SI4703_POWERCFG] &= ~SI4703_SEEK;
+    regs.reg[SI4703_CHANNEL] &= ~SI4703_TUNE;
+    return writeRegs(SI4703_CHANNEL);
+}
+
+static void abortOperation()
+{
+    clearOperation();
+    for (int i = 0; i < 10; i++)
+    {
+        if (!readRegs(2) || !(regs.reg[SI4703_STATUSRSSI] & SI4703_STC))
+            break;
+        vTaskDelay(1);
+    }
+    finish(TunerPhase::Cancelled, currentFreq());
+}
+
+static bool begin(TunerPhase op, bool up)
+{
+    // The scan retunes on its way out; wait for that before taking over
+    if (bandScanActive())
+    {
+        bandScanCancel();
+        while (bandScanActive())
+            vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    operation = op;
+    operationStartMs = millis();
+    bandLimit = false;
+    if (!readRegs(SI4703_REG_COUNT))
+    {
+        finish(TunerPhase::Failed, 0);
+        return false;
+    }
+    readBand();
+    lastChannel = regs.reg[SI4703_READCHAN] & SI4703_CHAN_MASK;
+
+    portENTER_CRITICAL(&lock);
+    status.up = up;
+    status.startFreq = currentFreq();
+    portEXIT_CRITICAL(&lock);
+    return true;
+}
+
+static void startTune(uint16_t freq)
+{
+    stats.tunes++;
+    if (!begin(TunerPhase::Tuning, false))
+        return;
+    regs.reg[SI4703_POWERCFG] &= ~SI4703_SEEK;
+    regs.reg[SI4703_CHANNEL] = (regs.reg[SI4703_CHANNEL] & ~SI4703_CHAN_MASK) | SI4703_TUNE |
+                               si4703FreqChannel(band, freq);
+    if (!writeRegs(SI4703_CHANNEL))
+    {
+        finish(TunerPhase::Failed, currentFreq());
+        return;
+    }
+    step = Step::WaitStc;
+    update(TunerPhase::Tuning, freq);
+}
+
+static void startSeek(bool up)
+{
+    stats.seeks++;
+    if (!begin(TunerPhase::Seeking, up))
+        return;
+    // Wrap at the band edge: a full circle ends on the start channel
+    regs.reg[SI4703_POWERCFG] = (regs.reg[SI4703_POWERCFG] & ~(SI4703_SKMODE | SI4703_SEEKUP)) | SI4703_SEEK |
+                                (up ? SI4703_SEEKUP : 0);
+    regs.reg[SI4703_CHANNEL] &= ~SI4703_TUNE;
+    if (!writeRegs(SI4703_POWERCFG))
+    {
+        finish(TunerPhase::Failed, currentFreq());
+        return;
+    }
+    step = Step::WaitStc;
+    update(TunerPhase::Seeking, currentFreq());
+}
+
+// One state machine step
+static void poll()
+{
+    if (!readRegs(2))
+    {
+        clearOperation();
+        finish(TunerPhase::Failed, 0);
+        return;
+    }
+    uint16_t st = regs.reg[SI4703_STATUSRSSI];
+    uint16_t channel = regs.reg[SI4703_READCHAN] & SI4703_CHAN_MASK;
+
+    if (step == Step::WaitClear)
+    {
+        if (!(st & SI4703_STC))
+            finish(outcome, currentFreq());
+        return;
+    }
+
+    if (operation == TunerPhase::Seeking && channel != lastChannel)
+    {
+        lastChannel = channel;
+        update(TunerPhase::Seeking, currentFreq());
+    }
+
+    uint32_t timeout = operation == TunerPhase::Seeking ? TUNER_SEEK_TIMEOUT_MS : TUNER_TUNE_TIMEOUT_MS;
+    if (st & SI4703_STC)
+    {
+        bandLimit = operation == TunerPhase::Seeking && (st & SI4703_SFBL);
+        outcome = TunerPhase::Done;
+    }
+    else if (millis() - operationStartMs >= timeout)
+    {
+        outcome = TunerPhase::Failed;
+    }
+    else
+    {
+        return;
+    }
+    clearOperation();
+    step = Step::WaitClear;
+}
+
+static TickType_t pollTicks()
+{
+    if (step == Step::Idle)
+        return portMAX_DELAY;
+    if (step == Step::WaitStc && operation == TunerPhase::Seeking)
+        return pdMS_TO_TICKS(TUNER_SEEK_POLL_MS);
+    return pdMS_TO_TICKS(TUNER_TUNE_POLL_MS);
+}
+
+static void tunerTask(void *pvParameters)
+{
+    // The screens and the console step and check against the band
+    if (readRegs(SI4703_REG_COUNT))
+        readBand();
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, pollTicks());
+
+        portENTER_CRITICAL(&lock);
+        Request request = pendingRequest;
+        uint16_t freq = pendingFreq;
+        bool up = pendingUp;
+        pendingRequest = Request::None;
+        portEXIT_CRITICAL(&lock);
+
+        if (request != Request::None && step != Step::Idle)
+        {
+            replacing = request != Request::Cancel;
+            abortOperation();
+            replacing = false;
+        }
+        if (request == Request::Tune)
+            startTune(freq);
+        else if (request == Request::Seek)
+            startSeek(up);
+        else if (step != Step::Idle)
+            poll();
+    }
+}
+
+static void post(Request request, uint16_t freq, bool up)
+{
+    portENTER_CRITICAL(&lock);
+    pendingRequest = request;
+    pendingFreq = freq;
+    pendingUp = up;
+    if (request != Request::Cancel)
+        busy = true;
+    portEXIT_CRITICAL(&lock);
+    if (tunerTaskHandle)
+        xTaskNotifyGive(tunerTaskHandle);
+}
+
+bool initTunerTask()
+{
+    if (tunerTaskHandle != nullptr)
+    {
+        Serial.println("TunerTask: Task already running");
+        return false;
+    }
+
+    // Above the UI so a seek follows the keys, below the bus task; it
+    // sleeps between polls
+    BaseType_t result = xTaskCreatePinnedToCore(
+        tunerTask,
+        "TunerTask",
+        3072,
+        nullptr,
+        2,
+        &tunerTaskHandle,
+        0);
+
+    if (result != pdPASS)
+    {
+        Serial.println("TunerTask: Failed to create task");
+        tunerTaskHandle = nullptr;
+        return false;
+    }
+    // A request posted before the task existed (audioTask.begin() tunes the
+    // saved station) had no handle to notify; let the first pass pick it up
+    xTaskNotifyGive(tunerTaskHandle);
+    return true;
+}
+
+void tunerTune(uint16_t freq)
+{
+    post(Request::Tune, freq, false);
+}
+
+void tunerSeek(bool up)
+{
+    post(Request::Seek, 0, up);
+}
+
+void tunerCancel()
+{
+    // Checked and posted in one step, so a tune posted in between is not
+    // replaced by the cancel
+    portENTER_CRITICAL(&lock);
+    bool active = busy;
+    if (active)
+        pendingRequest = Request::Cancel;
+    portEXIT_CRITICAL(&lock);
+    if (active && tunerTaskHandle)
+        xTaskNotifyGive(tunerTaskHandle);
+}
+
+bool tunerBusy()
+{
+    return busy;
+}
+
+TunerStatus tunerGetStatus()
+{
+    portENTER_CRITICAL(&lock);
+    TunerStatus s = status;
+    portEXIT_CRITICAL(&lock);
+    return s;
+}
+
+Si4703Band tunerGetBand()
+{
+    portENTER_CRITICAL(&lock);
+    Si4703Band b = publishedBand;
+    portEXIT_CRITICAL(&lock);
+    return b;
+}
+
+TunerStats tunerGetStats()
+{
+    return stats;
+}
+
+const char *tunerPhaseName(TunerPhase phase)
+{
+    switch (phase)
+    {
+    case TunerPhase::Idle:
+        return "idle";
+    case TunerPhase::Tuning:
+        return "tuning";
+    case TunerPhase::Seeking:
+        return "seeking";
+    case TunerPhase::Done:
+        return "done";
+    case TunerPhase::Cancelled:
+        return "cancelled";
+    case TunerPhase::Failed:
+        return "failed";
+    }
+    return "?";
+}
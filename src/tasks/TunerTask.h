@@ -0,0 +1,92 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <Arduino.h>
+#include "../AppDrivers/si4703Regs.h"
+
+/**
+ * @brief TunerTask - non-blocking tune and seek for the Si4703
+ *
+ * Tune and seek are state machines: start the operation, poll STC through
+ * the I2C bus task at HIGH priority and sleep in between, then clear the
+ * TUNE/SEEK bit and wait for STC to drop. Callers only post a request and
+ * return; progress is published as TunerStatus plus a TunerProgress event:
+ *
+ * - every channel the seek passes, so the display can follow it
+ * - the final channel, with the phase Done, Cancelled or Failed
+ *
+ * A new request replaces the one in progress; tunerCancel() stops a seek
+ * where it is. Requests wake the task at once, so a cancel takes effect
+ * within one bus transaction. A running band scan is cancelled first.
+ * The audio task is told the new channel (AudioTask::radioTuned()).
+ */
+
+#define TUNER_TUNE_POLL_MS   5      // STC polling while tuning
+#define TUNER_SEEK_POLL_MS   20     // STC/channel polling while seeking
+#define TUNER_TUNE_TIMEOUT_MS 200
+#define TUNER_SEEK_TIMEOUT_MS 15000 // a full band with wrap-around
+
+enum class TunerPhase : uint8_t {
+    Idle,
+    Tuning,
+    Seeking,
+    Done,
+    Cancelled,
+    Failed
+};
+
+struct TunerStatus {
+    TunerPhase phase;
+    bool up;                   // seek direction
+    bool bandLimit;            // seek came back without a station
+    uint16_t freq;             // current channel, 10 kHz units
+    uint16_t startFreq;        // channel the operation started from
+    uint32_t elapsedMs;        // of the current or last operation
+    uint32_t seq;              // changes with every update
+};
+
+struct TunerStats {
+    uint32_t tunes;
+    uint32_t seeks;
+    uint32_t cancels;
+    uint32_t failures;
+    uint32_t tuneLastMs, tuneMaxMs;
+    uint32_t seekLastMs, seekMaxMs;
+    uint32_t polls;            // bus transactions of the task
+};
+
+/**
+ * @brief Create the tuner task (after the tuner has been started)
+ */
+bool initTunerTask();
+
+/**
+ * @brief Tune to 'freq' (10 kHz units); returns at once
+ */
+void tunerTune(uint16_t freq);
+
+/**
+ * @brief Seek to the next station up or down, wrapping at the band edge
+ */
+void tunerSeek(bool up);
+
+/**
+ * @brief Stop a seek or tune in progress
+ */
+void tunerCancel();
+
+/**
+ * @brief True from a request until its Done/Cancelled/Failed update
+ */
+bool tunerBusy();
+
+TunerStatus tunerGetStatus();
+
+/**
+ * @brief Band and channel spacing the tuner is configured for (SYSCONFIG2);
+ *        spacing is 0 until the task has read the chip
+ */
+Si4703Band tunerGetBand();
+TunerStats tunerGetStats();
+const char *tunerPhaseName(TunerPhase phase);
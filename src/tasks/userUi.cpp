@@ -8,12 +8,15 @@
 #include "Screens/MainMenuScreen.h"
 #include "Screens/OperationScreen.h"
 #include "../AppDrivers/setupDriver.h"
+#include "../SystemEvents.h"
+#include "../AppDrivers/i2cBus.h"
+#include "../AppDrivers/inputEvents.h"
+#include "RenderTask.h"
+#include "Profiler.h"
 
 // Display configuration
-#define SCREEN_WIDTH 128
-#define SCREEN_HEIGHT 64
 #define OLED_RESET -1
-#define SCREEN_ADDRESS 0x3C
+#define OLED_I2C_CLOCK 400000 // SSD1306 is rated for 400 kHz, many panels run at 1 MHz
 
 // Global objects
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
@@ -25,6 +28,23 @@ ScreenID currentScreen = SCREEN_OPERATION; // Start with operation screen
 static unsigned long globalLastKeyTime = 0;
 static bool globalIsDimmed = false;
 
+// Event bus subscription of the UI task
+static EventSubscriber uiEvents = -1;
+
+// Keys and optos reach the UI through the input FIFO (inputEvents.h), which
+// keeps every event in order; this bit wakes the task on a push
+#define UI_INPUT_NOTIFY_BIT (1u << 0)
+
+// Announcement played when an opto input is asserted, by input index
+#define OPTO_ANNOUNCEMENT_PATH "/announce/input%02u.mp3"
+
+// Key events popped from the FIFO and not yet taken by the screen, in order.
+// Opto events are handled when they are popped and never wait here.
+static InputEvent keyQueue[INPUT_EVENT_QUEUE_LEN];
+static uint8_t keyHead = 0, keyTail = 0;
+static uint8_t keysHeld = NONE;     // pressed and not released yet
+static uint8_t keysGestured = NONE; // held keys whose release is not a click
+
 // Function prototypes
 void initDisplay();
 void uiTask(void *parameter);
@@ -33,20 +53,19 @@ ScreenID callScreen(ScreenID screenId);
 // Common display helper functions
 void setDisplayBrightness(uint8_t brightness)
 {
-    display.ssd1306_command(SSD1306_SETCONTRAST);
-    display.ssd1306_command(brightness);
+    const uint8_t cmd[] = {0x00, SSD1306_SETCONTRAST, brightness};
+    i2cBusWrite(I2C_DEV_OLED, I2C_PRIO_LOW, SCREEN_ADDRESS, cmd, sizeof(cmd));
 }
 
 void applyDisplayRotation()
 {
-    display.ssd1306_command(SSD1306_SEGREMAP);
-    display.ssd1306_command(SSD1306_COMSCANINC);
+    const uint8_t cmd[] = {0x00, SSD1306_SEGREMAP, SSD1306_COMSCANINC};
+    i2cBusWrite(I2C_DEV_OLED, I2C_PRIO_LOW, SCREEN_ADDRESS, cmd, sizeof(cmd));
 }
 
-bool checkExitCombo()
+bool checkExitCombo(const InputEvent &evt)
 {
-    uint8_t key = getKeypadState();
-    return ((key & PREVIOUS) && (key & NEXT));
+    return evt.type == KEY_EVENT_CHORD && evt.input == KEY_CHORD_EXIT;
 }
 
 /**
@@ -85,12 +104,123 @@ void resetScreenBrightness()
     setDisplayBrightness(NORMAL_BRIGHTNESS);
 }
 
+// Opto inputs, including the alarm inputs: an asserted input plays its
+// announcement, whatever screen is shown
+static void handleOptoEvent(const InputEvent &evt)
+{
+    if (evt.type != KEY_EVENT_PRESS)
+        return;
+    char path[32];
+    snprintf(path, sizeof(path), OPTO_ANNOUNCEMENT_PATH, evt.input);
+    Serial.printf("UserUI: Opto %u%s -> %s\n", evt.input, evt.alarm ? " (alarm)" : "", path);
+    audioTask.playAnnouncement(path);
+}
+
+static uint32_t pollUiEvents()
+{
+    uint32_t received = 0;
+    SysEventRecord evt;
+    while (eventBusPoll(uiEvents, evt))
+    {
+        received |= SYS_EVENT_MASK(evt.type);
+    }
+
+    InputEvent in;
+    while (inputEventPop(in))
+    {
+        if (in.source == INPUT_SRC_OPTO)
+        {
+            handleOptoEvent(in);
+            received |= SYS_EVENT_MASK(SysEvent::Opto);
+        }
+        else if ((uint8_t)(keyHead - keyTail) < INPUT_EVENT_QUEUE_LEN)
+        {
+            keyQueue[keyHead++ % INPUT_EVENT_QUEUE_LEN] = in;
+            received |= SYS_EVENT_MASK(SysEvent::Key);
+        }
+    }
+    return received;
+}
+
+/**
+ * @brief Take the next key event for the screen, oldest first
+ *
+ * A key's RELEASE is only passed on for a plain click: it is dropped after
+ * a long press, repeat or chord of that key, and for keys that were already
+ * held when the screen before this one returned.
+ */
+bool nextKeyEvent(InputEvent &evt)
+{
+    while (keyTail != keyHead)
+    {
+        evt = keyQueue[keyTail++ % INPUT_EVENT_QUEUE_LEN];
+        switch (evt.type)
+        {
+        case KEY_EVENT_PRESS:
+        case KEY_EVENT_DOUBLE:
+            keysHeld |= evt.input;
+            keysGestured &= ~evt.input;
+            break;
+        case KEY_EVENT_LONGPRESS:
+        case KEY_EVENT_REPEAT:
+        case KEY_EVENT_CHORD:
+            keysGestured |= evt.input;
+            break;
+        case KEY_EVENT_RELEASE: {
+            bool click = !(keysGestured & evt.input);
+            keysHeld &= ~evt.input;
+            keysGestured &= ~evt.input;
+            if (!click)
+                continue;
+            break;
+        }
+        default:
+            break;
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Start a screen: keys still held from the last one do not click
+ */
+static void enterScreen()
+{
+    keysGestured |= keysHeld;
+}
+
+/**
+ * @brief Block the screen loop until an event arrives or the timeout expires
+ * @param timeout Longest sleep, so periodic work (RSSI, dimming) still runs
+ * @return Mask of the event types received (SYS_EVENT_MASK bits)
+ */
+uint32_t waitForUiEvent(TickType_t timeout)
+{
+    // Events that arrived while the screen was busy don't need a wait
+    uint32_t received = pollUiEvents();
+    if (received || keyTail != keyHead)
+    {
+        return received;
+    }
+
+    // Any notification ends the wait: the bus bit or UI_INPUT_NOTIFY_BIT
+    eventBusWait(timeout);
+    received = pollUiEvents();
+    PROF_TRACE(PROF_UI_WAKE, received);
+    return received;
+}
+
 void initDisplay()
 {
     // I2C bus should already be initialized in main.cpp
     // Wire.begin() is not called here to avoid conflicts with FM radio
 
-    if (!display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS))
+    i2cBusSetClock(I2C_DEV_OLED, OLED_I2C_CLOCK);
+    bool ok = i2cBusRun(I2C_DEV_OLED, I2C_PRIO_LOW, [](void *) {
+        return display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS);
+    }, nullptr);
+    if (!ok)
     {
         Serial.println("UserUI: SSD1306 allocation failed");
         return;
@@ -102,13 +232,19 @@ void initDisplay()
     display.clearDisplay();
     display.setTextSize(1);
     display.setTextColor(SSD1306_WHITE);
-    display.display();
+
+    RadioScreenHelpers::buildGlyphs();
+
+    // From here on only the render task touches the frame buffer
+    renderInvalidate();
+    initRenderTask();
     Serial.println("UserUI: Display initialized (I2C bus shared with FM radio)");
 }
 
 ScreenID callScreen(ScreenID screenId)
 {
     Serial.printf("UserUI: Calling screen %d\n", screenId);
+    enterScreen();
 
     switch (screenId)
     {
@@ -148,6 +284,12 @@ void uiTask(void *parameter)
 {
     Serial.println("UserUI: Starting UI task");
 
+    uiEvents = eventBusSubscribe("UI", SYS_EVENT_MASK(SysEvent::TrackChanged) |
+                                           SYS_EVENT_MASK(SysEvent::SourceChanged) |
+                                           SYS_EVENT_MASK(SysEvent::RdsChanged) |
+                                           SYS_EVENT_MASK(SysEvent::TunerProgress));
+    inputEventSubscribe(xTaskGetCurrentTaskHandle(), UI_INPUT_NOTIFY_BIT);
+
     initDisplay();
 
     Serial.println("UserUI: Display initialized, starting screen flow");
@@ -160,11 +302,9 @@ void uiTask(void *parameter)
     // Simple screen flow manager - just calls screens and follows return values
     while (true)
     {
+        // Screens block on events, so no delay is needed between them
         ScreenID nextScreen = callScreen(currentScreen);
         currentScreen = nextScreen;
-
-        // Small delay to prevent excessive CPU usage
-        vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
 
@@ -2,6 +2,7 @@
 
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
+#define SCREEN_ADDRESS 0x3C
 
 #include <Adafruit_SSD1306.h>
 #include <Fonts/FreeMonoBold12pt7b.h>
@@ -10,13 +11,17 @@
 #include "keypadDriver.h"
 #include "optoInDriver.h"
 #include "setupDriver.h"
+#include "RenderTask.h"
+#include "inputEvents.h"
 
 // Common display functions
 void setDisplayBrightness(uint8_t brightness);
 void applyDisplayRotation();
-bool checkExitCombo();
+bool checkExitCombo(const InputEvent &evt);
 void handleScreenBrightness(bool keyPressed);
 void resetScreenBrightness();
+uint32_t waitForUiEvent(TickType_t timeout);
+bool nextKeyEvent(InputEvent &evt);
 
 // External references
 extern Adafruit_SSD1306 display;
@@ -25,6 +30,7 @@ extern Adafruit_SSD1306 display;
 const uint8_t NORMAL_BRIGHTNESS = 255;
 const uint8_t DIM_BRIGHTNESS = 64;
 const unsigned long BRIGHTNESS_TIMEOUT_MS = 30000; // 30 seconds
+const TickType_t UI_IDLE_TICKS = pdMS_TO_TICKS(100);  // longest sleep between screen loop passes
 
 // Helper classes forward declarations
 namespace MainMenuHelpers {
@@ -32,7 +38,7 @@ namespace MainMenuHelpers {
 }
 
 namespace OperationHelpers {
-    void drawStatus(Adafruit_SSD1306* display, uint8_t source, uint8_t volume, uint8_t floor);
+    void drawStatus(Adafruit_SSD1306* display, uint8_t source, uint8_t volume, uint8_t floor, uint16_t frequency);
 }
 
 namespace RadioScreenHelpers {
@@ -132,7 +138,6 @@ namespace OperationHelpers {
     const unsigned long BRIGHTNESS_TIMEOUT_MS = 30000; // 30 seconds
     
     void initDisplay(Adafruit_SSD1306* display);
-    void drawStatus(Adafruit_SSD1306* display, uint8_t source, uint8_t volume, uint8_t floor);
+    void drawStatus(Adafruit_SSD1306* display, uint8_t source, uint8_t volume, uint8_t floor, uint16_t frequency);
     void setDisplayBrightness(Adafruit_SSD1306* display, uint8_t brightness);
-    bool checkExitCombo();
 }